@@ -581,7 +581,7 @@ void Thread::setCurrentThreadAffinityMask (const uint32 affinityMask)
        If you don't want to update your copy of glibc and don't care about cpu affinities,
        then you can just disable all this stuff by setting the SUPPORT_AFFINITIES macro to 0.
     */
-    sched_setaffinity (getpid(), sizeof (cpu_set_t), &affinity);
+    sched_setaffinity (0, sizeof (cpu_set_t), &affinity);
     sched_yield();
 
    #else
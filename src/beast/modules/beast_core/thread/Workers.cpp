@@ -23,6 +23,11 @@ Workers::Workers (Callback& callback, String const& threadNames, int numberOfThr
     , m_allPaused (true, true)
     , m_semaphore (0)
     , m_numberOfThreads (0)
+    , m_stealing (false)
+    , m_createdCount (0)
+    , m_affinityMask (0)
+    , m_pinThreads (false)
+    , m_nextCpu (0)
 {
     setNumberOfThreads (numberOfThreads);
 }
@@ -67,7 +72,10 @@ void Workers::setNumberOfThreads (int numberOfThreads)
                 }
                 else
                 {
-                    worker = new Worker (*this, m_threadNames);
+                    int const slot = (m_createdCount < maxLocalQueues) ? m_createdCount : -1;
+                    ++m_createdCount;
+
+                    worker = new Worker (*this, m_threadNames, slot, getNextAffinityMask ());
                 }
 
                 m_everyone.push_front (worker);
@@ -101,8 +109,41 @@ void Workers::pauseAllThreadsAndWait ()
     bassert (numberOfCurrentlyRunningTasks () == 0);
 }
 
+void Workers::setWorkStealing (bool enabled)
+{
+    m_stealing = enabled;
+}
+
+void Workers::setAffinity (uint32 cpuMask, bool pinThreads)
+{
+    m_affinityMask = cpuMask;
+    m_pinThreads = pinThreads;
+    m_nextCpu = 0;
+}
+
 void Workers::addTask ()
 {
+    if (m_stealing)
+    {
+        Worker* const worker = getCurrentWorker ();
+
+        // Keep the task for the calling thread unless another
+        // thread is idle and could start on it right away.
+        //
+        if (worker != nullptr && worker->getSlot () >= 0 && m_idleCount.get () == 0)
+        {
+            ++m_localTasks [worker->getSlot ()];
+
+            // A thread may have gone idle after we checked, and missed
+            // the task when it looked for one to steal. Hand it over.
+            //
+            if (m_idleCount.get () > 0 && takeTask (worker->getSlot ()))
+                m_semaphore.signal ();
+
+            return;
+        }
+    }
+
     m_semaphore.signal ();
 }
 
@@ -116,6 +157,73 @@ double Workers::getUtilization () const
     return m_usage.getUtilization();
 }
 
+Workers::Worker* Workers::getCurrentWorker () const
+{
+    Worker* const worker = dynamic_cast <Worker*> (Thread::getCurrentThread ());
+
+    if (worker != nullptr && &worker->getWorkers () == this)
+        return worker;
+
+    return nullptr;
+}
+
+uint32 Workers::getNextAffinityMask ()
+{
+    if (m_affinityMask == 0 || ! m_pinThreads)
+        return m_affinityMask;
+
+    // Pick the next allowed CPU, wrapping around
+    for (int i = 0; i < 32; ++i)
+    {
+        int const cpu = (m_nextCpu + i) % 32;
+
+        if ((m_affinityMask & (uint32 (1) << cpu)) != 0)
+        {
+            m_nextCpu = cpu + 1;
+            return uint32 (1) << cpu;
+        }
+    }
+
+    return m_affinityMask;
+}
+
+// Takes one task from the local count of a thread, if it has any.
+//
+bool Workers::takeTask (int slot)
+{
+    Atomic <int>& tasks (m_localTasks [slot]);
+
+    for (;;)
+    {
+        int const count = tasks.get ();
+
+        if (count <= 0)
+            return false;
+
+        if (tasks.compareAndSetBool (count - 1, count))
+            return true;
+    }
+}
+
+// Takes a task kept by the given thread, or failing that steals one
+// kept by another thread. A slot of -1 only steals.
+//
+bool Workers::takeLocalTask (int slot)
+{
+    if (slot >= 0 && takeTask (slot))
+        return true;
+
+    int const count = std::min (m_createdCount, int (maxLocalQueues));
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (i != slot && takeTask (i))
+            return true;
+    }
+
+    return false;
+}
+
 void Workers::deleteWorkers (LockFreeStack <Worker>& stack)
 {
     for (;;)
@@ -136,10 +244,16 @@ void Workers::deleteWorkers (LockFreeStack <Worker>& stack)
 
 //------------------------------------------------------------------------------
 
-Workers::Worker::Worker (Workers& workers, String const& threadName)
+Workers::Worker::Worker (Workers& workers, String const& threadName,
+                         int slot, uint32 affinityMask)
     : Thread (threadName)
     , m_workers (workers)
+    , m_threadName (threadName)
+    , m_slot (slot)
 {
+    if (affinityMask != 0)
+        setAffinityMask (affinityMask);
+
     startThread ();
 }
 
@@ -160,12 +274,44 @@ void Workers::Worker::run ()
 
         for (;;)
         {
+            // Perform tasks we kept, or steal from a busy thread,
+            // before waiting on the shared semaphore.
+            //
+            if (m_workers.m_stealing && m_workers.takeLocalTask (m_slot))
+            {
+                CPUMeter::ScopedActiveTime elapsed (m_workers.m_usage);
+
+                runTask ();
+                continue;
+            }
+
             // Acquire a task or "internal task."
             //
+            bool stolen = false;
+
             {
                 CPUMeter::ScopedIdleTime elapsed (m_workers.m_usage);
 
-                m_workers.m_semaphore.wait ();
+                ++m_workers.m_idleCount;
+
+                // Look again now that we are counted as idle, a task
+                // kept by another thread before that might have been missed.
+                //
+                if (m_workers.m_stealing)
+                    stolen = m_workers.takeLocalTask (m_slot);
+
+                if (! stolen)
+                    m_workers.m_semaphore.wait ();
+
+                --m_workers.m_idleCount;
+            }
+
+            if (stolen)
+            {
+                CPUMeter::ScopedActiveTime elapsed (m_workers.m_usage);
+
+                runTask ();
+                continue;
             }
 
             {
@@ -196,13 +342,8 @@ void Workers::Worker::run ()
                 // We couldn't pause so we must have gotten
                 // unblocked in order to process a task.
                 //
-                ++m_workers.m_runningTaskCount;
-                m_workers.m_callback.processTask ();
-                --m_workers.m_runningTaskCount;
+                runTask ();
             }
-
-            // Put the name back in case the callback changed it
-            Thread::setCurrentThreadName (m_threadName);
         }
 
         // Any worker that goes into the paused list must
@@ -230,6 +371,16 @@ void Workers::Worker::run ()
     }
 }
 
+void Workers::Worker::runTask ()
+{
+    ++m_workers.m_runningTaskCount;
+    m_workers.m_callback.processTask ();
+    --m_workers.m_runningTaskCount;
+
+    // Put the name back in case the callback changed it
+    Thread::setCurrentThreadName (m_threadName);
+}
+
 //------------------------------------------------------------------------------
 
 class WorkersTests : public UnitTest
@@ -287,8 +438,69 @@ public:
         expectEquals (count, 0);
     }
 
+    // Each task adds another one from inside processTask
+    // until the total has been reached.
+    //
+    struct SpawningCallback : Workers::Callback
+    {
+        SpawningCallback (int count_, int toSpawn_)
+            : finished (false, count_ == 0)
+            , workers (nullptr)
+            , count (count_)
+            , toSpawn (toSpawn_)
+        {
+        }
+
+        void processTask ()
+        {
+            if (--toSpawn >= 0)
+                workers->addTask ();
+
+            if (--count == 0)
+                finished.signal ();
+        }
+
+        WaitableEvent finished;
+        Workers* workers;
+        Atomic <int> count;
+        Atomic <int> toSpawn;
+    };
+
+    void testStealing (int const threadCount)
+    {
+        String s;
+        s << "stealing, threadCount = " << String (threadCount);
+        beginTestCase (s);
+
+        int const taskCount = 1000;
+
+        SpawningCallback cb (taskCount, taskCount - threadCount);
+
+        Workers w (cb, "Test", 0);
+        cb.workers = &w;
+        w.setWorkStealing (true);
+        w.setNumberOfThreads (threadCount);
+
+        for (int i = 0; i < threadCount; ++i)
+            w.addTask ();
+
+        bool signaled = cb.finished.wait (10 * 1000);
+
+        expect (signaled, "timed out");
+
+        w.pauseAllThreadsAndWait ();
+
+        int const count (cb.count.get ());
+
+        expectEquals (count, 0);
+    }
+
     void runTest ()
     {
+        testStealing (1);
+        testStealing (4);
+        testStealing (16);
+
         testThreads (0);
         testThreads (1);
         testThreads (2);
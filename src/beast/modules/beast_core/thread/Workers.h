@@ -77,6 +77,30 @@ public:
     */
     void pauseAllThreadsAndWait ();
 
+    /** Enable or disable work stealing.
+
+        When enabled, a task added from inside Callback::processTask is
+        kept by the calling thread and performed as soon as its current
+        task returns, so related work stays on the same core. If another
+        thread is idle, or becomes idle first, it steals the task instead.
+
+        @note This function is not thread-safe, call it before adding tasks.
+    */
+    void setWorkStealing (bool enabled);
+
+    /** Restrict the threads to a set of CPUs.
+
+        This only applies to threads created after the call.
+
+        @param cpuMask Bit N allows the threads to run on CPU N. Zero allows
+                       any CPU.
+        @param pinThreads If `true`, each thread is bound to a single CPU from
+                          the mask, assigned in turn as threads are created.
+
+        @note This function is not thread-safe.
+    */
+    void setAffinity (uint32 cpuMask, bool pinThreads);
+
     /** Add a task to be performed.
 
         Every call to addTask will eventually result in a call to
@@ -115,20 +139,44 @@ private:
         , public Thread
     {
     public:
-        Worker (Workers& workers, String const& threadName);
+        Worker (Workers& workers, String const& threadName,
+                int slot, uint32 affinityMask);
 
         ~Worker ();
 
+        Workers& getWorkers () const noexcept
+        {
+            return m_workers;
+        }
+
+        // Index of this thread's local task count, or -1 if it has none
+        int getSlot () const noexcept
+        {
+            return m_slot;
+        }
+
     private:
         void run ();
+        void runTask ();
 
     private:
         Workers& m_workers;
         String m_threadName;
+        int const m_slot;
+    };
+
+    // The number of threads that can keep tasks for themselves
+    enum
+    {
+        maxLocalQueues = 64
     };
 
 private:
     static void deleteWorkers (LockFreeStack <Worker>& stack);
+    Worker* getCurrentWorker () const;
+    uint32 getNextAffinityMask ();
+    bool takeTask (int slot);
+    bool takeLocalTask (int slot);
 
 private:
     Callback& m_callback;
@@ -142,6 +190,13 @@ private:
     Atomic <int> m_runningTaskCount;             // how many calls to processTask() active
     LockFreeStack <Worker> m_everyone;           // holds all created workers
     LockFreeStack <Worker, PausedTag> m_paused;  // holds just paused workers
+    bool m_stealing;                             // keep spawned tasks local
+    Atomic <int> m_idleCount;                    // threads waiting for a task
+    int m_createdCount;                          // worker threads ever created
+    uint32 m_affinityMask;                       // allowed CPUs, 0 for any
+    bool m_pinThreads;                           // one CPU per thread
+    int m_nextCpu;                               // next CPU to pin to
+    Atomic <int> m_localTasks [maxLocalQueues];  // tasks kept by each thread
 };
 
 #endif
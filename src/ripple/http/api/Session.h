@@ -84,6 +84,15 @@ public:
     virtual void write (void const* buffer, std::size_t bytes) = 0;
     /** @} */
 
+    /** Block until no more than maxBytes of written data remain unsent.
+        This lets a producer on another thread keep pace with the
+        connection. It must not be called from an io_service thread.
+        Data dropped because the connection failed counts as sent.
+        @return false if the connection failed, or a write took too long,
+                so the rest of the reply will not be delivered.
+    */
+    virtual bool waitForWrites (std::size_t maxBytes) = 0;
+
     /** Output support using ostream. */
     /** @{ */
     ScopedStream operator<< (std::ostream& manip (std::ostream&))
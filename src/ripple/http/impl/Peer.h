@@ -48,7 +48,10 @@ public:
         dataTimeoutSeconds = 10,
 
         // Max seconds without completing the request
-        requestTimeoutSeconds = 30
+        requestTimeoutSeconds = 30,
+
+        // Max seconds to send one queued buffer
+        writeTimeoutSeconds = 30
 
     };
 
@@ -58,10 +61,14 @@ public:
     boost::asio::io_service::strand m_strand;
     boost::asio::deadline_timer m_data_timer;
     boost::asio::deadline_timer m_request_timer;
+    boost::asio::deadline_timer m_write_timer;
     ScopedPointer <MultiSocket> m_socket;
     MemoryBlock m_buffer;
     HTTPRequestParser m_parser;
-    int m_writesPending;
+    std::deque <SharedBuffer> m_writeQueue;
+    Atomic <int> m_writeFailed;
+    Atomic <int> m_bytesQueued;
+    WaitableEvent m_writeDone;
     bool m_closed;
     bool m_callClose;
     Atomic <int> m_detached;
@@ -76,8 +83,8 @@ public:
         , m_strand (m_impl.get_io_service())
         , m_data_timer (m_impl.get_io_service())
         , m_request_timer (m_impl.get_io_service())
+        , m_write_timer (m_impl.get_io_service())
         , m_buffer (bufferSize)
-        , m_writesPending (0)
         , m_closed (false)
         , m_callClose (false)
         , m_errorCode (0)
@@ -154,6 +161,8 @@ public:
     // Send a copy of the data.
     void write (void const* buffer, std::size_t bytes)
     {
+        m_bytesQueued += static_cast <int> (bytes);
+
         // Make sure this happens on an io_service thread.
         m_impl.get_io_service().dispatch (m_strand.wrap (
             boost::bind (&Peer::handle_write, Ptr (this),
@@ -161,6 +170,16 @@ public:
                     CompletionCounter (this))));
     }
 
+    // Block until no more than maxBytes are waiting to be sent.
+    // Returns false if the connection failed and data was dropped.
+    bool waitForWrites (std::size_t maxBytes)
+    {
+        while (m_bytesQueued.get () > static_cast <int> (maxBytes))
+            m_writeDone.wait ();
+
+        return m_writeFailed.get () == 0;
+    }
+
     // Make the Session asynchronous
     void detach ()
     {
@@ -238,7 +257,18 @@ public:
     // Called from an io_service thread to write the shared buffer.
     void handle_write (SharedBuffer const& buf, CompletionCounter)
     {
-        async_write (buf);
+        if (m_writeFailed.get () != 0)
+        {
+            release (buf);
+            return;
+        }
+
+        m_writeQueue.push_back (buf);
+
+        // Only one write is in progress at a time, so the
+        // buffers go out in order without interleaving.
+        if (m_writeQueue.size () == 1)
+            async_write ();
     }
 
     // Called when the handshake completes
@@ -297,21 +327,67 @@ public:
             boost::system::errc::timed_out));
     }
 
-    // Called when async_write completes.
-    void handle_write (error_code ec, std::size_t bytes_transferred,
-        SharedBuffer buf, CompletionCounter)
+    // Called when the write timer expires
+    //
+    // This is not skipped when the session is closed, so a client
+    // that stops reading cannot hold the queued buffers forever.
+    //
+    void handle_write_timer (error_code ec, CompletionCounter)
     {
         if (ec == boost::asio::error::operation_aborted)
             return;
 
+        // The write finished or the timer was re-armed
+        // after this wait had already expired.
+        if (m_writeQueue.empty () || m_write_timer.expires_at () >
+            boost::asio::deadline_timer::traits_type::now ())
+            return;
+
         if (ec != 0)
         {
             failed (ec);
             return;
         }
 
-        bassert (m_writesPending > 0);
-        if (--m_writesPending == 0 && m_closed)
+        // Cancelling the socket completes the pending
+        // write with an error, which drops the queue.
+        failed (boost::system::errc::make_error_code (
+            boost::system::errc::timed_out));
+    }
+
+    // Called when async_write completes.
+    void handle_write (error_code ec, std::size_t bytes_transferred,
+        CompletionCounter)
+    {
+        bassert (! m_writeQueue.empty ());
+
+        if (ec != 0)
+        {
+            // Nothing more can be sent, drop what is waiting
+            m_writeFailed.set (1);
+            m_write_timer.cancel ();
+
+            for (; ! m_writeQueue.empty (); m_writeQueue.pop_front ())
+                release (m_writeQueue.front ());
+
+            if (ec != boost::asio::error::operation_aborted)
+                failed (ec);
+
+            return;
+        }
+
+        release (m_writeQueue.front ());
+        m_writeQueue.pop_front ();
+
+        if (! m_writeQueue.empty ())
+        {
+            async_write ();
+            return;
+        }
+
+        m_write_timer.cancel ();
+
+        if (m_closed)
             m_socket->shutdown (socket::shutdown_send);
     }
 
@@ -429,6 +505,7 @@ public:
         error_code ec;
         m_data_timer.cancel (ec);
         m_request_timer.cancel (ec);
+        m_write_timer.cancel (ec);
         m_socket->cancel (ec);
         m_socket->shutdown (socket::shutdown_both);
     }
@@ -468,43 +545,41 @@ public:
                         CompletionCounter (this))));
     }
 
-    // Send a shared buffer
-    void async_write (SharedBuffer const& buf)
+    // Send the buffer at the front of the write queue
+    void async_write ()
     {
+        SharedBuffer const& buf (m_writeQueue.front ());
+
         bassert (buf.get().size() > 0);
 
-        ++m_writesPending;
+        // re-arm the write timer
+        // (this cancels the previous wait, if any)
+        //
+        m_write_timer.expires_from_now (
+            boost::posix_time::seconds (
+                writeTimeoutSeconds));
+
+        m_write_timer.async_wait (m_strand.wrap (boost::bind (
+            &Peer::handle_write_timer, Ptr(this),
+                boost::asio::placeholders::error,
+                    CompletionCounter (this))));
 
-        // Send the copy. We pass the SharedBuffer in the last parameter
-        // so that a reference is maintained as the handler gets copied.
-        // When the final completion function returns, the reference
-        // count will drop to zero and the buffer will be freed.
+        // The queue holds a reference to the buffer until
+        // the completion handler removes it.
         //
         boost::asio::async_write (*m_socket,
             boost::asio::const_buffers_1 (&(*buf)[0], buf->size()),
                 m_strand.wrap (boost::bind (&Peer::handle_write,
                     Ptr (this), boost::asio::placeholders::error,
                         boost::asio::placeholders::bytes_transferred,
-                            buf, CompletionCounter (this))));
+                            CompletionCounter (this))));
     }
 
-    // Send a copy of a BufferSequence
-    template <typename BufferSequence>
-    void async_write (BufferSequence const& buffers)
+    // Called when a buffer leaves the write queue, sent or not.
+    void release (SharedBuffer const& buf)
     {
-        // Iterate over each linear vector in the BufferSequence.
-        for (typename BufferSequence::const_iterator iter (buffers.begin());
-            iter != buffers.end(); ++iter)
-        {
-            typename BufferSequence::value_type const& buffer (*iter);
-
-            // Put a copy of this section of the buffer sequence into
-            // a reference counted, shared container.
-            //
-            async_write (SharedBuffer (
-                boost::asio::buffer_cast <char const*> (buffer),
-                    boost::asio::buffer_size (buffer)));
-        }
+        m_bytesQueued -= static_cast <int> (buf->size());
+        m_writeDone.signal();
     }
 };
 
@@ -89,6 +89,144 @@ private:
     const char* str_;
 };
 
+/** \brief Per-document arena for the memory held by Values.
+ *
+ * While a ValueArena::Scope is alive on a thread, the strings, member names
+ * and object or array members of Values made on that thread are carved out
+ * of large blocks instead of each being a separate heap allocation. Every
+ * allocation holds a reference to its arena, so a document that outlives
+ * the scope stays valid, and the blocks are freed together once the last
+ * of it is destroyed, on any thread.
+ *
+ * Freed memory is not reused. A scope should cover the building of one
+ * document which is then kept or thrown away as a whole, such as a
+ * published event.
+ */
+class JSON_API ValueArena
+{
+public:
+    /// Makes a new arena current on this thread.
+    /// If an arena is already current, the scope shares it.
+    class JSON_API Scope
+    {
+    public:
+        Scope ();
+        ~Scope ();
+
+    private:
+        Scope ( const Scope& );
+        Scope& operator= ( const Scope& );
+
+        ValueArena* arena_;
+    };
+
+    /// Standard allocator for containers whose storage follows the arena.
+    template <typename T>
+    class Allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef Allocator <U> other;
+        };
+
+        Allocator ()
+        {
+        }
+
+        template <typename U>
+        Allocator ( const Allocator <U>& )
+        {
+        }
+
+        pointer address ( reference x ) const
+        {
+            return &x;
+        }
+
+        const_pointer address ( const_reference x ) const
+        {
+            return &x;
+        }
+
+        pointer allocate ( size_type n, const void* = 0 )
+        {
+            return static_cast <pointer> ( ValueArena::allocate ( n * sizeof ( T ) ) );
+        }
+
+        void deallocate ( pointer p, size_type )
+        {
+            ValueArena::deallocate ( p );
+        }
+
+        size_type max_size () const
+        {
+            return size_type ( -1 ) / sizeof ( T );
+        }
+
+        void construct ( pointer p, const T& value )
+        {
+            new ( p ) T ( value );
+        }
+
+        void destroy ( pointer p )
+        {
+            p->~T ();
+        }
+
+        bool operator== ( const Allocator& ) const
+        {
+            return true;
+        }
+
+        bool operator!= ( const Allocator& ) const
+        {
+            return false;
+        }
+    };
+
+    /// Allocates from the current arena, or from the heap if there is none.
+    static void* allocate ( std::size_t bytes );
+
+    /// Releases memory obtained from allocate(), on any thread.
+    static void deallocate ( void* p );
+
+    /// Returns the arena current on this thread, if any.
+    static ValueArena* current ();
+
+    /// Returns the number of bytes handed out by this arena.
+    std::size_t used () const
+    {
+        return used_;
+    }
+
+private:
+    struct Block;
+
+    ValueArena ();
+    ~ValueArena ();
+    ValueArena ( const ValueArena& );
+    ValueArena& operator= ( const ValueArena& );
+
+    void* allocateHere ( std::size_t bytes );
+    void release ();
+
+    Block* blocks_;
+    char* next_;
+    char* end_;
+    std::size_t used_;
+    beast::Atomic <int> refs_;
+};
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represents a:
@@ -165,11 +303,114 @@ private:
     };
 
 public:
-#  ifndef JSON_USE_CPPTL_SMALLMAP
-    typedef std::map<CZString, Value> ObjectValues;
-#  else
-    typedef CppTL::SmallMap<CZString, Value> ObjectValues;
-#  endif // ifndef JSON_USE_CPPTL_SMALLMAP
+    /** The members of an object or array, ordered by name or index.
+     *
+     * Members are found through a sorted vector of pointers, so a lookup is
+     * a binary search and appending to an array only adds to the end of the
+     * vector. Each member is allocated on its own and keeps its address as
+     * others are added, so references to members stay valid as they did
+     * with a map. All of it comes from the current ValueArena, if any.
+     */
+    class ObjectValues
+    {
+    public:
+        typedef std::pair<const CZString, Value> value_type;
+
+    private:
+        typedef std::vector<value_type*, ValueArena::Allocator<value_type*> > Index;
+
+    public:
+        class iterator
+        {
+        public:
+            iterator ()
+            {
+            }
+
+            explicit iterator ( Index::const_iterator current )
+                : current_ ( current )
+            {
+            }
+
+            value_type& operator* () const
+            {
+                return **current_;
+            }
+
+            value_type* operator-> () const
+            {
+                return *current_;
+            }
+
+            iterator& operator++ ()
+            {
+                ++current_;
+                return *this;
+            }
+
+            iterator& operator-- ()
+            {
+                --current_;
+                return *this;
+            }
+
+            bool operator== ( const iterator& other ) const
+            {
+                return current_ == other.current_;
+            }
+
+            bool operator!= ( const iterator& other ) const
+            {
+                return current_ != other.current_;
+            }
+
+            int operator- ( const iterator& other ) const
+            {
+                return int ( current_ - other.current_ );
+            }
+
+        private:
+            friend class ObjectValues;
+            Index::const_iterator current_;
+        };
+
+        typedef iterator const_iterator;
+
+        ObjectValues ();
+        ObjectValues ( const ObjectValues& other );
+        ~ObjectValues ();
+
+        static void* operator new ( std::size_t bytes );
+        static void operator delete ( void* p );
+
+        iterator begin () const;
+        iterator end () const;
+        std::size_t size () const;
+        bool empty () const;
+
+        /// Return the first member which is not ordered before key.
+        iterator lower_bound ( const CZString& key ) const;
+        iterator find ( const CZString& key ) const;
+
+        /// Add a null member named key at position, which must be lower_bound( key ).
+        iterator insert ( iterator position, const CZString& key );
+
+        void erase ( iterator position );
+        void erase ( const CZString& key );
+        void clear ();
+
+        bool operator== ( const ObjectValues& other ) const;
+        bool operator< ( const ObjectValues& other ) const;
+
+    private:
+        ObjectValues& operator= ( const ObjectValues& );
+
+        static bool memberBefore ( const value_type* member, const CZString& key );
+        static value_type* newMember ( const CZString& key, const Value& value );
+        static void deleteMember ( value_type* member );
+
+        Index index_;
+    };
 # endif // ifndef JSON_VALUE_USE_INTERNAL_MAP
 #endif // ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
 
@@ -213,9 +454,15 @@ public:
 # endif
     Value ( bool value );
     Value ( const Value& other );
+   #if BEAST_COMPILER_SUPPORTS_MOVE_SEMANTICS
+    Value ( Value&& other );
+   #endif
     ~Value ();
 
     Value& operator= ( const Value& other );
+   #if BEAST_COMPILER_SUPPORTS_MOVE_SEMANTICS
+    Value& operator= ( Value&& other );
+   #endif
     /// Swap values.
     /// \note Currently, comments are intentionally not swapped, for
     /// both logic and efficiency.
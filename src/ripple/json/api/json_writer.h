@@ -173,6 +173,83 @@ private:
     bool addChildValues_;
 };
 
+/** \brief Writes a document in <a HREF="http://www.json.org">JSON</a> format piece by piece,
+    without building a Value for all of it first.
+
+    Objects and arrays are opened and closed explicitly, and members and
+    elements are written as they are produced, in the same format as
+    FastWriter. The text is collected in a buffer which is handed to the
+    Sink whenever it grows past the chunk size, so a large document never
+    has to be held in memory at once.
+
+    \sa FastWriter
+*/
+class JSON_API StreamWriter
+{
+public:
+    /** Receives the text of the document, in order. */
+    class Sink
+    {
+    public:
+        virtual ~Sink () { }
+
+        virtual void write (char const* data, std::size_t bytes) = 0;
+    };
+
+    explicit StreamWriter (Sink& sink, std::size_t chunkSize = 64 * 1024);
+
+    /** Open an object or array at the top level, or as the next array element. */
+    void startObject ();
+    void startArray ();
+
+    /** Open an object or array as a member of the current object. */
+    void startObject ( std::string const& key );
+    void startArray ( std::string const& key );
+
+    /** Close the innermost open object or array. */
+    void endObject ();
+    void endArray ();
+
+    /** Write a value at the top level, or as the next array element. */
+    void write ( const Value& value );
+
+    /** Write a member of the current object. */
+    void write ( std::string const& key, const Value& value );
+
+    /** Write each member of an object value into the current object. */
+    void writeMembers ( const Value& object );
+
+    /** Hand everything written so far to the sink.
+        This must be called once the document is complete.
+    */
+    void flush ();
+
+private:
+    void writeSeparator ();
+    void writeKey ( std::string const& key );
+    void writeValue ( const Value& value );
+    void checkFlush ();
+
+    Sink& sink_;
+    std::size_t chunkSize_;
+    std::string buffer_;
+
+    // One entry for each open object or array, true until it has an element.
+    std::vector<bool> empty_;
+};
+
+/** A StreamWriter::Sink which appends the document to a string. */
+class JSON_API StringSink : public StreamWriter::Sink
+{
+public:
+    explicit StringSink ( std::string& document );
+
+    void write (char const* data, std::size_t bytes);
+
+private:
+    std::string& document_;
+};
+
 std::string JSON_API valueToString ( Int value );
 std::string JSON_API valueToString ( UInt value );
 std::string JSON_API valueToString ( double value );
@@ -38,9 +38,173 @@ public:
         pass ();
     }
 
+    void testStreamWriter ()
+    {
+        beginTestCase ("stream writer");
+
+        Json::Value entry (Json::objectValue);
+        entry["index"] = 7;
+        entry["flags"] = Json::arrayValue;
+        entry["flags"].append (true);
+        entry["flags"].append (Json::Value ());
+        entry["name"] = "a \"quoted\" name";
+
+        // Write with a tiny chunk size so the sink sees many pieces
+        std::string document;
+        Json::StringSink sink (document);
+        Json::StreamWriter writer (sink, 8);
+
+        writer.startObject ();
+        writer.write ("seq", 42);
+        writer.startArray ("entries");
+        writer.write (entry);
+        writer.write (entry);
+        writer.startArray ();
+        writer.endArray ();
+        writer.endArray ();
+        writer.startObject ("empty");
+        writer.endObject ();
+        writer.writeMembers (entry);
+        writer.endObject ();
+        writer.flush ();
+
+        Json::Value expected (Json::objectValue);
+        expected["seq"] = 42;
+        expected["entries"] = Json::arrayValue;
+        expected["entries"].append (entry);
+        expected["entries"].append (entry);
+        expected["entries"].append (Json::arrayValue);
+        expected["empty"] = Json::objectValue;
+        expected["index"] = entry["index"];
+        expected["flags"] = entry["flags"];
+        expected["name"] = entry["name"];
+
+        Json::Value parsed;
+        Json::Reader reader;
+
+        expect (reader.parse (document, parsed), "Streamed document should parse");
+        expect (parsed == expected, "Streamed document should match the value");
+
+        Json::FastWriter fastWriter;
+        std::string const text = fastWriter.write (entry);
+
+        document.clear ();
+        writer.write (entry);
+        writer.flush ();
+        expect (document + "\n" == text, "Values should be written as FastWriter does");
+    }
+
+    void testMembers ()
+    {
+        beginTestCase ("members");
+
+        Json::Value object (Json::objectValue);
+        object["b"] = 2;
+        object["a"] = 1;
+        object["c"] = 3;
+
+        Json::Value::Members names (object.getMemberNames ());
+        expect (names.size () == 3 && names[0] == "a" && names[1] == "b" && names[2] == "c",
+            "Members should be ordered by name");
+        expect (object.end () - object.begin () == 3, "Iterators should span the members");
+
+        // References to members must survive adding more of them
+        Json::Value& first = object["a"];
+
+        for (int i = 0; i < 100; ++i)
+            object["m" + lexicalCast <std::string> (i)] = i;
+
+        expect (&object["a"] == &first && first == 1, "Members should not move");
+
+        expect (object.removeMember ("b") == 2, "Removed member should be returned");
+        expect (!object.isMember ("b") && object.size () == 102, "Member should be removed");
+
+        Json::Value copy (object);
+        expect (copy == object, "Copies should be equal");
+
+        copy["a"] = 0;
+        expect (copy < object && !(object < copy), "Members should be compared in order");
+
+        Json::Value array (Json::arrayValue);
+
+        for (int i = 0; i < 100; ++i)
+            array.append (i);
+
+        expect (array.size () == 100 && array[50u] == 50, "Appended elements should be kept");
+
+        array.resize (10);
+        array.resize (20);
+        expect (array.size () == 20 && array[9u] == 9 && array[15u].isNull (),
+            "Resized arrays should keep the elements before the cut");
+
+        Json::Value sparse;
+        sparse[5u] = 1;
+        expect (sparse.size () == 6 && sparse[0u].isNull (), "Arrays should be sized by index");
+    }
+
+    static Json::Value makeEntry (int i)
+    {
+        Json::Value entry (Json::objectValue);
+        entry["index"] = i;
+        entry["name"] = "entry " + lexicalCast <std::string> (i);
+        entry["flags"] = Json::arrayValue;
+        entry["flags"].append (true);
+        return entry;
+    }
+
+    void testArena ()
+    {
+        beginTestCase ("arena");
+
+        expect (Json::ValueArena::current () == nullptr, "No arena outside a scope");
+
+        Json::Value expected (Json::objectValue);
+
+        for (int i = 0; i < 200; ++i)
+            expected["entries"].append (makeEntry (i));
+
+        Json::Value kept;
+
+        {
+            Json::ValueArena::Scope scope;
+            Json::ValueArena* const arena = Json::ValueArena::current ();
+
+            expect (arena != nullptr, "An arena should be current in a scope");
+
+            {
+                Json::ValueArena::Scope nested;
+                expect (Json::ValueArena::current () == arena, "Nested scopes should share");
+            }
+
+            Json::Value document (Json::objectValue);
+
+            // Enough to span several blocks
+            for (int i = 0; i < 200; ++i)
+                document["entries"].append (makeEntry (i));
+
+            expect (arena->used () > 16384, "Members should come from the arena");
+            expect (document == expected, "Arena values should match heap values");
+
+            kept.swap (document);
+        }
+
+        expect (Json::ValueArena::current () == nullptr, "The arena should end with the scope");
+
+        // The document outlives its scope, and can still grow
+        expect (kept == expected, "A kept document should stay valid");
+
+        kept["entries"].append (makeEntry (200));
+        kept["entries"][0u]["name"] = "changed";
+        expect (kept["entries"].size () == 201 && kept["entries"][0u]["name"] == "changed",
+            "A kept document should still change");
+    }
+
     void runTest ()
     {
         testBadJson ();
+        testStreamWriter ();
+        testMembers ();
+        testArena ();
     }
 
     JsonCppTests () : UnitTest ("JsonCpp", "ripple")
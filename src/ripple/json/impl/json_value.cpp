@@ -54,6 +54,158 @@ const UInt Value::maxUInt = UInt (-1);
 //   return 0;
 //}
 
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class ValueArena
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+// This follows ripple's Arena, which lives above this module.
+
+struct ValueArena::Block
+{
+    Block* next_;
+};
+
+namespace
+{
+
+enum
+{
+    arenaHeaderSize = 8,        // Holds the owning arena, keeps Values aligned
+    arenaBlockSize = 16384,
+    arenaLargeSize = 1024       // Larger requests always go to the heap
+};
+
+// The arena a Scope made current on this thread, if any
+#if BEAST_MSVC
+__declspec(thread) ValueArena* currentValueArena;
+#else
+__thread ValueArena* currentValueArena;
+#endif
+
+}
+
+ValueArena::Scope::Scope ()
+    : arena_ ( 0 )
+{
+    if ( ValueArena::current () == 0 )
+    {
+        arena_ = new ValueArena;
+        currentValueArena = arena_;
+    }
+}
+
+ValueArena::Scope::~Scope ()
+{
+    if ( arena_ )
+    {
+        currentValueArena = 0;
+        arena_->release ();
+    }
+}
+
+ValueArena::ValueArena ()
+    : blocks_ ( 0 )
+    , next_ ( 0 )
+    , end_ ( 0 )
+    , used_ ( 0 )
+    , refs_ ( 1 )
+{
+}
+
+ValueArena::~ValueArena ()
+{
+    while ( blocks_ )
+    {
+        Block* next = blocks_->next_;
+        free ( blocks_ );
+        blocks_ = next;
+    }
+}
+
+ValueArena*
+ValueArena::current ()
+{
+    return currentValueArena;
+}
+
+void*
+ValueArena::allocate ( std::size_t bytes )
+{
+    ValueArena* arena = current ();
+
+    if ( arena  &&  bytes <= arenaLargeSize )
+        return arena->allocateHere ( ( bytes + 7 ) & ~std::size_t ( 7 ) );
+
+    char* mem = static_cast<char*> ( malloc ( arenaHeaderSize + bytes ) );
+
+    if ( mem == 0 )
+        throw std::bad_alloc ();
+
+    *reinterpret_cast<ValueArena**> ( mem ) = 0;
+    return mem + arenaHeaderSize;
+}
+
+void
+ValueArena::deallocate ( void* p )
+{
+    if ( p == 0 )
+        return;
+
+    char* mem = static_cast<char*> ( p ) - arenaHeaderSize;
+    ValueArena* arena = *reinterpret_cast<ValueArena**> ( mem );
+
+    if ( arena )
+        arena->release ();
+    else
+        free ( mem );
+}
+
+void*
+ValueArena::allocateHere ( std::size_t bytes )
+{
+    std::size_t const needed = arenaHeaderSize + bytes;
+
+    if ( static_cast<std::size_t> ( end_ - next_ ) < needed )
+    {
+        Block* block = static_cast<Block*> ( malloc ( arenaHeaderSize + arenaBlockSize ) );
+
+        if ( block == 0 )
+            throw std::bad_alloc ();
+
+        block->next_ = blocks_;
+        blocks_ = block;
+        next_ = reinterpret_cast<char*> ( block ) + arenaHeaderSize;
+        end_ = next_ + arenaBlockSize;
+    }
+
+    char* mem = next_;
+    next_ += needed;
+    used_ += bytes;
+    ++refs_;
+
+    *reinterpret_cast<ValueArena**> ( mem ) = this;
+    return mem + arenaHeaderSize;
+}
+
+void
+ValueArena::release ()
+{
+    if ( --refs_ == 0 )
+        delete this;
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class ValueAllocator
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
 ValueAllocator::~ValueAllocator ()
 {
 }
@@ -85,7 +237,7 @@ public:
         if ( length == unknown )
             length = (unsigned int)strlen (value);
 
-        char* newString = static_cast<char*> ( malloc ( length + 1 ) );
+        char* newString = static_cast<char*> ( ValueArena::allocate ( length + 1 ) );
         memcpy ( newString, value, length );
         newString[length] = 0;
         return newString;
@@ -93,8 +245,7 @@ public:
 
     virtual void releaseStringValue ( char* value )
     {
-        if ( value )
-            free ( value );
+        ValueArena::deallocate ( value );
     }
 };
 
@@ -256,6 +407,208 @@ Value::CZString::isStaticString () const
     return index_ == noDuplication;
 }
 
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Value::ObjectValues
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+Value::ObjectValues::ObjectValues ()
+{
+}
+
+Value::ObjectValues::ObjectValues ( const ObjectValues& other )
+{
+    index_.reserve ( other.index_.size () );
+
+    try
+    {
+        for ( Index::const_iterator it = other.index_.begin (); it != other.index_.end (); ++it )
+            index_.push_back ( newMember ( (*it)->first, (*it)->second ) );
+    }
+    catch ( ... )
+    {
+        clear ();
+        throw;
+    }
+}
+
+Value::ObjectValues::~ObjectValues ()
+{
+    clear ();
+}
+
+void*
+Value::ObjectValues::operator new ( std::size_t bytes )
+{
+    return ValueArena::allocate ( bytes );
+}
+
+void
+Value::ObjectValues::operator delete ( void* p )
+{
+    ValueArena::deallocate ( p );
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::begin () const
+{
+    return iterator ( index_.begin () );
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::end () const
+{
+    return iterator ( index_.end () );
+}
+
+std::size_t
+Value::ObjectValues::size () const
+{
+    return index_.size ();
+}
+
+bool
+Value::ObjectValues::empty () const
+{
+    return index_.empty ();
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::lower_bound ( const CZString& key ) const
+{
+    return iterator ( std::lower_bound ( index_.begin (), index_.end (), key, &memberBefore ) );
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::find ( const CZString& key ) const
+{
+    iterator it = lower_bound ( key );
+
+    if ( it != end ()  &&  (*it).first == key )
+        return it;
+
+    return end ();
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::insert ( iterator position, const CZString& key )
+{
+    value_type* member = newMember ( key, null );
+    Index::iterator at = index_.begin () + ( position.current_ - index_.begin () );
+
+    try
+    {
+        at = index_.insert ( at, member );
+    }
+    catch ( ... )
+    {
+        deleteMember ( member );
+        throw;
+    }
+
+    return iterator ( at );
+}
+
+void
+Value::ObjectValues::erase ( iterator position )
+{
+    Index::iterator at = index_.begin () + ( position.current_ - index_.begin () );
+    deleteMember ( *at );
+    index_.erase ( at );
+}
+
+void
+Value::ObjectValues::erase ( const CZString& key )
+{
+    iterator it = find ( key );
+
+    if ( it != end () )
+        erase ( it );
+}
+
+void
+Value::ObjectValues::clear ()
+{
+    for ( Index::iterator it = index_.begin (); it != index_.end (); ++it )
+        deleteMember ( *it );
+
+    index_.clear ();
+}
+
+bool
+Value::ObjectValues::operator== ( const ObjectValues& other ) const
+{
+    if ( index_.size () != other.index_.size () )
+        return false;
+
+    for ( std::size_t i = 0; i < index_.size (); ++i )
+    {
+        if ( ! ( index_[i]->first == other.index_[i]->first )
+                ||  index_[i]->second != other.index_[i]->second )
+            return false;
+    }
+
+    return true;
+}
+
+bool
+Value::ObjectValues::operator< ( const ObjectValues& other ) const
+{
+    // Ordered as a map of the same members would be
+    for ( std::size_t i = 0; i < index_.size ()  &&  i < other.index_.size (); ++i )
+    {
+        value_type const& mine = *index_[i];
+        value_type const& theirs = *other.index_[i];
+
+        if ( mine.first < theirs.first )
+            return true;
+
+        if ( theirs.first < mine.first )
+            return false;
+
+        if ( mine.second < theirs.second )
+            return true;
+
+        if ( theirs.second < mine.second )
+            return false;
+    }
+
+    return index_.size () < other.index_.size ();
+}
+
+bool
+Value::ObjectValues::memberBefore ( const value_type* member, const CZString& key )
+{
+    return member->first < key;
+}
+
+Value::ObjectValues::value_type*
+Value::ObjectValues::newMember ( const CZString& key, const Value& value )
+{
+    void* memory = ValueArena::allocate ( sizeof ( value_type ) );
+
+    try
+    {
+        return new ( memory ) value_type ( key, value );
+    }
+    catch ( ... )
+    {
+        ValueArena::deallocate ( memory );
+        throw;
+    }
+}
+
+void
+Value::ObjectValues::deleteMember ( value_type* member )
+{
+    member->~value_type ();
+    ValueArena::deallocate ( member );
+}
+
 #endif // ifndef JSON_VALUE_USE_INTERNAL_MAP
 
 
@@ -505,6 +858,21 @@ Value::Value ( const Value& other )
 }
 
 
+#if BEAST_COMPILER_SUPPORTS_MOVE_SEMANTICS
+Value::Value ( Value&& other )
+    : type_ ( nullValue )
+    , allocated_ ( 0 )
+    , comments_ ( 0 )
+# ifdef JSON_VALUE_USE_INTERNAL_MAP
+    , itemIsUsed_ ( 0 )
+#endif
+{
+    swap ( other );
+    std::swap ( comments_, other.comments_ );
+}
+#endif
+
+
 Value::~Value ()
 {
     switch ( type_ )
@@ -554,6 +922,16 @@ Value::operator= ( const Value& other )
     return *this;
 }
 
+#if BEAST_COMPILER_SUPPORTS_MOVE_SEMANTICS
+Value&
+Value::operator= ( Value&& other )
+{
+    Value temp ( static_cast<Value&&> ( other ) );
+    swap ( temp );
+    return *this;
+}
+#endif
+
 void
 Value::swap ( Value& other )
 {
@@ -1092,8 +1470,9 @@ Value::resize ( UInt newSize )
         (*this)[ newSize - 1 ];
     else
     {
-        for ( UInt index = newSize; index < oldSize; ++index )
-            value_.map_->erase ( index );
+        // From the back, so the erased members are at the end
+        for ( UInt index = oldSize; index > newSize; --index )
+            value_.map_->erase ( index - 1 );
 
         assert ( size () == newSize );
     }
@@ -1119,8 +1498,7 @@ Value::operator[] ( UInt index )
     if ( it != value_.map_->end ()  &&  (*it).first == key )
         return (*it).second;
 
-    ObjectValues::value_type defaultValue ( key, null );
-    it = value_.map_->insert ( it, defaultValue );
+    it = value_.map_->insert ( it, key );
     return (*it).second;
 #else
     return value_.array_->resolveReference ( index );
@@ -1175,8 +1553,7 @@ Value::resolveReference ( const char* key,
     if ( it != value_.map_->end ()  &&  (*it).first == actualKey )
         return (*it).second;
 
-    ObjectValues::value_type defaultValue ( actualKey, null );
-    it = value_.map_->insert ( it, defaultValue );
+    it = value_.map_->insert ( it, actualKey );
     Value& value = (*it).second;
     return value;
 #else
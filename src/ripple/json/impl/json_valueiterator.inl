@@ -116,34 +116,15 @@ ValueIteratorBase::difference_type
 ValueIteratorBase::computeDistance ( const SelfType& other ) const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-# ifdef JSON_USE_CPPTL_SMALLMAP
-    return current_ - other.current_;
-# else
 
     // Iterator for null value are initialized using the default
-    // constructor, which initialize current_ to the default
-    // std::map::iterator. As begin() and end() are two instance
-    // of the default std::map::iterator, they can not be compared.
-    // To allow this, we handle this comparison specifically.
+    // constructor, so they have nothing to subtract.
     if ( isNull_  &&  other.isNull_ )
     {
         return 0;
     }
 
-
-    // Usage of std::distance is not portable (does not compile with Sun Studio 12 RogueWave STL,
-    // which is the one used by default).
-    // Using a portable hand-made version for non random iterator instead:
-    //   return difference_type( std::distance( current_, other.current_ ) );
-    difference_type myDistance = 0;
-
-    for ( Value::ObjectValues::iterator it = current_; it != other.current_; ++it )
-    {
-        ++myDistance;
-    }
-
-    return myDistance;
-# endif
+    return current_ - other.current_;
 #else
 
     if ( isArray_ )
@@ -194,7 +175,7 @@ Value
 ValueIteratorBase::key () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = (*current_).first;
 
     if ( czstring.c_str () )
     {
@@ -225,7 +206,7 @@ UInt
 ValueIteratorBase::index () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = (*current_).first;
 
     if ( !czstring.c_str () )
         return czstring.index ();
@@ -900,6 +900,240 @@ StyledStreamWriter::normalizeEOL ( const std::string& text )
 }
 
 
+// Class StreamWriter
+// //////////////////////////////////////////////////////////////////
+
+StreamWriter::StreamWriter ( Sink& sink, std::size_t chunkSize )
+    : sink_ ( sink )
+    , chunkSize_ ( chunkSize )
+{
+    buffer_.reserve ( chunkSize_ );
+}
+
+
+void
+StreamWriter::startObject ()
+{
+    writeSeparator ();
+    buffer_ += "{";
+    empty_.push_back ( true );
+}
+
+
+void
+StreamWriter::startArray ()
+{
+    writeSeparator ();
+    buffer_ += "[";
+    empty_.push_back ( true );
+}
+
+
+void
+StreamWriter::startObject ( std::string const& key )
+{
+    writeKey ( key );
+    buffer_ += "{";
+    empty_.push_back ( true );
+}
+
+
+void
+StreamWriter::startArray ( std::string const& key )
+{
+    writeKey ( key );
+    buffer_ += "[";
+    empty_.push_back ( true );
+}
+
+
+void
+StreamWriter::endObject ()
+{
+    JSON_ASSERT ( !empty_.empty () );
+    empty_.pop_back ();
+    buffer_ += "}";
+    checkFlush ();
+}
+
+
+void
+StreamWriter::endArray ()
+{
+    JSON_ASSERT ( !empty_.empty () );
+    empty_.pop_back ();
+    buffer_ += "]";
+    checkFlush ();
+}
+
+
+void
+StreamWriter::write ( const Value& value )
+{
+    writeSeparator ();
+    writeValue ( value );
+    checkFlush ();
+}
+
+
+void
+StreamWriter::write ( std::string const& key, const Value& value )
+{
+    writeKey ( key );
+    writeValue ( value );
+    checkFlush ();
+}
+
+
+void
+StreamWriter::writeMembers ( const Value& object )
+{
+    JSON_ASSERT ( object.isObject () || object.isNull () );
+
+    Value::Members members ( object.getMemberNames () );
+
+    for ( Value::Members::iterator it = members.begin ();
+            it != members.end ();
+            ++it )
+    {
+        write ( *it, object[*it] );
+    }
+}
+
+
+void
+StreamWriter::flush ()
+{
+    if ( !buffer_.empty () )
+    {
+        sink_.write ( buffer_.data (), buffer_.size () );
+        buffer_.clear ();
+    }
+}
+
+
+void
+StreamWriter::writeSeparator ()
+{
+    if ( !empty_.empty () )
+    {
+        if ( !empty_.back () )
+            buffer_ += ",";
+
+        empty_.back () = false;
+    }
+}
+
+
+void
+StreamWriter::writeKey ( std::string const& key )
+{
+    JSON_ASSERT ( !empty_.empty () );
+    writeSeparator ();
+    buffer_ += valueToQuotedString ( key.c_str () );
+    buffer_ += ":";
+}
+
+
+void
+StreamWriter::writeValue ( const Value& value )
+{
+    switch ( value.type () )
+    {
+    case nullValue:
+        buffer_ += "null";
+        break;
+
+    case intValue:
+        buffer_ += valueToString ( value.asInt () );
+        break;
+
+    case uintValue:
+        buffer_ += valueToString ( value.asUInt () );
+        break;
+
+    case realValue:
+        buffer_ += valueToString ( value.asDouble () );
+        break;
+
+    case stringValue:
+        buffer_ += valueToQuotedString ( value.asCString () );
+        break;
+
+    case booleanValue:
+        buffer_ += valueToString ( value.asBool () );
+        break;
+
+    case arrayValue:
+    {
+        buffer_ += "[";
+        int size = value.size ();
+
+        for ( int index = 0; index < size; ++index )
+        {
+            if ( index > 0 )
+                buffer_ += ",";
+
+            writeValue ( value[index] );
+            checkFlush ();
+        }
+
+        buffer_ += "]";
+    }
+    break;
+
+    case objectValue:
+    {
+        Value::Members members ( value.getMemberNames () );
+        buffer_ += "{";
+
+        for ( Value::Members::iterator it = members.begin ();
+                it != members.end ();
+                ++it )
+        {
+            const std::string& name = *it;
+
+            if ( it != members.begin () )
+                buffer_ += ",";
+
+            buffer_ += valueToQuotedString ( name.c_str () );
+            buffer_ += ":";
+            writeValue ( value[name] );
+            checkFlush ();
+        }
+
+        buffer_ += "}";
+    }
+    break;
+
+    }
+}
+
+
+void
+StreamWriter::checkFlush ()
+{
+    if ( buffer_.size () >= chunkSize_ )
+        flush ();
+}
+
+
+// Class StringSink
+// //////////////////////////////////////////////////////////////////
+
+StringSink::StringSink ( std::string& document )
+    : document_ ( document )
+{
+}
+
+
+void
+StringSink::write ( char const* data, std::size_t bytes )
+{
+    document_.append ( data, bytes );
+}
+
+
 std::ostream& operator<< ( std::ostream& sout, const Value& root )
 {
     Json::StyledStreamWriter writer;
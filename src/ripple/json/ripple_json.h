@@ -21,6 +21,7 @@
 #define RIPPLE_JSON_H_INCLUDED
 
 #include "beast/beast/Config.h"
+#include "beast/beast/Atomic.h"
 
 #include "beast/beast/strings/String.h"
 #include "beast/beast/utility/PropertyStream.h"
@@ -1073,10 +1073,9 @@ void LedgerConsensus::playbackProposals ()
 #define LCAT_FAIL       1
 #define LCAT_RETRY      2
 
-int LedgerConsensus::applyTransaction (TransactionEngine& engine, SerializedTransaction::ref txn, Ledger::ref ledger,
-                                       bool openLedger, bool retryAssured)
+TransactionEngineParams LedgerConsensus::getApplyParams (SerializedTransaction::ref txn,
+        bool openLedger, bool retryAssured)
 {
-    // Returns false if the transaction has need not be retried.
     TransactionEngineParams parms = openLedger ? tapOPEN_LEDGER : tapNONE;
 
     if (retryAssured)
@@ -1085,6 +1084,36 @@ int LedgerConsensus::applyTransaction (TransactionEngine& engine, SerializedTran
     if (getApp().getHashRouter ().setFlag (txn->getTransactionID (), SF_SIGGOOD))
         parms = static_cast<TransactionEngineParams> (parms | tapNO_CHECK_SIGN);
 
+    return parms;
+}
+
+int LedgerConsensus::classifyResult (SerializedTransaction::ref txn, Ledger::ref ledger,
+                                     TER result, bool didApply)
+{
+    if (didApply)
+    {
+        WriteLog (lsDEBUG, LedgerConsensus) << "Transaction success: " << transHuman (result);
+        return LCAT_SUCCESS;
+    }
+
+    if (isTefFailure (result) || isTemMalformed (result) || isTelLocal (result))
+    {
+        // failure
+        WriteLog (lsDEBUG, LedgerConsensus) << "Transaction failure: " << transHuman (result);
+        return LCAT_FAIL;
+    }
+
+    WriteLog (lsDEBUG, LedgerConsensus) << "Transaction retry: " << transHuman (result);
+    assert (!ledger->hasTransaction (txn->getTransactionID ()));
+    return LCAT_RETRY;
+}
+
+int LedgerConsensus::applyTransaction (TransactionEngine& engine, SerializedTransaction::ref txn, Ledger::ref ledger,
+                                       bool openLedger, bool retryAssured)
+{
+    // Returns false if the transaction has need not be retried.
+    TransactionEngineParams parms = getApplyParams (txn, openLedger, retryAssured);
+
     WriteLog (lsDEBUG, LedgerConsensus) << "TXN " << txn->getTransactionID ()
                                         << (openLedger ? " open" : " closed")
                                         << (retryAssured ? "/retry" : "/final");
@@ -1100,38 +1129,272 @@ int LedgerConsensus::applyTransaction (TransactionEngine& engine, SerializedTran
         bool didApply;
         TER result = engine.applyTransaction (*txn, parms, didApply);
 
-        if (didApply)
+        return classifyResult (txn, ledger, result, didApply);
+
+#ifndef TRUST_NETWORK
+    }
+    catch (...)
+    {
+        WriteLog (lsWARNING, LedgerConsensus) << "Throws";
+        return false;
+    }
+
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+// The candidates of a first pass, speculatively applied by several threads.
+// Each thread applies the candidates it takes to its own snapshot of the
+// ledger, recording everything each one read in its entry set.
+//
+class LedgerConsensus::SpeculateWork
+{
+public:
+    struct Candidate
+    {
+        Candidate ()
+            : params (tapNONE)
+            , eligible (false)
+            , done (false)
+            , didApply (false)
+            , result (temUNKNOWN)
         {
-            WriteLog (lsDEBUG, LedgerConsensus) << "Transaction success: " << transHuman (result);
-            return LCAT_SUCCESS;
         }
 
-        if (isTefFailure (result) || isTemMalformed (result) || isTelLocal (result))
+        SerializedTransaction::pointer txn;
+        TransactionEngineParams params;
+        bool eligible;
+        bool done;
+        bool didApply;
+        TER result;
+        LedgerEntrySet nodes;
+    };
+
+    SpeculateWork ()
+        : m_next (0)
+        , m_remaining (0)
+    {
+    }
+
+    void add (SerializedTransaction::ref txn, TransactionEngineParams params, bool eligible)
+    {
+        m_candidates.push_back (Candidate ());
+        m_candidates.back ().txn = txn;
+        m_candidates.back ().params = params;
+        m_candidates.back ().eligible = eligible;
+
+        if (eligible)
         {
-            // failure
-            WriteLog (lsDEBUG, LedgerConsensus) << "Transaction failure: " << transHuman (result);
-            return LCAT_FAIL;
+            m_eligible.push_back (m_candidates.size () - 1);
+            ++m_remaining;
         }
+    }
 
-        WriteLog (lsDEBUG, LedgerConsensus) << "Transaction retry: " << transHuman (result);
-        assert (!ledger->hasTransaction (txn->getTransactionID ()));
-        return LCAT_RETRY;
+    int size () const
+    {
+        return m_candidates.size ();
+    }
 
-#ifndef TRUST_NETWORK
+    int getEligibleCount () const
+    {
+        return m_eligible.size ();
     }
-    catch (...)
+
+    Candidate& operator[] (int index)
     {
-        WriteLog (lsWARNING, LedgerConsensus) << "Throws";
+        return m_candidates [index];
+    }
+
+    // Speculate candidates on the snapshot until none are left to take
+    void run (Ledger::ref snapshot)
+    {
+        TransactionEngine engine (snapshot);
+
+        for (;;)
+        {
+            int const index = (++m_next) - 1;
+
+            if (index >= getEligibleCount ())
+                return;
+
+            Candidate& c = m_candidates [m_eligible [index]];
+
+            try
+            {
+                c.result = engine.speculateTransaction (*c.txn, c.params, c.didApply, c.nodes);
+                c.done = true;
+            }
+            catch (...)
+            {
+                // Left for the serial pass to apply, or to throw again
+                c.done = false;
+            }
+
+            if (--m_remaining == 0)
+                m_done.signal ();
+        }
+    }
+
+    // Wait for candidates taken by other threads to finish
+    void wait ()
+    {
+        m_done.wait ();
+    }
+
+private:
+    std::vector <Candidate> m_candidates;
+    std::vector <int> m_eligible;
+    Atomic <int> m_next;
+    Atomic <int> m_remaining;
+    WaitableEvent m_done;
+};
+
+// Returns true if applying the transaction only reads ledger entries whose
+// indexes it can name. Offers and paths walk order books and directories,
+// so what they read depends on entries that may not exist yet.
+//
+bool LedgerConsensus::canSpeculate (SerializedTransaction const& txn)
+{
+    switch (txn.getTxnType ())
+    {
+    case ttPAYMENT:
+        return !txn.isFieldPresent (sfPaths)
+               && !txn.isFieldPresent (sfSendMax)
+               && txn.getFieldAmount (sfAmount).isNative ();
+
+    case ttACCOUNT_SET:
+    case ttREGULAR_KEY_SET:
+    case ttTRUST_SET:
+    case ttOFFER_CANCEL:
+        return true;
+
+    default:
         return false;
     }
+}
 
-#endif
+void LedgerConsensus::speculateJob (boost::shared_ptr <SpeculateWork> work, Ledger::pointer snapshot, Job&)
+{
+    work->run (snapshot);
+}
+
+// Applies the candidates of the first pass in order, using the speculative
+// result of any candidate that read nothing an earlier candidate wrote. The
+// others are applied again to the ledger, so the result is the same as
+// applying every candidate in turn. Up to the given number of jobs help the
+// calling thread speculate.
+//
+void LedgerConsensus::applySpeculative (TransactionEngine& engine,
+        std::vector <SerializedTransaction::pointer> const& txns,
+        Ledger::ref applyLedger, CanonicalTXSet& failedTransactions, bool openLgr, int jobs)
+{
+    boost::shared_ptr <SpeculateWork> work (makeSpeculateWork (txns, openLgr));
+
+    if (work->getEligibleCount () != 0)
+    {
+        for (int i = 0; i < jobs; ++i)
+        {
+            Ledger::pointer snapshot (boost::make_shared <Ledger> (boost::ref (*applyLedger), false));
+
+            getApp().getJobQueue ().addJob (jtSPECULATE, "LedgerConsensus::speculate",
+                BIND_TYPE (&LedgerConsensus::speculateJob, work, snapshot, P_1));
+        }
+
+        // Work alongside the jobs, they may not start right away
+        work->run (boost::make_shared <Ledger> (boost::ref (*applyLedger), false));
+        work->wait ();
+    }
+
+    applySpeculated (engine, *work, applyLedger, failedTransactions, openLgr);
+}
+
+boost::shared_ptr <LedgerConsensus::SpeculateWork> LedgerConsensus::makeSpeculateWork (
+        std::vector <SerializedTransaction::pointer> const& txns, bool openLgr)
+{
+    boost::shared_ptr <SpeculateWork> work (boost::make_shared <SpeculateWork> ());
+
+    BOOST_FOREACH (SerializedTransaction::ref txn, txns)
+    {
+        work->add (txn, getApplyParams (txn, openLgr, true), canSpeculate (*txn));
+    }
+
+    return work;
+}
+
+// The serial pass of applySpeculative, once every candidate was speculated
+void LedgerConsensus::applySpeculated (TransactionEngine& engine, SpeculateWork& work,
+        Ledger::ref applyLedger, CanonicalTXSet& failedTransactions, bool openLgr)
+{
+    // Indexes of the entries changed by the candidates applied so far
+    boost::unordered_set <uint256> written;
+    int speculated = 0;
+    bool serial = false;
+
+    for (int i = 0; i < work.size (); ++i)
+    {
+        SpeculateWork::Candidate& c = work[i];
+
+        WriteLog (lsDEBUG, LedgerConsensus) << "TXN " << c.txn->getTransactionID ()
+                                            << (openLgr ? " open" : " closed") << "/retry";
+        WriteLog (lsTRACE, LedgerConsensus) << c.txn->getJson (0);
+
+        try
+        {
+            if (serial)
+            {
+                c.result = engine.applyTransaction (*c.txn, c.params, c.didApply);
+            }
+            else
+            {
+                bool valid = c.eligible && c.done;
+
+                for (LedgerEntrySet::const_iterator it = c.nodes.begin (); valid && (it != c.nodes.end ()); ++it)
+                    valid = (written.find (it->first) == written.end ());
+
+                BOOST_FOREACH (uint256 const& index, c.nodes.getMisses ())
+                {
+                    if (written.find (index) != written.end ())
+                        valid = false;
+                }
+
+                if (valid)
+                    ++speculated;
+                else
+                    c.result = engine.speculateTransaction (*c.txn, c.params, c.didApply, c.nodes);
+
+                if (c.didApply)
+                {
+                    for (LedgerEntrySet::const_iterator it = c.nodes.begin (); it != c.nodes.end (); ++it)
+                    {
+                        if (it->second.mAction != taaCACHED)
+                            written.insert (it->first);
+                    }
+
+                    engine.commitTransaction (*c.txn, c.params, c.result, c.nodes);
+                }
+            }
+
+            if (classifyResult (c.txn, applyLedger, c.result, c.didApply) == LCAT_RETRY)
+                failedTransactions.push_back (c.txn);
+        }
+        catch (...)
+        {
+            // The ledger may hold part of what was being written
+            WriteLog (lsWARNING, LedgerConsensus) << "Throws";
+            serial = true;
+        }
+    }
+
+    WriteLog (lsDEBUG, LedgerConsensus) << "Speculated " << speculated << " of " << work.size ()
+                                        << " candidates";
 }
 
 void LedgerConsensus::applyTransactions (SHAMap::ref set, Ledger::ref applyLedger,
         Ledger::ref checkLedger, CanonicalTXSet& failedTransactions, bool openLgr)
 {
     TransactionEngine engine (applyLedger);
+    std::vector <SerializedTransaction::pointer> candidates;
 
     for (SHAMapItem::pointer item = set->peekFirstItem (); !!item; item = set->peekNextItem (item->getTag ()))
         if (!checkLedger->hasTransaction (item->getTag ()))
@@ -1143,7 +1406,31 @@ void LedgerConsensus::applyTransactions (SHAMap::ref set, Ledger::ref applyLedge
             {
 #endif
                 SerializerIterator sit (item->peekSerializer ());
-                SerializedTransaction::pointer txn = boost::make_shared<SerializedTransaction> (boost::ref (sit));
+                candidates.push_back (boost::make_shared<SerializedTransaction> (boost::ref (sit)));
+
+#ifndef TRUST_NETWORK
+            }
+            catch (...)
+            {
+                WriteLog (lsWARNING, LedgerConsensus) << "  Throws";
+            }
+
+#endif
+        }
+
+    if (getConfig ().PARALLEL_APPLY && (candidates.size () >= parallelApplyThreshold) && getApp().running ())
+    {
+        applySpeculative (engine, candidates, applyLedger, failedTransactions, openLgr, maxSpeculateJobs);
+    }
+    else
+    {
+        BOOST_FOREACH (SerializedTransaction::ref txn, candidates)
+        {
+#ifndef TRUST_NETWORK
+
+            try
+            {
+#endif
 
                 if (applyTransaction (engine, txn, applyLedger, openLgr, true) == LCAT_RETRY)
                     failedTransactions.push_back (txn);
@@ -1157,6 +1444,7 @@ void LedgerConsensus::applyTransactions (SHAMap::ref set, Ledger::ref applyLedge
 
 #endif
         }
+    }
 
     int changes;
     bool certainRetry = true;
@@ -1252,18 +1540,13 @@ void LedgerConsensus::accept (SHAMap::ref set, LoadEvent::pointer)
         boost::shared_ptr<SHAMap::DirtyMap> acctNodes = newLCL->peekAccountStateMap ()->disarmDirty ();
         boost::shared_ptr<SHAMap::DirtyMap> txnNodes = newLCL->peekTransactionMap ()->disarmDirty ();
 
-        // write out dirty nodes (temporarily done here) Most come before setAccepted
-        int fc;
-
-        while ((fc = SHAMap::flushDirty (*acctNodes, 256, hotACCOUNT_NODE, newLCL->getLedgerSeq ())) > 0)
-        {
-            WriteLog (lsTRACE, LedgerConsensus) << "Flushed " << fc << " dirty state nodes";
-        }
-
-        while ((fc = SHAMap::flushDirty (*txnNodes, 256, hotTRANSACTION_NODE, newLCL->getLedgerSeq ())) > 0)
-        {
-            WriteLog (lsTRACE, LedgerConsensus) << "Flushed " << fc << " dirty transaction nodes";
-        }
+        // write out dirty nodes in the background, the ledger holds them until then.
+        // Until a node's chunk is written it is only reachable through newLCL, so a
+        // peer asking the node store for it by hash misses. The flusher bounds how
+        // far behind the writes can fall.
+        SHAMapFlusher& flusher = getApp().getLedgerMaster ().getFlusher ();
+        flusher.flushDirty (*acctNodes, hotACCOUNT_NODE, newLCL->getLedgerSeq ());
+        flusher.flushDirty (*txnNodes, hotTRANSACTION_NODE, newLCL->getLedgerSeq ());
 
         newLCL->setAccepted (closeTime, mCloseResolution, closeTimeCorrect);
         newLCL->updateHash ();
@@ -1522,4 +1805,189 @@ Json::Value LedgerConsensus::getJson (bool full)
     return ret;
 }
 
+//------------------------------------------------------------------------------
+
+class LedgerConsensusTests : public UnitTest
+{
+public:
+    LedgerConsensusTests () : UnitTest ("LedgerConsensus", "ripple")
+    {
+    }
+
+    struct Account
+    {
+        RippleAddress publicKey;
+        RippleAddress privateKey;
+        uint32 sequence;
+    };
+
+    static Account makeAccount (std::string const& passPhrase)
+    {
+        RippleAddress seed = RippleAddress::createSeedGeneric (passPhrase);
+        RippleAddress generator = RippleAddress::createGeneratorPublic (seed);
+
+        Account account;
+        account.publicKey = RippleAddress::createAccountPublic (generator, 0);
+        account.privateKey = RippleAddress::createAccountPrivate (generator, seed, 0);
+        account.sequence = 1;
+        return account;
+    }
+
+    static SerializedTransaction::pointer makePayment (Account& from, Account const& to, uint64 xrp)
+    {
+        SerializedTransaction::pointer txn (boost::make_shared <SerializedTransaction> (ttPAYMENT));
+
+        txn->setSigningPubKey (from.publicKey);
+        txn->setSourceAccount (from.publicKey);
+        txn->setSequence (from.sequence++);
+        txn->setTransactionFee (STAmount (10));
+        txn->setFieldAccount (sfDestination, to.publicKey);
+        txn->setFieldAmount (sfAmount, STAmount (xrp * SYSTEM_CURRENCY_PARTS));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    // Speculates on its own ledger snapshot, as a jtSPECULATE job would
+    class SpeculateThread : public Thread
+    {
+    public:
+        SpeculateThread (boost::shared_ptr <LedgerConsensus::SpeculateWork> const& work, Ledger::ref ledger)
+            : Thread ("speculate")
+            , m_work (work)
+            , m_snapshot (boost::make_shared <Ledger> (boost::ref (*ledger), false))
+        {
+        }
+
+        void run ()
+        {
+            m_work->run (m_snapshot);
+        }
+
+    private:
+        boost::shared_ptr <LedgerConsensus::SpeculateWork> m_work;
+        Ledger::pointer m_snapshot;
+    };
+
+    // Apply what is left to retry once more, as the last consensus pass would
+    static void applyRetries (TransactionEngine& engine, Ledger::ref ledger, CanonicalTXSet& failed)
+    {
+        CanonicalTXSet::iterator it = failed.begin ();
+
+        while (it != failed.end ())
+        {
+            if (LedgerConsensus::applyTransaction (engine, it->second, ledger, false, false) == LCAT_RETRY)
+                ++it;
+            else
+                it = failed.erase (it);
+        }
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("speculative");
+
+        Account master (makeAccount ("masterpassphrase"));
+        std::vector <Account> accounts;
+        std::vector <Account> unfunded;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            accounts.push_back (makeAccount ("speculate" + lexicalCastThrow <std::string> (i)));
+            unfunded.push_back (makeAccount ("unfunded" + lexicalCastThrow <std::string> (i)));
+        }
+
+        Ledger::pointer funded (boost::make_shared <Ledger> (master.publicKey, SYSTEM_CURRENCY_START));
+
+        {
+            TransactionEngine engine (funded);
+
+            for (std::size_t i = 0; i < accounts.size (); ++i)
+            {
+                bool didApply;
+                engine.applyTransaction (*makePayment (master, accounts[i], 10000), tapNONE, didApply);
+                expect (didApply, "funding payment not applied");
+            }
+        }
+
+        std::vector <SerializedTransaction::pointer> txns;
+
+        // Independent of each other, so the speculative results are used
+        for (std::size_t i = 0; i < accounts.size (); i += 2)
+            txns.push_back (makePayment (accounts[i], unfunded[i], 500));
+
+        // Each reads what the one before it wrote, so it must be applied again
+        for (std::size_t i = 0; i < accounts.size (); ++i)
+            txns.push_back (makePayment (accounts[i], accounts[(i + 1) % accounts.size ()], 100));
+
+        // A conflicting pair out of sequence order, the first is retried
+        SerializedTransaction::pointer first (makePayment (accounts[1], accounts[2], 50));
+        txns.push_back (makePayment (accounts[1], accounts[3], 50));
+        txns.push_back (first);
+
+        // Both look for the same missing account, the first one creates it
+        txns.push_back (makePayment (accounts[3], unfunded[15], 300));
+        txns.push_back (makePayment (accounts[5], unfunded[15], 300));
+
+        Ledger::pointer serialLedger (boost::make_shared <Ledger> (boost::ref (*funded), true));
+        CanonicalTXSet serialFailed (funded->getHash ());
+
+        {
+            TransactionEngine engine (serialLedger);
+
+            BOOST_FOREACH (SerializedTransaction::ref txn, txns)
+            {
+                if (LedgerConsensus::applyTransaction (engine, txn, serialLedger, false, true) == LCAT_RETRY)
+                    serialFailed.push_back (txn);
+            }
+
+            expect (serialFailed.size () == 1, "serial apply did not retry");
+            applyRetries (engine, serialLedger, serialFailed);
+        }
+
+        Ledger::pointer parallelLedger (boost::make_shared <Ledger> (boost::ref (*funded), true));
+        CanonicalTXSet parallelFailed (funded->getHash ());
+
+        {
+            TransactionEngine engine (parallelLedger);
+
+            // The job queue has no threads while testing, so threads of our
+            // own stand in for the jobs that help speculate
+            boost::shared_ptr <LedgerConsensus::SpeculateWork> work (LedgerConsensus::makeSpeculateWork (txns, false));
+            expect (work->getEligibleCount () == work->size (), "payments not speculated");
+
+            OwnedArray <SpeculateThread> threads;
+
+            for (int i = 0; i < 3; ++i)
+                threads.add (new SpeculateThread (work, parallelLedger));
+
+            for (int i = 0; i < threads.size (); ++i)
+                threads[i]->startThread ();
+
+            work->run (boost::make_shared <Ledger> (boost::ref (*parallelLedger), false));
+            work->wait ();
+
+            for (int i = 0; i < threads.size (); ++i)
+                threads[i]->stopThread ();
+
+            LedgerConsensus::applySpeculated (engine, *work, parallelLedger, parallelFailed, false);
+
+            expect (parallelFailed.size () == 1, "speculative apply did not retry");
+            applyRetries (engine, parallelLedger, parallelFailed);
+        }
+
+        expect (serialFailed.size () == 0 && parallelFailed.size () == 0, "retry not applied");
+
+        expect (serialLedger->peekAccountStateMap ()->getHash () != funded->peekAccountStateMap ()->getHash (),
+                "nothing applied");
+
+        expect (parallelLedger->peekAccountStateMap ()->getHash () == serialLedger->peekAccountStateMap ()->getHash (),
+                "account state differs");
+
+        expect (parallelLedger->peekTransactionMap ()->getHash () == serialLedger->peekTransactionMap ()->getHash (),
+                "transactions differ");
+    }
+};
+
+static LedgerConsensusTests ledgerConsensusTests;
+
 // vim:ts=4
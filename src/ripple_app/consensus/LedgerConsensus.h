@@ -105,8 +105,33 @@ private:
     void sendHaveTxSet (uint256 const & set, bool direct);
     void applyTransactions (SHAMap::ref transactionSet, Ledger::ref targetLedger,
                             Ledger::ref checkLedger, CanonicalTXSet & failedTransactions, bool openLgr);
-    int applyTransaction (TransactionEngine & engine, SerializedTransaction::ref txn, Ledger::ref targetLedger,
-                          bool openLgr, bool retryAssured);
+    static int applyTransaction (TransactionEngine & engine, SerializedTransaction::ref txn, Ledger::ref targetLedger,
+                                 bool openLgr, bool retryAssured);
+    static TransactionEngineParams getApplyParams (SerializedTransaction::ref txn, bool openLgr, bool retryAssured);
+    static int classifyResult (SerializedTransaction::ref txn, Ledger::ref targetLedger, TER result, bool didApply);
+
+    class SpeculateWork;
+
+    enum
+    {
+        // Candidates needed before the first pass is speculated in parallel
+        parallelApplyThreshold = 64,
+
+        // Most jobs that help speculate, each uses its own ledger snapshot
+        maxSpeculateJobs = 4
+    };
+
+    static bool canSpeculate (SerializedTransaction const& txn);
+    static void speculateJob (boost::shared_ptr <SpeculateWork> work, Ledger::pointer snapshot, Job&);
+    static void applySpeculative (TransactionEngine & engine, std::vector <SerializedTransaction::pointer> const& txns,
+                                  Ledger::ref targetLedger, CanonicalTXSet & failedTransactions, bool openLgr,
+                                  int jobs);
+    static boost::shared_ptr <SpeculateWork> makeSpeculateWork (std::vector <SerializedTransaction::pointer> const& txns,
+                                  bool openLgr);
+    static void applySpeculated (TransactionEngine & engine, SpeculateWork & work, Ledger::ref targetLedger,
+                                 CanonicalTXSet & failedTransactions, bool openLgr);
+
+    friend class LedgerConsensusTests;
 
     uint32 roundCloseTime (uint32 closeTime);
 
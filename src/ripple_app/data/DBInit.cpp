@@ -291,6 +291,20 @@ const char* WalletDBInit[] =
 		LastMajority	BIGINT UNSIGNED					\
 	);",
 
+    // The order books of a recent ledger, so that OrderBookDB does not
+    // have to walk the whole ledger on start up.
+    "CREATE TABLE OrderBookLedger (						\
+		LedgerSeq		BIGINT UNSIGNED,				\
+		LedgerHash		CHARACTER(64)					\
+	);",
+
+    "CREATE TABLE OrderBooks (							\
+		TakerPaysCurrency	CHARACTER(40),				\
+		TakerPaysIssuer		CHARACTER(40),				\
+		TakerGetsCurrency	CHARACTER(40),				\
+		TakerGetsIssuer		CHARACTER(40)				\
+	);",
+
     "END TRANSACTION;"
 };
 
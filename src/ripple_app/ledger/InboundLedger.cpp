@@ -115,6 +115,8 @@ bool InboundLedger::tryLocal ()
         mHaveBase = true;
     }
 
+    prefetchRoots ();
+
     if (!mHaveTransactions)
     {
         if (mLedger->getTransHash ().isZero ())
@@ -679,9 +681,25 @@ bool InboundLedger::takeBase (const std::string& data) // data must not have has
         mHaveState = true;
 
     mLedger->setAcquiring ();
+    prefetchRoots ();
     return true;
 }
 
+// Start reading the roots of the maps we still need from the node store,
+// so the reads overlap each other and the work done before we ask for them.
+void InboundLedger::prefetchRoots ()
+{
+    std::vector<uint256> hashes;
+
+    if (!mHaveTransactions && mLedger->getTransHash ().isNonZero ())
+        hashes.push_back (mLedger->getTransHash ());
+
+    if (!mHaveState && mLedger->getAccountHash ().isNonZero ())
+        hashes.push_back (mLedger->getAccountHash ());
+
+    getApp().getNodeStore ().prefetch (hashes);
+}
+
 bool InboundLedger::takeTxNode (const std::list<SHAMapNode>& nodeIDs,
                                 const std::list< Blob >& data, SHAMapAddNode& san)
 {
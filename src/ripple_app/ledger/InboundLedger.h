@@ -97,6 +97,8 @@ public:
 private:
     void done ();
 
+    void prefetchRoots ();
+
     void onTimer (bool progress, ScopedLockType& peerSetLock);
 
     void newPeer (Peer::ref peer)
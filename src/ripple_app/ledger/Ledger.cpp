@@ -150,6 +150,10 @@ Ledger::Ledger (bool /* dummy */,
 
     assert (mParentHash.isNonZero ());
 
+    // An open ledger changes many times before its hashes are needed
+    mTransactionMap->setDeferredHashing (true);
+    mAccountStateMap->setDeferredHashing (true);
+
     mCloseResolution = ContinuousLedgerTiming::getNextLedgerTimeResolution (
                            prevLedger.mCloseResolution,
                            prevLedger.getCloseAgree (),
@@ -1000,13 +1004,21 @@ static void stateItemFullAppender(Json::Value& value, SLE::ref sle)
     value.append (sle->getJson (0));
 }
 
-Json::Value Ledger::getJson (int options)
+static void stateItemTagWriter(Json::StreamWriter& writer, SHAMapItem::ref smi)
 {
-    Json::Value ledger (Json::objectValue);
+    writer.write (smi->getTag ().GetHex ());
+}
 
-    bool bFull = isSetBit (options, LEDGER_JSON_FULL);
+static void stateItemFullWriter(Json::StreamWriter& writer, SHAMapItem::ref smi)
+{
+    SLE sle (smi->peekSerializer (), smi->getTag ());
+    writer.write (sle.getJson (0));
+}
 
-    ScopedLockType sl (mLock, __FILE__, __LINE__);
+// Caller must hold mLock
+void Ledger::addJsonHeader (Json::Value& ledger, int options)
+{
+    bool bFull = isSetBit (options, LEDGER_JSON_FULL);
 
     ledger["seqNum"]                = lexicalCastThrow <std::string> (mLedgerSeq); // DEPRECATED
 
@@ -1041,6 +1053,47 @@ Json::Value Ledger::getJson (int options)
     {
         ledger["closed"] = false;
     }
+}
+
+Json::Value Ledger::getTxJson (SHAMapItem::ref item, SHAMapTreeNode::TNType type, int options)
+{
+    if (!isSetBit (options, LEDGER_JSON_FULL) && !isSetBit (options, LEDGER_JSON_EXPAND))
+        return item->getTag ().GetHex ();
+
+    if (type == SHAMapTreeNode::tnTRANSACTION_NM)
+    {
+        SerializerIterator sit (item->peekSerializer ());
+        SerializedTransaction txn (sit);
+        return txn.getJson (0);
+    }
+    else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
+    {
+        SerializerIterator sit (item->peekSerializer ());
+        Serializer sTxn (sit.getVL ());
+
+        SerializerIterator tsit (sTxn);
+        SerializedTransaction txn (tsit);
+
+        TransactionMetaSet meta (item->getTag (), mLedgerSeq, sit.getVL ());
+        Json::Value txJson = txn.getJson (0);
+        txJson["metaData"] = meta.getJson (0);
+        return txJson;
+    }
+
+    Json::Value error = Json::objectValue;
+    error[item->getTag ().GetHex ()] = type;
+    return error;
+}
+
+Json::Value Ledger::getJson (int options)
+{
+    Json::Value ledger (Json::objectValue);
+
+    bool bFull = isSetBit (options, LEDGER_JSON_FULL);
+
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    addJsonHeader (ledger, options);
 
     if (mTransactionMap && (bFull || isSetBit (options, LEDGER_JSON_DUMP_TXRP)))
     {
@@ -1051,35 +1104,7 @@ Json::Value Ledger::getJson (int options)
         for (SHAMapItem::pointer item = mTransactionMap->peekFirstItem (type); !!item;
                 item = mTransactionMap->peekNextItem (item->getTag (), type))
         {
-            if (bFull || isSetBit (options, LEDGER_JSON_EXPAND))
-            {
-                if (type == SHAMapTreeNode::tnTRANSACTION_NM)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    SerializedTransaction txn (sit);
-                    txns.append (txn.getJson (0));
-                }
-                else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    Serializer sTxn (sit.getVL ());
-
-                    SerializerIterator tsit (sTxn);
-                    SerializedTransaction txn (tsit);
-
-                    TransactionMetaSet meta (item->getTag (), mLedgerSeq, sit.getVL ());
-                    Json::Value txJson = txn.getJson (0);
-                    txJson["metaData"] = meta.getJson (0);
-                    txns.append (txJson);
-                }
-                else
-                {
-                    Json::Value error = Json::objectValue;
-                    error[item->getTag ().GetHex ()] = type;
-                    txns.append (error);
-                }
-            }
-            else txns.append (item->getTag ().GetHex ());
+            txns.append (getTxJson (item, type, options));
         }
 
         ledger["transactions"] = txns;
@@ -1097,6 +1122,60 @@ Json::Value Ledger::getJson (int options)
     return ledger;
 }
 
+void Ledger::writeJson (Json::StreamWriter& writer, int options)
+{
+    Json::Value header (Json::objectValue);
+
+    bool bFull = isSetBit (options, LEDGER_JSON_FULL);
+
+    SHAMap::pointer txMap;
+    SHAMap::pointer stateMap;
+
+    // The writer can block for as long as the client takes to read, so
+    // only the header and snapshots of the maps are taken under the lock.
+    {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+        addJsonHeader (header, options);
+
+        if (mTransactionMap && (bFull || isSetBit (options, LEDGER_JSON_DUMP_TXRP)))
+            txMap = mTransactionMap->snapShot (false);
+
+        if (mAccountStateMap && (bFull || isSetBit (options, LEDGER_JSON_DUMP_STATE)))
+            stateMap = mAccountStateMap->snapShot (false);
+    }
+
+    writer.startObject ("ledger");
+    writer.writeMembers (header);
+
+    if (txMap)
+    {
+        SHAMapTreeNode::TNType type;
+
+        writer.startArray ("transactions");
+
+        for (SHAMapItem::pointer item = txMap->peekFirstItem (type); !!item;
+                item = txMap->peekNextItem (item->getTag (), type))
+        {
+            writer.write (getTxJson (item, type, options));
+        }
+
+        writer.endArray ();
+    }
+
+    if (stateMap)
+    {
+        writer.startArray ("accountState");
+        if (bFull || isSetBit (options, LEDGER_JSON_EXPAND))
+            stateMap->visitLeaves(BIND_TYPE(stateItemFullWriter, beast::ref(writer), P_1));
+        else
+            stateMap->visitLeaves(BIND_TYPE(stateItemTagWriter, beast::ref(writer), P_1));
+        writer.endArray ();
+    }
+
+    writer.endObject ();
+}
+
 void Ledger::setAcquiring (void)
 {
     if (!mTransactionMap || !mAccountStateMap) throw std::runtime_error ("invalid map");
@@ -1198,6 +1277,9 @@ SLE::pointer Ledger::getSLEi (uint256 const& uId)
 
     if (!ret)
     {
+        // The cache outlives any transaction arena
+        Arena::Suspend suspend;
+
         ret = boost::make_shared<SLE> (node->peekSerializer (), node->getTag ());
         ret->setImmutable ();
         getApp().getSLECache ().canonicalize (hash, ret);
@@ -1234,6 +1316,36 @@ void Ledger::visitAccountItems (const uint160& accountID, FUNCTION_TYPE<void (SL
 
 }
 
+// Like visitAccountItems, but the items are read in place
+void Ledger::visitAccountItemViews (const uint160& accountID, FUNCTION_TYPE<void (STObjectView const&)> func)
+{
+    uint256 rootIndex       = Ledger::getOwnerDirIndex (accountID);
+    uint256 currentIndex    = rootIndex;
+
+    while (1)
+    {
+        SLE::pointer ownerDir   = getSLEi (currentIndex);
+
+        if (!ownerDir || (ownerDir->getType () != ltDIR_NODE))
+            return;
+
+        BOOST_FOREACH (uint256 const & uNode, ownerDir->getFieldV256 (sfIndexes).peekValue ())
+        {
+            SHAMapItem::pointer item = mAccountStateMap->peekItem (uNode);
+
+            if (item)
+                func (STObjectView (item->peekSerializer ()));
+        }
+
+        uint64 uNodeNext    = ownerDir->getFieldU64 (sfIndexNext);
+
+        if (!uNodeNext)
+            return;
+
+        currentIndex    = Ledger::getDirNodeIndex (rootIndex, uNodeNext);
+    }
+}
+
 static void visitHelper (FUNCTION_TYPE<void (SLE::ref)>& function, SHAMapItem::ref item)
 {
     function (boost::make_shared<SLE> (item->peekSerializer (), item->getTag ()));
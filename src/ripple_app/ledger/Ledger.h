@@ -260,6 +260,7 @@ public:
     SLE::pointer getAccountRoot (const RippleAddress & naAccountID);
     void updateSkipList ();
     void visitAccountItems (const uint160 & acctID, FUNCTION_TYPE<void (SLE::ref)>);
+    void visitAccountItemViews (const uint160 & acctID, FUNCTION_TYPE<void (STObjectView const&)>);
     void visitStateItems (FUNCTION_TYPE<void (SLE::ref)>);
 
     // database functions (low-level)
@@ -458,10 +459,19 @@ public:
     Json::Value getJson (int options);
     void addJson (Json::Value&, int options);
 
+    /** Write the same "ledger" member as addJson, one entry at a time.
+        Dumps of the transactions or the account state are never held
+        in memory as a whole.
+    */
+    void writeJson (Json::StreamWriter& writer, int options);
+
     bool walkLedger ();
     bool assertSane ();
 
 protected:
+    void addJsonHeader (Json::Value& ledger, int options);
+    Json::Value getTxJson (SHAMapItem::ref item, SHAMapTreeNode::TNType type, int options);
+
     SLE::pointer getASNode (LedgerStateParms & parms, uint256 const & nodeID, LedgerEntryType let);
 
     // returned SLE is immutable
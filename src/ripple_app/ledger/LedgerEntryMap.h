@@ -0,0 +1,267 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_LEDGERENTRYMAP_H
+#define RIPPLE_LEDGERENTRYMAP_H
+
+/** A map from ledger entry index to Mapped, ordered by index.
+
+    The values are kept in a vector sorted by index. Once there are enough
+    of them, lookups go through an open addressed table of positions
+    instead of a binary search.
+
+    Copies share their storage until one of them is changed, so making a
+    checkpoint of a set costs nothing until it is written. Anything that
+    can change the values unshares the storage first; this includes
+    calling the non-const begin (), end (), find () and upper_bound (). A
+    non-const iterator must not be kept across a copy of the map.
+*/
+template <class Mapped>
+class LedgerEntryMap
+{
+public:
+    typedef uint256                                         key_type;
+    typedef Mapped                                          mapped_type;
+    typedef std::pair <uint256, Mapped>                     value_type;
+    typedef typename std::vector <value_type>::iterator        iterator;
+    typedef typename std::vector <value_type>::const_iterator  const_iterator;
+
+    LedgerEntryMap ()
+        : m_storage (boost::make_shared <Storage> ())
+    {
+    }
+
+    std::size_t size () const
+    {
+        return m_storage->values.size ();
+    }
+
+    bool empty () const
+    {
+        return m_storage->values.empty ();
+    }
+
+    const_iterator begin () const
+    {
+        return m_storage->values.begin ();
+    }
+
+    const_iterator end () const
+    {
+        return m_storage->values.end ();
+    }
+
+    iterator begin ()
+    {
+        return unshare ().values.begin ();
+    }
+
+    iterator end ()
+    {
+        return unshare ().values.end ();
+    }
+
+    const_iterator find (uint256 const& key) const
+    {
+        int const pos = lookup (*m_storage, key);
+
+        return (pos < 0) ? end () : (begin () + pos);
+    }
+
+    iterator find (uint256 const& key)
+    {
+        Storage& storage (unshare ());
+        int const pos = lookup (storage, key);
+
+        return (pos < 0) ? storage.values.end () : (storage.values.begin () + pos);
+    }
+
+    const_iterator upper_bound (uint256 const& key) const
+    {
+        return std::upper_bound (begin (), end (), key, KeyLess ());
+    }
+
+    iterator upper_bound (uint256 const& key)
+    {
+        Storage& storage (unshare ());
+
+        return std::upper_bound (storage.values.begin (), storage.values.end (), key, KeyLess ());
+    }
+
+    std::pair <iterator, bool> insert (value_type const& value)
+    {
+        Storage& storage (unshare ());
+        iterator it = std::lower_bound (storage.values.begin (), storage.values.end (),
+                                        value.first, KeyLess ());
+
+        if ((it != storage.values.end ()) && (it->first == value.first))
+            return std::make_pair (it, false);
+
+        int const pos = it - storage.values.begin ();
+        it = storage.values.insert (it, value);
+
+        if (!storage.slots.empty ())
+        {
+            if ((storage.values.size () * 2) > storage.slots.size ())
+            {
+                rebuild (storage);
+            }
+            else
+            {
+                // Everything after the new value moved up one place
+                for (std::vector <int>::iterator slot = storage.slots.begin ();
+                        slot != storage.slots.end (); ++slot)
+                {
+                    if (*slot >= pos)
+                        ++*slot;
+                }
+
+                place (storage, pos);
+            }
+        }
+        else if (storage.values.size () >= indexThreshold)
+        {
+            rebuild (storage);
+        }
+
+        return std::make_pair (it, true);
+    }
+
+    void erase (iterator it)
+    {
+        Storage& storage (unshare ());
+
+        storage.values.erase (it);
+
+        // Removing from an open addressed table breaks probe chains
+        if (!storage.slots.empty ())
+            rebuild (storage);
+    }
+
+    void clear ()
+    {
+        if (m_storage.unique ())
+        {
+            m_storage->values.clear ();
+            m_storage->slots.clear ();
+        }
+        else
+        {
+            m_storage = boost::make_shared <Storage> ();
+        }
+    }
+
+    void swap (LedgerEntryMap& other)
+    {
+        m_storage.swap (other.m_storage);
+    }
+
+private:
+    enum
+    {
+        // Values needed before lookups use the table
+        indexThreshold = 64
+    };
+
+    struct Storage
+    {
+        // Sorted by key
+        std::vector <value_type> values;
+
+        // Positions in values, -1 for an empty slot. The size is a power of
+        // two, at least twice the number of values, or zero if there are
+        // too few values to need it.
+        std::vector <int> slots;
+    };
+
+    struct KeyLess
+    {
+        bool operator() (value_type const& lhs, uint256 const& rhs) const
+        {
+            return lhs.first < rhs;
+        }
+
+        bool operator() (uint256 const& lhs, value_type const& rhs) const
+        {
+            return lhs < rhs.first;
+        }
+    };
+
+    Storage& unshare ()
+    {
+        if (!m_storage.unique ())
+            m_storage = boost::make_shared <Storage> (*m_storage);
+
+        return *m_storage;
+    }
+
+    // Returns the position of the key, or -1 if it is not present
+    static int lookup (Storage const& storage, uint256 const& key)
+    {
+        if (storage.slots.empty ())
+        {
+            const_iterator it = std::lower_bound (storage.values.begin (), storage.values.end (),
+                                                  key, KeyLess ());
+
+            if ((it == storage.values.end ()) || (it->first != key))
+                return -1;
+
+            return it - storage.values.begin ();
+        }
+
+        std::size_t const mask = storage.slots.size () - 1;
+
+        for (std::size_t slot = hash_value (key) & mask; ; slot = (slot + 1) & mask)
+        {
+            int const pos = storage.slots [slot];
+
+            if ((pos < 0) || (storage.values [pos].first == key))
+                return pos;
+        }
+    }
+
+    static void place (Storage& storage, int pos)
+    {
+        std::size_t const mask = storage.slots.size () - 1;
+        std::size_t slot = hash_value (storage.values [pos].first) & mask;
+
+        while (storage.slots [slot] >= 0)
+            slot = (slot + 1) & mask;
+
+        storage.slots [slot] = pos;
+    }
+
+    static void rebuild (Storage& storage)
+    {
+        std::size_t size = indexThreshold * 2;
+
+        while (size < (storage.values.size () * 4))
+            size *= 2;
+
+        storage.slots.assign (size, -1);
+
+        for (int pos = 0; pos < static_cast <int> (storage.values.size ()); ++pos)
+            place (storage, pos);
+    }
+
+    boost::shared_ptr <Storage> m_storage;
+};
+
+#endif
@@ -35,17 +35,19 @@ void LedgerEntrySet::init (Ledger::ref ledger, uint256 const& transactionID,
     mSet.init (transactionID, ledgerID);
     mParams = params;
     mSeq    = 0;
+    mMisses.clear ();
 }
 
 void LedgerEntrySet::clear ()
 {
     mEntries.clear ();
     mSet.clear ();
+    mMisses.clear ();
 }
 
 LedgerEntrySet LedgerEntrySet::duplicate () const
 {
-    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1);
+    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1, mTrackMisses, mMisses);
 }
 
 void LedgerEntrySet::setTo (const LedgerEntrySet& e)
@@ -55,6 +57,8 @@ void LedgerEntrySet::setTo (const LedgerEntrySet& e)
     mSet = e.mSet;
     mParams = e.mParams;
     mSeq = e.mSeq;
+    mTrackMisses = e.mTrackMisses;
+    mMisses = e.mMisses;
 }
 
 void LedgerEntrySet::swapWith (LedgerEntrySet& e)
@@ -64,27 +68,36 @@ void LedgerEntrySet::swapWith (LedgerEntrySet& e)
     mSet.swap (e.mSet);
     std::swap (mParams, e.mParams);
     std::swap (mSeq, e.mSeq);
+    std::swap (mTrackMisses, e.mTrackMisses);
+    mMisses.swap (e.mMisses);
 }
 
 // Find an entry in the set.  If it has the wrong sequence number, copy it and update the sequence number.
 // This is basically: copy-on-read.
 SLE::pointer LedgerEntrySet::getEntry (uint256 const& index, LedgerEntryAction& action)
 {
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (index);
+    // Look without unsharing the entries, most entries are current
+    EntryMap const& entries (mEntries);
+    const_iterator cit = entries.find (index);
 
-    if (it == mEntries.end ())
+    if (cit == entries.end ())
     {
         action = taaNONE;
         return SLE::pointer ();
     }
 
-    if (it->second.mSeq != mSeq)
+    if (cit->second.mSeq == mSeq)
     {
-        assert (it->second.mSeq < mSeq);
-        it->second.mEntry = boost::make_shared<SerializedLedgerEntry> (*it->second.mEntry);
-        it->second.mSeq = mSeq;
+        action = cit->second.mAction;
+        return cit->second.mEntry;
     }
 
+    iterator it = mEntries.find (index);
+
+    assert (it->second.mSeq < mSeq);
+    it->second.mEntry = boost::make_shared<SerializedLedgerEntry> (*it->second.mEntry);
+    it->second.mSeq = mSeq;
+
     action = it->second.mAction;
     return it->second.mEntry;
 }
@@ -114,6 +127,8 @@ SLE::pointer LedgerEntrySet::entryCache (LedgerEntryType letType, uint256 const&
 
             if (sleEntry)
                 entryCache (sleEntry);
+            else if (mTrackMisses)
+                mMisses.push_back (index);
         }
         else if (action == taaDELETE)
             sleEntry.reset ();
@@ -124,7 +139,7 @@ SLE::pointer LedgerEntrySet::entryCache (LedgerEntryType letType, uint256 const&
 
 LedgerEntryAction LedgerEntrySet::hasEntry (uint256 const& index) const
 {
-    std::map<uint256, LedgerEntrySetEntry>::const_iterator it = mEntries.find (index);
+    const_iterator it = mEntries.find (index);
 
     if (it == mEntries.end ())
         return taaNONE;
@@ -136,7 +151,7 @@ void LedgerEntrySet::entryCache (SLE::ref sle)
 {
     assert (mLedger);
     assert (sle->isMutable () || mImmutable); // Don't put an immutable SLE in a mutable LES
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (sle->getIndex ());
+    iterator it = mEntries.find (sle->getIndex ());
 
     if (it == mEntries.end ())
     {
@@ -161,7 +176,7 @@ void LedgerEntrySet::entryCreate (SLE::ref sle)
 {
     assert (mLedger && !mImmutable);
     assert (sle->isMutable ());
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (sle->getIndex ());
+    iterator it = mEntries.find (sle->getIndex ());
 
     if (it == mEntries.end ())
     {
@@ -199,7 +214,7 @@ void LedgerEntrySet::entryModify (SLE::ref sle)
 {
     assert (sle->isMutable () && !mImmutable);
     assert (mLedger);
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (sle->getIndex ());
+    iterator it = mEntries.find (sle->getIndex ());
 
     if (it == mEntries.end ())
     {
@@ -234,7 +249,7 @@ void LedgerEntrySet::entryDelete (SLE::ref sle)
 {
     assert (sle->isMutable () && !mImmutable);
     assert (mLedger);
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (sle->getIndex ());
+    iterator it = mEntries.find (sle->getIndex ());
 
     if (it == mEntries.end ())
     {
@@ -269,8 +284,9 @@ void LedgerEntrySet::entryDelete (SLE::ref sle)
 
 bool LedgerEntrySet::hasChanges ()
 {
-    typedef std::map<uint256, LedgerEntrySetEntry>::value_type u256_LES_pair;
-    BOOST_FOREACH (u256_LES_pair & it, mEntries)
+    EntryMap const& entries (mEntries);
+
+    BOOST_FOREACH (value_type const & it, entries)
 
     if (it.second.mAction != taaCACHED)
         return true;
@@ -289,7 +305,7 @@ Json::Value LedgerEntrySet::getJson (int) const
 
     Json::Value nodes (Json::arrayValue);
 
-    for (std::map<uint256, LedgerEntrySetEntry>::const_iterator it = mEntries.begin (),
+    for (const_iterator it = mEntries.begin (),
             end = mEntries.end (); it != end; ++it)
     {
         Json::Value entry (Json::objectValue);
@@ -364,7 +380,7 @@ Json::Value LedgerEntrySet::getJson (int) const
 SLE::pointer LedgerEntrySet::getForMod (uint256 const& node, Ledger::ref ledger,
                                         boost::unordered_map<uint256, SLE::pointer>& newMods)
 {
-    std::map<uint256, LedgerEntrySetEntry>::iterator it = mEntries.find (node);
+    iterator it = mEntries.find (node);
 
     if (it != mEntries.end ())
     {
@@ -471,8 +487,7 @@ void LedgerEntrySet::calcRawMeta (Serializer& s, TER result, uint32 index)
     // Entries modified only as a result of building the transaction metadata
     boost::unordered_map<uint256, SLE::pointer> newMod;
 
-    typedef std::map<uint256, LedgerEntrySetEntry>::value_type u256_LES_pair;
-    BOOST_FOREACH (u256_LES_pair & it, mEntries)
+    BOOST_FOREACH (value_type & it, mEntries)
     {
         SField::ptr type = &sfGeneric;
 
@@ -603,6 +618,12 @@ void LedgerEntrySet::calcRawMeta (Serializer& s, TER result, uint32 index)
     WriteLog (lsTRACE, LedgerEntrySet) << "Metadata:" << mSet.getJson (0);
 }
 
+void LedgerEntrySet::addRawMeta (Serializer& s, TER result, uint32 index)
+{
+    // the metadata must already have been calculated, only the index changes
+    mSet.addRaw (s, result, index);
+}
+
 TER LedgerEntrySet::dirCount (uint256 const& uRootIndex, uint32& uCount)
 {
     uint64  uNodeDir    = 0;
@@ -998,17 +1019,18 @@ uint256 LedgerEntrySet::getNextLedgerIndex (uint256 const& uHash)
 {
     // find next node in ledger that isn't deleted by LES
     uint256 ledgerNext = uHash;
-    std::map<uint256, LedgerEntrySetEntry>::const_iterator it;
+    EntryMap const& entries (mEntries);
+    const_iterator it;
 
     do
     {
         ledgerNext = mLedger->getNextLedgerIndex (ledgerNext);
-        it  = mEntries.find (ledgerNext);
+        it  = entries.find (ledgerNext);
     }
-    while ((it != mEntries.end ()) && (it->second.mAction == taaDELETE));
+    while ((it != entries.end ()) && (it->second.mAction == taaDELETE));
 
     // find next node in LES that isn't deleted
-    for (it = mEntries.upper_bound (uHash); it != mEntries.end (); ++it)
+    for (it = entries.upper_bound (uHash); it != entries.end (); ++it)
     {
         // node found in LES, node found in ledger, return earliest
         if (it->second.mAction != taaDELETE)
@@ -1656,4 +1678,94 @@ TER LedgerEntrySet::accountSend (const uint160& uSenderID, const uint160& uRecei
     return terResult;
 }
 
+//------------------------------------------------------------------------------
+
+class LedgerEntryMapTests : public UnitTest
+{
+public:
+    LedgerEntryMapTests () : UnitTest ("LedgerEntryMap", "ripple")
+    {
+    }
+
+    typedef LedgerEntryMap <int> Map;
+
+    static uint256 makeKey (int i)
+    {
+        Serializer s;
+        s.add32 (i);
+        return s.getSHA512Half ();
+    }
+
+    bool same (Map const& map, std::map <uint256, int> const& expected)
+    {
+        if (map.size () != expected.size ())
+            return false;
+
+        Map::const_iterator it = map.begin ();
+
+        for (std::map <uint256, int>::const_iterator e = expected.begin (); e != expected.end (); ++e, ++it)
+        {
+            if ((it->first != e->first) || (it->second != e->second))
+                return false;
+
+            Map::const_iterator found = map.find (e->first);
+
+            if ((found == map.end ()) || (found->second != e->second))
+                return false;
+        }
+
+        return true;
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("ordering");
+
+        Map map;
+        std::map <uint256, int> expected;
+
+        // Enough values to go past the lookup table threshold
+        for (int i = 0; i < 500; ++i)
+        {
+            map.insert (std::make_pair (makeKey (i), i));
+            expected.insert (std::make_pair (makeKey (i), i));
+        }
+
+        unexpected (map.insert (std::make_pair (makeKey (7), 0)).second, "bad duplicate insert");
+        unexpected (!same (map, expected), "bad order");
+        unexpected (map.find (makeKey (1000)) != map.end (), "bad missing find");
+
+        Map::const_iterator upper = static_cast <Map const&> (map).upper_bound (makeKey (3));
+        unexpected ((upper == map.end ()) ?
+                    (expected.upper_bound (makeKey (3)) != expected.end ()) :
+                    (upper->first != expected.upper_bound (makeKey (3))->first), "bad upper bound");
+
+        for (int i = 0; i < 500; i += 3)
+        {
+            map.erase (map.find (makeKey (i)));
+            expected.erase (makeKey (i));
+        }
+
+        unexpected (!same (map, expected), "bad erase");
+
+        beginTestCase ("copy on write");
+
+        Map copy (map);
+        std::map <uint256, int> copyExpected (expected);
+
+        copy.find (makeKey (1))->second = -1;
+        copyExpected [makeKey (1)] = -1;
+        copy.insert (std::make_pair (makeKey (1001), 1001));
+        copyExpected.insert (std::make_pair (makeKey (1001), 1001));
+
+        unexpected (!same (copy, copyExpected), "bad copy");
+        unexpected (!same (map, expected), "copy changed the original");
+
+        copy.clear ();
+        unexpected (!copy.empty () || !same (map, expected), "bad clear");
+    }
+};
+
+static LedgerEntryMapTests ledgerEntryMapTests;
+
 // vim:ts=4
@@ -79,11 +79,11 @@ public:
     static char const* getCountedObjectName () { return "LedgerEntrySet"; }
 
     LedgerEntrySet (Ledger::ref ledger, TransactionEngineParams tep, bool immutable = false) :
-        mLedger (ledger), mParams (tep), mSeq (0), mImmutable (immutable)
+        mLedger (ledger), mParams (tep), mSeq (0), mImmutable (immutable), mTrackMisses (false)
     {
     }
 
-    LedgerEntrySet () : mParams (tapNONE), mSeq (0), mImmutable (false)
+    LedgerEntrySet () : mParams (tapNONE), mSeq (0), mImmutable (false), mTrackMisses (false)
     {
     }
 
@@ -98,6 +98,23 @@ public:
         return mImmutable;
     }
 
+    // Remember the indexes of entries looked for but not found. Together
+    // with the entries in the set, these are everything the set has read.
+    void setTrackMisses (bool track)
+    {
+        mTrackMisses = track;
+    }
+
+    bool isTrackingMisses () const
+    {
+        return mTrackMisses;
+    }
+
+    std::vector <uint256> const& getMisses () const
+    {
+        return mMisses;
+    }
+
     LedgerEntrySet duplicate () const;  // Make a duplicate of this set
 
     void setTo (const LedgerEntrySet&); // Set this set to have the same contents as another
@@ -220,27 +237,30 @@ public:
 
     Json::Value getJson (int) const;
     void calcRawMeta (Serializer&, TER result, uint32 index);
+    void addRawMeta (Serializer&, TER result, uint32 index); // Serialize the metadata again
 
     // iterator functions
-    typedef std::map<uint256, LedgerEntrySetEntry>::iterator                iterator;
-    typedef std::map<uint256, LedgerEntrySetEntry>::const_iterator          const_iterator;
+    typedef LedgerEntryMap <LedgerEntrySetEntry>                            EntryMap;
+    typedef EntryMap::value_type                                            value_type;
+    typedef EntryMap::iterator                                              iterator;
+    typedef EntryMap::const_iterator                                        const_iterator;
     bool isEmpty () const
     {
         return mEntries.empty ();
     }
-    std::map<uint256, LedgerEntrySetEntry>::const_iterator begin () const
+    const_iterator begin () const
     {
         return mEntries.begin ();
     }
-    std::map<uint256, LedgerEntrySetEntry>::const_iterator end () const
+    const_iterator end () const
     {
         return mEntries.end ();
     }
-    std::map<uint256, LedgerEntrySetEntry>::iterator begin ()
+    iterator begin ()
     {
         return mEntries.begin ();
     }
-    std::map<uint256, LedgerEntrySetEntry>::iterator end ()
+    iterator end ()
     {
         return mEntries.end ();
     }
@@ -249,15 +269,18 @@ public:
 
 private:
     Ledger::pointer mLedger;
-    std::map<uint256, LedgerEntrySetEntry>  mEntries; // cannot be unordered!
+    EntryMap mEntries; // cannot be unordered!
     TransactionMetaSet mSet;
     TransactionEngineParams mParams;
     int mSeq;
     bool mImmutable;
+    bool mTrackMisses;
+    std::vector <uint256> mMisses;
 
-    LedgerEntrySet (Ledger::ref ledger, const std::map<uint256, LedgerEntrySetEntry>& e,
-                    const TransactionMetaSet & s, int m) :
-        mLedger (ledger), mEntries (e), mSet (s), mParams (tapNONE), mSeq (m), mImmutable (false)
+    LedgerEntrySet (Ledger::ref ledger, const EntryMap& e,
+                    const TransactionMetaSet & s, int m, bool trackMisses, const std::vector <uint256>& misses) :
+        mLedger (ledger), mEntries (e), mSet (s), mParams (tapNONE), mSeq (m), mImmutable (false),
+        mTrackMisses (trackMisses), mMisses (misses)
     {
         ;
     }
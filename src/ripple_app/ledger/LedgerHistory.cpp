@@ -31,7 +31,8 @@
 // FIXME: Need to clean up ledgers by index at some point
 
 LedgerHistory::LedgerHistory ()
-	: mLedgersByHash ("LedgerCache", CACHED_LEDGER_NUM, CACHED_LEDGER_AGE)
+	: mLock (this, "LedgerHistory", __FILE__, __LINE__)
+	, mLedgersByHash ("LedgerCache", CACHED_LEDGER_NUM, CACHED_LEDGER_AGE, 4)
 	, mConsensusValidated ("ConsensusValidated", 64, 300)
 {
     ;
@@ -42,7 +43,7 @@ void LedgerHistory::addLedger (Ledger::pointer ledger, bool validated)
     assert (ledger && ledger->isImmutable ());
     assert (ledger->peekAccountStateMap ()->getHash ().isNonZero ());
 
-    TaggedCache::ScopedLockType sl (mLedgersByHash.peekMutex (), __FILE__, __LINE__);
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
 
     mLedgersByHash.canonicalize (ledger->getHash(), ledger, true);
     if (validated)
@@ -51,7 +52,7 @@ void LedgerHistory::addLedger (Ledger::pointer ledger, bool validated)
 
 uint256 LedgerHistory::getLedgerHash (uint32 index)
 {
-    TaggedCache::ScopedLockType sl (mLedgersByHash.peekMutex (), __FILE__, __LINE__);
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
     std::map<uint32, uint256>::iterator it (mLedgersByIndex.find (index));
 
     if (it != mLedgersByIndex.end ())
@@ -62,7 +63,7 @@ uint256 LedgerHistory::getLedgerHash (uint32 index)
 
 Ledger::pointer LedgerHistory::getLedgerBySeq (uint32 index)
 {
-    TaggedCache::ScopedLockType sl (mLedgersByHash.peekMutex (), __FILE__, __LINE__);
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
     std::map<uint32, uint256>::iterator it (mLedgersByIndex.find (index));
 
     if (it != mLedgersByIndex.end ())
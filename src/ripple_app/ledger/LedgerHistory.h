@@ -52,7 +52,13 @@ public:
     void validatedLedger (Ledger::ref);
 
 private:
-    TaggedCacheType <LedgerHash, Ledger, UptimeTimerAdapter> mLedgersByHash;
+    typedef RippleRecursiveMutex LockType;
+    typedef LockType::ScopedLockType ScopedLockType;
+
+    // Protects mLedgersByIndex
+    LockType mLock;
+
+    ShardedTaggedCacheType <LedgerHash, Ledger, UptimeTimerAdapter> mLedgersByHash;
     TaggedCacheType <LedgerIndex, std::pair< LedgerHash, LedgerHash >, UptimeTimerAdapter> mConsensusValidated;
 
 
@@ -25,11 +25,14 @@ SETUP_LOG (LedgerMaster)
 
 uint32 LedgerMaster::getCurrentLedgerIndex ()
 {
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
     return mCurrentLedger->getLedgerSeq ();
 }
 
-Ledger::ref LedgerMaster::getCurrentSnapshot ()
+Ledger::pointer LedgerMaster::getCurrentSnapshot ()
 {
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
     if (!mCurrentSnapshot || (mCurrentSnapshot->getHash () != mCurrentLedger->getHash ()))
         mCurrentSnapshot = boost::make_shared<Ledger> (boost::ref (*mCurrentLedger), false);
 
@@ -760,6 +763,7 @@ void LedgerMaster::doAdvance ()
 
                     setFullLedger(ledger, true, true);
                     getApp().getOPs().pubLedger(ledger);
+                    getApp().getOrderBookDB().setup(ledger);
                 }
 
                 setPubLedger(ledger);
@@ -956,6 +960,34 @@ void LedgerMaster::updatePaths (Job& job)
     }
 }
 
+boost::shared_ptr <RippleLineCache> LedgerMaster::getLineCache (Ledger::ref ledger)
+{
+    RippleLineCache::pointer last;
+
+    {
+        ScopedLockType sl (mLineCacheLock, __FILE__, __LINE__);
+        last = mLineCache;
+    }
+
+    // Carrying the lines over scans ledgers, so it is done without the lock
+    RippleLineCache::pointer const previous = last;
+    RippleLineCache::pointer cache = RippleLineCache::getCache (ledger, last);
+
+    if (last != previous)
+    {
+        ScopedLockType sl (mLineCacheLock, __FILE__, __LINE__);
+
+        // Another thread may have kept a later ledger's lines meanwhile
+        if (!isStopping () && (!mLineCache ||
+            (mLineCache->getLedger ()->getLedgerSeq () < last->getLedger ()->getLedgerSeq ())))
+        {
+            mLineCache = last;
+        }
+    }
+
+    return cache;
+}
+
 void LedgerMaster::newPathRequest ()
 {
     ScopedLockType ml (mLock, __FILE__, __LINE__);
@@ -21,6 +21,8 @@
 #ifndef RIPPLE_LEDGERMASTER_H
 #define RIPPLE_LEDGERMASTER_H
 
+class RippleLineCache;
+
 // Tracks the current ledger and any ledgers in the process of closing
 // Tracks ledger history
 // Tracks held transactions
@@ -62,6 +64,21 @@ public:
     {
     }
 
+    // The node store is declared before us in Application, so it is
+    // still open here and stops after the pending nodes are written.
+    void onStop ()
+    {
+        mFlusher.stop ();
+
+        {
+            // Let go of the ledger the path finding cache holds
+            ScopedLockType sl (mLineCacheLock, __FILE__, __LINE__);
+            mLineCache.reset ();
+        }
+
+        stopped ();
+    }
+
     uint32 getCurrentLedgerIndex ();
 
     LockType& peekMutex ()
@@ -70,29 +87,33 @@ public:
     }
 
     // The current ledger is the ledger we believe new transactions should go in
-    Ledger::ref getCurrentLedger ()
+    Ledger::pointer getCurrentLedger ()
     {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
         return mCurrentLedger;
     }
 
     // An immutable snapshot of the current ledger
-    Ledger::ref getCurrentSnapshot ();
+    Ledger::pointer getCurrentSnapshot ();
 
     // The finalized ledger is the last closed/accepted ledger
-    Ledger::ref getClosedLedger ()
+    Ledger::pointer getClosedLedger ()
     {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
         return mClosedLedger;
     }
 
     // The validated ledger is the last fully validated ledger
-    Ledger::ref getValidatedLedger ()
+    Ledger::pointer getValidatedLedger ()
     {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
         return mValidLedger;
     }
 
     // This is the last ledger we published to clients and can lag the validated ledger
-    Ledger::ref getPublishedLedger ()
+    Ledger::pointer getPublishedLedger ()
     {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
         return mPubLedger;
     }
 
@@ -162,14 +183,18 @@ public:
 
     Ledger::pointer getLedgerByHash (uint256 const& hash)
     {
-        if (hash.isZero ())
-            return boost::make_shared<Ledger> (boost::ref (*mCurrentLedger), false);
+        {
+            ScopedLockType sl (mLock, __FILE__, __LINE__);
 
-        if (mCurrentLedger && (mCurrentLedger->getHash () == hash))
-            return boost::make_shared<Ledger> (boost::ref (*mCurrentLedger), false);
+            if (hash.isZero ())
+                return boost::make_shared<Ledger> (boost::ref (*mCurrentLedger), false);
 
-        if (mClosedLedger && (mClosedLedger->getHash () == hash))
-            return mClosedLedger;
+            if (mCurrentLedger && (mCurrentLedger->getHash () == hash))
+                return boost::make_shared<Ledger> (boost::ref (*mCurrentLedger), false);
+
+            if (mClosedLedger && (mClosedLedger->getHash () == hash))
+                return mClosedLedger;
+        }
 
         return mLedgerHistory.getLedgerByHash (hash);
     }
@@ -204,6 +229,12 @@ public:
         return mLedgerHistory.getCacheHitRate ();
     }
 
+    // Writes the dirty nodes of ledgers we close
+    SHAMapFlusher& getFlusher ()
+    {
+        return mFlusher;
+    }
+
     void addValidateCallback (callback& c)
     {
         mOnValidate.push_back (c);
@@ -215,6 +246,10 @@ public:
     void tryAdvance ();
     void newPathRequest ();
 
+    // The lines of a ledger for path finding, carried over from the last
+    // closed ledger asked for where possible
+    boost::shared_ptr <RippleLineCache> getLineCache (Ledger::ref ledger);
+
     static bool shouldAcquire (uint32 currentLedgerID, uint32 ledgerHistory, uint32 targetLedger);
 
 private:
@@ -252,11 +287,16 @@ private:
 
     LedgerHistory mLedgerHistory;
 
+    SHAMapFlusher mFlusher;
+
     CanonicalTXSet mHeldTransactions;
 
     LockType mCompleteLock;
     RangeSet mCompleteLedgers;
 
+    LockType mLineCacheLock;
+    boost::shared_ptr <RippleLineCache> mLineCache;
+
     int                         mMinValidations;    // The minimum validations to publish a ledger
     uint256                     mLastValidateHash;
     uint32                      mLastValidateSeq;
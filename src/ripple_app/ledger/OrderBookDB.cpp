@@ -24,6 +24,9 @@ OrderBookDB::OrderBookDB (Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , mLock (this, "OrderBookDB", __FILE__, __LINE__)
     , mSeq (0)
+    , mIndexSeq (0)
+    , mSavedSeq (0)
+    , mUpdateLock (this, "OrderBookDB::update", __FILE__, __LINE__)
 {
 
 }
@@ -32,19 +35,24 @@ void OrderBookDB::invalidate ()
 {
     ScopedLockType sl (mLock, __FILE__, __LINE__);
     mSeq = 0;
+    mIndexSeq = 0;
 }
 
 void OrderBookDB::setup (Ledger::ref ledger)
 {
+    // The books are saved in the wallet database, which is not open yet
+    if (!getApp().running ())
+        return;
+
     {
         ScopedLockType sl (mLock, __FILE__, __LINE__);
 
-        // Do a full update every 256 ledgers
         if (mSeq != 0)
         {
             if (ledger->getLedgerSeq () == mSeq)
                 return;
-            if ((ledger->getLedgerSeq () > mSeq) && ((ledger->getLedgerSeq () - mSeq) < 256))
+            // Books created in an open ledger are added as they are created
+            if (!ledger->isClosed ())
                 return;
             if ((ledger->getLedgerSeq () < mSeq) && ((mSeq - ledger->getLedgerSeq ()) < 16))
                 return;
@@ -66,6 +74,65 @@ void OrderBookDB::update (Ledger::pointer ledger)
 {
     LoadEvent::autoptr ev = getApp().getJobQueue ().getLoadEventAP (jtOB_SETUP, "OrderBookDB::update");
 
+    ScopedLockType ul (mUpdateLock, __FILE__, __LINE__);
+
+    uint32 indexSeq;
+    uint256 indexHash;
+    {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
+        indexSeq = mIndexSeq;
+        indexHash = mIndexHash;
+    }
+
+    if ((indexSeq == 0) && loadSnapshot ())
+    {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
+        indexSeq = mIndexSeq;
+        indexHash = mIndexHash;
+    }
+
+    if (indexSeq != 0)
+    {
+        uint32 const seq = ledger->getLedgerSeq ();
+
+        if ((seq <= indexSeq) && ((indexSeq - seq) < 16))
+            return;
+
+        // Books created in an open ledger are added as they are created,
+        // the ledger it closes into brings the rest.
+        if (!ledger->isClosed () && ((seq - indexSeq) <= maxLedgerDeltas))
+            return;
+
+        if (ledger->isClosed () && (seq > indexSeq) && ((seq - indexSeq) <= maxLedgerDeltas) &&
+            applyLedgers (ledger, indexSeq, indexHash))
+        {
+            setIndexLedger (ledger);
+
+            if ((seq - mSavedSeq) >= snapshotInterval)
+                saveSnapshot ();
+
+            return;
+        }
+    }
+
+    walkLedger (ledger);
+    saveSnapshot ();
+}
+
+// Adds a book to maps that other threads cannot see yet
+static void addBookTo (boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >& sourceMap,
+                       boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >& destMap,
+                       boost::unordered_set< currencyIssuer_t >& XRPBooks,
+                       OrderBook::ref book)
+{
+    sourceMap[currencyIssuer_ct (book->getCurrencyIn (), book->getIssuerIn ())].push_back (book);
+    destMap[currencyIssuer_ct (book->getCurrencyOut (), book->getIssuerOut ())].push_back (book);
+    if (book->getCurrencyOut ().isZero ())
+        XRPBooks.insert (currencyIssuer_ct (book->getCurrencyIn (), book->getIssuerIn ()));
+}
+
+void OrderBookDB::walkLedger (Ledger::ref ledger)
+{
     boost::unordered_set< uint256 > seen;
     boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > destMap;
     boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > sourceMap;
@@ -97,10 +164,7 @@ void OrderBookDB::update (Ledger::pointer ledger)
                 OrderBook::pointer book = boost::make_shared<OrderBook> (boost::cref (index),
                                           boost::cref (ci), boost::cref (co), boost::cref (ii), boost::cref (io));
 
-                sourceMap[currencyIssuer_ct (ci, ii)].push_back (book);
-                destMap[currencyIssuer_ct (co, io)].push_back (book);
-                if (co.isZero())
-                    XRPBooks.insert(currencyIssuer_ct (ci, ii));
+                addBookTo (sourceMap, destMap, XRPBooks, book);
                 ++books;
             }
         }
@@ -116,6 +180,307 @@ void OrderBookDB::update (Ledger::pointer ledger)
         mSourceMap.swap(sourceMap);
         mDestMap.swap(destMap);
     }
+
+    setIndexLedger (ledger);
+}
+
+void OrderBookDB::setIndexLedger (Ledger::ref ledger)
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    if (ledger->isClosed ())
+    {
+        mIndexSeq = ledger->getLedgerSeq ();
+        mIndexHash = ledger->getHash ();
+    }
+    else
+    {
+        // The books of the open ledger are also in the metadata of the
+        // ledger it closes into, so that is where the next update starts.
+        mIndexSeq = ledger->getLedgerSeq () - 1;
+        mIndexHash = ledger->getParentHash ();
+    }
+}
+
+// Applies the books created and removed by the ledgers after fromSeq
+//
+bool OrderBookDB::applyLedgers (Ledger::ref ledger, uint32 fromSeq, uint256 const& fromHash)
+{
+    std::map<uint256, OrderBook::pointer> books;
+    int removed = 0;
+
+    try
+    {
+        Ledger::pointer current = ledger;
+
+        for (;;)
+        {
+            findBooks (current, books);
+
+            if (current->getLedgerSeq () == (fromSeq + 1))
+                break;
+
+            current = getApp().getLedgerMaster ().getLedgerByHash (current->getParentHash ());
+
+            if (!current)
+            {
+                WriteLog (lsDEBUG, OrderBookDB) << "Ledger missing after " << fromSeq;
+                return false;
+            }
+        }
+
+        if (current->getParentHash () != fromHash)
+        {
+            WriteLog (lsDEBUG, OrderBookDB) << "Ledger " << fromSeq << " is not an ancestor";
+            return false;
+        }
+
+        // A book exists for as long as any of its quality directories
+        typedef std::map<uint256, OrderBook::pointer>::value_type value_type;
+        BOOST_FOREACH (value_type const& it, books)
+        {
+            uint256 const& base = it.first;
+
+            if (ledger->getNextLedgerIndex (base, Ledger::getQualityNext (base)).isNonZero ())
+            {
+                addOrderBook (it.second->getCurrencyIn (), it.second->getCurrencyOut (),
+                              it.second->getIssuerIn (), it.second->getIssuerOut ());
+            }
+            else
+            {
+                removeOrderBook (it.second);
+                ++removed;
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        WriteLog (lsINFO, OrderBookDB) << "Unable to apply ledgers after " << fromSeq << ": " << e.what ();
+        return false;
+    }
+
+    WriteLog (lsDEBUG, OrderBookDB) << "OrderBookDB::update " << fromSeq << " to " << ledger->getLedgerSeq () <<
+        ": " << books.size () << " books touched, " << removed << " removed";
+
+    return true;
+}
+
+// A field left out of the metadata holds its default value
+static uint160 getBookField (STObject const& object, SField::ref field)
+{
+    return object.isFieldPresent (field) ? object.getFieldH160 (field) : uint160 ();
+}
+
+// Finds the books whose directories the ledger created or deleted
+//
+void OrderBookDB::findBooks (Ledger::ref ledger, std::map<uint256, OrderBook::pointer>& books)
+{
+    AcceptedLedger::pointer accepted = AcceptedLedger::makeAcceptedLedger (ledger);
+
+    BOOST_FOREACH (AcceptedLedger::value_type const& vt, accepted->getMap ())
+    {
+        BOOST_FOREACH (STObject & node, vt.second->getMeta ()->getNodes ())
+        {
+            SField* field = NULL;
+
+            if (node.getFName () == sfCreatedNode)
+                field = &sfNewFields;
+            else if (node.getFName () == sfDeletedNode)
+                field = &sfFinalFields;
+
+            if (!field || (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE))
+                continue;
+
+            const STObject* data = dynamic_cast<const STObject*> (node.peekAtPField (*field));
+
+            // Owner directories have none of the book fields
+            if (!data || !(data->isFieldPresent (sfExchangeRate) ||
+                           data->isFieldPresent (sfTakerPaysCurrency) ||
+                           data->isFieldPresent (sfTakerGetsCurrency)))
+                continue;
+
+            uint160 ci = getBookField (*data, sfTakerPaysCurrency);
+            uint160 co = getBookField (*data, sfTakerGetsCurrency);
+            uint160 ii = getBookField (*data, sfTakerPaysIssuer);
+            uint160 io = getBookField (*data, sfTakerGetsIssuer);
+
+            uint256 index = Ledger::getBookBase (ci, ii, co, io);
+
+            if (books.find (index) == books.end ())
+            {
+                books[index] = boost::make_shared<OrderBook> (boost::cref (index),
+                               boost::cref (ci), boost::cref (co), boost::cref (ii), boost::cref (io));
+            }
+        }
+    }
+}
+
+// Removes a book from a map by its base index
+static void removeBookFrom (boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >& bookMap,
+                            currencyIssuer_t const& key, uint256 const& base)
+{
+    boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >::iterator it = bookMap.find (key);
+
+    if (it == bookMap.end ())
+        return;
+
+    std::vector<OrderBook::pointer>& books = it->second;
+
+    for (std::size_t i = 0; i < books.size (); ++i)
+    {
+        if (books[i]->getBookBase () == base)
+        {
+            books.erase (books.begin () + i);
+            break;
+        }
+    }
+
+    if (books.empty ())
+        bookMap.erase (it);
+}
+
+void OrderBookDB::removeOrderBook (OrderBook::ref book)
+{
+    currencyIssuer_t in (book->getCurrencyIn (), book->getIssuerIn ());
+    currencyIssuer_t out (book->getCurrencyOut (), book->getIssuerOut ());
+
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    removeBookFrom (mSourceMap, in, book->getBookBase ());
+    removeBookFrom (mDestMap, out, book->getBookBase ());
+
+    if (out.first.isZero ())
+    {
+        bool toXRP = false;
+
+        boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >::const_iterator
+        it = mSourceMap.find (in);
+
+        if (it != mSourceMap.end ())
+        {
+            BOOST_FOREACH (OrderBook::ref ob, it->second)
+            {
+                if (ob->getCurrencyOut ().isZero ())
+                    toXRP = true;
+            }
+        }
+
+        if (!toXRP)
+            mXRPBooks.erase (in);
+    }
+}
+
+// Loads the books saved by saveSnapshot
+//
+bool OrderBookDB::loadSnapshot ()
+{
+    uint32 seq = 0;
+    uint256 hash;
+    boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > destMap;
+    boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > sourceMap;
+    boost::unordered_set< currencyIssuer_t > XRPBooks;
+
+    {
+        DeprecatedScopedLock sl (getApp().getWalletDB ()->getDBLock ());
+        Database* db = getApp().getWalletDB ()->getDB ();
+
+        if (db->executeSQL ("SELECT LedgerSeq,LedgerHash FROM OrderBookLedger;") && db->startIterRows ())
+        {
+            std::string strHash;
+            seq = static_cast<uint32> (db->getBigInt ("LedgerSeq"));
+            db->getStr ("LedgerHash", strHash);
+            hash.SetHex (strHash);
+            db->endIterRows ();
+        }
+
+        if (seq == 0)
+            return false;
+
+        SQL_FOREACH (db, "SELECT TakerPaysCurrency,TakerPaysIssuer,TakerGetsCurrency,TakerGetsIssuer FROM OrderBooks;")
+        {
+            std::string strField;
+            uint160 ci, ii, co, io;
+
+            db->getStr ("TakerPaysCurrency", strField);
+            ci.SetHex (strField);
+            db->getStr ("TakerPaysIssuer", strField);
+            ii.SetHex (strField);
+            db->getStr ("TakerGetsCurrency", strField);
+            co.SetHex (strField);
+            db->getStr ("TakerGetsIssuer", strField);
+            io.SetHex (strField);
+
+            uint256 index = Ledger::getBookBase (ci, ii, co, io);
+
+            addBookTo (sourceMap, destMap, XRPBooks, boost::make_shared<OrderBook> (boost::cref (index),
+                       boost::cref (ci), boost::cref (co), boost::cref (ii), boost::cref (io)));
+        }
+    }
+
+    WriteLog (lsDEBUG, OrderBookDB) << "Loaded the books of ledger " << seq;
+
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    mXRPBooks.swap(XRPBooks);
+    mSourceMap.swap(sourceMap);
+    mDestMap.swap(destMap);
+    mIndexSeq = seq;
+    mIndexHash = hash;
+    mSavedSeq = seq;
+
+    return true;
+}
+
+// Saves the books so a restart does not have to walk the ledger
+//
+void OrderBookDB::saveSnapshot ()
+{
+    uint32 seq;
+    uint256 hash;
+    std::vector<OrderBook::pointer> books;
+
+    {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+        seq = mIndexSeq;
+        hash = mIndexHash;
+
+        typedef boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> >::value_type value_type;
+        BOOST_FOREACH (value_type const& it, mSourceMap)
+        {
+            books.insert (books.end (), it.second.begin (), it.second.end ());
+        }
+    }
+
+    if (seq == 0)
+        return;
+
+    {
+        DeprecatedScopedLock sl (getApp().getWalletDB ()->getDBLock ());
+        Database* db = getApp().getWalletDB ()->getDB ();
+
+        db->executeSQL ("BEGIN TRANSACTION;");
+        db->executeSQL ("DELETE FROM OrderBookLedger;");
+        db->executeSQL ("DELETE FROM OrderBooks;");
+
+        BOOST_FOREACH (OrderBook::ref book, books)
+        {
+            db->executeSQL (boost::str (boost::format (
+                "INSERT INTO OrderBooks (TakerPaysCurrency,TakerPaysIssuer,TakerGetsCurrency,TakerGetsIssuer) "
+                "VALUES ('%s','%s','%s','%s');")
+                % book->getCurrencyIn ().GetHex () % book->getIssuerIn ().GetHex ()
+                % book->getCurrencyOut ().GetHex () % book->getIssuerOut ().GetHex ()));
+        }
+
+        db->executeSQL (boost::str (boost::format (
+            "INSERT INTO OrderBookLedger (LedgerSeq,LedgerHash) VALUES (%u,'%s');")
+            % seq % hash.GetHex ()));
+        db->executeSQL ("END TRANSACTION;");
+    }
+
+    mSavedSeq = seq;
+
+    WriteLog (lsDEBUG, OrderBookDB) << "Saved " << books.size () << " books of ledger " << seq;
 }
 
 void OrderBookDB::addOrderBook(const uint160& ci, const uint160& co,
@@ -234,7 +599,8 @@ BookListeners::pointer OrderBookDB::getBookListeners (const uint160& currencyPay
 
 // Based on the meta, send the meta to the streams that are listening
 // We need to determine which streams a given meta effects
-void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value& jvObj)
+void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+                              boost::unordered_set <InfoSub::pointer>& listeners)
 {
     ScopedLockType sl (mLock, __FILE__, __LINE__);
 
@@ -282,7 +648,7 @@ void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
                                 getBookListeners (currencyPays, currencyGets, issuerPays, issuerGets);
 
                             if (book)
-                                book->publish (jvObj);
+                                book->addListeners (listeners);
                         }
                     }
                 }
@@ -314,11 +680,8 @@ void BookListeners::removeSubscriber (uint64 seq)
     mListeners.erase (seq);
 }
 
-void BookListeners::publish (Json::Value& jvObj)
+void BookListeners::addListeners (boost::unordered_set <InfoSub::pointer>& listeners)
 {
-    Json::FastWriter jfwWriter;
-    std::string sObj = jfwWriter.write (jvObj);
-
     ScopedLockType sl (mLock, __FILE__, __LINE__);
     NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
 
@@ -328,7 +691,7 @@ void BookListeners::publish (Json::Value& jvObj)
 
         if (p)
         {
-            p->send (jvObj, sObj, true);
+            listeners.insert (p);
             ++it;
         }
         else
@@ -336,4 +699,194 @@ void BookListeners::publish (Json::Value& jvObj)
     }
 }
 
+//------------------------------------------------------------------------------
+
+class OrderBookDBTests : public UnitTest
+{
+public:
+    OrderBookDBTests () : UnitTest ("OrderBookDB", "ripple")
+    {
+    }
+
+    struct Account
+    {
+        RippleAddress publicKey;
+        RippleAddress privateKey;
+        uint32 sequence;
+    };
+
+    static Account makeAccount (std::string const& passPhrase)
+    {
+        RippleAddress seed = RippleAddress::createSeedGeneric (passPhrase);
+        RippleAddress generator = RippleAddress::createGeneratorPublic (seed);
+
+        Account account;
+        account.publicKey = RippleAddress::createAccountPublic (generator, 0);
+        account.privateKey = RippleAddress::createAccountPrivate (generator, seed, 0);
+        account.sequence = 1;
+        return account;
+    }
+
+    static SerializedTransaction::pointer makeTransaction (TxType type, Account& from)
+    {
+        SerializedTransaction::pointer txn (boost::make_shared <SerializedTransaction> (type));
+
+        txn->setSigningPubKey (from.publicKey);
+        txn->setSourceAccount (from.publicKey);
+        txn->setSequence (from.sequence++);
+        txn->setTransactionFee (STAmount (10));
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makePayment (Account& from, Account const& to, uint64 xrp)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttPAYMENT, from));
+
+        txn->setFieldAccount (sfDestination, to.publicKey);
+        txn->setFieldAmount (sfAmount, STAmount (xrp * SYSTEM_CURRENCY_PARTS));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    // Offers XRP for a currency the issuer issues
+    static SerializedTransaction::pointer makeOffer (Account& from, Account const& issuer,
+                                                     std::string const& currency, uint64 xrp)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttOFFER_CREATE, from));
+
+        uint160 currencyID;
+        STAmount::currencyFromString (currencyID, currency);
+
+        txn->setFieldAmount (sfTakerPays, STAmount (currencyID, issuer.publicKey.getAccountID (), 10));
+        txn->setFieldAmount (sfTakerGets, STAmount (xrp * SYSTEM_CURRENCY_PARTS));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makeCancel (Account& from, uint32 offerSequence)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttOFFER_CANCEL, from));
+
+        txn->setFieldU32 (sfOfferSequence, offerSequence);
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    // Applies the transactions to a new ledger after the previous one and closes it
+    Ledger::pointer closeLedger (Ledger::ref previous, std::vector <SerializedTransaction::pointer> const& txns)
+    {
+        Ledger::pointer ledger (boost::make_shared <Ledger> (false, boost::ref (*previous)));
+
+        {
+            TransactionEngine engine (ledger);
+
+            BOOST_FOREACH (SerializedTransaction::ref txn, txns)
+            {
+                bool didApply;
+                engine.applyTransaction (*txn, tapNONE, didApply);
+                expect (didApply, "transaction not applied");
+            }
+        }
+
+        ledger->setClosed ();
+        ledger->setAccepted (previous->getCloseTimeNC () + 10, 10, false);
+        return ledger;
+    }
+
+    typedef boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > BookMap;
+
+    static std::set <uint256> getBookSet (BookMap const& books)
+    {
+        std::set <uint256> result;
+
+        for (BookMap::const_iterator it = books.begin (); it != books.end (); ++it)
+        {
+            BOOST_FOREACH (OrderBook::ref book, it->second)
+                result.insert (book->getBookBase ());
+        }
+
+        return result;
+    }
+
+    static bool sameBooks (OrderBookDB& lhs, OrderBookDB& rhs)
+    {
+        return (getBookSet (lhs.mSourceMap) == getBookSet (rhs.mSourceMap)) &&
+               (getBookSet (lhs.mDestMap) == getBookSet (rhs.mDestMap)) &&
+               (lhs.mXRPBooks == rhs.mXRPBooks);
+    }
+
+    // Brings the books up to date with the ledger after the one they have,
+    // then checks them against a fresh walk of that ledger
+    bool updateMatchesWalk (OrderBookDB& books, Ledger::ref previous, Ledger::ref ledger)
+    {
+        if (!books.applyLedgers (ledger, previous->getLedgerSeq (), previous->getHash ()))
+            return false;
+
+        books.setIndexLedger (ledger);
+
+        RootStoppable root ("OrderBookDBTests");
+        bool same;
+
+        {
+            OrderBookDB walked (root);
+            walked.walkLedger (ledger);
+            same = sameBooks (books, walked);
+            root.stop ();
+        }
+
+        return same;
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("update from metadata");
+
+        Account master (makeAccount ("masterpassphrase"));
+        Account alice (makeAccount ("alice"));
+        Account bob (makeAccount ("bob"));
+
+        Ledger::pointer genesis (boost::make_shared <Ledger> (master.publicKey, SYSTEM_CURRENCY_START));
+        genesis->setClosed ();
+        genesis->setAccepted (10, 10, false);
+
+        std::vector <SerializedTransaction::pointer> txns;
+        txns.push_back (makePayment (master, alice, 10000));
+        txns.push_back (makePayment (master, bob, 10000));
+        Ledger::pointer funded (closeLedger (genesis, txns));
+
+        RootStoppable root ("OrderBookDBTests");
+
+        {
+            OrderBookDB books (root);
+            books.walkLedger (funded);
+            expect (books.mSourceMap.empty (), "books before any offer");
+
+            // Two offers in the USD book and one in the EUR book
+            uint32 const aliceUSD = alice.sequence;
+            uint32 const bobEUR = bob.sequence + 1;
+            txns.clear ();
+            txns.push_back (makeOffer (alice, alice, "USD", 100));
+            txns.push_back (makeOffer (bob, alice, "USD", 200));
+            txns.push_back (makeOffer (bob, alice, "EUR", 50));
+            Ledger::pointer created (closeLedger (funded, txns));
+
+            expect (updateMatchesWalk (books, funded, created), "created books differ from a walk");
+            expect (getBookSet (books.mSourceMap).size () == 2, "created books not found");
+
+            // Deleting one USD offer keeps that book, the EUR book goes away
+            txns.clear ();
+            txns.push_back (makeCancel (alice, aliceUSD));
+            txns.push_back (makeCancel (bob, bobEUR));
+            Ledger::pointer deleted (closeLedger (created, txns));
+
+            expect (updateMatchesWalk (books, created, deleted), "deleted books differ from a walk");
+            expect (getBookSet (books.mSourceMap).size () == 1, "deleted book still found");
+
+            root.stop ();
+        }
+    }
+};
+
+static OrderBookDBTests orderBookDBTests;
+
 // vim:ts=4
@@ -43,7 +43,9 @@ public:
     BookListeners ();
     void addSubscriber (InfoSub::ref sub);
     void removeSubscriber (uint64 sub);
-    void publish (Json::Value& jvObj);
+
+    // Adds the live listeners to the set, forgetting the dead ones
+    void addListeners (boost::unordered_set <InfoSub::pointer>& listeners);
 
 private:
     typedef RippleRecursiveMutex LockType;
@@ -61,6 +63,12 @@ class OrderBookDB
 public:
     explicit OrderBookDB (Stoppable& parent);
 
+    /** Brings the books up to date with a ledger.
+
+        The books created or removed by the ledgers since the last update
+        are found in their metadata. The whole ledger is only walked when
+        those ledgers are not available.
+    */
     void setup (Ledger::ref ledger);
     void update (Ledger::pointer ledger);
     void invalidate ();
@@ -83,9 +91,13 @@ public:
             const uint160& issuerPays, const uint160& issuerGets);
 
     // see if this txn effects any orderbook
-    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value& jvObj);
+    // Adds the listeners of every book the transaction touched
+    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+                     boost::unordered_set <InfoSub::pointer>& listeners);
 
 private:
+    friend class OrderBookDBTests;
+
     boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > mSourceMap;   // by ci/ii
     boost::unordered_map< currencyIssuer_t, std::vector<OrderBook::pointer> > mDestMap;     // by co/io
     boost::unordered_set< currencyIssuer_t > mXRPBooks; // does an order book to XRP exist
@@ -99,6 +111,28 @@ private:
 
     uint32 mSeq;
 
+    // The ledger the books were last brought up to date with
+    uint32 mIndexSeq;
+    uint256 mIndexHash;
+    uint32 mSavedSeq;
+
+    // Held while the books are updated, so updates are applied in turn
+    LockType mUpdateLock;
+
+    enum
+    {
+        maxLedgerDeltas     = 256,  // Beyond this the ledger is walked instead
+        snapshotInterval    = 256   // Ledgers between saved snapshots
+    };
+
+    void walkLedger (Ledger::ref ledger);
+    bool applyLedgers (Ledger::ref ledger, uint32 fromSeq, uint256 const& fromHash);
+    void findBooks (Ledger::ref ledger, std::map<uint256, OrderBook::pointer>& books);
+    void removeOrderBook (OrderBook::ref book);
+    void setIndexLedger (Ledger::ref ledger);
+
+    bool loadSnapshot ();
+    void saveSnapshot ();
 };
 
 #endif
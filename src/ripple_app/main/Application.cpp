@@ -95,11 +95,17 @@ public:
 
         , m_orderBookDB (*m_jobQueue)
 
+        , m_nodeStoreScheduler (*m_jobQueue, *m_jobQueue,
+            getConfig ().getSize (siNodeReadThreads))
+
+        , m_nodeStore (NodeStore::Database::New ("NodeStore.main", m_nodeStoreScheduler,
+            getConfig ().nodeDatabase, getConfig ().ephemeralNodeDatabase))
+
         , m_ledgerMaster (*m_jobQueue)
 
         // VFALCO NOTE Does NetworkOPs depend on LedgerMaster?
-        , m_networkOPs (NetworkOPs::New (
-            m_ledgerMaster, *m_jobQueue, LogJournal::get <NetworkOPsLog> ()))
+        , m_networkOPs (NetworkOPs::New (m_ledgerMaster, m_mainIoPool,
+            *m_jobQueue, LogJournal::get <NetworkOPsLog> ()))
 
         // VFALCO NOTE LocalCredentials starts the deprecated UNL service
         , m_deprecatedUNL (UniqueNodeList::New (*m_jobQueue))
@@ -111,11 +117,6 @@ public:
         , m_rpcServerHandler (*m_networkOPs) // passive object, not a Service
 #endif
 
-        , m_nodeStoreScheduler (*m_jobQueue, *m_jobQueue)
-
-        , m_nodeStore (NodeStore::Database::New ("NodeStore.main", m_nodeStoreScheduler,
-            getConfig ().nodeDatabase, getConfig ().ephemeralNodeDatabase))
-
         , m_sntpClient (SNTPClient::New (*this))
 
         , m_inboundLedgers (*m_jobQueue)
@@ -359,6 +360,8 @@ public:
     //
     void setup ()
     {
+        m_jobQueue->configure (getConfig ().jobQueue);
+
         // VFALCO NOTE: 0 means use heuristics to determine the thread count.
         m_jobQueue->setThreadCount (0, getConfig ().RUN_STANDALONE);
 
@@ -453,6 +456,7 @@ public:
 
         mValidations->tune (getConfig ().getSize (siValidationsSize), getConfig ().getSize (siValidationsAge));
         m_nodeStore->tune (getConfig ().getSize (siNodeCacheSize), getConfig ().getSize (siNodeCacheAge));
+        m_nodeStore->tuneBytes (static_cast <std::size_t> (getConfig ().getSize (siNodeCacheMB)) * 1024 * 1024);
         m_ledgerMaster.tune (getConfig ().getSize (siLedgerSize), getConfig ().getSize (siLedgerAge));
         m_sleCache.setTargetSize (getConfig ().getSize (siSLECacheSize));
         m_sleCache.setTargetAge (getConfig ().getSize (siSLECacheAge));
@@ -858,6 +862,12 @@ private:
     ScopedPointer <JobQueue> m_jobQueue;
     IoServicePool m_mainIoPool;
     OrderBookDB m_orderBookDB;
+
+    // Before LedgerMaster, which writes closed ledgers to the node store
+    // until it stops, and so must stop and be destroyed first.
+    NodeStoreScheduler m_nodeStoreScheduler;
+    ScopedPointer <NodeStore::Database> m_nodeStore;
+
     LedgerMaster m_ledgerMaster;
     ScopedPointer <NetworkOPs> m_networkOPs;
     ScopedPointer <UniqueNodeList> m_deprecatedUNL;
@@ -865,8 +875,6 @@ private:
 #if ! RIPPLE_USE_RPC_SERVICE_MANAGER
     RPCServerHandler m_rpcServerHandler;
 #endif
-    NodeStoreScheduler m_nodeStoreScheduler;
-    ScopedPointer <NodeStore::Database> m_nodeStore;
     ScopedPointer <SNTPClient> m_sntpClient;
     InboundLedgers m_inboundLedgers;
     ScopedPointer <TxQueue> m_txQueue;
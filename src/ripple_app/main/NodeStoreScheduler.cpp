@@ -18,10 +18,12 @@
 //==============================================================================
 
 
-NodeStoreScheduler::NodeStoreScheduler (Stoppable& parent, JobQueue& jobQueue)
+NodeStoreScheduler::NodeStoreScheduler (Stoppable& parent, JobQueue& jobQueue,
+    int readThreads)
     : Stoppable ("NodeStoreScheduler", parent)
     , m_jobQueue (jobQueue)
     , m_taskCount (1) // start it off at 1
+    , m_readWorkers (*this, "NodeStore.read", readThreads)
 {
 }
 
@@ -45,9 +47,41 @@ void NodeStoreScheduler::scheduleTask (NodeStore::Task& task)
             this, boost::ref(task), P_1));
 }
 
+void NodeStoreScheduler::scheduleReadTask (NodeStore::Task& task)
+{
+    ++m_taskCount;
+
+    {
+        ScopedLock lock (m_readMutex);
+        m_readTasks.push_back (&task);
+    }
+
+    m_readWorkers.addTask ();
+}
+
 void NodeStoreScheduler::doTask (NodeStore::Task& task, Job&)
 {
     task.performScheduledTask ();
+    taskDone ();
+}
+
+void NodeStoreScheduler::processTask ()
+{
+    NodeStore::Task* task;
+
+    {
+        ScopedLock lock (m_readMutex);
+        bassert (! m_readTasks.empty ());
+        task = m_readTasks.front ();
+        m_readTasks.pop_front ();
+    }
+
+    task->performScheduledTask ();
+    taskDone ();
+}
+
+void NodeStoreScheduler::taskDone ()
+{
     if ((--m_taskCount == 0) && isStopping())
         stopped();
 }
@@ -21,23 +21,37 @@
 #ifndef RIPPLE_APP_NODESTORESCHEDULER_H_INCLUDED
 #define RIPPLE_APP_NODESTORESCHEDULER_H_INCLUDED
 
-/** A NodeStore::Scheduler which uses the JobQueue and implements the Stoppable API. */
+/** A NodeStore::Scheduler which uses the JobQueue and implements the Stoppable API.
+
+    Write tasks are performed as jobs on the JobQueue. Read tasks, which
+    block on the disk, get their own pool of threads so that they do not
+    tie up the threads of the JobQueue.
+*/
 class NodeStoreScheduler
     : public NodeStore::Scheduler
     , public Stoppable
+    , private Workers::Callback
 {
 public:
-    NodeStoreScheduler (Stoppable& parent, JobQueue& jobQueue);
+    NodeStoreScheduler (Stoppable& parent, JobQueue& jobQueue, int readThreads);
 
     void onStop ();
     void onChildrenStopped ();
     void scheduleTask (NodeStore::Task& task);
+    void scheduleReadTask (NodeStore::Task& task);
 
 private:
     void doTask (NodeStore::Task& task, Job&);
+    void processTask ();
+    void taskDone ();
+
+    typedef CriticalSection::ScopedLockType ScopedLock;
 
     JobQueue& m_jobQueue;
     Atomic <int> m_taskCount;
+    CriticalSection m_readMutex;
+    std::deque <NodeStore::Task*> m_readTasks;
+    Workers m_readWorkers;
 };
 
 
@@ -148,10 +148,44 @@ public:
 
     //--------------------------------------------------------------------------
 
+    // Hands each piece of a streamed reply to the session, waiting
+    // for the connection to catch up when too much is unsent. Throws
+    // once the connection is gone so the writer stops producing.
+    class SessionSink : public Json::StreamWriter::Sink
+    {
+    public:
+        enum
+        {
+            // Most bytes of a reply waiting to be sent
+            maxQueuedBytes = 256 * 1024
+        };
+
+        explicit SessionSink (HTTP::Session& session)
+            : m_session (session)
+        {
+        }
+
+        void write (char const* data, std::size_t bytes)
+        {
+            m_session.write (data, bytes);
+
+            if (! m_session.waitForWrites (maxQueuedBytes))
+                throw std::runtime_error ("connection closed during streamed reply");
+        }
+
+    private:
+        HTTP::Session& m_session;
+    };
+
     void processSession (Job& job, HTTP::Session& session)
     {
-        session.write (m_deprecatedHandler.processRequest (
-            session.content(), session.remoteAddress().withPort(0).to_string()));
+        SessionSink sink (session);
+
+        std::string const reply (m_deprecatedHandler.processRequest (
+            session.content(), session.remoteAddress().withPort(0).to_string(), sink));
+
+        if (! reply.empty ())
+            session.write (reply);
 
         session.close();
     }
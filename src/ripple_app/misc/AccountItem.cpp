@@ -18,8 +18,41 @@
 //==============================================================================
 
 
+AccountItem::StaticLockType AccountItem::sEntryLock ("AccountItem", __FILE__, __LINE__);
+
 AccountItem::AccountItem (SerializedLedgerEntry::ref ledger)
     : mLedgerEntry (ledger)
 {
 
 }
+
+AccountItem::AccountItem (SHAMapItem::ref item)
+    : mItem (item)
+{
+}
+
+AccountItem::pointer AccountItem::readItem (const uint160& accountID, SHAMapItem::ref item)
+{
+    SerializedLedgerEntry::pointer ledgerEntry (
+        boost::make_shared<SerializedLedgerEntry> (item->peekSerializer (), item->getTag ()));
+    ledgerEntry->setImmutable ();
+
+    return makeItem (accountID, ledgerEntry);
+}
+
+SerializedLedgerEntry::ref AccountItem::getEntry () const
+{
+    // Items made from an entry never change it
+    if (!mItem)
+        return mLedgerEntry;
+
+    StaticScopedLockType sl (sEntryLock, __FILE__, __LINE__);
+
+    if (!mLedgerEntry)
+    {
+        mLedgerEntry = boost::make_shared<SerializedLedgerEntry> (mItem->peekSerializer (), mItem->getTag ());
+        mLedgerEntry->setImmutable ();
+    }
+
+    return mLedgerEntry;
+}
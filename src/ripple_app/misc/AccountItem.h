@@ -48,6 +48,12 @@ public:
     */
     explicit AccountItem (SerializedLedgerEntry::ref ledger);
 
+    /** Construct from a serialized ledger entry.
+
+        The entry is only deserialized if it is asked for.
+    */
+    explicit AccountItem (SHAMapItem::ref item);
+
     virtual ~AccountItem ()
     {
         ;
@@ -55,6 +61,13 @@ public:
 
     virtual AccountItem::pointer makeItem (const uint160& accountID, SerializedLedgerEntry::ref ledgerEntry) = 0;
 
+    /** Make an item from a serialized ledger entry.
+
+        By default the entry is deserialized and passed to makeItem. Items
+        that keep only a few fields can read them through an STObjectView.
+    */
+    virtual AccountItem::pointer readItem (const uint160& accountID, SHAMapItem::ref item);
+
     // VFALCO TODO Make this const and change derived classes
     virtual LedgerEntryType getType () = 0;
 
@@ -63,17 +76,17 @@ public:
 
     SerializedLedgerEntry::pointer getSLE ()
     {
-        return mLedgerEntry;
+        return getEntry ();
     }
 
     const SerializedLedgerEntry& peekSLE () const
     {
-        return *mLedgerEntry;
+        return *getEntry ();
     }
 
     SerializedLedgerEntry& peekSLE ()
     {
-        return *mLedgerEntry;
+        return *getEntry ();
     }
 
     Blob getRaw () const;
@@ -81,8 +94,20 @@ public:
     // VFALCO TODO Make this private and use the existing accessors
     //
 protected:
+    // Deserializes the entry the first time it is needed
+    SerializedLedgerEntry::ref getEntry () const;
+
     // VFALCO TODO Research making the object pointed to const
-    SerializedLedgerEntry::pointer mLedgerEntry;
+    mutable SerializedLedgerEntry::pointer mLedgerEntry;
+
+    // The serialized entry, if the item was read through a view
+    SHAMapItem::pointer mItem;
+
+private:
+    // Items are shared by path finding jobs, the entry is made under this lock
+    typedef RippleMutex StaticLockType;
+    typedef StaticLockType::ScopedLockType StaticScopedLockType;
+    static StaticLockType sEntryLock;
 };
 
 #endif
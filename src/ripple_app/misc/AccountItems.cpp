@@ -45,10 +45,13 @@ void AccountItems::fillItems (const uint160& accountID, Ledger::ref ledger)
 
         BOOST_FOREACH (uint256 const & uNode, ownerDir->getFieldV256 (sfIndexes).peekValue ())
         {
-            // VFALCO TODO rename getSLEi() to something legible.
-            SLE::pointer sleCur = ledger->getSLEi (uNode);
+            // The entry is read in place, items deserialize only what they keep
+            SHAMapItem::pointer entry = ledger->peekAccountStateMap ()->peekItem (uNode);
 
-            AccountItem::pointer item = mOfType->makeItem (accountID, sleCur);
+            if (!entry)
+                continue;
+
+            AccountItem::pointer item = mOfType->readItem (accountID, entry);
 
             // VFALCO NOTE Under what conditions would makeItem() return nullptr?
             if (item)
@@ -34,10 +34,12 @@ public:
 public:
     // VFALCO TODO Make LedgerMaster a SharedPtr or a reference.
     //
-    NetworkOPsImp (LedgerMaster& ledgerMaster, Stoppable& parent, Journal journal)
+    NetworkOPsImp (LedgerMaster& ledgerMaster, boost::asio::io_service& io_service,
+            Stoppable& parent, Journal journal)
         : NetworkOPs (parent)
         , m_journal (journal)
         , mLock (this, "NetOPs", __FILE__, __LINE__)
+        , m_publishStrand (io_service)
         , mMode (omDISCONNECTED)
         , mNeedNetworkLedger (false)
         , mProposing (false)
@@ -76,23 +78,23 @@ public:
     }
     std::string strOperatingMode ();
 
-    Ledger::ref     getClosedLedger ()
+    Ledger::pointer getClosedLedger ()
     {
         return m_ledgerMaster.getClosedLedger ();
     }
-    Ledger::ref     getValidatedLedger ()
+    Ledger::pointer getValidatedLedger ()
     {
         return m_ledgerMaster.getValidatedLedger ();
     }
-    Ledger::ref     getPublishedLedger ()
+    Ledger::pointer getPublishedLedger ()
     {
         return m_ledgerMaster.getPublishedLedger ();
     }
-    Ledger::ref     getCurrentLedger ()
+    Ledger::pointer getCurrentLedger ()
     {
         return m_ledgerMaster.getCurrentLedger ();
     }
-    Ledger::ref     getCurrentSnapshot ()
+    Ledger::pointer getCurrentSnapshot ()
     {
         return m_ledgerMaster.getCurrentSnapshot ();
     }
@@ -399,10 +401,21 @@ private:
     Json::Value pubBootstrapAccountInfo (Ledger::ref lpAccepted, const RippleAddress& naAccountID);
 
     void pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTransaction);
-    void pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTransaction, bool isAccepted);
+    void pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTransaction, bool isAccepted,
+                                InfoSub::Message::pointer message);
 
     void pubServer ();
 
+    typedef std::vector <InfoSub::pointer> SubscriberList;
+
+    // Appends the live subscribers in the map, erasing the dead ones.
+    // Call with mLock held.
+    static void collectSubscribers (SubMapType& subMap, SubscriberList& subscribers);
+
+    // Hands a message to its subscribers on the publisher strand
+    void publish (InfoSub::Message::pointer const& message, SubscriberList& subscribers);
+    static void deliver (InfoSub::Message::pointer const& message, boost::shared_ptr <SubscriberList> const& subscribers);
+
 private:
     typedef boost::unordered_map <uint160, SubMapType>               SubInfoMapType;
     typedef boost::unordered_map <uint160, SubMapType>::iterator     SubInfoMapIterator;
@@ -416,6 +429,9 @@ private:
     Journal m_journal;
     LockType mLock;
 
+    // Publishes events in order, without holding mLock
+    boost::asio::io_service::strand     m_publishStrand;
+
     OperatingMode                       mMode;
     bool                                mNeedNetworkLedger;
     bool                                mProposing, mValidating;
@@ -452,7 +468,7 @@ private:
     SubMapType                                          mSubTransactions;       // all accepted transactions
     SubMapType                                          mSubRTTransactions;     // all proposed and accepted transactions
 
-    TaggedCacheType< uint256, Blob , UptimeTimerAdapter >   mFetchPack;
+    ShardedTaggedCacheType< uint256, Blob , UptimeTimerAdapter > mFetchPack;
     uint32                                              mFetchSeq;
 
     uint32                                              mLastLoadBase;
@@ -658,7 +674,7 @@ Ledger::pointer NetworkOPsImp::getLedgerBySeq (const uint32 seq)
 
 uint32 NetworkOPsImp::getCurrentLedgerID ()
 {
-    return m_ledgerMaster.getCurrentLedger ()->getLedgerSeq ();
+    return m_ledgerMaster.getCurrentLedgerIndex ();
 }
 
 bool NetworkOPsImp::haveLedgerRange (uint32 from, uint32 to)
@@ -1598,43 +1614,59 @@ void NetworkOPsImp::consensusViewChange ()
 
 void NetworkOPsImp::pubServer ()
 {
-    // VFALCO TODO Don't hold the lock across calls to send...make a copy of the
-    //             list into a local array while holding the lock then release the
-    //             lock and call send on everyone.
-    //
-    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    Json::Value jvObj (Json::objectValue);
+    SubscriberList subscribers;
 
-    if (!mSubServer.empty ())
     {
-        Json::Value jvObj (Json::objectValue);
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+        if (mSubServer.empty ())
+            return;
 
         jvObj ["type"]          = "serverStatus";
         jvObj ["server_status"] = strOperatingMode ();
         jvObj ["load_base"]     = (mLastLoadBase = getApp().getFeeTrack ().getLoadBase ());
         jvObj ["load_factor"]   = (mLastLoadFactor = getApp().getFeeTrack ().getLoadFactor ());
 
-        Json::FastWriter w;
-        std::string sObj = w.write (jvObj);
+        collectSubscribers (mSubServer, subscribers);
+    }
 
-        NetworkOPsImp::SubMapType::const_iterator it = mSubServer.begin ();
+    if (!subscribers.empty ())
+        publish (boost::make_shared <InfoSub::Message> (MOVE_P (jvObj)), subscribers);
+}
 
-        while (it != mSubServer.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+void NetworkOPsImp::collectSubscribers (SubMapType& subMap, SubscriberList& subscribers)
+{
+    SubMapType::const_iterator it = subMap.begin ();
 
-            // VFALCO TODO research the possibility of using thread queues and linearizing
-            //             the deletion of subscribers with the sending of JSON data.
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
+    while (it != subMap.end ())
+    {
+        InfoSub::pointer p = it->second.lock ();
 
-                ++it;
-            }
-            else
-            {
-                it = mSubServer.erase (it);
-            }
+        if (p)
+        {
+            subscribers.push_back (p);
+            ++it;
         }
+        else
+            it = subMap.erase (it);
+    }
+}
+
+void NetworkOPsImp::publish (InfoSub::Message::pointer const& message, SubscriberList& subscribers)
+{
+    boost::shared_ptr <SubscriberList> list = boost::make_shared <SubscriberList> ();
+
+    list->swap (subscribers);
+
+    m_publishStrand.post (BIND_TYPE (&NetworkOPsImp::deliver, message, list));
+}
+
+void NetworkOPsImp::deliver (InfoSub::Message::pointer const& message, boost::shared_ptr <SubscriberList> const& subscribers)
+{
+    BOOST_FOREACH (InfoSub::ref sub, *subscribers)
+    {
+        sub->send (message, true);
     }
 }
 
@@ -2282,28 +2314,28 @@ Json::Value NetworkOPsImp::pubBootstrapAccountInfo (Ledger::ref lpAccepted, cons
 
 void NetworkOPsImp::pubProposedTransaction (Ledger::ref lpCurrent, SerializedTransaction::ref stTxn, TER terResult)
 {
-    Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
+    SubscriberList subscribers;
+    InfoSub::Message::pointer message;
 
     {
         ScopedLockType sl (mLock, __FILE__, __LINE__);
-        NetworkOPsImp::SubMapType::const_iterator it = mSubRTTransactions.begin ();
+        collectSubscribers (mSubRTTransactions, subscribers);
+    }
 
-        while (it != mSubRTTransactions.end ())
+    if (!subscribers.empty ())
+    {
         {
-            InfoSub::pointer p = it->second.lock ();
-
-            if (p)
-            {
-                p->send (jvObj, true);
-                ++it;
-            }
-            else
-                it = mSubRTTransactions.erase (it);
+            // The event is built once and dropped as a whole
+            Json::ValueArena::Scope scope;
+            message = boost::make_shared <InfoSub::Message> (transJson (*stTxn, terResult, false, lpCurrent));
         }
+
+        publish (message, subscribers);
     }
+
     AcceptedLedgerTx alt (stTxn, terResult);
     m_journal.trace << "pubProposed: " << alt.getJson ();
-    pubAccountTransaction (lpCurrent, AcceptedLedgerTx (stTxn, terResult), false);
+    pubAccountTransaction (lpCurrent, alt, false, message);
 }
 
 void NetworkOPsImp::pubLedger (Ledger::ref accepted)
@@ -2314,12 +2346,14 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
     AcceptedLedger::pointer alpAccepted = AcceptedLedger::makeAcceptedLedger (accepted);
     Ledger::ref lpAccepted = alpAccepted->getLedger ();
 
+    Json::Value jvObj (Json::objectValue);
+    SubscriberList subscribers;
+
     {
         ScopedLockType sl (mLock, __FILE__, __LINE__);
 
         if (!mSubLedger.empty ())
         {
-            Json::Value jvObj (Json::objectValue);
 
             jvObj["type"]           = "ledgerClosed";
             jvObj["ledger_index"]   = lpAccepted->getLedgerSeq ();
@@ -2336,23 +2370,13 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
             if (mMode >= omSYNCING)
                 jvObj["validated_ledgers"]  = getApp().getLedgerMaster ().getCompleteLedgers ();
 
-            NetworkOPsImp::SubMapType::const_iterator it = mSubLedger.begin ();
-
-            while (it != mSubLedger.end ())
-            {
-                InfoSub::pointer p = it->second.lock ();
-
-                if (p)
-                {
-                    p->send (jvObj, true);
-                    ++it;
-                }
-                else
-                    it = mSubLedger.erase (it);
-            }
+            collectSubscribers (mSubLedger, subscribers);
         }
     }
 
+    if (!subscribers.empty ())
+        publish (boost::make_shared <InfoSub::Message> (MOVE_P (jvObj)), subscribers);
+
     // Don't lock since pubAcceptedTransaction is locking.
     if (!mSubTransactions.empty () || !mSubRTTransactions.empty () || !mSubAccount.empty () || !mSubRTAccount.empty ())
     {
@@ -2384,7 +2408,10 @@ Json::Value NetworkOPsImp::transJson (const SerializedTransaction& stTxn, TER te
     transResultInfo (terResult, sToken, sHuman);
 
     jvObj["type"]           = "transaction";
-    jvObj["transaction"]    = stTxn.getJson (0);
+
+    // Swap the large members in rather than copying them
+    Json::Value jvTxn (stTxn.getJson (0));
+    jvObj["transaction"].swap (jvTxn);
 
     if (bValidated)
     {
@@ -2412,50 +2439,44 @@ Json::Value NetworkOPsImp::transJson (const SerializedTransaction& stTxn, TER te
 
 void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTx)
 {
-    Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
-    jvObj["meta"] = alTx.getMeta ()->getJson (0);
-
-    Json::FastWriter w;
-    std::string sObj = w.write (jvObj);
+    InfoSub::Message::pointer message;
 
     {
-        ScopedLockType sl (mLock, __FILE__, __LINE__);
+        // The event is built once and dropped as a whole
+        Json::ValueArena::Scope scope;
 
-        NetworkOPsImp::SubMapType::const_iterator it = mSubTransactions.begin ();
+        Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
+        Json::Value jvMeta (alTx.getMeta ()->getJson (0));
+        jvObj["meta"].swap (jvMeta);
 
-        while (it != mSubTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+        // One serialization serves every stream this transaction goes to
+        message = boost::make_shared <InfoSub::Message> (MOVE_P (jvObj));
+    }
 
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
-                ++it;
-            }
-            else
-                it = mSubTransactions.erase (it);
-        }
+    SubscriberList subscribers;
 
-        it = mSubRTTransactions.begin ();
+    {
+        ScopedLockType sl (mLock, __FILE__, __LINE__);
 
-        while (it != mSubRTTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+        collectSubscribers (mSubTransactions, subscribers);
+        collectSubscribers (mSubRTTransactions, subscribers);
+    }
 
-            if (p)
-            {
-                p->send (jvObj, sObj, true);
-                ++it;
-            }
-            else
-                it = mSubRTTransactions.erase (it);
-        }
+    {
+        boost::unordered_set <InfoSub::pointer> bookListeners;
+
+        getApp().getOrderBookDB ().processTxn (alAccepted, alTx, bookListeners);
+        subscribers.insert (subscribers.end (), bookListeners.begin (), bookListeners.end ());
     }
-    getApp().getOrderBookDB ().processTxn (alAccepted, alTx, jvObj);
-    pubAccountTransaction (alAccepted, alTx, true);
+
+    if (!subscribers.empty ())
+        publish (message, subscribers);
+
+    pubAccountTransaction (alAccepted, alTx, true, message);
 }
 
-void NetworkOPsImp::pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTx, bool bAccepted)
+void NetworkOPsImp::pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTx, bool bAccepted,
+                                           InfoSub::Message::pointer message)
 {
     boost::unordered_set<InfoSub::pointer>  notify;
     int                             iProposed   = 0;
@@ -2521,18 +2542,23 @@ void NetworkOPsImp::pubAccountTransaction (Ledger::ref lpCurrent, const Accepted
 
     if (!notify.empty ())
     {
-        Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), bAccepted, lpCurrent);
+        if (!message)
+        {
+            Json::ValueArena::Scope scope;
 
-        if (alTx.isApplied ())
-            jvObj["meta"] = alTx.getMeta ()->getJson (0);
+            Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), bAccepted, lpCurrent);
 
-        Json::FastWriter w;
-        std::string sObj = w.write (jvObj);
+            if (alTx.isApplied ())
+            {
+                Json::Value jvMeta (alTx.getMeta ()->getJson (0));
+                jvObj["meta"].swap (jvMeta);
+            }
 
-        BOOST_FOREACH (InfoSub::ref isrListener, notify)
-        {
-            isrListener->send (jvObj, sObj, true);
+            message = boost::make_shared <InfoSub::Message> (MOVE_P (jvObj));
         }
+
+        SubscriberList subscribers (notify.begin (), notify.end ());
+        publish (message, subscribers);
     }
 }
 
@@ -3047,12 +3073,9 @@ bool NetworkOPsImp::getFetchPack (uint256 const& hash, Blob& data)
 
     mFetchPack.del (hash, false);
 
-    if (hash != Serializer::getSHA512Half (data))
-    {
-        m_journal.warning << "Bad entry in fetch pack";
-        return false;
-    }
-
+    // Entries are verified before they are added, in batches when a fetch
+    // pack arrives, so only debug builds check them again here
+    assert (hash == Serializer::getSHA512Half (data));
     return true;
 }
 
@@ -3099,9 +3122,9 @@ NetworkOPs::NetworkOPs (Stoppable& parent)
 //------------------------------------------------------------------------------
 
 NetworkOPs* NetworkOPs::New (LedgerMaster& ledgerMaster,
-    Stoppable& parent, Journal journal)
+    boost::asio::io_service& io_service, Stoppable& parent, Journal journal)
 {
     ScopedPointer <NetworkOPs> object (new NetworkOPsImp (
-        ledgerMaster, parent, journal));
+        ledgerMaster, io_service, parent, journal));
     return object.release ();
 }
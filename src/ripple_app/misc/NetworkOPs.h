@@ -82,7 +82,7 @@ public:
     // VFALCO TODO Make LedgerMaster a SharedPtr or a reference.
     //
     static NetworkOPs* New (LedgerMaster& ledgerMaster,
-        Stoppable& parent, Journal journal);
+        boost::asio::io_service& io_service, Stoppable& parent, Journal journal);
 
     virtual ~NetworkOPs () { }
 
@@ -104,11 +104,11 @@ public:
 
     virtual OperatingMode getOperatingMode () = 0;
     virtual std::string strOperatingMode () = 0;
-    virtual Ledger::ref     getClosedLedger () = 0;
-    virtual Ledger::ref     getValidatedLedger () = 0;
-    virtual Ledger::ref     getPublishedLedger () = 0;
-    virtual Ledger::ref     getCurrentLedger () = 0;
-    virtual Ledger::ref     getCurrentSnapshot () = 0;
+    virtual Ledger::pointer getClosedLedger () = 0;
+    virtual Ledger::pointer getValidatedLedger () = 0;
+    virtual Ledger::pointer getPublishedLedger () = 0;
+    virtual Ledger::pointer getCurrentLedger () = 0;
+    virtual Ledger::pointer getCurrentSnapshot () = 0;
     virtual Ledger::pointer getLedgerByHash (uint256 const& hash) = 0;
     virtual Ledger::pointer getLedgerBySeq (const uint32 seq) = 0;
     virtual void            missingNodeInLedger (const uint32 seq) = 0;
@@ -227,6 +227,8 @@ public:
 
     virtual bool shouldFetchPack (uint32 seq) = 0;
     virtual void gotFetchPack (bool progress, uint32 seq) = 0;
+    // The data must already be known to hash to hash
+    // The caller must have checked that hash is the SHA512Half of data
     virtual void addFetchPack (uint256 const& hash, boost::shared_ptr< Blob >& data) = 0;
     virtual bool getFetchPack (uint256 const& hash, Blob& data) = 0;
     virtual int getFetchSize () = 0;
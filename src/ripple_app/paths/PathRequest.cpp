@@ -118,7 +118,7 @@ Json::Value PathRequest::doCreate (Ledger::ref lrLedger, const Json::Value& valu
 
             if (mValid)
             {
-                RippleLineCache::pointer cache = boost::make_shared<RippleLineCache> (lrLedger);
+                RippleLineCache::pointer cache = getApp().getLedgerMaster ().getLineCache (lrLedger);
                 doUpdate (cache, true);
             }
         }
@@ -244,6 +244,11 @@ Json::Value PathRequest::doStatus (const Json::Value&)
 }
 
 bool PathRequest::doUpdate (RippleLineCache::ref cache, bool fast)
+{
+    return doUpdate (cache, fast, nullptr);
+}
+
+bool PathRequest::doUpdate (RippleLineCache::ref cache, bool fast, PathfinderMap* pathfinders)
 {
     ScopedLockType sl (mLock, __FILE__, __LINE__);
     jvStatus = Json::objectValue;
@@ -325,13 +330,30 @@ bool PathRequest::doUpdate (RippleLineCache::ref cache, bool fast)
             STAmount test (currIssuer.first, currIssuer.second, 1);
             WriteLog (lsDEBUG, PathRequest) << "Trying to find paths: " << test.getFullText ();
         }
-        bool valid;
+        bool valid = true;
         STPathSet& spsPaths = mContext[currIssuer];
-        Pathfinder pf (cache, raSrcAccount, raDstAccount,
-                       currIssuer.first, currIssuer.second, saDstAmount, valid);
+        boost::shared_ptr<Pathfinder> pf;
+
+        if (pathfinders != nullptr)
+        {
+            PathfinderMap::iterator it = pathfinders->find (std::make_pair (iLevel, currIssuer));
+
+            if (it != pathfinders->end ())
+                pf = it->second;
+        }
+
+        if (!pf)
+        {
+            pf.reset (new Pathfinder (cache, raSrcAccount, raDstAccount,
+                                      currIssuer.first, currIssuer.second, saDstAmount, valid));
+
+            if (valid && (pathfinders != nullptr))
+                (*pathfinders)[std::make_pair (iLevel, currIssuer)] = pf;
+        }
+
         CondLog (!valid, lsINFO, PathRequest) << "PF request not valid";
 
-        if (valid && pf.findPaths (iLevel, 4, spsPaths))
+        if (valid && pf->findPaths (iLevel, 4, spsPaths, saDstAmount))
         {
             LedgerEntrySet                      lesSandbox (cache->getLedger (), tapNONE);
             std::vector<PathState::pointer>     vpsExpanded;
@@ -372,6 +394,130 @@ bool PathRequest::doUpdate (RippleLineCache::ref cache, bool fast)
     return true;
 }
 
+//------------------------------------------------------------------------------
+
+// The requests of one update pass, grouped so that requests which can share
+// their Pathfinders are updated by the same thread.
+//
+class PathRequest::UpdateWork
+{
+public:
+    struct Entry
+    {
+        PathRequest::pointer request;
+        InfoSub::pointer subscriber;
+    };
+
+    typedef std::vector <Entry> Group;
+
+    UpdateWork (RippleLineCache::ref cache, CancelCallback shouldCancel)
+        : m_cache (cache)
+        , m_shouldCancel (shouldCancel)
+        , m_next (0)
+        , m_remaining (0)
+    {
+    }
+
+    void add (PathRequest::ref request, InfoSub::ref subscriber)
+    {
+        GroupKey key;
+        {
+            ScopedLockType sl (request->mLock, __FILE__, __LINE__);
+            key.first = std::make_pair (request->raSrcAccount.getAccountID (),
+                                        request->raDstAccount.getAccountID ());
+            key.second = std::make_pair (request->saDstAmount.getCurrency (),
+                                         request->saDstAmount.getIssuer ());
+        }
+
+        std::map <GroupKey, int>::iterator it = m_index.find (key);
+
+        if (it == m_index.end ())
+        {
+            it = m_index.insert (std::make_pair (key, static_cast <int> (m_groups.size ()))).first;
+            m_groups.push_back (Group ());
+            ++m_remaining;
+        }
+
+        Entry entry;
+        entry.request = request;
+        entry.subscriber = subscriber;
+        m_groups [it->second].push_back (entry);
+    }
+
+    int getGroupCount () const
+    {
+        return m_groups.size ();
+    }
+
+    // Update groups until none are left to take
+    void run ()
+    {
+        for (;;)
+        {
+            int const index = (++m_next) - 1;
+
+            if (index >= getGroupCount ())
+                return;
+
+            // A canceled pass still counts its groups down
+            if (!m_shouldCancel ())
+                update (m_groups [index]);
+
+            if (--m_remaining == 0)
+                m_done.signal ();
+        }
+    }
+
+    // Wait for groups taken by other threads to finish
+    void wait ()
+    {
+        if (getGroupCount () != 0)
+            m_done.wait ();
+    }
+
+private:
+    void update (Group& group)
+    {
+        PathfinderMap pathfinders;
+
+        BOOST_FOREACH (Entry& entry, group)
+        {
+            Json::Value update;
+
+            try
+            {
+                ScopedLockType sl (entry.request->mLock, __FILE__, __LINE__);
+                entry.request->doUpdate (m_cache, false, &pathfinders);
+                update = entry.request->jvStatus;
+            }
+            catch (std::exception const& e)
+            {
+                WriteLog (lsWARNING, PathRequest) << "Path request update failed: " << e.what ();
+                continue;
+            }
+
+            update["type"] = "path_find";
+            entry.subscriber->send (update, false);
+        }
+    }
+
+    // Source and destination accounts, destination currency and issuer
+    typedef std::pair <std::pair <uint160, uint160>, currIssuer_t> GroupKey;
+
+    RippleLineCache::pointer m_cache;
+    CancelCallback m_shouldCancel;
+    std::vector <Group> m_groups;
+    std::map <GroupKey, int> m_index;
+    Atomic <int> m_next;
+    Atomic <int> m_remaining;
+    WaitableEvent m_done;
+};
+
+void PathRequest::updateJob (boost::shared_ptr<UpdateWork> work, Job&)
+{
+    work->run ();
+}
+
 void PathRequest::updateAll (Ledger::ref ledger, bool newOnly, CancelCallback shouldCancel)
 {
     std::set<wptr> requests;
@@ -386,7 +532,8 @@ void PathRequest::updateAll (Ledger::ref ledger, bool newOnly, CancelCallback sh
     if (requests.empty ())
         return;
 
-    RippleLineCache::pointer cache = boost::make_shared<RippleLineCache> (ledger);
+    RippleLineCache::pointer cache = getApp().getLedgerMaster ().getLineCache (ledger);
+    boost::shared_ptr<UpdateWork> work (boost::make_shared<UpdateWork> (cache, shouldCancel));
 
     BOOST_FOREACH (wref wRequest, requests)
     {
@@ -406,14 +553,7 @@ void PathRequest::updateAll (Ledger::ref ledger, bool newOnly, CancelCallback sh
 
                 if (ipSub)
                 {
-                    Json::Value update;
-                    {
-                        ScopedLockType sl (pRequest->mLock, __FILE__, __LINE__);
-                        pRequest->doUpdate (cache, false);
-                        update = pRequest->jvStatus;
-                    }
-                    update["type"] = "path_find";
-                    ipSub->send (update, false);
+                    work->add (pRequest, ipSub);
                     remove = false;
                 }
             }
@@ -425,6 +565,184 @@ void PathRequest::updateAll (Ledger::ref ledger, bool newOnly, CancelCallback sh
             sRequests.erase (wRequest);
         }
     }
+
+    // This thread takes groups too, the jobs only help
+    int const jobs = std::min <int> (maxUpdateJobs, work->getGroupCount () - 1);
+
+    for (int i = 0; i < jobs; ++i)
+    {
+        getApp().getJobQueue ().addJob (jtUPDATE_PF, "PathRequest::updateJob",
+            BIND_TYPE (&PathRequest::updateJob, work, P_1));
+    }
+
+    work->run ();
+    work->wait ();
 }
 
+//------------------------------------------------------------------------------
+
+class PathRequestTests : public UnitTest
+{
+public:
+    PathRequestTests () : UnitTest ("PathRequest", "ripple")
+    {
+    }
+
+    struct Account
+    {
+        RippleAddress publicKey;
+        RippleAddress privateKey;
+        uint32 sequence;
+    };
+
+    static Account makeAccount (std::string const& passPhrase)
+    {
+        RippleAddress seed = RippleAddress::createSeedGeneric (passPhrase);
+        RippleAddress generator = RippleAddress::createGeneratorPublic (seed);
+
+        Account account;
+        account.publicKey = RippleAddress::createAccountPublic (generator, 0);
+        account.privateKey = RippleAddress::createAccountPrivate (generator, seed, 0);
+        account.sequence = 1;
+        return account;
+    }
+
+    static STAmount makeUSD (Account const& issuer, int value)
+    {
+        uint160 currencyID;
+        STAmount::currencyFromString (currencyID, "USD");
+        return STAmount (currencyID, issuer.publicKey.getAccountID (), value);
+    }
+
+    static SerializedTransaction::pointer makeTransaction (TxType type, Account& from)
+    {
+        SerializedTransaction::pointer txn (boost::make_shared <SerializedTransaction> (type));
+
+        txn->setSigningPubKey (from.publicKey);
+        txn->setSourceAccount (from.publicKey);
+        txn->setSequence (from.sequence++);
+        txn->setTransactionFee (STAmount (10));
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makePayment (Account& from, Account const& to, STAmount const& amount)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttPAYMENT, from));
+
+        txn->setFieldAccount (sfDestination, to.publicKey);
+        txn->setFieldAmount (sfAmount, amount);
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makeTrust (Account& from, Account const& issuer, int limit)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttTRUST_SET, from));
+
+        txn->setFieldAmount (sfLimitAmount, makeUSD (issuer, limit));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    // Applies the transactions to a new ledger after the previous one and closes it
+    Ledger::pointer closeLedger (Ledger::ref previous, std::vector <SerializedTransaction::pointer> const& txns)
+    {
+        Ledger::pointer ledger (boost::make_shared <Ledger> (false, boost::ref (*previous)));
+
+        {
+            TransactionEngine engine (ledger);
+
+            BOOST_FOREACH (SerializedTransaction::ref txn, txns)
+            {
+                bool didApply;
+                engine.applyTransaction (*txn, tapNONE, didApply);
+                expect (didApply, "transaction not applied");
+            }
+        }
+
+        ledger->setClosed ();
+        ledger->setAccepted (previous->getCloseTimeNC () + 10, 10, false);
+        return ledger;
+    }
+
+    // A request that last searched at the given level
+    static PathRequest::pointer makeRequest (Account const& from, Account const& to, int value,
+                                             int lastLevel, bool lastSuccess)
+    {
+        PathRequest::pointer request (boost::make_shared <PathRequest> (InfoSub::pointer ()));
+
+        request->raSrcAccount = from.publicKey;
+        request->raDstAccount = to.publicKey;
+        request->saDstAmount = makeUSD (to, value);
+        request->iLastLevel = lastLevel;
+        request->bLastSuccess = lastSuccess;
+        return request;
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("grouped update");
+
+        Account master (makeAccount ("masterpassphrase"));
+        Account alice (makeAccount ("alice"));
+        Account bob (makeAccount ("bob"));
+        Account carol (makeAccount ("carol"));
+
+        Ledger::pointer genesis (boost::make_shared <Ledger> (master.publicKey, SYSTEM_CURRENCY_START));
+        genesis->setClosed ();
+        genesis->setAccepted (10, 10, false);
+
+        std::vector <SerializedTransaction::pointer> txns;
+        txns.push_back (makePayment (master, alice, STAmount (10000 * SYSTEM_CURRENCY_PARTS)));
+        txns.push_back (makePayment (master, bob, STAmount (10000 * SYSTEM_CURRENCY_PARTS)));
+        txns.push_back (makePayment (master, carol, STAmount (10000 * SYSTEM_CURRENCY_PARTS)));
+        Ledger::pointer funded (closeLedger (genesis, txns));
+
+        // Bob holds alice's USD, which carol accepts
+        txns.clear ();
+        txns.push_back (makeTrust (bob, alice, 100));
+        txns.push_back (makeTrust (carol, alice, 100));
+        Ledger::pointer trusted (closeLedger (funded, txns));
+
+        txns.clear ();
+        txns.push_back (makePayment (alice, bob, makeUSD (alice, 50)));
+        Ledger::pointer ledger (closeLedger (trusted, txns));
+
+        RippleLineCache::pointer cache (boost::make_shared <RippleLineCache> (ledger));
+
+        // One group, searched at the highest level first and then lower
+        int const high = getConfig ().PATH_SEARCH_MAX;
+        int const low = getConfig ().PATH_SEARCH_FAST + 1;
+
+        std::vector <PathRequest::pointer> grouped;
+        grouped.push_back (makeRequest (bob, carol, 10, high, false));
+        grouped.push_back (makeRequest (bob, carol, 20, low, true));
+        grouped.push_back (makeRequest (bob, carol, 30, high, false));
+
+        std::vector <PathRequest::pointer> alone;
+        alone.push_back (makeRequest (bob, carol, 10, high, false));
+        alone.push_back (makeRequest (bob, carol, 20, low, true));
+        alone.push_back (makeRequest (bob, carol, 30, high, false));
+
+        PathRequest::PathfinderMap pathfinders;
+        bool same = true;
+        bool found = true;
+
+        for (std::size_t i = 0; i < grouped.size (); ++i)
+        {
+            grouped[i]->doUpdate (cache, false, &pathfinders);
+            alone[i]->doUpdate (cache, false, nullptr);
+
+            same = same && (grouped[i]->jvStatus["alternatives"] == alone[i]->jvStatus["alternatives"]);
+            found = found && (grouped[i]->jvStatus["alternatives"].size () != 0);
+        }
+
+        expect (found, "no alternatives found");
+        expect (same, "grouped results differ from lone ones");
+        expect (grouped[0]->iLastLevel != grouped[1]->iLastLevel, "requests searched at one level");
+    }
+};
+
+static PathRequestTests pathRequestTests;
+
 // vim:ts=4
@@ -25,6 +25,7 @@
 // The request issuer must maintain a strong pointer
 
 class RippleLineCache;
+class Pathfinder;
 
 // Return values from parseJson <0 = invalid, >0 = valid
 #define PFR_PJ_INVALID              -1
@@ -58,12 +59,32 @@ public:
 
     bool        doUpdate (const boost::shared_ptr<RippleLineCache>&, bool fast); // update jvStatus
 
+    // Requests with the same accounts and destination currency are updated
+    // together, sharing their Pathfinders, and groups are spread over jobs.
     static void updateAll (const boost::shared_ptr<Ledger>& ledger, bool newOnly, CancelCallback shouldCancel);
 
 private:
+    friend class PathRequestTests;
+
+    class UpdateWork;
+
+    // The Pathfinders of one group, by search level and source currency and
+    // issuer. A Pathfinder keeps every path it found, so one that searched
+    // at a higher level would hand its paths to a lower level search.
+    typedef std::map<std::pair<int, currIssuer_t>, boost::shared_ptr<Pathfinder> > PathfinderMap;
+
+    enum
+    {
+        maxUpdateJobs = 4
+    };
+
     void setValid ();
     int parseJson (const Json::Value&, bool complete);
 
+    bool doUpdate (const boost::shared_ptr<RippleLineCache>&, bool fast, PathfinderMap* pathfinders);
+
+    static void updateJob (boost::shared_ptr<UpdateWork> work, Job&);
+
     typedef RippleRecursiveMutex LockType;
     typedef LockType::ScopedLockType ScopedLockType;
     LockType mLock;
@@ -127,13 +127,18 @@ Pathfinder::Pathfinder (RippleLineCache::ref cache,
 }
 
 bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet& pathsOut)
+{
+    return findPaths (iLevel, iMaxPaths, pathsOut, mDstAmount);
+}
+
+bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet& pathsOut, const STAmount& dstAmount)
 { // pathsOut contains only non-default paths without source or destiation
 // On input, pathsOut contains any paths you want to ensure are included if still good
 
-    WriteLog (lsTRACE, Pathfinder) << boost::str (boost::format ("findPaths> mSrcAccountID=%s mDstAccountID=%s mDstAmount=%s mSrcCurrencyID=%s mSrcIssuerID=%s")
+    WriteLog (lsTRACE, Pathfinder) << boost::str (boost::format ("findPaths> mSrcAccountID=%s mDstAccountID=%s dstAmount=%s mSrcCurrencyID=%s mSrcIssuerID=%s")
                                    % RippleAddress::createHumanAccountID (mSrcAccountID)
                                    % RippleAddress::createHumanAccountID (mDstAccountID)
-                                   % mDstAmount.getFullText ()
+                                   % dstAmount.getFullText ()
                                    % STAmount::createHumanCurrency (mSrcCurrencyID)
                                    % RippleAddress::createHumanAccountID (mSrcIssuerID)
                                                  );
@@ -145,6 +150,12 @@ bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet&
         return false;
     }
 
+    // The amount is checked here as well, it need not be the one we were made with
+    assert (dstAmount.getCurrency () == mDstAmount.getCurrency ());
+
+    if (dstAmount.isZero ())
+        return false;
+
     bool bSrcXrp       = mSrcCurrencyID.isZero();
     bool bDstXrp       = mDstAmount.getCurrency().isZero();
 
@@ -153,7 +164,7 @@ bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet&
         return false;
 
     SLE::pointer sleDest = mLedger->getSLEi(Ledger::getAccountRootIndex(mDstAccountID));
-    if (!sleDest && (!bDstXrp || (mDstAmount < mLedger->getReserve(0))))
+    if (!sleDest && (!bDstXrp || (dstAmount < mLedger->getReserve(0))))
         return false;
 
     PaymentType paymentType;
@@ -203,10 +214,13 @@ bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet&
 
     WriteLog (lsDEBUG, Pathfinder) << mCompletePaths.size() << " complete paths found";
 
+    // The complete paths are kept as they are for the next amount
+    STPathSet candidates (mCompletePaths);
+
     BOOST_FOREACH(const STPath& path, pathsOut)
     { // make sure no paths were lost
         bool found = false;
-        BOOST_FOREACH(const STPath& ePath, mCompletePaths)
+        BOOST_FOREACH(const STPath& ePath, candidates)
         {
             if (ePath == path)
             {
@@ -215,25 +229,25 @@ bool Pathfinder::findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet&
             }
         }
         if (!found)
-            mCompletePaths.addPath(path);
+            candidates.addPath(path);
     }
 
-    WriteLog (lsDEBUG, Pathfinder) << mCompletePaths.size() << " paths to filter";
+    WriteLog (lsDEBUG, Pathfinder) << candidates.size() << " paths to filter";
 
-    if (mCompletePaths.size() > iMaxPaths)
-        pathsOut = filterPaths(iMaxPaths);
+    if (candidates.size() > iMaxPaths)
+        pathsOut = filterPaths(candidates, dstAmount, iMaxPaths);
     else
-        pathsOut = mCompletePaths;
+        pathsOut = candidates;
 
     return true; // Even if we find no paths, default paths may work, and we don't check them currently
 }
 
-STPathSet Pathfinder::filterPaths(int iMaxPaths)
+STPathSet Pathfinder::filterPaths(const STPathSet& paths, const STAmount& dstAmount, int iMaxPaths)
 {
-    if (mCompletePaths.size() <= iMaxPaths)
-        return mCompletePaths;
+    if (paths.size() <= iMaxPaths)
+        return paths;
 
-    STAmount remaining = mDstAmount;
+    STAmount remaining = dstAmount;
 
     // must subtract liquidity in default path from remaining amount
     try
@@ -248,7 +262,7 @@ STPathSet Pathfinder::filterPaths(int iMaxPaths)
                  saDstAmountAct,
                  vpsExpanded,
                  mSrcAmount,
-                 mDstAmount,
+                 dstAmount,
                  mDstAccountID,
                  mSrcAccountID,
                  STPathSet (),
@@ -275,13 +289,13 @@ STPathSet Pathfinder::filterPaths(int iMaxPaths)
     std::vector<path_LQ_t> vMap;
 
     // Build map of quality to entry.
-    for (int i = mCompletePaths.size (); i--;)
+    for (int i = paths.size (); i--;)
     {
         STAmount    saMaxAmountAct;
         STAmount    saDstAmountAct;
         std::vector<PathState::pointer> vpsExpanded;
         STPathSet   spsPaths;
-        STPath&     spCurrent   = mCompletePaths[i];
+        const STPath& spCurrent = paths[i];
 
         spsPaths.addPath (spCurrent);               // Just checking the current path.
 
@@ -297,7 +311,7 @@ STPathSet Pathfinder::filterPaths(int iMaxPaths)
                               saDstAmountAct,
                               vpsExpanded,
                               mSrcAmount,         // --> amount to send max.
-                              mDstAmount,         // --> amount to deliver.
+                              dstAmount,         // --> amount to deliver.
                               mDstAccountID,
                               mSrcAccountID,
                               spsPaths,
@@ -349,15 +363,15 @@ STPathSet Pathfinder::filterPaths(int iMaxPaths)
                 // last path must fill
                 --iPathsLeft;
                 remaining -= lqt.get<2> ();
-                spsDst.addPath (mCompletePaths[lqt.get<3> ()]);
+                spsDst.addPath (paths[lqt.get<3> ()]);
             }
             else
-                WriteLog (lsDEBUG, Pathfinder) << "Skipping a non-filling path: " << mCompletePaths[lqt.get<3> ()].getJson (0);
+                WriteLog (lsDEBUG, Pathfinder) << "Skipping a non-filling path: " << paths[lqt.get<3> ()].getJson (0);
         }
 
         if (remaining.isPositive ())
         {
-            WriteLog (lsINFO, Pathfinder) << "Paths could not send " << remaining << " of " << mDstAmount;
+            WriteLog (lsINFO, Pathfinder) << "Paths could not send " << remaining << " of " << dstAmount;
         }
         else
         {
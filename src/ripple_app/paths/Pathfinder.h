@@ -64,6 +64,13 @@ public:
     static void initPathTable();
     bool findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet& spsDst);
 
+    /** Finds paths delivering another amount of the destination currency.
+
+        The paths explored are kept, so one Pathfinder can serve requests
+        that differ only in the amount delivered.
+    */
+    bool findPaths (int iLevel, const unsigned int iMaxPaths, STPathSet& spsDst, const STAmount& dstAmount);
+
 private:
 
     enum PaymentType
@@ -102,7 +109,7 @@ private:
     void addLink(const STPath& currentPath, STPathSet& incompletePaths, int addFlags);
     void addLink(const STPathSet& currentPaths, STPathSet& incompletePaths, int addFlags);
     STPathSet& getPaths(const PathType_t& type, bool addComplete = true);
-    STPathSet filterPaths(int iMaxPaths);
+    STPathSet filterPaths(const STPathSet& paths, const STAmount& dstAmount, int iMaxPaths);
 
     // Our main table of paths
 
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+SETUP_LOG (RippleLineCache)
 
 RippleLineCache::RippleLineCache (Ledger::ref l)
     : mLock (this, "RippleLineCache", __FILE__, __LINE__)
@@ -31,8 +32,299 @@ AccountItems& RippleLineCache::getRippleLines (const uint160& accountID)
     boost::unordered_map <uint160, AccountItems::pointer>::iterator it = mRLMap.find (accountID);
 
     if (it == mRLMap.end ())
+    {
         it = mRLMap.insert (std::make_pair (accountID, boost::make_shared<AccountItems>
                                             (boost::cref (accountID), boost::cref (mLedger), AccountItem::pointer (new RippleState ())))).first;
+    }
 
     return *it->second;
 }
+
+RippleLineCache::pointer RippleLineCache::getCache (Ledger::ref ledger, pointer& last)
+{
+    // The lines of an open ledger can still change
+    if (!ledger->isClosed ())
+        return boost::make_shared<RippleLineCache> (ledger);
+
+    if (last)
+    {
+        uint32 const lastSeq = last->mLedger->getLedgerSeq ();
+
+        if (last->mLedger->getHash () == ledger->getHash ())
+            return last;
+
+        // Path finding on an older ledger gets a cache of its own
+        if (ledger->getLedgerSeq () < lastSeq)
+            return boost::make_shared<RippleLineCache> (ledger);
+
+        if ((ledger->getLedgerSeq () - lastSeq) <= maxLedgerGap)
+        {
+            pointer cache = advance (*last, ledger);
+
+            if (cache)
+            {
+                last = cache;
+                return cache;
+            }
+        }
+    }
+
+    last = boost::make_shared<RippleLineCache> (ledger);
+    return last;
+}
+
+// Makes a cache for a later ledger holding the lines of previous that the
+// ledgers in between did not change.
+//
+RippleLineCache::pointer RippleLineCache::advance (RippleLineCache& previous, Ledger::ref ledger)
+{
+    boost::unordered_set <uint160> changed;
+    uint256 const& previousHash = previous.mLedger->getHash ();
+
+    try
+    {
+        Ledger::pointer current = ledger;
+
+        while (current->getHash () != previousHash)
+        {
+            if (current->getLedgerSeq () <= previous.mLedger->getLedgerSeq ())
+                return pointer ();
+
+            findChangedAccounts (current, changed);
+
+            if (current->getParentHash () == previousHash)
+                break;
+
+            current = getApp().getLedgerMaster ().getLedgerByHash (current->getParentHash ());
+
+            if (!current)
+                return pointer ();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        WriteLog (lsDEBUG, RippleLineCache) << "Unable to advance: " << e.what ();
+        return pointer ();
+    }
+
+    pointer cache = boost::make_shared<RippleLineCache> (ledger);
+    int kept = 0;
+
+    {
+        ScopedLockType sl (previous.mLock, __FILE__, __LINE__);
+
+        if (previous.mRLMap.size () > maxAccounts)
+            return cache;
+
+        typedef boost::unordered_map <uint160, AccountItems::pointer>::value_type value_type;
+        BOOST_FOREACH (value_type const& it, previous.mRLMap)
+        {
+            if (changed.find (it.first) == changed.end ())
+            {
+                cache->mRLMap.insert (it);
+                ++kept;
+            }
+        }
+    }
+
+    WriteLog (lsDEBUG, RippleLineCache) << "Ledger " << ledger->getLedgerSeq () << ": kept the lines of " <<
+        kept << " accounts, " << changed.size () << " accounts changed";
+
+    return cache;
+}
+
+// Adds the accounts at both ends of every line the ledger changed
+//
+void RippleLineCache::findChangedAccounts (Ledger::ref ledger, boost::unordered_set <uint160>& accounts)
+{
+    AcceptedLedger::pointer accepted = AcceptedLedger::makeAcceptedLedger (ledger);
+
+    BOOST_FOREACH (AcceptedLedger::value_type const& vt, accepted->getMap ())
+    {
+        BOOST_FOREACH (STObject const& node, vt.second->getMeta ()->getNodes ())
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltRIPPLE_STATE)
+                continue;
+
+            int index = node.getFieldIndex ((node.getFName () == sfCreatedNode) ? sfNewFields : sfFinalFields);
+
+            if (index == -1)
+                continue;
+
+            const STObject* inner = dynamic_cast<const STObject*> (&node.peekAtIndex (index));
+
+            if (!inner)
+                continue;
+
+            // Limits are never left out, they always carry an issuer
+            if (inner->isFieldPresent (sfLowLimit))
+                accounts.insert (inner->getFieldAmount (sfLowLimit).getIssuer ());
+
+            if (inner->isFieldPresent (sfHighLimit))
+                accounts.insert (inner->getFieldAmount (sfHighLimit).getIssuer ());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+class RippleLineCacheTests : public UnitTest
+{
+public:
+    RippleLineCacheTests () : UnitTest ("RippleLineCache", "ripple")
+    {
+    }
+
+    struct Account
+    {
+        RippleAddress publicKey;
+        RippleAddress privateKey;
+        uint32 sequence;
+    };
+
+    static Account makeAccount (std::string const& passPhrase)
+    {
+        RippleAddress seed = RippleAddress::createSeedGeneric (passPhrase);
+        RippleAddress generator = RippleAddress::createGeneratorPublic (seed);
+
+        Account account;
+        account.publicKey = RippleAddress::createAccountPublic (generator, 0);
+        account.privateKey = RippleAddress::createAccountPrivate (generator, seed, 0);
+        account.sequence = 1;
+        return account;
+    }
+
+    static SerializedTransaction::pointer makeTransaction (TxType type, Account& from)
+    {
+        SerializedTransaction::pointer txn (boost::make_shared <SerializedTransaction> (type));
+
+        txn->setSigningPubKey (from.publicKey);
+        txn->setSourceAccount (from.publicKey);
+        txn->setSequence (from.sequence++);
+        txn->setTransactionFee (STAmount (10));
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makePayment (Account& from, Account const& to, uint64 xrp)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttPAYMENT, from));
+
+        txn->setFieldAccount (sfDestination, to.publicKey);
+        txn->setFieldAmount (sfAmount, STAmount (xrp * SYSTEM_CURRENCY_PARTS));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    static SerializedTransaction::pointer makeTrust (Account& from, Account const& issuer, int limit)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttTRUST_SET, from));
+
+        uint160 currencyID;
+        STAmount::currencyFromString (currencyID, "USD");
+
+        txn->setFieldAmount (sfLimitAmount, STAmount (currencyID, issuer.publicKey.getAccountID (), limit));
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    // Applies the transactions to a new ledger after the previous one and closes it
+    Ledger::pointer closeLedger (Ledger::ref previous, std::vector <SerializedTransaction::pointer> const& txns)
+    {
+        Ledger::pointer ledger (boost::make_shared <Ledger> (false, boost::ref (*previous)));
+
+        {
+            TransactionEngine engine (ledger);
+
+            BOOST_FOREACH (SerializedTransaction::ref txn, txns)
+            {
+                bool didApply;
+                engine.applyTransaction (*txn, tapNONE, didApply);
+                expect (didApply, "transaction not applied");
+            }
+        }
+
+        ledger->setClosed ();
+        ledger->setAccepted (previous->getCloseTimeNC () + 10, 10, false);
+        return ledger;
+    }
+
+    static bool sameLines (AccountItems& lhs, AccountItems& rhs)
+    {
+        AccountItems::Container& left = lhs.getItems ();
+        AccountItems::Container& right = rhs.getItems ();
+
+        if (left.size () != right.size ())
+            return false;
+
+        for (std::size_t i = 0; i < left.size (); ++i)
+        {
+            if (left[i]->getRaw () != right[i]->getRaw ())
+                return false;
+        }
+
+        return true;
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("carried lines");
+
+        Account master (makeAccount ("masterpassphrase"));
+        std::vector <Account> accounts;
+        accounts.push_back (makeAccount ("alice"));
+        accounts.push_back (makeAccount ("bob"));
+        accounts.push_back (makeAccount ("carol"));
+        accounts.push_back (makeAccount ("dave"));
+        Account& alice = accounts[0];
+
+        Ledger::pointer genesis (boost::make_shared <Ledger> (master.publicKey, SYSTEM_CURRENCY_START));
+        genesis->setClosed ();
+        genesis->setAccepted (10, 10, false);
+
+        std::vector <SerializedTransaction::pointer> txns;
+
+        for (std::size_t i = 0; i < accounts.size (); ++i)
+            txns.push_back (makePayment (master, accounts[i], 10000));
+
+        Ledger::pointer funded (closeLedger (genesis, txns));
+
+        txns.clear ();
+        txns.push_back (makeTrust (accounts[1], alice, 100));
+        txns.push_back (makeTrust (accounts[2], alice, 100));
+        Ledger::pointer trusted (closeLedger (funded, txns));
+
+        RippleLineCache::pointer last;
+        RippleLineCache::pointer first (RippleLineCache::getCache (trusted, last));
+
+        for (std::size_t i = 0; i < accounts.size (); ++i)
+            first->getRippleLines (accounts[i].publicKey.getAccountID ());
+
+        // Carol changes her line and dave opens one, bob is left alone
+        txns.clear ();
+        txns.push_back (makeTrust (accounts[2], alice, 200));
+        txns.push_back (makeTrust (accounts[3], alice, 50));
+        Ledger::pointer changed (closeLedger (trusted, txns));
+
+        RippleLineCache::pointer carried (RippleLineCache::getCache (changed, last));
+        RippleLineCache fresh (changed);
+
+        expect ((carried != first) && (last == carried), "cache not carried");
+
+        uint160 const bobID (accounts[1].publicKey.getAccountID ());
+        expect (&carried->getRippleLines (bobID) == &first->getRippleLines (bobID), "unchanged lines not kept");
+
+        bool same = true;
+
+        for (std::size_t i = 0; i < accounts.size (); ++i)
+        {
+            uint160 const accountID (accounts[i].publicKey.getAccountID ());
+            same = same && sameLines (carried->getRippleLines (accountID), fresh.getRippleLines (accountID));
+        }
+
+        expect (same, "carried lines differ from fresh ones");
+        expect (carried->getRippleLines (alice.publicKey.getAccountID ()).getItems ().size () == 3,
+                "changed lines not read again");
+    }
+};
+
+static RippleLineCacheTests rippleLineCacheTests;
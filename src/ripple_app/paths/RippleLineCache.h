@@ -30,6 +30,19 @@ public:
 
     explicit RippleLineCache (Ledger::ref l);
 
+    /** Returns a cache of the lines in a ledger.
+
+        The cache handed out for the last closed ledger is kept in last,
+        which the caller owns and must not share between threads. The
+        caller should not hold a lock across this call, since carrying
+        the lines over reads the metadata of up to maxLedgerGap ledgers. When a
+        later closed ledger is asked for, the lines of every account its
+        transactions left untouched are carried over, so only the changed
+        accounts have to be read again. Caches of open ledgers are not
+        shared.
+    */
+    static pointer getCache (Ledger::ref ledger, pointer& last);
+
     Ledger::ref getLedger () // VFALCO TODO const?
     {
         return mLedger;
@@ -45,6 +58,16 @@ private:
     Ledger::pointer mLedger;
     
     boost::unordered_map <uint160, AccountItems::pointer> mRLMap;
+
+private:
+    enum
+    {
+        maxLedgerGap    = 16,       // Beyond this the lines are read again
+        maxAccounts     = 100000    // Beyond this the cache starts over
+    };
+
+    static void findChangedAccounts (Ledger::ref ledger, boost::unordered_set <uint160>& accounts);
+    static pointer advance (RippleLineCache& previous, Ledger::ref ledger);
 };
 
 #endif
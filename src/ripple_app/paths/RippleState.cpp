@@ -29,29 +29,56 @@ AccountItem::pointer RippleState::makeItem (const uint160& accountID, Serialized
     return AccountItem::pointer (rs);
 }
 
-RippleState::RippleState (SerializedLedgerEntry::ref ledgerEntry) : AccountItem (ledgerEntry),
-    mValid (false),
-    mViewLowest (true),
+AccountItem::pointer RippleState::readItem (const uint160& accountID, SHAMapItem::ref item)
+{
+    STObjectView view (item->peekSerializer ());
+
+    if (view.getFieldU16 (sfLedgerEntryType) != ltRIPPLE_STATE)
+        return AccountItem::pointer ();
 
-    mLowLimit (ledgerEntry->getFieldAmount (sfLowLimit)),
-    mHighLimit (ledgerEntry->getFieldAmount (sfHighLimit)),
+    RippleState* rs = new RippleState (item, view);
+    rs->setViewAccount (accountID);
 
-    mLowID (mLowLimit.getIssuer ()),
-    mHighID (mHighLimit.getIssuer ()),
+    return AccountItem::pointer (rs);
+}
 
-    mBalance (ledgerEntry->getFieldAmount (sfBalance))
+// Works with a ledger entry or a view of one
+template <class Entry>
+void RippleState::setFields (Entry const& entry)
 {
-    mFlags          = mLedgerEntry->getFieldU32 (sfFlags);
+    mLowLimit       = entry.getFieldAmount (sfLowLimit);
+    mHighLimit      = entry.getFieldAmount (sfHighLimit);
+
+    mLowID          = mLowLimit.getIssuer ();
+    mHighID         = mHighLimit.getIssuer ();
+
+    mBalance        = entry.getFieldAmount (sfBalance);
 
-    mLowQualityIn   = mLedgerEntry->getFieldU32 (sfLowQualityIn);
-    mLowQualityOut  = mLedgerEntry->getFieldU32 (sfLowQualityOut);
+    mFlags          = entry.getFieldU32 (sfFlags);
 
-    mHighQualityIn  = mLedgerEntry->getFieldU32 (sfHighQualityIn);
-    mHighQualityOut = mLedgerEntry->getFieldU32 (sfHighQualityOut);
+    mLowQualityIn   = entry.getFieldU32 (sfLowQualityIn);
+    mLowQualityOut  = entry.getFieldU32 (sfLowQualityOut);
+
+    mHighQualityIn  = entry.getFieldU32 (sfHighQualityIn);
+    mHighQualityOut = entry.getFieldU32 (sfHighQualityOut);
 
     mValid      = true;
 }
 
+RippleState::RippleState (SerializedLedgerEntry::ref ledgerEntry) : AccountItem (ledgerEntry),
+    mValid (false),
+    mViewLowest (true)
+{
+    setFields (*ledgerEntry);
+}
+
+RippleState::RippleState (SHAMapItem::ref item, STObjectView const& view) : AccountItem (item),
+    mValid (false),
+    mViewLowest (true)
+{
+    setFields (view);
+}
+
 void RippleState::setViewAccount (const uint160& accountID)
 {
     bool    bViewLowestNew  = mLowID == accountID;
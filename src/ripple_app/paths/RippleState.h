@@ -38,6 +38,8 @@ public:
 
     AccountItem::pointer makeItem (const uint160& accountID, SerializedLedgerEntry::ref ledgerEntry);
 
+    AccountItem::pointer readItem (const uint160& accountID, SHAMapItem::ref item);
+
     LedgerEntryType getType ()
     {
         return ltRIPPLE_STATE;
@@ -101,27 +103,16 @@ public:
         return ((uint32) (mViewLowest ? mLowQualityOut : mHighQualityOut));
     }
 
-    SerializedLedgerEntry::pointer getSLE ()
-    {
-        return mLedgerEntry;
-    }
-    
-    const SerializedLedgerEntry& peekSLE () const
-    {
-        return *mLedgerEntry;
-    }
-    
-    SerializedLedgerEntry& peekSLE ()
-    {
-        return *mLedgerEntry;
-    }
-    
     Json::Value getJson (int);
 
     Blob getRaw () const;
 
 private:
     explicit RippleState (SerializedLedgerEntry::ref ledgerEntry);   // For accounts in a ledger
+    RippleState (SHAMapItem::ref item, STObjectView const& view);
+
+    template <class Entry>
+    void setFields (Entry const& entry);
 
 private:
     bool                            mValid;
@@ -107,7 +107,7 @@ private:
 
     std::list<uint256>    mRecentLedgers;
     std::list<uint256>    mRecentTxSets;
-    mutable boost::mutex  mRecentLock;
+    mutable boost::mutex  mRecentLock;   // Also guards the ledger range, hashes and mLastStatus
 
 
     boost::asio::deadline_timer                                 mActivityTimer;
@@ -188,8 +188,9 @@ public:
         return !m_isInbound;
     }
 
-    uint256 const& getClosedLedgerHash () const
+    uint256 getClosedLedgerHash () const
     {
+        boost::mutex::scoped_lock sl (mRecentLock);
         return mClosedLedgerHash;
     }
     bool hasLedger (uint256 const & hash, uint32 seq) const;
@@ -206,12 +207,14 @@ public:
     }
     void cycleStatus ()
     {
+        boost::mutex::scoped_lock sl (mRecentLock);
         mPreviousLedgerHash = mClosedLedgerHash;
         mClosedLedgerHash.zero ();
     }
     bool hasProto (int version);
     bool hasRange (uint32 uMin, uint32 uMax)
     {
+        boost::mutex::scoped_lock sl (mRecentLock);
         return (uMin >= mMinLedger) && (uMax <= mMaxLedger);
     }
 
@@ -283,11 +286,7 @@ private:
                 WriteLog (lsINFO, Peer) << "Peer: Body: Error: " << getIP () << ": " << error.category ().name () << ": " << error.message () << ": " << error;
             }
 
-            {
-                Application::ScopedLockType lock (getApp ().getMasterLock (), __FILE__, __LINE__);
-
-                detach ("hrb", true);
-            }
+            detach ("hrb", true);
             return;
         }
 
@@ -398,12 +397,12 @@ private:
 
     void recvHello (protocol::TMHello & packet);
     void recvCluster (protocol::TMCluster & packet);
-    void recvTransaction (protocol::TMTransaction & packet, Application::ScopedLockType& masterLockHolder);
-    void recvValidation (const boost::shared_ptr<protocol::TMValidation>& packet, Application::ScopedLockType& masterLockHolder);
+    void recvTransaction (protocol::TMTransaction & packet);
+    void recvValidation (const boost::shared_ptr<protocol::TMValidation>& packet);
     void recvGetValidation (protocol::TMGetValidations & packet);
     void recvContact (protocol::TMContact & packet);
     void recvGetContacts (protocol::TMGetContacts & packet);
-    void recvGetPeers (protocol::TMGetPeers & packet, Application::ScopedLockType& masterLockHolder);
+    void recvGetPeers (protocol::TMGetPeers & packet);
     void recvPeers (protocol::TMPeers & packet);
     void recvEndpoints (protocol::TMEndpoints & packet);
     void recvGetObjectByHash (const boost::shared_ptr<protocol::TMGetObjectByHash>& packet);
@@ -412,9 +411,10 @@ private:
     void recvSearchTransaction (protocol::TMSearchTransaction & packet);
     void recvGetAccount (protocol::TMGetAccount & packet);
     void recvAccount (protocol::TMAccount & packet);
-    void recvGetLedger (protocol::TMGetLedger & packet, Application::ScopedLockType& masterLockHolder);
-    void recvLedger (const boost::shared_ptr<protocol::TMLedgerData>& packet, Application::ScopedLockType& masterLockHolder);
+    void recvGetLedger (protocol::TMGetLedger & packet);
+    void recvLedger (const boost::shared_ptr<protocol::TMLedgerData>& packet);
     void recvStatus (protocol::TMStatusChange & packet);
+    void setLastStatus (protocol::TMStatusChange & packet);
     void recvPropose (const boost::shared_ptr<protocol::TMProposeSet>& packet);
     void recvHaveTxSet (protocol::TMHaveTransactionSet & packet);
     void recvProofWork (protocol::TMProofWork & packet);
@@ -777,7 +777,8 @@ void PeerImp::startReadBody (unsigned msg_len)
 
 void PeerImp::processReadBuffer ()
 {
-    // must not hold peer lock
+    // must not hold peer lock. The master lock is not held either; handlers
+    // take it only around the consensus state they touch.
     int type = PackedMessage::getType (mReadbuf);
 #ifdef BEAST_DEBUG
     //  Log::out() << "PRB(" << type << "), len=" << (mReadbuf.size()-PackedMessage::kHeaderBytes);
@@ -787,290 +788,286 @@ void PeerImp::processReadBuffer ()
 
     LoadEvent::autoptr event (getApp().getJobQueue ().getLoadEventAP (jtPEER, "Peer::read"));
 
+    // If connected and get a mtHELLO or if not connected and get a non-mtHELLO, wrong message was sent.
+    if (mHelloed == (type == protocol::mtHELLO))
     {
-        Application::ScopedLockType lock (getApp ().getMasterLock (), __FILE__, __LINE__);
-
-        // If connected and get a mtHELLO or if not connected and get a non-mtHELLO, wrong message was sent.
-        if (mHelloed == (type == protocol::mtHELLO))
+        WriteLog (lsWARNING, Peer) << "Wrong message type: " << type;
+        detach ("prb1", true);
+    }
+    else
+    {
+        switch (type)
         {
-            WriteLog (lsWARNING, Peer) << "Wrong message type: " << type;
-            detach ("prb1", true);
-        }
-        else
+        case protocol::mtHELLO:
         {
-            switch (type)
-            {
-            case protocol::mtHELLO:
-            {
-                event->reName ("Peer::hello");
-                protocol::TMHello msg;
+            event->reName ("Peer::hello");
+            protocol::TMHello msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvHello (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvHello (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtCLUSTER:
-            {
-                event->reName ("Peer::cluster");
-                protocol::TMCluster msg;
+        case protocol::mtCLUSTER:
+        {
+            event->reName ("Peer::cluster");
+            protocol::TMCluster msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvCluster (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvCluster (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
 
-            case protocol::mtERROR_MSG:
-            {
-                event->reName ("Peer::errormessage");
-                protocol::TMErrorMsg msg;
+        case protocol::mtERROR_MSG:
+        {
+            event->reName ("Peer::errormessage");
+            protocol::TMErrorMsg msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvErrorMessage (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvErrorMessage (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtPING:
-            {
-                event->reName ("Peer::ping");
-                protocol::TMPing msg;
+        case protocol::mtPING:
+        {
+            event->reName ("Peer::ping");
+            protocol::TMPing msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvPing (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvPing (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtGET_CONTACTS:
-            {
-                event->reName ("Peer::getcontacts");
-                protocol::TMGetContacts msg;
+        case protocol::mtGET_CONTACTS:
+        {
+            event->reName ("Peer::getcontacts");
+            protocol::TMGetContacts msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvGetContacts (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvGetContacts (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtCONTACT:
-            {
-                event->reName ("Peer::contact");
-                protocol::TMContact msg;
+        case protocol::mtCONTACT:
+        {
+            event->reName ("Peer::contact");
+            protocol::TMContact msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvContact (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvContact (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtGET_PEERS:
-            {
-                event->reName ("Peer::getpeers");
-                protocol::TMGetPeers msg;
+        case protocol::mtGET_PEERS:
+        {
+            event->reName ("Peer::getpeers");
+            protocol::TMGetPeers msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvGetPeers (msg, lock);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvGetPeers (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtPEERS:
-            {
-                event->reName ("Peer::peers");
-                protocol::TMPeers msg;
+        case protocol::mtPEERS:
+        {
+            event->reName ("Peer::peers");
+            protocol::TMPeers msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvPeers (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvPeers (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtENDPOINTS:
-            {
-                event->reName ("Peer::endpoints");
-                protocol::TMEndpoints msg;
+        case protocol::mtENDPOINTS:
+        {
+            event->reName ("Peer::endpoints");
+            protocol::TMEndpoints msg;
 
-                if(msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size() - PackedMessage::kHeaderBytes))
-                    recvEndpoints (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;;
-            }
-            break;
-            
-            case protocol::mtSEARCH_TRANSACTION:
-            {
-                event->reName ("Peer::searchtransaction");
-                protocol::TMSearchTransaction msg;
+            if(msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size() - PackedMessage::kHeaderBytes))
+                recvEndpoints (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;;
+        }
+        break;
+        
+        case protocol::mtSEARCH_TRANSACTION:
+        {
+            event->reName ("Peer::searchtransaction");
+            protocol::TMSearchTransaction msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvSearchTransaction (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvSearchTransaction (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtGET_ACCOUNT:
-            {
-                event->reName ("Peer::getaccount");
-                protocol::TMGetAccount msg;
+        case protocol::mtGET_ACCOUNT:
+        {
+            event->reName ("Peer::getaccount");
+            protocol::TMGetAccount msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvGetAccount (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvGetAccount (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtACCOUNT:
-            {
-                event->reName ("Peer::account");
-                protocol::TMAccount msg;
+        case protocol::mtACCOUNT:
+        {
+            event->reName ("Peer::account");
+            protocol::TMAccount msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvAccount (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvAccount (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtTRANSACTION:
-            {
-                event->reName ("Peer::transaction");
-                protocol::TMTransaction msg;
+        case protocol::mtTRANSACTION:
+        {
+            event->reName ("Peer::transaction");
+            protocol::TMTransaction msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvTransaction (msg, lock);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvTransaction (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtSTATUS_CHANGE:
-            {
-                event->reName ("Peer::statuschange");
-                protocol::TMStatusChange msg;
+        case protocol::mtSTATUS_CHANGE:
+        {
+            event->reName ("Peer::statuschange");
+            protocol::TMStatusChange msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvStatus (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvStatus (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtPROPOSE_LEDGER:
-            {
-                event->reName ("Peer::propose");
-                boost::shared_ptr<protocol::TMProposeSet> msg = boost::make_shared<protocol::TMProposeSet> ();
+        case protocol::mtPROPOSE_LEDGER:
+        {
+            event->reName ("Peer::propose");
+            boost::shared_ptr<protocol::TMProposeSet> msg = boost::make_shared<protocol::TMProposeSet> ();
 
-                if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvPropose (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvPropose (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtGET_LEDGER:
-            {
-                event->reName ("Peer::getledger");
-                protocol::TMGetLedger msg;
+        case protocol::mtGET_LEDGER:
+        {
+            event->reName ("Peer::getledger");
+            protocol::TMGetLedger msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvGetLedger (msg, lock);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvGetLedger (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtLEDGER_DATA:
-            {
-                event->reName ("Peer::ledgerdata");
-                boost::shared_ptr<protocol::TMLedgerData> msg = boost::make_shared<protocol::TMLedgerData> ();
+        case protocol::mtLEDGER_DATA:
+        {
+            event->reName ("Peer::ledgerdata");
+            boost::shared_ptr<protocol::TMLedgerData> msg = boost::make_shared<protocol::TMLedgerData> ();
 
-                if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvLedger (msg, lock);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvLedger (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtHAVE_SET:
-            {
-                event->reName ("Peer::haveset");
-                protocol::TMHaveTransactionSet msg;
+        case protocol::mtHAVE_SET:
+        {
+            event->reName ("Peer::haveset");
+            protocol::TMHaveTransactionSet msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvHaveTxSet (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvHaveTxSet (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtVALIDATION:
-            {
-                event->reName ("Peer::validation");
-                boost::shared_ptr<protocol::TMValidation> msg = boost::make_shared<protocol::TMValidation> ();
+        case protocol::mtVALIDATION:
+        {
+            event->reName ("Peer::validation");
+            boost::shared_ptr<protocol::TMValidation> msg = boost::make_shared<protocol::TMValidation> ();
 
-                if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvValidation (msg, lock);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
-    #if 0
+            if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvValidation (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
+#if 0
 
-            case protocol::mtGET_VALIDATION:
-            {
-                protocol::TM msg;
+        case protocol::mtGET_VALIDATION:
+        {
+            protocol::TM msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recv (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recv (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-    #endif
+#endif
 
-            case protocol::mtGET_OBJECTS:
-            {
-                event->reName ("Peer::getobjects");
-                boost::shared_ptr<protocol::TMGetObjectByHash> msg = boost::make_shared<protocol::TMGetObjectByHash> ();
+        case protocol::mtGET_OBJECTS:
+        {
+            event->reName ("Peer::getobjects");
+            boost::shared_ptr<protocol::TMGetObjectByHash> msg = boost::make_shared<protocol::TMGetObjectByHash> ();
 
-                if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvGetObjectByHash (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg->ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvGetObjectByHash (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
-            case protocol::mtPROOFOFWORK:
-            {
-                event->reName ("Peer::proofofwork");
-                protocol::TMProofWork msg;
+        case protocol::mtPROOFOFWORK:
+        {
+            event->reName ("Peer::proofofwork");
+            protocol::TMProofWork msg;
 
-                if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
-                    recvProofWork (msg);
-                else
-                    WriteLog (lsWARNING, Peer) << "parse error: " << type;
-            }
-            break;
+            if (msg.ParseFromArray (&mReadbuf[PackedMessage::kHeaderBytes], mReadbuf.size () - PackedMessage::kHeaderBytes))
+                recvProofWork (msg);
+            else
+                WriteLog (lsWARNING, Peer) << "parse error: " << type;
+        }
+        break;
 
 
-            default:
-                event->reName ("Peer::unknown");
-                WriteLog (lsWARNING, Peer) << "Unknown Msg: " << type;
-                WriteLog (lsWARNING, Peer) << strHex (&mReadbuf[0], mReadbuf.size ());
-            }
+        default:
+            event->reName ("Peer::unknown");
+            WriteLog (lsWARNING, Peer) << "Unknown Msg: " << type;
+            WriteLog (lsWARNING, Peer) << strHex (&mReadbuf[0], mReadbuf.size ());
         }
     }
 }
@@ -1203,14 +1200,20 @@ void PeerImp::recvHello (protocol::TMHello& packet)
 
             if ((packet.has_ledgerclosed ()) && (packet.ledgerclosed ().size () == (256 / 8)))
             {
-                memcpy (mClosedLedgerHash.begin (), packet.ledgerclosed ().data (), 256 / 8);
+                uint256 closedLedgerHash;
+                uint256 previousLedgerHash;
+
+                memcpy (closedLedgerHash.begin (), packet.ledgerclosed ().data (), 256 / 8);
 
                 if ((packet.has_ledgerprevious ()) && (packet.ledgerprevious ().size () == (256 / 8)))
                 {
-                    memcpy (mPreviousLedgerHash.begin (), packet.ledgerprevious ().data (), 256 / 8);
-                    addLedger (mPreviousLedgerHash);
+                    memcpy (previousLedgerHash.begin (), packet.ledgerprevious ().data (), 256 / 8);
+                    addLedger (previousLedgerHash);
                 }
-                else mPreviousLedgerHash.zero ();
+
+                boost::mutex::scoped_lock sl (mRecentLock);
+                mClosedLedgerHash = closedLedgerHash;
+                mPreviousLedgerHash = previousLedgerHash;
             }
 
             bDetach = false;
@@ -1267,9 +1270,8 @@ static void checkTransaction (Job&, int flags, SerializedTransaction::pointer st
 #endif
 }
 
-void PeerImp::recvTransaction (protocol::TMTransaction& packet, Application::ScopedLockType& masterLockHolder)
+void PeerImp::recvTransaction (protocol::TMTransaction& packet)
 {
-    masterLockHolder.unlock ();
     Transaction::pointer tx;
 #ifndef TRUST_NETWORK
 
@@ -1452,7 +1454,13 @@ void PeerImp::recvPropose (const boost::shared_ptr<protocol::TMProposeSet>& pack
 
     WriteLog (lsTRACE, Peer) << "Received " << (isTrusted ? "trusted" : "UNtrusted") << " proposal from " << mPeerId;
 
-    uint256 consensusLCL = getApp().getOPs ().getConsensusLCL ();
+    uint256 consensusLCL;
+
+    {
+        Application::ScopedLockType lock (getApp ().getMasterLock (), __FILE__, __LINE__);
+        consensusLCL = getApp().getOPs ().getConsensusLCL ();
+    }
+
     LedgerProposal::pointer proposal = boost::make_shared<LedgerProposal> (
                                            prevLedger.isNonZero () ? prevLedger : consensusLCL,
                                            set.proposeseq (), proposeHash, set.closetime (), signerPublic, suppression);
@@ -1483,7 +1491,14 @@ void PeerImp::recvHaveTxSet (protocol::TMHaveTransactionSet& packet)
     if (packet.status () == protocol::tsHAVE)
         addTxSet (hash);
 
-    if (!getApp().getOPs ().hasTXSet (shared_from_this (), hash, packet.status ()))
+    bool wanted;
+
+    {
+        Application::ScopedLockType lock (getApp ().getMasterLock (), __FILE__, __LINE__);
+        wanted = getApp().getOPs ().hasTXSet (shared_from_this (), hash, packet.status ());
+    }
+
+    if (!wanted)
     {
         charge (Resource::feeUnwantedData);
         applyLoadCharge (LT_UnwantedData);
@@ -1548,10 +1563,9 @@ static void checkValidation (Job&, SerializedValidation::pointer val, bool isTru
 #endif
 }
 
-void PeerImp::recvValidation (const boost::shared_ptr<protocol::TMValidation>& packet, Application::ScopedLockType& masterLockHolder)
+void PeerImp::recvValidation (const boost::shared_ptr<protocol::TMValidation>& packet)
 {
     uint32 closeTime = getApp().getOPs().getCloseTimeNC();
-    masterLockHolder.unlock ();
 
     if (packet->validation ().size () < 50)
     {
@@ -1645,9 +1659,8 @@ void PeerImp::recvGetContacts (protocol::TMGetContacts& packet)
 
 // Return a list of your favorite people
 // TODO: filter out all the LAN peers
-void PeerImp::recvGetPeers (protocol::TMGetPeers& packet, Application::ScopedLockType& masterLockHolder)
+void PeerImp::recvGetPeers (protocol::TMGetPeers& packet)
 {
-    masterLockHolder.unlock ();
     std::vector<std::string> addrs;
 
     getApp().getPeers ().getTopNAddrs (30, addrs);
@@ -1824,6 +1837,10 @@ void PeerImp::recvGetObjectByHash (const boost::shared_ptr<protocol::TMGetObject
         bool pLDo = true;
         bool progress = false;
 
+        // Objects are verified together once the packet is parsed
+        std::vector <uint256> packHashes;
+        std::vector < boost::shared_ptr< Blob > > packData;
+
         for (int i = 0; i < packet.objects_size (); ++i)
         {
             const protocol::TMIndexedObject& obj = packet.objects (i);
@@ -1856,11 +1873,43 @@ void PeerImp::recvGetObjectByHash (const boost::shared_ptr<protocol::TMGetObject
                     boost::shared_ptr< Blob > data = boost::make_shared< Blob >
                                                      (obj.data ().begin (), obj.data ().end ());
 
-                    getApp().getOPs ().addFetchPack (hash, data);
+                    packHashes.push_back (hash);
+                    packData.push_back (data);
                 }
             }
         }
 
+        if (!packHashes.empty ())
+        {
+            std::vector <const unsigned char*> buffers (packData.size ());
+            std::vector <int> sizes (packData.size ());
+            std::vector <uint256> computed (packData.size ());
+
+            for (int i = 0; i < packData.size (); ++i)
+            {
+                buffers[i] = packData[i]->empty () ? NULL : & (packData[i]->front ());
+                sizes[i] = packData[i]->size ();
+            }
+
+            Serializer::getSHA512HalfBatch (&buffers.front (), &sizes.front (), buffers.size (), &computed.front ());
+
+            int bad = 0;
+
+            for (int i = 0; i < packHashes.size (); ++i)
+            {
+                if (computed[i] == packHashes[i])
+                    getApp().getOPs ().addFetchPack (packHashes[i], packData[i]);
+                else
+                    ++bad;
+            }
+
+            if (bad != 0)
+            {
+                WriteLog (lsWARNING, Peer) << "Fetch pack from " << getIP () << " had " << bad << " bad entries";
+                applyLoadCharge (LT_InvalidRequest);
+            }
+        }
+
         CondLog (pLDo && (pLSeq != 0), lsDEBUG, Peer) << "Received partial fetch pack for " << pLSeq;
 
         if (packet.type () == protocol::TMGetObjectByHash::otFETCH_PACK)
@@ -1983,18 +2032,12 @@ void PeerImp::recvStatus (protocol::TMStatusChange& packet)
     if (!packet.has_networktime ())
         packet.set_networktime (getApp().getOPs ().getNetworkTimeNC ());
 
-    if (!mLastStatus.has_newstatus () || packet.has_newstatus ())
-        mLastStatus = packet;
-    else
-    {
-        // preserve old status
-        protocol::NodeStatus status = mLastStatus.newstatus ();
-        mLastStatus = packet;
-        packet.set_newstatus (status);
-    }
-
     if (packet.newevent () == protocol::neLOST_SYNC)
     {
+        boost::mutex::scoped_lock sl (mRecentLock);
+
+        setLastStatus (packet);
+
         if (!mClosedLedgerHash.isZero ())
         {
             WriteLog (lsTRACE, Peer) << "peer has lost sync " << getIP ();
@@ -2005,25 +2048,32 @@ void PeerImp::recvStatus (protocol::TMStatusChange& packet)
         return;
     }
 
+    uint256 closedLedgerHash;
+    uint256 previousLedgerHash;
+
     if (packet.has_ledgerhash () && (packet.ledgerhash ().size () == (256 / 8)))
     {
         // a peer has changed ledgers
-        memcpy (mClosedLedgerHash.begin (), packet.ledgerhash ().data (), 256 / 8);
-        addLedger (mClosedLedgerHash);
-        WriteLog (lsTRACE, Peer) << "peer LCL is " << mClosedLedgerHash << " " << getIP ();
+        memcpy (closedLedgerHash.begin (), packet.ledgerhash ().data (), 256 / 8);
+        addLedger (closedLedgerHash);
+        WriteLog (lsTRACE, Peer) << "peer LCL is " << closedLedgerHash << " " << getIP ();
     }
     else
     {
         WriteLog (lsTRACE, Peer) << "peer has no ledger hash" << getIP ();
-        mClosedLedgerHash.zero ();
     }
 
     if (packet.has_ledgerhashprevious () && packet.ledgerhashprevious ().size () == (256 / 8))
     {
-        memcpy (mPreviousLedgerHash.begin (), packet.ledgerhashprevious ().data (), 256 / 8);
-        addLedger (mPreviousLedgerHash);
+        memcpy (previousLedgerHash.begin (), packet.ledgerhashprevious ().data (), 256 / 8);
+        addLedger (previousLedgerHash);
     }
-    else mPreviousLedgerHash.zero ();
+
+    boost::mutex::scoped_lock sl (mRecentLock);
+
+    setLastStatus (packet);
+    mClosedLedgerHash = closedLedgerHash;
+    mPreviousLedgerHash = previousLedgerHash;
 
     if (packet.has_firstseq () && packet.has_lastseq())
     {
@@ -2038,7 +2088,21 @@ void PeerImp::recvStatus (protocol::TMStatusChange& packet)
     }
 }
 
-void PeerImp::recvGetLedger (protocol::TMGetLedger& packet, Application::ScopedLockType& masterLockHolder)
+// Call with mRecentLock held
+void PeerImp::setLastStatus (protocol::TMStatusChange& packet)
+{
+    if (!mLastStatus.has_newstatus () || packet.has_newstatus ())
+        mLastStatus = packet;
+    else
+    {
+        // preserve old status
+        protocol::NodeStatus status = mLastStatus.newstatus ();
+        mLastStatus = packet;
+        packet.set_newstatus (status);
+    }
+}
+
+void PeerImp::recvGetLedger (protocol::TMGetLedger& packet)
 {
     SHAMap::pointer map;
     protocol::TMLedgerData reply;
@@ -2064,8 +2128,11 @@ void PeerImp::recvGetLedger (protocol::TMGetLedger& packet, Application::ScopedL
 
         uint256 txHash;
         memcpy (txHash.begin (), packet.ledgerhash ().data (), 32);
-        map = getApp().getOPs ().getTXMap (txHash);
-        masterLockHolder.unlock();
+
+        {
+            Application::ScopedLockType lock (getApp ().getMasterLock (), __FILE__, __LINE__);
+            map = getApp().getOPs ().getTXMap (txHash);
+        }
 
         if (!map)
         {
@@ -2169,7 +2236,7 @@ void PeerImp::recvGetLedger (protocol::TMGetLedger& packet, Application::ScopedL
             CondLog (!ledger, lsDEBUG, Peer) << "Don't have ledger " << packet.ledgerseq ();
         }
         else if (packet.has_ltype () && (packet.ltype () == protocol::ltCURRENT))
-            ledger = getApp().getLedgerMaster ().getCurrentLedger ();
+            ledger = getApp().getLedgerMaster ().getCurrentSnapshot ();
         else if (packet.has_ltype () && (packet.ltype () == protocol::ltCLOSED) )
         {
             ledger = getApp().getLedgerMaster ().getClosedLedger ();
@@ -2199,11 +2266,14 @@ void PeerImp::recvGetLedger (protocol::TMGetLedger& packet, Application::ScopedL
             return;
         }
 
-        if (ledger->isImmutable ())
-            masterLockHolder.unlock ();
-        else
+        if (!ledger->isImmutable ())
         {
+            // Serve the request from a snapshot so the walk below
+            // does not need the master lock
             WriteLog (lsWARNING, Peer) << "Request for data from mutable ledger";
+
+            LedgerMaster::ScopedLockType sl (getApp().getLedgerMaster ().peekMutex (), __FILE__, __LINE__);
+            ledger = boost::make_shared<Ledger> (boost::ref (*ledger), false);
         }
 
         // Fill out the reply
@@ -2336,9 +2406,8 @@ void PeerImp::recvGetLedger (protocol::TMGetLedger& packet, Application::ScopedL
     sendPacket (oPacket, true);
 }
 
-void PeerImp::recvLedger (const boost::shared_ptr<protocol::TMLedgerData>& packet_ptr, Application::ScopedLockType& masterLockHolder)
+void PeerImp::recvLedger (const boost::shared_ptr<protocol::TMLedgerData>& packet_ptr)
 {
-    masterLockHolder.unlock ();
     protocol::TMLedgerData& packet = *packet_ptr;
 
     if (packet.nodes ().size () <= 0)
@@ -2718,12 +2787,21 @@ Json::Value PeerImp::getJson ()
         ret["complete_ledgers"] = boost::lexical_cast<std::string>(minSeq) + " - " +
                                   boost::lexical_cast<std::string>(maxSeq);
 
-    if (!!mClosedLedgerHash)
-        ret["ledger"] = mClosedLedgerHash.GetHex ();
+    uint256 closedLedgerHash;
+    protocol::TMStatusChange lastStatus;
+
+    {
+        boost::mutex::scoped_lock sl (mRecentLock);
+        closedLedgerHash = mClosedLedgerHash;
+        lastStatus = mLastStatus;
+    }
+
+    if (!!closedLedgerHash)
+        ret["ledger"] = closedLedgerHash.GetHex ();
 
-    if (mLastStatus.has_newstatus ())
+    if (lastStatus.has_newstatus ())
     {
-        switch (mLastStatus.newstatus ())
+        switch (lastStatus.newstatus ())
         {
         case protocol::nsCONNECTING:
             ret["status"] = "connecting";
@@ -2746,7 +2824,7 @@ Json::Value PeerImp::getJson ()
             break;
 
         default:
-            WriteLog (lsWARNING, Peer) << "Peer has unknown status: " << mLastStatus.newstatus ();
+            WriteLog (lsWARNING, Peer) << "Peer has unknown status: " << lastStatus.newstatus ();
         }
     }
 
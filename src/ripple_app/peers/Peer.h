@@ -91,7 +91,7 @@ public:
 
     virtual bool getConnectString(std::string&) const = 0;
 
-    virtual uint256 const& getClosedLedgerHash () const = 0;
+    virtual uint256 getClosedLedgerHash () const = 0;
 
     virtual bool hasLedger (uint256 const& hash, uint32 seq) const = 0;
 
@@ -75,10 +75,12 @@ namespace ripple {
 #include "shamap/SHAMapItem.h"
 #include "shamap/SHAMapNode.h"
 #include "shamap/SHAMapTreeNode.h"
+#include "shamap/SHAMapNodeMap.h"
 #include "shamap/SHAMapMissingNode.h"
 #include "shamap/SHAMapSyncFilter.h"
 #include "shamap/SHAMapAddNode.h"
 #include "shamap/SHAMap.h"
+#include "shamap/SHAMapFlusher.h"
 #include "misc/SerializedTransaction.h"
 #include "misc/SerializedLedger.h"
 #include "tx/TransactionMeta.h"
@@ -105,6 +107,7 @@ namespace ripple {
 #include "misc/AccountItems.h"
 #include "ledger/AcceptedLedgerTx.h"
 #include "ledger/AcceptedLedger.h"
+#include "ledger/LedgerEntryMap.h"
 #include "ledger/LedgerEntrySet.h"
 #include "tx/TransactionEngine.h"
 #include "misc/CanonicalTXSet.h"
@@ -26,7 +26,9 @@ namespace ripple {
 
 #include "shamap/SHAMap.cpp" // Uses theApp
 #include "shamap/SHAMapItem.cpp"
+#include "shamap/SHAMapNodeMap.cpp"
 #include "shamap/SHAMapSync.cpp"
+#include "shamap/SHAMapFlusher.cpp"
 #include "shamap/SHAMapMissingNode.cpp"
 
 #include "misc/AccountItem.cpp"
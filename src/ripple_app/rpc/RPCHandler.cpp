@@ -36,7 +36,7 @@ RPCHandler::RPCHandler (NetworkOPs* netOps, InfoSub::pointer infoSub)
 {
 }
 
-Json::Value RPCHandler::transactionSign (Json::Value params, bool bSubmit, bool bFailHard, Application::ScopedLockType& mlh)
+Json::Value RPCHandler::transactionSign (Json::Value params, bool bSubmit, bool bFailHard)
 {
     if (getApp().getFeeTrack().isLoadedCluster() && (mRole != Config::ADMIN))
         return rpcError(rpcTOO_BUSY);
@@ -90,7 +90,6 @@ Json::Value RPCHandler::transactionSign (Json::Value params, bool bSubmit, bool
     AccountState::pointer asSrc = bOffline
                                   ? AccountState::pointer ()                              // Don't look up address if offline.
                                   : mNetOps->getAccountState (lSnapshot, raSrcAddressID);
-    mlh.unlock();
 
     if (!bOffline && !asSrc)
     {
@@ -168,7 +167,7 @@ Json::Value RPCHandler::transactionSign (Json::Value params, bool bSubmit, bool
 
             {
                 bool bValid;
-                RippleLineCache::pointer cache = boost::make_shared<RippleLineCache> (lSnapshot);
+                RippleLineCache::pointer cache = getApp().getLedgerMaster ().getLineCache (lSnapshot);
                 Pathfinder pf (cache, raSrcAddressID, dstAccountID,
                                saSendMax.getCurrency (), saSendMax.getIssuer (), saSend, bValid);
 
@@ -581,7 +580,7 @@ Json::Value RPCHandler::accountFromString (Ledger::ref lrLedger, RippleAddress&
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
 // }
-Json::Value RPCHandler::doAccountInfo (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountInfo (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -622,9 +621,8 @@ Json::Value RPCHandler::doAccountInfo (Json::Value params, LoadType* loadType, A
     return jvResult;
 }
 
-Json::Value RPCHandler::doBlackList (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doBlackList (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock();
     if (params.isMember("threshold"))
         return getApp().getLoadManager().getBlackList(params["threshold"].asInt());
     else
@@ -636,7 +634,7 @@ Json::Value RPCHandler::doBlackList (Json::Value params, LoadType* loadType, App
 //   port: <number>
 // }
 // XXX Might allow domain for manual connections.
-Json::Value RPCHandler::doConnect (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doConnect (Json::Value params, LoadType* loadType)
 {
     if (getConfig ().RUN_STANDALONE)
         return "cannot connect in standalone mode";
@@ -657,7 +655,7 @@ Json::Value RPCHandler::doConnect (Json::Value params, LoadType* loadType, Appli
 // {
 //   key: <string>
 // }
-Json::Value RPCHandler::doDataDelete (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doDataDelete (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("key"))
         return rpcError (rpcINVALID_PARAMS);
@@ -683,7 +681,7 @@ Json::Value RPCHandler::doDataDelete (Json::Value params, LoadType* loadType, Ap
 // {
 //   key: <string>
 // }
-Json::Value RPCHandler::doDataFetch (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doDataFetch (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("key"))
         return rpcError (rpcINVALID_PARAMS);
@@ -707,7 +705,7 @@ Json::Value RPCHandler::doDataFetch (Json::Value params, LoadType* loadType, App
 //   key: <string>
 //   value: <string>
 // }
-Json::Value RPCHandler::doDataStore (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doDataStore (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("key")
             || !params.isMember ("value"))
@@ -768,7 +766,7 @@ Json::Value RPCHandler::doNicknameInfo (Json::Value params)
 //   'account_index' : <index> // optional
 // }
 // XXX This would be better if it took the ledger.
-Json::Value RPCHandler::doOwnerInfo (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doOwnerInfo (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("account") && !params.isMember ("ident"))
         return rpcError (rpcINVALID_PARAMS);
@@ -782,18 +780,20 @@ Json::Value RPCHandler::doOwnerInfo (Json::Value params, LoadType* loadType, App
 
     // Get info on account.
 
-    Json::Value     jAccepted   = accountFromString (mNetOps->getClosedLedger (), raAccount, bIndex, strIdent, iIndex, false);
+    Ledger::pointer lpClosed    = mNetOps->getClosedLedger ();
+    Json::Value     jAccepted   = accountFromString (lpClosed, raAccount, bIndex, strIdent, iIndex, false);
 
-    ret["accepted"] = jAccepted.empty () ? mNetOps->getOwnerInfo (mNetOps->getClosedLedger (), raAccount) : jAccepted;
+    ret["accepted"] = jAccepted.empty () ? mNetOps->getOwnerInfo (lpClosed, raAccount) : jAccepted;
 
-    Json::Value     jCurrent    = accountFromString (mNetOps->getCurrentLedger (), raAccount, bIndex, strIdent, iIndex, false);
+    Ledger::pointer lpCurrent   = mNetOps->getCurrentSnapshot ();
+    Json::Value     jCurrent    = accountFromString (lpCurrent, raAccount, bIndex, strIdent, iIndex, false);
 
-    ret["current"]  = jCurrent.empty () ? mNetOps->getOwnerInfo (mNetOps->getCurrentLedger (), raAccount) : jCurrent;
+    ret["current"]  = jCurrent.empty () ? mNetOps->getOwnerInfo (lpCurrent, raAccount) : jCurrent;
 
     return ret;
 }
 
-Json::Value RPCHandler::doPeers (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doPeers (Json::Value, LoadType* loadType)
 {
     Json::Value jvResult (Json::objectValue);
 
@@ -804,15 +804,13 @@ Json::Value RPCHandler::doPeers (Json::Value, LoadType* loadType, Application::S
     return jvResult;
 }
 
-Json::Value RPCHandler::doPing (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doPing (Json::Value, LoadType* loadType)
 {
     return Json::Value (Json::objectValue);
 }
 
-Json::Value RPCHandler::doPrint (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doPrint (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     JsonPropertyStream stream;
     if (params.isObject() && params["params"].isArray() && params["params"][0u].isString ())
         getApp().write (stream, params["params"][0u].asString());
@@ -827,7 +825,7 @@ Json::Value RPCHandler::doPrint (Json::Value params, LoadType* loadType, Applica
 // issuer is the offering account
 // --> submit: 'submit|true|false': defaults to false
 // Prior to running allow each to have a credit line of what they will be getting from the other account.
-Json::Value RPCHandler::doProfile (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doProfile (Json::Value params, LoadType* loadType)
 {
     /* need to fix now that sharedOfferCreate is gone
     int             iArgs   = params.size();
@@ -919,9 +917,8 @@ Json::Value RPCHandler::doProfile (Json::Value params, LoadType* loadType, Appli
 //   difficulty: <number>       // optional
 //   secret: <secret>           // optional
 // }
-Json::Value RPCHandler::doProofCreate (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doProofCreate (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
     // XXX: Add ability to create proof with arbitrary time
 
     Json::Value     jvResult (Json::objectValue);
@@ -964,10 +961,8 @@ Json::Value RPCHandler::doProofCreate (Json::Value params, LoadType* loadType, A
 // {
 //   token: <token>
 // }
-Json::Value RPCHandler::doProofSolve (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doProofSolve (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     Json::Value         jvResult;
 
     if (!params.isMember ("token"))
@@ -994,9 +989,8 @@ Json::Value RPCHandler::doProofSolve (Json::Value params, LoadType* loadType, Ap
 //   difficulty: <number>       // optional
 //   secret: <secret>           // optional
 // }
-Json::Value RPCHandler::doProofVerify (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doProofVerify (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
     // XXX Add ability to check proof against arbitrary time
 
     Json::Value         jvResult;
@@ -1064,7 +1058,7 @@ Json::Value RPCHandler::doProofVerify (Json::Value params, LoadType* loadType, A
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
 // }
-Json::Value RPCHandler::doAccountLines (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountLines (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -1072,14 +1066,6 @@ Json::Value RPCHandler::doAccountLines (Json::Value params, LoadType* loadType,
     if (!lpLedger)
         return jvResult;
 
-    bool bUnlocked = false;
-
-    if (lpLedger->isImmutable ())
-    {
-        masterLockHolder.unlock ();
-        bUnlocked = true;
-    }
-
     if (!params.isMember ("account"))
         return rpcError (rpcINVALID_PARAMS);
 
@@ -1151,9 +1137,6 @@ Json::Value RPCHandler::doAccountLines (Json::Value params, LoadType* loadType,
                     jPeer["no_ripple_peer"] = true;
             }
         }
-
-        if (!bUnlocked)
-            masterLockHolder.unlock ();
     }
     else
     {
@@ -1163,15 +1146,15 @@ Json::Value RPCHandler::doAccountLines (Json::Value params, LoadType* loadType,
     return jvResult;
 }
 
-static void offerAdder (Json::Value& jvLines, SLE::ref offer)
+static void offerAdder (Json::Value& jvLines, STObjectView const& offer)
 {
-    if (offer->getType () == ltOFFER)
+    if (offer.getFieldU16 (sfLedgerEntryType) == ltOFFER)
     {
         Json::Value&    obj = jvLines.append (Json::objectValue);
-        offer->getFieldAmount (sfTakerPays).setJson (obj["taker_pays"]);
-        offer->getFieldAmount (sfTakerGets).setJson (obj["taker_gets"]);
-        obj["seq"] = offer->getFieldU32 (sfSequence);
-        obj["flags"] = offer->getFieldU32 (sfFlags);
+        offer.getFieldAmount (sfTakerPays).setJson (obj["taker_pays"]);
+        offer.getFieldAmount (sfTakerGets).setJson (obj["taker_gets"]);
+        obj["seq"] = offer.getFieldU32 (sfSequence);
+        obj["flags"] = offer.getFieldU32 (sfFlags);
     }
 }
 
@@ -1181,7 +1164,7 @@ static void offerAdder (Json::Value& jvLines, SLE::ref offer)
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
 // }
-Json::Value RPCHandler::doAccountOffers (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountOffers (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -1189,14 +1172,6 @@ Json::Value RPCHandler::doAccountOffers (Json::Value params, LoadType* loadType,
     if (!lpLedger)
         return jvResult;
 
-    bool bUnlocked = false;
-
-    if (lpLedger->isImmutable ())
-    {
-        masterLockHolder.unlock ();
-        bUnlocked = true;
-    }
-
     if (!params.isMember ("account"))
         return rpcError (rpcINVALID_PARAMS);
 
@@ -1222,10 +1197,7 @@ Json::Value RPCHandler::doAccountOffers (Json::Value params, LoadType* loadType,
         return rpcError (rpcACT_NOT_FOUND);
 
     Json::Value& jvsOffers = (jvResult["offers"] = Json::arrayValue);
-    lpLedger->visitAccountItems (raAccount.getAccountID (), BIND_TYPE (&offerAdder, boost::ref (jvsOffers), P_1));
-
-    if (!bUnlocked)
-        masterLockHolder.unlock ();
+    lpLedger->visitAccountItemViews (raAccount.getAccountID (), BIND_TYPE (&offerAdder, boost::ref (jvsOffers), P_1));
 
     return jvResult;
 }
@@ -1240,7 +1212,7 @@ Json::Value RPCHandler::doAccountOffers (Json::Value params, LoadType* loadType,
 //   "limit" : integer,                  // Optional.
 //   "proof" : boolean                   // Defaults to false.
 // }
-Json::Value RPCHandler::doBookOffers (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doBookOffers (Json::Value params, LoadType* loadType)
 {
     if (getApp().getJobQueue ().getJobCountGE (jtCLIENT) > 200)
     {
@@ -1253,9 +1225,6 @@ Json::Value RPCHandler::doBookOffers (Json::Value params, LoadType* loadType, Ap
     if (!lpLedger)
         return jvResult;
 
-    if (lpLedger->isImmutable ())
-        masterLockHolder.unlock ();
-
     if (!params.isMember ("taker_pays") || !params.isMember ("taker_gets") || !params["taker_pays"].isObject () || !params["taker_gets"].isObject ())
         return rpcError (rpcINVALID_PARAMS);
 
@@ -1341,9 +1310,8 @@ Json::Value RPCHandler::doBookOffers (Json::Value params, LoadType* loadType, Ap
 // {
 //   random: <uint256>
 // }
-Json::Value RPCHandler::doRandom (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doRandom (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
     uint256         uRandom;
 
     try
@@ -1362,10 +1330,9 @@ Json::Value RPCHandler::doRandom (Json::Value params, LoadType* loadType, Applic
     }
 }
 
-Json::Value RPCHandler::doPathFind (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doPathFind (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer lpLedger = mNetOps->getClosedLedger();
-    masterLockHolder.unlock();
 
     if (!params.isMember ("subcommand") || !params["subcommand"].isString ())
         return rpcError (rpcINVALID_PARAMS);
@@ -1420,7 +1387,7 @@ Json::Value RPCHandler::doPathFind (Json::Value params, LoadType* loadType, Appl
 //   - Allows clients to verify path exists.
 // - Return canonicalized path.
 //   - From a trusted server, allows clients to use path without manipulation.
-Json::Value RPCHandler::doRipplePathFind (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doRipplePathFind (Json::Value params, LoadType* loadType)
 {
     int jc = getApp().getJobQueue ().getJobCountGE (jtCLIENT);
 
@@ -1502,9 +1469,7 @@ Json::Value RPCHandler::doRipplePathFind (Json::Value params, LoadType* loadType
         }
 
         *loadType = LT_RPCBurden;
-        Ledger::pointer lSnapShot = boost::make_shared<Ledger> (boost::ref (*lpLedger), false);
-
-        masterLockHolder.unlock (); // As long as we have a locked copy of the ledger, we can unlock.
+        Ledger::pointer lSnapShot = lpLedger;
 
         // Fill in currencies destination will accept
         Json::Value jvDestCur (Json::arrayValue);
@@ -1517,7 +1482,7 @@ Json::Value RPCHandler::doRipplePathFind (Json::Value params, LoadType* loadType
         jvResult["destination_account"] = raDst.humanAccountID ();
 
         Json::Value jvArray (Json::arrayValue);
-        RippleLineCache::pointer cache = boost::make_shared<RippleLineCache> (lSnapShot);
+        RippleLineCache::pointer cache = getApp().getLedgerMaster ().getLineCache (lSnapShot);
 
         for (unsigned int i = 0; i != jvSrcCurrencies.size (); ++i)
         {
@@ -1656,23 +1621,23 @@ Json::Value RPCHandler::doRipplePathFind (Json::Value params, LoadType* loadType
 //   tx_json: <object>,
 //   secret: <secret>
 // }
-Json::Value RPCHandler::doSign (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doSign (Json::Value params, LoadType* loadType)
 {
     *loadType = LT_RPCBurden;
     bool bFailHard = params.isMember ("fail_hard") && params["fail_hard"].asBool ();
-    return transactionSign (params, false, bFailHard, masterLockHolder);
+    return transactionSign (params, false, bFailHard);
 }
 
 // {
 //   tx_json: <object>,
 //   secret: <secret>
 // }
-Json::Value RPCHandler::doSubmit (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doSubmit (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("tx_blob"))
     {
         bool bFailHard = params.isMember ("fail_hard") && params["fail_hard"].asBool ();
-        return transactionSign (params, true, bFailHard, masterLockHolder);
+        return transactionSign (params, true, bFailHard);
     }
 
     Json::Value                 jvResult;
@@ -1730,8 +1695,6 @@ Json::Value RPCHandler::doSubmit (Json::Value params, LoadType* loadType, Applic
         return jvResult;
     }
 
-    masterLockHolder.unlock ();
-
     try
     {
         jvResult["tx_json"]     = tpTrans->getJson (0);
@@ -1760,7 +1723,7 @@ Json::Value RPCHandler::doSubmit (Json::Value params, LoadType* loadType, Applic
     }
 }
 
-Json::Value RPCHandler::doConsensusInfo (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doConsensusInfo (Json::Value, LoadType* loadType)
 {
     Json::Value ret (Json::objectValue);
 
@@ -1769,10 +1732,8 @@ Json::Value RPCHandler::doConsensusInfo (Json::Value, LoadType* loadType, Applic
     return ret;
 }
 
-Json::Value RPCHandler::doFetchInfo (Json::Value jvParams, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doFetchInfo (Json::Value jvParams, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     Json::Value ret (Json::objectValue);
 
     if (jvParams.isMember("clear") && jvParams["clear"].asBool())
@@ -1786,7 +1747,7 @@ Json::Value RPCHandler::doFetchInfo (Json::Value jvParams, LoadType* loadType, A
     return ret;
 }
 
-Json::Value RPCHandler::doServerInfo (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doServerInfo (Json::Value, LoadType* loadType)
 {
     Json::Value ret (Json::objectValue);
 
@@ -1795,7 +1756,7 @@ Json::Value RPCHandler::doServerInfo (Json::Value, LoadType* loadType, Applicati
     return ret;
 }
 
-Json::Value RPCHandler::doServerState (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doServerState (Json::Value, LoadType* loadType)
 {
     Json::Value ret (Json::objectValue);
 
@@ -1807,10 +1768,8 @@ Json::Value RPCHandler::doServerState (Json::Value, LoadType* loadType, Applicat
 // {
 //   start: <index>
 // }
-Json::Value RPCHandler::doTxHistory (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doTxHistory (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     if (!params.isMember ("start"))
         return rpcError (rpcINVALID_PARAMS);
 
@@ -1848,10 +1807,8 @@ Json::Value RPCHandler::doTxHistory (Json::Value params, LoadType* loadType, App
 // {
 //   transaction: <hex>
 // }
-Json::Value RPCHandler::doTx (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doTx (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     if (!params.isMember ("transaction"))
         return rpcError (rpcINVALID_PARAMS);
 
@@ -1916,20 +1873,20 @@ Json::Value RPCHandler::doTx (Json::Value params, LoadType* loadType, Applicatio
     return rpcError (rpcNOT_IMPL);
 }
 
-Json::Value RPCHandler::doLedgerClosed (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLedgerClosed (Json::Value, LoadType* loadType)
 {
     Json::Value jvResult;
 
-    uint256 uLedger = mNetOps->getClosedLedgerHash ();
+    Ledger::pointer lpLedger = mNetOps->getClosedLedger ();
 
-    jvResult["ledger_index"]        = mNetOps->getLedgerID (uLedger);
-    jvResult["ledger_hash"]         = uLedger.ToString ();
+    jvResult["ledger_index"]        = lpLedger->getLedgerSeq ();
+    jvResult["ledger_hash"]         = lpLedger->getHash ().ToString ();
     //jvResult["ledger_time"]       = uLedger.
 
     return jvResult;
 }
 
-Json::Value RPCHandler::doLedgerCurrent (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLedgerCurrent (Json::Value, LoadType* loadType)
 {
     Json::Value jvResult;
 
@@ -1943,13 +1900,32 @@ Json::Value RPCHandler::doLedgerCurrent (Json::Value, LoadType* loadType, Applic
 //    ledger: 'current' | 'closed' | <uint256> | <number>,  // optional
 //    full: true | false    // optional, defaults to false.
 // }
-Json::Value RPCHandler::doLedger (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+static int getLedgerOptions (Json::Value const& params)
+{
+    bool    bFull           = params.isMember ("full") && params["full"].asBool ();
+    bool    bTransactions   = params.isMember ("transactions") && params["transactions"].asBool ();
+    bool    bAccounts       = params.isMember ("accounts") && params["accounts"].asBool ();
+    bool    bExpand         = params.isMember ("expand") && params["expand"].asBool ();
+
+    return (bFull ? LEDGER_JSON_FULL : 0)
+           | (bExpand ? LEDGER_JSON_EXPAND : 0)
+           | (bTransactions ? LEDGER_JSON_DUMP_TXRP : 0)
+           | (bAccounts ? LEDGER_JSON_DUMP_STATE : 0);
+}
+
+static bool isTooBusyForDump (int iOptions, int iRole)
+{
+    return (isSetBit (iOptions, LEDGER_JSON_FULL) || isSetBit (iOptions, LEDGER_JSON_DUMP_STATE))
+           && getApp().getFeeTrack().isLoadedLocal() && (iRole != Config::ADMIN);
+}
+
+Json::Value RPCHandler::doLedger (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("ledger") && !params.isMember ("ledger_hash") && !params.isMember ("ledger_index"))
     {
         Json::Value ret (Json::objectValue), current (Json::objectValue), closed (Json::objectValue);
 
-        getApp().getLedgerMaster ().getCurrentLedger ()->addJson (current, 0);
+        getApp().getLedgerMaster ().getCurrentSnapshot ()->addJson (current, 0);
         getApp().getLedgerMaster ().getClosedLedger ()->addJson (closed, 0);
 
         ret["open"] = current;
@@ -1964,19 +1940,9 @@ Json::Value RPCHandler::doLedger (Json::Value params, LoadType* loadType, Applic
     if (!lpLedger)
         return jvResult;
 
-    if (lpLedger->isImmutable ())
-        masterLockHolder.unlock ();
-
-    bool    bFull           = params.isMember ("full") && params["full"].asBool ();
-    bool    bTransactions   = params.isMember ("transactions") && params["transactions"].asBool ();
-    bool    bAccounts       = params.isMember ("accounts") && params["accounts"].asBool ();
-    bool    bExpand         = params.isMember ("expand") && params["expand"].asBool ();
-    int     iOptions        = (bFull ? LEDGER_JSON_FULL : 0)
-                              | (bExpand ? LEDGER_JSON_EXPAND : 0)
-                              | (bTransactions ? LEDGER_JSON_DUMP_TXRP : 0)
-                              | (bAccounts ? LEDGER_JSON_DUMP_STATE : 0);
+    int     iOptions        = getLedgerOptions (params);
 
-    if ((bFull || bAccounts) && getApp().getFeeTrack().isLoadedLocal() && (mRole != Config::ADMIN))
+    if (isTooBusyForDump (iOptions, mRole))
     {
        WriteLog (lsDEBUG, Peer) << "Too busy to give full ledger";
        return rpcError(rpcTOO_BUSY);
@@ -1990,12 +1956,12 @@ Json::Value RPCHandler::doLedger (Json::Value params, LoadType* loadType, Applic
 }
 
 // Temporary switching code until the old account_tx is removed
-Json::Value RPCHandler::doAccountTxSwitch (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountTxSwitch (Json::Value params, LoadType* loadType)
 {
     if (params.isMember("offset") || params.isMember("count") || params.isMember("descending") ||
             params.isMember("ledger_max") || params.isMember("ledger_min"))
-        return doAccountTxOld(params, loadType, masterLockHolder);
-    return doAccountTx(params, loadType, masterLockHolder);
+        return doAccountTxOld(params, loadType);
+    return doAccountTx(params, loadType);
 }
 
 // {
@@ -2008,7 +1974,7 @@ Json::Value RPCHandler::doAccountTxSwitch (Json::Value params, LoadType* loadTyp
 //   offset: integer,              // optional, defaults to 0
 //   limit: integer                // optional
 // }
-Json::Value RPCHandler::doAccountTxOld (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountTxOld (Json::Value params, LoadType* loadType)
 {
     RippleAddress   raAccount;
     uint32          offset      = params.isMember ("offset") ? params["offset"].asUInt () : 0;
@@ -2077,8 +2043,6 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, LoadType* loadType,
     try
     {
 #endif
-        masterLockHolder.unlock ();
-
         Json::Value ret (Json::objectValue);
 
         ret["account"] = raAccount.humanAccountID ();
@@ -2157,7 +2121,7 @@ Json::Value RPCHandler::doAccountTxOld (Json::Value params, LoadType* loadType,
 //   limit: integer,                 // optional
 //   marker: opaque                  // optional, resume previous query
 // }
-Json::Value RPCHandler::doAccountTx (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doAccountTx (Json::Value params, LoadType* loadType)
 {
     RippleAddress   raAccount;
     int             limit       = params.isMember ("limit") ? params["limit"].asUInt () : -1;
@@ -2218,8 +2182,6 @@ Json::Value RPCHandler::doAccountTx (Json::Value params, LoadType* loadType, App
     try
     {
 #endif
-        masterLockHolder.unlock ();
-
         Json::Value ret (Json::objectValue);
 
         ret["account"] = raAccount.humanAccountID ();
@@ -2290,7 +2252,7 @@ Json::Value RPCHandler::doAccountTx (Json::Value params, LoadType* loadType, App
 // }
 //
 // This command requires Config::ADMIN access because it makes no sense to ask an untrusted server for this.
-Json::Value RPCHandler::doValidationCreate (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doValidationCreate (Json::Value params, LoadType* loadType)
 {
     RippleAddress   raSeed;
     Json::Value     obj (Json::objectValue);
@@ -2316,7 +2278,7 @@ Json::Value RPCHandler::doValidationCreate (Json::Value params, LoadType* loadTy
 // {
 //   secret: <string>
 // }
-Json::Value RPCHandler::doValidationSeed (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doValidationSeed (Json::Value params, LoadType* loadType)
 {
     Json::Value obj (Json::objectValue);
 
@@ -2387,7 +2349,7 @@ Json::Value RPCHandler::accounts (Ledger::ref lrLedger, const RippleAddress& naM
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
 // }
-Json::Value RPCHandler::doWalletAccounts (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doWalletAccounts (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -2430,7 +2392,7 @@ Json::Value RPCHandler::doWalletAccounts (Json::Value params, LoadType* loadType
     }
 }
 
-Json::Value RPCHandler::doLogRotate (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLogRotate (Json::Value, LoadType* loadType)
 {
     return LogSink::get()->rotateLog ();
 }
@@ -2438,10 +2400,8 @@ Json::Value RPCHandler::doLogRotate (Json::Value, LoadType* loadType, Applicatio
 // {
 //  passphrase: <string>
 // }
-Json::Value RPCHandler::doWalletPropose (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doWalletPropose (Json::Value params, LoadType* loadType)
 {
-    masterLockHolder.unlock ();
-
     RippleAddress   naSeed;
     RippleAddress   naAccount;
 
@@ -2470,7 +2430,7 @@ Json::Value RPCHandler::doWalletPropose (Json::Value params, LoadType* loadType,
 // {
 //   secret: <string>
 // }
-Json::Value RPCHandler::doWalletSeed (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doWalletSeed (Json::Value params, LoadType* loadType)
 {
     RippleAddress   raSeed;
     bool            bSecret = params.isMember ("secret");
@@ -2509,7 +2469,7 @@ Json::Value RPCHandler::doWalletSeed (Json::Value params, LoadType* loadType, Ap
 //   username: <string>,
 //   password: <string>
 // }
-Json::Value RPCHandler::doLogin (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLogin (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("username")
             || !params.isMember ("password"))
@@ -2547,7 +2507,7 @@ static void textTime (std::string& text, int& seconds, const char* unitName, int
         text += "s";
 }
 
-Json::Value RPCHandler::doFeature (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh)
+Json::Value RPCHandler::doFeature (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("feature"))
     {
@@ -2576,7 +2536,7 @@ Json::Value RPCHandler::doFeature (Json::Value params, LoadType* loadType, Appli
 // {
 //   min_count: <number>  // optional, defaults to 10
 // }
-Json::Value RPCHandler::doGetCounts (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doGetCounts (Json::Value params, LoadType* loadType)
 {
     int minCount = 10;
 
@@ -2608,9 +2568,11 @@ Json::Value RPCHandler::doGetCounts (Json::Value params, LoadType* loadType, App
         ret["dbKBTransaction"] = dbKB;
 
     ret["write_load"] = getApp().getNodeStore ().getWriteLoad ();
+    ret["flush_pending"] = getApp().getLedgerMaster ().getFlusher ().getPendingCount ();
 
     ret["SLE_hit_rate"] = getApp().getSLECache ().getHitRate ();
     ret["node_hit_rate"] = getApp().getNodeStore ().getCacheHitRate ();
+    ret["node_cache_KB"] = static_cast <Json::UInt> (getApp().getNodeStore ().getCacheBytes () / 1024);
     ret["ledger_hit_rate"] = getApp().getLedgerMaster ().getCacheHitRate ();
     ret["AL_hit_rate"] = AcceptedLedger::getCacheHitRate ();
 
@@ -2628,7 +2590,7 @@ Json::Value RPCHandler::doGetCounts (Json::Value params, LoadType* loadType, App
     return ret;
 }
 
-Json::Value RPCHandler::doLogLevel (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLogLevel (Json::Value params, LoadType* loadType)
 {
     // log_level
     if (!params.isMember ("severity"))
@@ -2681,7 +2643,7 @@ Json::Value RPCHandler::doLogLevel (Json::Value params, LoadType* loadType, Appl
 //   node: <domain>|<node_public>,
 //   comment: <comment>             // optional
 // }
-Json::Value RPCHandler::doUnlAdd (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlAdd (Json::Value params, LoadType* loadType)
 {
     std::string strNode     = params.isMember ("node") ? params["node"].asString () : "";
     std::string strComment  = params.isMember ("comment") ? params["comment"].asString () : "";
@@ -2705,7 +2667,7 @@ Json::Value RPCHandler::doUnlAdd (Json::Value params, LoadType* loadType, Applic
 // {
 //   node: <domain>|<public_key>
 // }
-Json::Value RPCHandler::doUnlDelete (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlDelete (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("node"))
         return rpcError (rpcINVALID_PARAMS);
@@ -2728,7 +2690,7 @@ Json::Value RPCHandler::doUnlDelete (Json::Value params, LoadType* loadType, App
     }
 }
 
-Json::Value RPCHandler::doUnlList (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlList (Json::Value, LoadType* loadType)
 {
     Json::Value obj (Json::objectValue);
 
@@ -2738,7 +2700,7 @@ Json::Value RPCHandler::doUnlList (Json::Value, LoadType* loadType, Application:
 }
 
 // Populate the UNL from a local validators.txt file.
-Json::Value RPCHandler::doUnlLoad (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlLoad (Json::Value, LoadType* loadType)
 {
     if (getConfig ().VALIDATORS_FILE.empty () || !getApp().getUNL ().nodeLoad (getConfig ().VALIDATORS_FILE))
     {
@@ -2750,7 +2712,7 @@ Json::Value RPCHandler::doUnlLoad (Json::Value, LoadType* loadType, Application:
 
 
 // Populate the UNL from ripple.com's validators.txt file.
-Json::Value RPCHandler::doUnlNetwork (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlNetwork (Json::Value params, LoadType* loadType)
 {
     getApp().getUNL ().nodeNetwork ();
 
@@ -2758,7 +2720,7 @@ Json::Value RPCHandler::doUnlNetwork (Json::Value params, LoadType* loadType, Ap
 }
 
 // unl_reset
-Json::Value RPCHandler::doUnlReset (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlReset (Json::Value params, LoadType* loadType)
 {
     getApp().getUNL ().nodeReset ();
 
@@ -2766,14 +2728,14 @@ Json::Value RPCHandler::doUnlReset (Json::Value params, LoadType* loadType, Appl
 }
 
 // unl_score
-Json::Value RPCHandler::doUnlScore (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnlScore (Json::Value, LoadType* loadType)
 {
     getApp().getUNL ().nodeScore ();
 
     return "scoring requested";
 }
 
-Json::Value RPCHandler::doSMS (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doSMS (Json::Value params, LoadType* loadType)
 {
     if (!params.isMember ("text"))
         return rpcError (rpcINVALID_PARAMS);
@@ -2782,14 +2744,14 @@ Json::Value RPCHandler::doSMS (Json::Value params, LoadType* loadType, Applicati
 
     return "sms dispatched";
 }
-Json::Value RPCHandler::doStop (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doStop (Json::Value, LoadType* loadType)
 {
     getApp().signalStop ();
 
     return SYSTEM_NAME " server stopping";
 }
 
-Json::Value RPCHandler::doLedgerAccept (Json::Value, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLedgerAccept (Json::Value, LoadType* loadType)
 {
     Json::Value jvResult;
 
@@ -2812,7 +2774,7 @@ Json::Value RPCHandler::doLedgerAccept (Json::Value, LoadType* loadType, Applica
 //   ledger_index : <ledger_index>
 // }
 // XXX In this case, not specify either ledger does not mean ledger current. It means any ledger.
-Json::Value RPCHandler::doTransactionEntry (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doTransactionEntry (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -2820,9 +2782,6 @@ Json::Value RPCHandler::doTransactionEntry (Json::Value params, LoadType* loadTy
     if (!lpLedger)
         return jvResult;
 
-    if (lpLedger->isImmutable())
-        masterLockHolder.unlock();
-
     if (!params.isMember ("tx_hash"))
     {
         jvResult["error"]   = "fieldNotFoundTransaction";
@@ -2965,6 +2924,15 @@ Json::Value RPCHandler::lookupLedger (Json::Value params, Ledger::pointer& lpLed
         }
     }
 
+    if (!lpLedger->isImmutable ())
+    {
+        // Commands run without the master lock, so never hand them a ledger
+        // that can change underneath them.
+        LedgerMaster::ScopedLockType sl (getApp().getLedgerMaster ().peekMutex (), __FILE__, __LINE__);
+
+        lpLedger        = boost::make_shared<Ledger> (boost::ref (*lpLedger), false);
+    }
+
     if (lpLedger->isClosed ())
     {
         if (!!uLedger)
@@ -2985,7 +2953,7 @@ Json::Value RPCHandler::lookupLedger (Json::Value params, Ledger::pointer& lpLed
 //   ledger_index : <ledger_index>
 //   ...
 // }
-Json::Value RPCHandler::doLedgerEntry (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLedgerEntry (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -2993,9 +2961,6 @@ Json::Value RPCHandler::doLedgerEntry (Json::Value params, LoadType* loadType, A
     if (!lpLedger)
         return jvResult;
 
-    if (lpLedger->isImmutable ())
-        masterLockHolder.unlock ();
-
     uint256     uNodeIndex;
     bool        bNodeBinary = false;
 
@@ -3201,7 +3166,7 @@ Json::Value RPCHandler::doLedgerEntry (Json::Value params, LoadType* loadType, A
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
 // }
-Json::Value RPCHandler::doLedgerHeader (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doLedgerHeader (Json::Value params, LoadType* loadType)
 {
     Ledger::pointer     lpLedger;
     Json::Value         jvResult    = lookupLedger (params, lpLedger);
@@ -3243,7 +3208,7 @@ boost::unordered_set<RippleAddress> RPCHandler::parseAccountIds (const Json::Val
     return usnaResult;
 }
 
-Json::Value RPCHandler::doSubscribe (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doSubscribe (Json::Value params, LoadType* loadType)
 {
     InfoSub::pointer ispSub;
     Json::Value jvResult (Json::objectValue);
@@ -3540,7 +3505,7 @@ Json::Value RPCHandler::doSubscribe (Json::Value params, LoadType* loadType, App
 }
 
 // FIXME: This leaks RPCSub objects for JSON-RPC.  Shouldn't matter for anyone sane.
-Json::Value RPCHandler::doUnsubscribe (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Json::Value RPCHandler::doUnsubscribe (Json::Value params, LoadType* loadType)
 {
     InfoSub::pointer ispSub;
     Json::Value jvResult (Json::objectValue);
@@ -3771,7 +3736,36 @@ Json::Value RPCHandler::doRpcCommand (const std::string& strMethod, Json::Value
     return jvResult;
 }
 
-Json::Value RPCHandler::doInternal (Json::Value params, LoadType* loadType, Application::ScopedLockType& masterLockHolder)
+Ledger::pointer RPCHandler::getLedgerDump (Json::Value const& params, int iRole, int& iOptions)
+{
+    // Only requests that doCommand would run successfully are streamed,
+    // so these make the same checks as doCommand and doLedger.
+    if (params["command"].asString () != "ledger" ||
+        (!params.isMember ("ledger") && !params.isMember ("ledger_hash") && !params.isMember ("ledger_index")))
+        return Ledger::pointer ();
+
+    iOptions = getLedgerOptions (params);
+
+    if (!isSetBit (iOptions, LEDGER_JSON_FULL) &&
+        !isSetBit (iOptions, LEDGER_JSON_DUMP_TXRP) &&
+        !isSetBit (iOptions, LEDGER_JSON_DUMP_STATE))
+        return Ledger::pointer ();
+
+    if (checkCommand (*findCommand ("ledger"), iRole) != rpcSUCCESS)
+        return Ledger::pointer ();
+
+    if (isTooBusyForDump (iOptions, iRole))
+        return Ledger::pointer ();
+
+    mRole = iRole;
+
+    Ledger::pointer lpLedger;
+    lookupLedger (params, lpLedger);
+
+    return lpLedger;
+}
+
+Json::Value RPCHandler::doInternal (Json::Value params, LoadType* loadType)
 {
     // Used for debug or special-purpose RPC commands
     if (!params.isMember ("internal_command"))
@@ -3780,7 +3774,87 @@ Json::Value RPCHandler::doInternal (Json::Value params, LoadType* loadType, Appl
     return RPCInternalHandler::runHandler (params["internal_command"].asString (), params["params"]);
 }
 
-Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, LoadType* loadType)
+RPCHandler::Command const* RPCHandler::findCommand (std::string const& strCommand)
+{
+    static Command const commandsA[] =
+    {
+        // Request-response methods
+        {   "account_info",         &RPCHandler::doAccountInfo,         false,  optCurrent                 },
+        {   "account_lines",        &RPCHandler::doAccountLines,        false,  optCurrent                 },
+        {   "account_offers",       &RPCHandler::doAccountOffers,       false,  optCurrent                 },
+        {   "account_tx",           &RPCHandler::doAccountTxSwitch,     false,  optNetwork                 },
+        {   "blacklist",            &RPCHandler::doBlackList,           true,   optNone                    },
+        {   "book_offers",          &RPCHandler::doBookOffers,          false,  optCurrent                 },
+        {   "connect",              &RPCHandler::doConnect,             true,   optMasterLock              },
+        {   "consensus_info",       &RPCHandler::doConsensusInfo,       true,   optMasterLock              },
+        {   "get_counts",           &RPCHandler::doGetCounts,           true,   optMasterLock              },
+        {   "internal",             &RPCHandler::doInternal,            true,   optMasterLock              },
+        {   "feature",              &RPCHandler::doFeature,             true,   optMasterLock              },
+        {   "fetch_info",           &RPCHandler::doFetchInfo,           true,   optNone                    },
+        {   "ledger",               &RPCHandler::doLedger,              false,  optNetwork                 },
+        {   "ledger_accept",        &RPCHandler::doLedgerAccept,        true,   optCurrent | optMasterLock },
+        {   "ledger_closed",        &RPCHandler::doLedgerClosed,        false,  optClosed                  },
+        {   "ledger_current",       &RPCHandler::doLedgerCurrent,       false,  optCurrent                 },
+        {   "ledger_entry",         &RPCHandler::doLedgerEntry,         false,  optCurrent                 },
+        {   "ledger_header",        &RPCHandler::doLedgerHeader,        false,  optCurrent                 },
+        {   "log_level",            &RPCHandler::doLogLevel,            true,   optMasterLock              },
+        {   "logrotate",            &RPCHandler::doLogRotate,           true,   optMasterLock              },
+//      {   "nickname_info",        &RPCHandler::doNicknameInfo,        false,  optCurrent                 },
+        {   "owner_info",           &RPCHandler::doOwnerInfo,           false,  optCurrent                 },
+        {   "peers",                &RPCHandler::doPeers,               true,   optNone                    },
+        {   "path_find",            &RPCHandler::doPathFind,            false,  optCurrent                 },
+        {   "ping",                 &RPCHandler::doPing,                false,  optNone                    },
+        {   "print",                &RPCHandler::doPrint,               true,   optNone                    },
+//      {   "profile",              &RPCHandler::doProfile,             false,  optCurrent                 },
+        {   "proof_create",         &RPCHandler::doProofCreate,         true,   optNone                    },
+        {   "proof_solve",          &RPCHandler::doProofSolve,          true,   optNone                    },
+        {   "proof_verify",         &RPCHandler::doProofVerify,         true,   optNone                    },
+        {   "random",               &RPCHandler::doRandom,              false,  optNone                    },
+        {   "ripple_path_find",     &RPCHandler::doRipplePathFind,      false,  optCurrent                 },
+        {   "sign",                 &RPCHandler::doSign,                false,  optNone                    },
+        {   "submit",               &RPCHandler::doSubmit,              false,  optCurrent                 },
+        {   "server_info",          &RPCHandler::doServerInfo,          false,  optMasterLock              },
+        {   "server_state",         &RPCHandler::doServerState,         false,  optMasterLock              },
+        {   "sms",                  &RPCHandler::doSMS,                 true,   optMasterLock              },
+        {   "stop",                 &RPCHandler::doStop,                true,   optMasterLock              },
+        {   "transaction_entry",    &RPCHandler::doTransactionEntry,    false,  optCurrent                 },
+        {   "tx",                   &RPCHandler::doTx,                  false,  optNetwork                 },
+        {   "tx_history",           &RPCHandler::doTxHistory,           false,  optNone                    },
+        {   "unl_add",              &RPCHandler::doUnlAdd,              true,   optMasterLock              },
+        {   "unl_delete",           &RPCHandler::doUnlDelete,           true,   optMasterLock              },
+        {   "unl_list",             &RPCHandler::doUnlList,             true,   optMasterLock              },
+        {   "unl_load",             &RPCHandler::doUnlLoad,             true,   optMasterLock              },
+        {   "unl_network",          &RPCHandler::doUnlNetwork,          true,   optMasterLock              },
+        {   "unl_reset",            &RPCHandler::doUnlReset,            true,   optMasterLock              },
+        {   "unl_score",            &RPCHandler::doUnlScore,            true,   optMasterLock              },
+        {   "validation_create",    &RPCHandler::doValidationCreate,    true,   optMasterLock              },
+        {   "validation_seed",      &RPCHandler::doValidationSeed,      true,   optMasterLock              },
+        {   "wallet_accounts",      &RPCHandler::doWalletAccounts,      false,  optCurrent                 },
+        {   "wallet_propose",       &RPCHandler::doWalletPropose,       true,   optNone                    },
+        {   "wallet_seed",          &RPCHandler::doWalletSeed,          true,   optMasterLock              },
+
+#if ENABLE_INSECURE
+        // XXX Unnecessary commands which should be removed.
+        {   "login",                &RPCHandler::doLogin,               true,   optMasterLock              },
+        {   "data_delete",          &RPCHandler::doDataDelete,          true,   optMasterLock              },
+        {   "data_fetch",           &RPCHandler::doDataFetch,           true,   optMasterLock              },
+        {   "data_store",           &RPCHandler::doDataStore,           true,   optMasterLock              },
+#endif
+
+        // Evented methods
+        {   "subscribe",            &RPCHandler::doSubscribe,           false,  optMasterLock              },
+        {   "unsubscribe",          &RPCHandler::doUnsubscribe,         false,  optMasterLock              },
+    };
+
+    int     i = NUMBER (commandsA);
+
+    while (i-- && strCommand != commandsA[i].pCommand)
+        ;
+
+    return (i < 0) ? nullptr : &commandsA[i];
+}
+
+int RPCHandler::checkCommand (Command const& command, int iRole)
 {
     if (iRole != Config::ADMIN)
     {
@@ -3791,10 +3865,36 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, LoadTyp
         if (jc > 500)
         {
             WriteLog (lsDEBUG, RPCHandler) << "Too busy for command: " << jc;
-            return rpcError (rpcTOO_BUSY);
+            return rpcTOO_BUSY;
         }
     }
 
+    if (command.bAdminRequired && iRole != Config::ADMIN)
+    {
+        return rpcNO_PERMISSION;
+    }
+
+    if ((command.iOptions & optNetwork) && (mNetOps->getOperatingMode () < NetworkOPs::omSYNCING))
+    {
+        WriteLog (lsINFO, RPCHandler) << "Insufficient network mode for RPC: " << mNetOps->strOperatingMode ();
+
+        return rpcNO_NETWORK;
+    }
+
+    if (!getConfig ().RUN_STANDALONE && (command.iOptions & optCurrent) && (getApp().getLedgerMaster().getValidatedLedgerAge() > 120))
+    {
+        return rpcNO_CURRENT;
+    }
+    else if ((command.iOptions & optClosed) && !mNetOps->getClosedLedger ())
+    {
+        return rpcNO_CLOSED;
+    }
+
+    return rpcSUCCESS;
+}
+
+Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, LoadType* loadType)
+{
     if (!params.isMember ("command"))
         return rpcError (rpcCOMMAND_MISSING);
 
@@ -3805,148 +3905,53 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, LoadTyp
 
     mRole   = iRole;
 
-    static struct
-    {
-        const char*     pCommand;
-        doFuncPtr       dfpFunc;
-        bool            bAdminRequired;
-        unsigned int    iOptions;
-    } commandsA[] =
-    {
-        // Request-response methods
-        {   "account_info",         &RPCHandler::doAccountInfo,         false,  optCurrent  },
-        {   "account_lines",        &RPCHandler::doAccountLines,        false,  optCurrent  },
-        {   "account_offers",       &RPCHandler::doAccountOffers,       false,  optCurrent  },
-        {   "account_tx",           &RPCHandler::doAccountTxSwitch,     false,  optNetwork  },
-        {   "blacklist",            &RPCHandler::doBlackList,           true,   optNone     },
-        {   "book_offers",          &RPCHandler::doBookOffers,          false,  optCurrent  },
-        {   "connect",              &RPCHandler::doConnect,             true,   optNone     },
-        {   "consensus_info",       &RPCHandler::doConsensusInfo,       true,   optNone     },
-        {   "get_counts",           &RPCHandler::doGetCounts,           true,   optNone     },
-        {   "internal",             &RPCHandler::doInternal,            true,   optNone     },
-        {   "feature",              &RPCHandler::doFeature,             true,   optNone     },
-        {   "fetch_info",           &RPCHandler::doFetchInfo,           true,   optNone     },
-        {   "ledger",               &RPCHandler::doLedger,              false,  optNetwork  },
-        {   "ledger_accept",        &RPCHandler::doLedgerAccept,        true,   optCurrent  },
-        {   "ledger_closed",        &RPCHandler::doLedgerClosed,        false,  optClosed   },
-        {   "ledger_current",       &RPCHandler::doLedgerCurrent,       false,  optCurrent  },
-        {   "ledger_entry",         &RPCHandler::doLedgerEntry,         false,  optCurrent  },
-        {   "ledger_header",        &RPCHandler::doLedgerHeader,        false,  optCurrent  },
-        {   "log_level",            &RPCHandler::doLogLevel,            true,   optNone     },
-        {   "logrotate",            &RPCHandler::doLogRotate,           true,   optNone     },
-//      {   "nickname_info",        &RPCHandler::doNicknameInfo,        false,  optCurrent  },
-        {   "owner_info",           &RPCHandler::doOwnerInfo,           false,  optCurrent  },
-        {   "peers",                &RPCHandler::doPeers,               true,   optNone     },
-        {   "path_find",            &RPCHandler::doPathFind,            false,  optCurrent  },
-        {   "ping",                 &RPCHandler::doPing,                false,  optNone     },
-        {   "print",                &RPCHandler::doPrint,               true,   optNone     },
-//      {   "profile",              &RPCHandler::doProfile,             false,  optCurrent  },
-        {   "proof_create",         &RPCHandler::doProofCreate,         true,   optNone     },
-        {   "proof_solve",          &RPCHandler::doProofSolve,          true,   optNone     },
-        {   "proof_verify",         &RPCHandler::doProofVerify,         true,   optNone     },
-        {   "random",               &RPCHandler::doRandom,              false,  optNone     },
-        {   "ripple_path_find",     &RPCHandler::doRipplePathFind,      false,  optCurrent  },
-        {   "sign",                 &RPCHandler::doSign,                false,  optNone     },
-        {   "submit",               &RPCHandler::doSubmit,              false,  optCurrent  },
-        {   "server_info",          &RPCHandler::doServerInfo,          false,  optNone     },
-        {   "server_state",         &RPCHandler::doServerState,         false,  optNone     },
-        {   "sms",                  &RPCHandler::doSMS,                 true,   optNone     },
-        {   "stop",                 &RPCHandler::doStop,                true,   optNone     },
-        {   "transaction_entry",    &RPCHandler::doTransactionEntry,    false,  optCurrent  },
-        {   "tx",                   &RPCHandler::doTx,                  false,  optNetwork  },
-        {   "tx_history",           &RPCHandler::doTxHistory,           false,  optNone     },
-        {   "unl_add",              &RPCHandler::doUnlAdd,              true,   optNone     },
-        {   "unl_delete",           &RPCHandler::doUnlDelete,           true,   optNone     },
-        {   "unl_list",             &RPCHandler::doUnlList,             true,   optNone     },
-        {   "unl_load",             &RPCHandler::doUnlLoad,             true,   optNone     },
-        {   "unl_network",          &RPCHandler::doUnlNetwork,          true,   optNone     },
-        {   "unl_reset",            &RPCHandler::doUnlReset,            true,   optNone     },
-        {   "unl_score",            &RPCHandler::doUnlScore,            true,   optNone     },
-        {   "validation_create",    &RPCHandler::doValidationCreate,    true,   optNone     },
-        {   "validation_seed",      &RPCHandler::doValidationSeed,      true,   optNone     },
-        {   "wallet_accounts",      &RPCHandler::doWalletAccounts,      false,  optCurrent  },
-        {   "wallet_propose",       &RPCHandler::doWalletPropose,       true,   optNone     },
-        {   "wallet_seed",          &RPCHandler::doWalletSeed,          true,   optNone     },
-
-#if ENABLE_INSECURE
-        // XXX Unnecessary commands which should be removed.
-        {   "login",                &RPCHandler::doLogin,               true,   optNone     },
-        {   "data_delete",          &RPCHandler::doDataDelete,          true,   optNone     },
-        {   "data_fetch",           &RPCHandler::doDataFetch,           true,   optNone     },
-        {   "data_store",           &RPCHandler::doDataStore,           true,   optNone     },
-#endif
-
-        // Evented methods
-        {   "subscribe",            &RPCHandler::doSubscribe,           false,  optNone     },
-        {   "unsubscribe",          &RPCHandler::doUnsubscribe,         false,  optNone     },
-    };
+    Command const* command = findCommand (strCommand);
 
-    int     i = NUMBER (commandsA);
+    if (!command)
+        return rpcError (rpcUNKNOWN_COMMAND);
 
-    while (i-- && strCommand != commandsA[i].pCommand)
-        ;
+    int const error = checkCommand (*command, iRole);
 
-    if (i < 0)
-    {
-        return rpcError (rpcUNKNOWN_COMMAND);
-    }
-    else if (commandsA[i].bAdminRequired && mRole != Config::ADMIN)
-    {
-        return rpcError (rpcNO_PERMISSION);
-    }
+    if (error != rpcSUCCESS)
+        return rpcError (error);
 
+    try
     {
-        Application::ScopedLockType lock (getApp().getMasterLock (), __FILE__, __LINE__);
+        LoadEvent::autoptr ev   = getApp().getJobQueue().getLoadEventAP(
+            jtGENERIC, std::string("cmd:") + strCommand);
+        beast::ScopedPointer <Application::ScopedLockType> lock;
 
-        if ((commandsA[i].iOptions & optNetwork) && (mNetOps->getOperatingMode () < NetworkOPs::omSYNCING))
-        {
-            WriteLog (lsINFO, RPCHandler) << "Insufficient network mode for RPC: " << mNetOps->strOperatingMode ();
+        // Commands without the master lock run against immutable ledgers only, see lookupLedger
+        if (command->iOptions & optMasterLock)
+            lock = new Application::ScopedLockType (getApp().getMasterLock (), __FILE__, __LINE__);
 
-            return rpcError (rpcNO_NETWORK);
-        }
+        Json::Value jvRaw   = (this->* (command->dfpFunc)) (params, loadType);
+        lock = nullptr;
 
-        if (!getConfig ().RUN_STANDALONE && (commandsA[i].iOptions & optCurrent) && (getApp().getLedgerMaster().getValidatedLedgerAge() > 120))
-        {
-            return rpcError (rpcNO_CURRENT);
-        }
-        else if ((commandsA[i].iOptions & optClosed) && !mNetOps->getClosedLedger ())
+        // Regularize result.
+        if (jvRaw.isObject ())
         {
-            return rpcError (rpcNO_CLOSED);
+            // Got an object.
+            return jvRaw;
         }
         else
         {
-            try
-            {
-                LoadEvent::autoptr ev   = getApp().getJobQueue().getLoadEventAP(
-                    jtGENERIC, std::string("cmd:") + strCommand);
-                Json::Value jvRaw       = (this->* (commandsA[i].dfpFunc)) (params, loadType, lock);
+            // Probably got a string.
+            Json::Value jvResult (Json::objectValue);
 
-                // Regularize result.
-                if (jvRaw.isObject ())
-                {
-                    // Got an object.
-                    return jvRaw;
-                }
-                else
-                {
-                    // Probably got a string.
-                    Json::Value jvResult (Json::objectValue);
+            jvResult["message"] = jvRaw;
 
-                    jvResult["message"] = jvRaw;
-
-                    return jvResult;
-                }
-            }
-            catch (std::exception& e)
-            {
-                WriteLog (lsINFO, RPCHandler) << "Caught throw: " << e.what ();
+            return jvResult;
+        }
+    }
+    catch (std::exception& e)
+    {
+        WriteLog (lsINFO, RPCHandler) << "Caught throw: " << e.what ();
 
-                if (*loadType == LT_RPCReference)
-                    *loadType = LT_RPCException;
+        if (*loadType == LT_RPCReference)
+            *loadType = LT_RPCException;
 
-                return rpcError (rpcINTERNAL);
-            }
-        }
+        return rpcError (rpcINTERNAL);
     }
 }
 
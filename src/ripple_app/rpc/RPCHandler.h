@@ -42,11 +42,18 @@ public:
 
     Json::Value doRpcCommand    (const std::string& strCommand, Json::Value const& jvParams, int iRole, LoadType* loadType);
 
+    /** Look up the ledger for a request that dumps its transactions or state.
+
+        Such a reply can be written with Ledger::writeJson instead of being
+        built in memory. Returns null when the request should be handled by
+        doCommand instead, which also reports any error.
+    */
+    Ledger::pointer getLedgerDump (Json::Value const& params, int iRole, int& iOptions);
+
 private:
     typedef Json::Value (RPCHandler::*doFuncPtr) (
         Json::Value params,
-        LoadType* loadType,
-        Application::ScopedLockType& MasterLockHolder);
+        LoadType* loadType);
 
     // VFALCO TODO Document these and give the enumeration a label.
     enum
@@ -55,15 +62,33 @@ private:
         optNetwork  = 1,                // Need network
         optCurrent  = 2 + optNetwork,   // Need current ledger
         optClosed   = 4 + optNetwork,   // Need closed ledger
+
+        // Run the handler while holding the master lock. Commands without
+        // this flag must only read from immutable ledgers.
+        optMasterLock = 8,
+    };
+
+    struct Command
+    {
+        const char*     pCommand;
+        doFuncPtr       dfpFunc;
+        bool            bAdminRequired;
+        unsigned int    iOptions;
     };
 
+    // Returns the table entry for a command, or null if there is none
+    static Command const* findCommand (std::string const& strCommand);
+
+    // Returns the error that keeps a command from running now, or rpcSUCCESS
+    int checkCommand (Command const& command, int iRole);
+
     // Utilities
 
     void addSubmitPath (Json::Value& txJSON);
 
     boost::unordered_set <RippleAddress> parseAccountIds (const Json::Value& jvArray);
 
-    Json::Value transactionSign (Json::Value jvRequest, bool bSubmit, bool bFailHard, Application::ScopedLockType& mlh);
+    Json::Value transactionSign (Json::Value jvRequest, bool bSubmit, bool bFailHard);
 
     Json::Value lookupLedger (Json::Value jvRequest, Ledger::pointer& lpLedger);
 
@@ -95,75 +120,75 @@ private:
         const int iIndex,
         const bool bStrict);
 
-    Json::Value doAccountInfo           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doAccountLines          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doAccountOffers         (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doAccountTx             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doAccountTxSwitch       (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doAccountTxOld          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doBookOffers            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doBlackList             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doConnect               (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doConsensusInfo         (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doFeature               (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doFetchInfo             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doGetCounts             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doInternal              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedger                (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedgerAccept          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedgerClosed          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedgerCurrent         (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedgerEntry           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLedgerHeader          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLogLevel              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLogRotate             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doNicknameInfo          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doOwnerInfo             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doPathFind              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doPeers                 (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doPing                  (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doPrint                 (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doProfile               (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doProofCreate           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doProofSolve            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doProofVerify           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doRandom                (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doRipplePathFind        (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doSMS                   (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doServerInfo            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh); // for humans
-    Json::Value doServerState           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh); // for machines
-    Json::Value doSessionClose          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doSessionOpen           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doSign                  (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doStop                  (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doSubmit                (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doSubscribe             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doTransactionEntry      (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doTx                    (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doTxHistory             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlAdd                (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlDelete             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlFetch              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlList               (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlLoad               (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlNetwork            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlReset              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnlScore              (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doUnsubscribe           (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doValidationCreate      (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doValidationSeed        (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletAccounts        (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletLock            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletPropose         (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletSeed            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletUnlock          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doWalletVerify          (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
+    Json::Value doAccountInfo           (Json::Value params, LoadType* loadType);
+    Json::Value doAccountLines          (Json::Value params, LoadType* loadType);
+    Json::Value doAccountOffers         (Json::Value params, LoadType* loadType);
+    Json::Value doAccountTx             (Json::Value params, LoadType* loadType);
+    Json::Value doAccountTxSwitch       (Json::Value params, LoadType* loadType);
+    Json::Value doAccountTxOld          (Json::Value params, LoadType* loadType);
+    Json::Value doBookOffers            (Json::Value params, LoadType* loadType);
+    Json::Value doBlackList             (Json::Value params, LoadType* loadType);
+    Json::Value doConnect               (Json::Value params, LoadType* loadType);
+    Json::Value doConsensusInfo         (Json::Value params, LoadType* loadType);
+    Json::Value doFeature               (Json::Value params, LoadType* loadType);
+    Json::Value doFetchInfo             (Json::Value params, LoadType* loadType);
+    Json::Value doGetCounts             (Json::Value params, LoadType* loadType);
+    Json::Value doInternal              (Json::Value params, LoadType* loadType);
+    Json::Value doLedger                (Json::Value params, LoadType* loadType);
+    Json::Value doLedgerAccept          (Json::Value params, LoadType* loadType);
+    Json::Value doLedgerClosed          (Json::Value params, LoadType* loadType);
+    Json::Value doLedgerCurrent         (Json::Value params, LoadType* loadType);
+    Json::Value doLedgerEntry           (Json::Value params, LoadType* loadType);
+    Json::Value doLedgerHeader          (Json::Value params, LoadType* loadType);
+    Json::Value doLogLevel              (Json::Value params, LoadType* loadType);
+    Json::Value doLogRotate             (Json::Value params, LoadType* loadType);
+    Json::Value doNicknameInfo          (Json::Value params, LoadType* loadType);
+    Json::Value doOwnerInfo             (Json::Value params, LoadType* loadType);
+    Json::Value doPathFind              (Json::Value params, LoadType* loadType);
+    Json::Value doPeers                 (Json::Value params, LoadType* loadType);
+    Json::Value doPing                  (Json::Value params, LoadType* loadType);
+    Json::Value doPrint                 (Json::Value params, LoadType* loadType);
+    Json::Value doProfile               (Json::Value params, LoadType* loadType);
+    Json::Value doProofCreate           (Json::Value params, LoadType* loadType);
+    Json::Value doProofSolve            (Json::Value params, LoadType* loadType);
+    Json::Value doProofVerify           (Json::Value params, LoadType* loadType);
+    Json::Value doRandom                (Json::Value params, LoadType* loadType);
+    Json::Value doRipplePathFind        (Json::Value params, LoadType* loadType);
+    Json::Value doSMS                   (Json::Value params, LoadType* loadType);
+    Json::Value doServerInfo            (Json::Value params, LoadType* loadType); // for humans
+    Json::Value doServerState           (Json::Value params, LoadType* loadType); // for machines
+    Json::Value doSessionClose          (Json::Value params, LoadType* loadType);
+    Json::Value doSessionOpen           (Json::Value params, LoadType* loadType);
+    Json::Value doSign                  (Json::Value params, LoadType* loadType);
+    Json::Value doStop                  (Json::Value params, LoadType* loadType);
+    Json::Value doSubmit                (Json::Value params, LoadType* loadType);
+    Json::Value doSubscribe             (Json::Value params, LoadType* loadType);
+    Json::Value doTransactionEntry      (Json::Value params, LoadType* loadType);
+    Json::Value doTx                    (Json::Value params, LoadType* loadType);
+    Json::Value doTxHistory             (Json::Value params, LoadType* loadType);
+    Json::Value doUnlAdd                (Json::Value params, LoadType* loadType);
+    Json::Value doUnlDelete             (Json::Value params, LoadType* loadType);
+    Json::Value doUnlFetch              (Json::Value params, LoadType* loadType);
+    Json::Value doUnlList               (Json::Value params, LoadType* loadType);
+    Json::Value doUnlLoad               (Json::Value params, LoadType* loadType);
+    Json::Value doUnlNetwork            (Json::Value params, LoadType* loadType);
+    Json::Value doUnlReset              (Json::Value params, LoadType* loadType);
+    Json::Value doUnlScore              (Json::Value params, LoadType* loadType);
+    Json::Value doUnsubscribe           (Json::Value params, LoadType* loadType);
+    Json::Value doValidationCreate      (Json::Value params, LoadType* loadType);
+    Json::Value doValidationSeed        (Json::Value params, LoadType* loadType);
+    Json::Value doWalletAccounts        (Json::Value params, LoadType* loadType);
+    Json::Value doWalletLock            (Json::Value params, LoadType* loadType);
+    Json::Value doWalletPropose         (Json::Value params, LoadType* loadType);
+    Json::Value doWalletSeed            (Json::Value params, LoadType* loadType);
+    Json::Value doWalletUnlock          (Json::Value params, LoadType* loadType);
+    Json::Value doWalletVerify          (Json::Value params, LoadType* loadType);
 
 #if ENABLE_INSECURE
-    Json::Value doDataDelete            (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doDataFetch             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doDataStore             (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
-    Json::Value doLogin                 (Json::Value params, LoadType* loadType, Application::ScopedLockType& mlh);
+    Json::Value doDataDelete            (Json::Value params, LoadType* loadType);
+    Json::Value doDataFetch             (Json::Value params, LoadType* loadType);
+    Json::Value doDataStore             (Json::Value params, LoadType* loadType);
+    Json::Value doLogin                 (Json::Value params, LoadType* loadType);
 #endif
 
 private:
@@ -37,6 +37,18 @@ bool RPCServerHandler::isAuthorized (
 }
 
 std::string RPCServerHandler::processRequest (std::string const& request, std::string const& remoteAddress)
+{
+    return processRequest (request, remoteAddress, nullptr);
+}
+
+std::string RPCServerHandler::processRequest (std::string const& request, std::string const& remoteAddress,
+                                              Json::StreamWriter::Sink& sink)
+{
+    return processRequest (request, remoteAddress, &sink);
+}
+
+std::string RPCServerHandler::processRequest (std::string const& request, std::string const& remoteAddress,
+                                              Json::StreamWriter::Sink* sink)
 {
     Json::Value jvRequest;
     {
@@ -107,6 +119,41 @@ std::string RPCServerHandler::processRequest (std::string const& request, std::s
 
     RPCHandler rpcHandler (&m_networkOPs);
 
+    if (sink != nullptr && params.size () == 1 && params[0u].isObject ())
+    {
+        Json::Value dumpParams = params[0u];
+        dumpParams["command"] = strMethod;
+
+        int options = 0;
+        Ledger::pointer ledger = rpcHandler.getLedgerDump (dumpParams, role, options);
+
+        if (ledger)
+        {
+            std::string const header (HTTPStreamHeader ());
+            sink->write (header.data (), header.size ());
+
+            // Once the header is out, a failure can only cut the reply short
+            try
+            {
+                Json::StreamWriter writer (*sink);
+
+                writer.startObject ();
+                writer.startObject ("result");
+                ledger->writeJson (writer, options);
+                writer.write ("status", "success");
+                writer.endObject ();
+                writer.endObject ();
+                writer.flush ();
+            }
+            catch (std::exception& e)
+            {
+                WriteLog (lsWARNING, RPCServer) << "Streamed reply failed: " << e.what ();
+            }
+
+            return std::string ();
+        }
+    }
+
     LoadType loadType = LT_RPCReference;
 
     Json::Value const result = rpcHandler.doRpcCommand (strMethod, params, role, &loadType);
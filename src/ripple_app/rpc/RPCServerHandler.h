@@ -36,7 +36,18 @@ public:
 
     std::string processRequest (std::string const& request, std::string const& remoteAddress);
 
+    /** Process a request, streaming large replies as they are produced.
+
+        Ledger dumps are written to the sink, HTTP header included, and an
+        empty string is returned. Any other reply is returned as usual.
+    */
+    std::string processRequest (std::string const& request, std::string const& remoteAddress,
+                                Json::StreamWriter::Sink& sink);
+
 private:
+    std::string processRequest (std::string const& request, std::string const& remoteAddress,
+                                Json::StreamWriter::Sink* sink);
+
     NetworkOPs& m_networkOPs;
 };
 
@@ -73,13 +73,15 @@ SHAMap::SHAMap (SHAMapType t, uint32 seq)
     , mLedgerSeq (0)
     , mState (smsModifying)
     , mType (t)
+    , mDeferHashes (false)
+    , mDeferredChanges (0)
 {
     if (t == smtSTATE)
         mTNByID.rehash (STATE_MAP_BUCKETS);
 
     root = boost::make_shared<SHAMapTreeNode> (mSeq, SHAMapNode (0, uint256 ()));
     root->makeInner ();
-    mTNByID[*root] = root;
+    mTNByID.set (*root, root);
 }
 
 SHAMap::SHAMap (SHAMapType t, uint256 const& hash)
@@ -88,6 +90,8 @@ SHAMap::SHAMap (SHAMapType t, uint256 const& hash)
     , mLedgerSeq (0)
     , mState (smsSynching)
     , mType (t)
+    , mDeferHashes (false)
+    , mDeferredChanges (0)
 {
     // FIXME: Need to acquire root node
     if (t == smtSTATE)
@@ -95,19 +99,25 @@ SHAMap::SHAMap (SHAMapType t, uint256 const& hash)
 
     root = boost::make_shared<SHAMapTreeNode> (mSeq, SHAMapNode (0, uint256 ()));
     root->makeInner ();
-    mTNByID[*root] = root;
+    mTNByID.set (*root, root);
 }
 
 SHAMap::pointer SHAMap::snapShot (bool isMutable)
 {
     // Return a new SHAMap that is an immutable snapshot of this one
     // Initially nodes are shared, but CoW is forced on both ledgers
+    // The node index is shared too, each map only indexes its own changes
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    // Shared nodes must not be dirty
+    flushHashes ();
+
     SHAMap::pointer ret = boost::make_shared<SHAMap> (mType);
     SHAMap& newMap = *ret;
     newMap.mSeq = ++mSeq;
-    newMap.mTNByID = mTNByID;
+    mTNByID.shareWith (newMap.mTNByID);
     newMap.root = root;
+    newMap.mDeferHashes = mDeferHashes;
 
     if (!isMutable)
         newMap.mState = smsImmutable;
@@ -156,6 +166,27 @@ void SHAMap::dirtyUp (std::stack<SHAMapTreeNode::pointer>& stack, uint256 const&
 
     assert ((mState != smsSynching) && (mState != smsImmutable));
 
+    if (mDeferHashes)
+    {
+        // Just mark the path, flushHashes will compute the hashes
+        ++mDeferredChanges;
+
+        while (!stack.empty ())
+        {
+            SHAMapTreeNode::pointer node = stack.top ();
+            stack.pop ();
+            assert (node->isInnerNode ());
+
+            int branch = node->selectBranch (target);
+            assert (branch >= 0);
+
+            returnNode (node, true);
+            node->setChildDirty (branch);
+        }
+
+        return;
+    }
+
     while (!stack.empty ())
     {
         SHAMapTreeNode::pointer node = stack.top ();
@@ -184,13 +215,13 @@ void SHAMap::dirtyUp (std::stack<SHAMapTreeNode::pointer>& stack, uint256 const&
 
 SHAMapTreeNode::pointer SHAMap::checkCacheNode (const SHAMapNode& iNode)
 {
-    boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer>::iterator it = mTNByID.find (iNode);
+    SHAMapTreeNode::pointer const* node = mTNByID.find (iNode);
 
-    if (it == mTNByID.end ())
+    if (node == nullptr)
         return SHAMapTreeNode::pointer ();
 
-    it->second->touch (mSeq);
-    return it->second;
+    (*node)->touch (mSeq);
+    return *node;
 }
 
 SHAMapTreeNode::pointer SHAMap::walkTo (uint256 const& id, bool modify)
@@ -253,7 +284,8 @@ SHAMapTreeNode::pointer SHAMap::getNode (const SHAMapNode& id, uint256 const& ha
     {
 #if BEAST_DEBUG
 
-        if (node->getNodeHash () != hash)
+        // Hashes are out of date until deferred hashing is flushed
+        if ((node->getNodeHash () != hash) && !root->isHashDirty ())
         {
             WriteLog (lsFATAL, SHAMap) << "Attempt to get node, hash not in tree";
             WriteLog (lsFATAL, SHAMap) << "ID: " << id;
@@ -284,10 +316,10 @@ SHAMapTreeNode* SHAMap::getNodePointer (const SHAMapNode& id, uint256 const& has
 SHAMapTreeNode* SHAMap::getNodePointerNT (const SHAMapNode& id, uint256 const& hash)
 {
     // fast, but you do not hold a reference
-    boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer>::iterator it = mTNByID.find (id);
+    SHAMapTreeNode::pointer const* node = mTNByID.find (id);
 
-    if (it != mTNByID.end ())
-        return it->second.get ();
+    if (node != nullptr)
+        return node->get ();
 
     return fetchNodeExternalNT (id, hash).get ();
 }
@@ -314,7 +346,7 @@ SHAMapTreeNode* SHAMap::getNodePointerNT (const SHAMapNode& id, uint256 const& h
         {
             SHAMapTreeNode::pointer node = boost::make_shared<SHAMapTreeNode> (
                                                boost::cref (id), boost::cref (nodeData), mSeq - 1, snfPREFIX, boost::cref (hash), true);
-            mTNByID[id] = node;
+            mTNByID.set (id, node);
             filter->gotNode (true, id, hash, nodeData, node->getType ());
             return node.get ();
         }
@@ -338,7 +370,7 @@ void SHAMap::returnNode (SHAMapTreeNode::pointer& node, bool modify)
         node = boost::make_shared<SHAMapTreeNode> (*node, mSeq); // here's to the new node, same as the old node
         assert (node->isValid ());
 
-        mTNByID[*node] = node;
+        mTNByID.set (*node, node);
 
         if (node->isRoot ())
             root = node;
@@ -461,7 +493,7 @@ void SHAMap::eraseChildren (SHAMapTreeNode::pointer node)
 
     returnNode (node, true);
 
-    if (mTNByID.erase (*node) == 0)
+    if (!mTNByID.erase (*node))
         assert (false);
 
     return;
@@ -654,10 +686,14 @@ bool SHAMap::delItem (uint256 const& id)
     SHAMapTreeNode::TNType type = leaf->getType ();
     returnNode (leaf, true);
 
-    if (mTNByID.erase (*leaf) == 0)
+    if (!mTNByID.erase (*leaf))
         assert (false);
 
     uint256 prevHash;
+    bool prevDirty = false;
+
+    if (mDeferHashes)
+        ++mDeferredChanges;
 
     while (!stack.empty ())
     {
@@ -666,7 +702,13 @@ bool SHAMap::delItem (uint256 const& id)
         returnNode (node, true);
         assert (node->isInner ());
 
-        if (!node->setChildHash (node->selectBranch (id), prevHash))
+        if (prevDirty)
+        {
+            // The child's hash is computed when the hashes are flushed
+            node->setChildDirty (node->selectBranch (id));
+        }
+        // A node with dirty branches is hashed later, so keep going up
+        else if (!node->setChildHash (node->selectBranch (id), prevHash) && !node->isHashDirty ())
         {
             assert (false);
             return true;
@@ -680,6 +722,7 @@ bool SHAMap::delItem (uint256 const& id)
             if (bc == 0)
             {
                 prevHash = uint256 ();
+                prevDirty = false;
 
                 if (!mTNByID.erase (*node))
                     assert (false);
@@ -697,12 +740,14 @@ bool SHAMap::delItem (uint256 const& id)
                 }
 
                 prevHash = node->getNodeHash ();
-                assert (prevHash.isNonZero ());
+                prevDirty = node->isHashDirty ();
+                assert (prevDirty || prevHash.isNonZero ());
             }
             else
             {
                 prevHash = node->getNodeHash ();
-                assert (prevHash.isNonZero ());
+                prevDirty = node->isHashDirty ();
+                assert (prevDirty || prevHash.isNonZero ());
             }
         }
         else assert (stack.empty ());
@@ -743,7 +788,7 @@ bool SHAMap::addGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasMeta
         SHAMapTreeNode::pointer newNode =
             boost::make_shared<SHAMapTreeNode> (node->getChildNodeID (branch), item, type, mSeq);
 
-        if (!mTNByID.emplace (SHAMapNode (*newNode), newNode).second)
+        if (!mTNByID.insert (*newNode, newNode))
         {
             WriteLog (lsFATAL, SHAMap) << "Node: " << *node;
             WriteLog (lsFATAL, SHAMap) << "NewNode: " << *newNode;
@@ -753,7 +798,7 @@ bool SHAMap::addGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasMeta
         }
 
         trackNewNode (newNode);
-        node->setChildHash (branch, newNode->getNodeHash ());
+        setChildNode (node, branch, newNode);
     }
     else
     {
@@ -772,7 +817,7 @@ bool SHAMap::addGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasMeta
                 boost::make_shared<SHAMapTreeNode> (mSeq, node->getChildNodeID (b1));
             newNode->makeInner ();
 
-            if (!mTNByID.emplace (SHAMapNode (*newNode), newNode).second)
+            if (!mTNByID.insert (*newNode, newNode))
                 assert (false);
 
             stack.push (node);
@@ -786,19 +831,19 @@ bool SHAMap::addGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasMeta
             boost::make_shared<SHAMapTreeNode> (node->getChildNodeID (b1), item, type, mSeq);
         assert (newNode->isValid () && newNode->isLeaf ());
 
-        if (!mTNByID.emplace (SHAMapNode (*newNode), newNode).second)
+        if (!mTNByID.insert (*newNode, newNode))
             assert (false);
 
-        node->setChildHash (b1, newNode->getNodeHash ()); // OPTIMIZEME hash op not needed
+        setChildNode (node, b1, newNode);
         trackNewNode (newNode);
 
         newNode = boost::make_shared<SHAMapTreeNode> (node->getChildNodeID (b2), otherItem, type, mSeq);
         assert (newNode->isValid () && newNode->isLeaf ());
 
-        if (!mTNByID.emplace (SHAMapNode (*newNode), newNode).second)
+        if (!mTNByID.insert (*newNode, newNode))
             assert (false);
 
-        node->setChildHash (b2, newNode->getNodeHash ());
+        setChildNode (node, b2, newNode);
         trackNewNode (newNode);
     }
 
@@ -904,8 +949,8 @@ SHAMapTreeNode::pointer SHAMap::fetchNodeExternalNT (const SHAMapNode& id, uint2
         }
 
         if (id.isRoot ())
-            mTNByID[id] = ret;
-        else if (!mTNByID.emplace (id, ret).second)
+            mTNByID.set (id, ret);
+        else if (!mTNByID.insert (id, ret))
             assert (false);
 
         trackNewNode (ret);
@@ -948,7 +993,7 @@ bool SHAMap::fetchRoot (uint256 const& hash, SHAMapSyncFilter* filter)
 
         root = boost::make_shared<SHAMapTreeNode> (SHAMapNode (), nodeData,
                 mSeq - 1, snfPREFIX, hash, true);
-        mTNByID[*root] = root;
+        mTNByID.set (*root, root);
         filter->gotNode (true, SHAMapNode (), hash, nodeData, root->getType ());
     }
 
@@ -1001,6 +1046,9 @@ boost::shared_ptr<SHAMap::DirtyMap> SHAMap::disarmDirty ()
     // stop saving dirty nodes
     ScopedLockType sl (mLock, __FILE__, __LINE__);
 
+    // The nodes are about to be written, they need their hashes
+    flushHashes ();
+
     boost::shared_ptr<DirtyMap> ret;
     ret.swap (mDirtyNodes);
     return ret;
@@ -1035,11 +1083,11 @@ SHAMapTreeNode::pointer SHAMap::getNode (const SHAMapNode& nodeID)
 // It throws if the map is incomplete
 SHAMapTreeNode* SHAMap::getNodePointer (const SHAMapNode& nodeID)
 {
-    boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer>::iterator it = mTNByID.find (nodeID);
-    if (it != mTNByID.end())
+    SHAMapTreeNode::pointer const* found = mTNByID.find (nodeID);
+    if (found != nullptr)
     {
-        it->second->touch(mSeq);
-        return it->second.get();
+        (*found)->touch(mSeq);
+        return found->get();
     }
 
     SHAMapTreeNode* node = root.get();
@@ -1100,7 +1148,7 @@ void SHAMap::dropCache ()
     mTNByID.clear ();
 
     if (root)
-        mTNByID[*root] = root;
+        mTNByID.set (*root, root);
 }
 
 void SHAMap::dropBelow (SHAMapTreeNode* d)
@@ -1115,14 +1163,198 @@ void SHAMap::dump (bool hash)
 {
     WriteLog (lsINFO, SHAMap) << " MAP Contains";
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
+
+    std::vector <SHAMapTreeNode::pointer> nodes;
+    mTNByID.getNodes (nodes);
+
+    BOOST_FOREACH (SHAMapTreeNode::ref node, nodes)
+    {
+        WriteLog (lsINFO, SHAMap) << node->getString ();
+        CondLog (hash, lsINFO, SHAMap) << node->getNodeHash ();
+    }
+
+}
+
+//------------------------------------------------------------------------------
+
+// Dirty subtrees shared out between the thread flushing
+// the hashes and the jobs helping it.
+//
+class SHAMap::HashWork
+{
+public:
+    explicit HashWork (SHAMap const& map)
+        : m_map (map)
+        , m_next (0)
+        , m_remaining (0)
+    {
+    }
+
+    void add (SHAMapTreeNode* node)
+    {
+        m_nodes.push_back (node);
+        ++m_remaining;
+    }
+
+    int size () const
+    {
+        return m_nodes.size ();
+    }
+
+    // Rehash subtrees until none are left to take
+    void run ()
+    {
+        for (;;)
+        {
+            int const index = (++m_next) - 1;
+
+            if (index >= size ())
+                return;
+
+            m_map.rehashDirty (m_nodes [index]);
+
+            if (--m_remaining == 0)
+                m_done.signal ();
+        }
+    }
+
+    // Wait for subtrees taken by other threads to finish
+    void wait ()
+    {
+        m_done.wait ();
+    }
+
+private:
+    SHAMap const& m_map;
+    std::vector <SHAMapTreeNode*> m_nodes;
+    Atomic <int> m_next;
+    Atomic <int> m_remaining;
+    WaitableEvent m_done;
+};
+
+void SHAMap::setDeferredHashing (bool defer)
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+
+    if (!defer)
+        flushHashes ();
+
+    mDeferHashes = defer;
+}
+
+void SHAMap::setChildNode (SHAMapTreeNode::ref node, int branch, SHAMapTreeNode::ref child)
+{
+    if (mDeferHashes)
+        node->setChildDirty (branch);
+    else
+        node->setChildHash (branch, child->getNodeHash ());
+}
+
+void SHAMap::flushHashes () const
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
 
-    for (boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer>::iterator it = mTNByID.begin ();
-            it != mTNByID.end (); ++it)
+    if (!mDeferHashes)
+        return;
+
+    // Every dirty node has a dirty path to the root
+    if (!root->isHashDirty ())
+        return;
+
+    if ((mDeferredChanges >= parallelHashThreshold) && getApp().running ())
     {
-        WriteLog (lsINFO, SHAMap) << it->second->getString ();
-        CondLog (hash, lsINFO, SHAMap) << it->second->getNodeHash ();
+        boost::shared_ptr <HashWork> work (boost::make_shared <HashWork> (boost::cref (*this)));
+
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (root->isDirtyBranch (branch))
+            {
+                SHAMapTreeNode::pointer const* child =
+                    mTNByID.find (root->getChildNodeID (branch));
+
+                if ((child != nullptr) && (*child)->isHashDirty ())
+                    work->add (child->get ());
+            }
+        }
+
+        if (work->size () > 1)
+        {
+            int const jobs = std::min (work->size () - 1, int (maxHashJobs));
+
+            for (int i = 0; i < jobs; ++i)
+                getApp().getJobQueue ().addJob (jtSHAMAP_HASH, "SHAMap::hash",
+                    BIND_TYPE (&SHAMap::hashJob, work, P_1));
+
+            // Work alongside the jobs, they may not start right away
+            work->run ();
+            work->wait ();
+        }
+    }
+
+    rehashDirty (root.get ());
+    mDeferredChanges = 0;
+}
+
+// Rehashes the dirty nodes below and including this one, children first,
+// so that each node is hashed only once. This only reads the node map,
+// so separate subtrees can be rehashed on separate threads.
+//
+void SHAMap::rehashDirty (SHAMapTreeNode* node) const
+{
+    rehashChildren (node);
+    SHAMapTreeNode::updateHashes (&node, 1);
+}
+
+// Brings the child hashes of a dirty node up to date. The dirty children
+// are hashed together in one batch, the node itself is left to the caller.
+//
+void SHAMap::rehashChildren (SHAMapTreeNode* node) const
+{
+    SHAMapTreeNode* children [16];
+    int branches [16];
+    int count = 0;
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (node->isDirtyBranch (branch))
+        {
+            SHAMapTreeNode::pointer const* found =
+                mTNByID.find (node->getChildNodeID (branch));
+
+            if (found == nullptr)
+            {
+                // Changed nodes are always in the map
+                WriteLog (lsFATAL, SHAMap) << "Dirty child missing: " << node->getChildNodeID (branch);
+                assert (false);
+                continue;
+            }
+
+            SHAMapTreeNode* const child = found->get ();
+
+            if (child->isHashDirty ())
+            {
+                rehashChildren (child);
+                children[count] = child;
+                branches[count] = branch;
+                ++count;
+            }
+            else
+            {
+                node->setDirtyChildHash (branch, child->getNodeHash ());
+            }
+        }
     }
 
+    SHAMapTreeNode::updateHashes (children, count);
+
+    for (int i = 0; i < count; ++i)
+        node->setDirtyChildHash (branches[i], children[i]->getNodeHash ());
+}
+
+void SHAMap::hashJob (boost::shared_ptr <HashWork> work, Job&)
+{
+    work->run ();
 }
 
 //------------------------------------------------------------------------------
@@ -1215,6 +1447,184 @@ public:
         unexpected (sMap.getHash () == mapHash, "bad snapshot");
 
         unexpected (map2->getHash () != mapHash, "bad snapshot");
+
+
+
+        beginTestCase ("deferred hashing");
+
+        SHAMap eager (smtFREE);
+        SHAMap deferred (smtFREE);
+        deferred.setDeferredHashing (true);
+
+        for (int k = 0; k < 100; ++k)
+        {
+            SHAMapItem item (Serializer::getSHA512Half (IntToVUC (k)), IntToVUC (k));
+            eager.addItem (item, true, false);
+            deferred.addItem (item, true, false);
+        }
+
+        unexpected (deferred.getHash () != eager.getHash (), "bad deferred add");
+
+        for (int k = 0; k < 100; k += 3)
+        {
+            SHAMapItem item (Serializer::getSHA512Half (IntToVUC (k)), IntToVUC (k + 1));
+            eager.updateItem (item, true, false);
+            deferred.updateItem (item, true, false);
+        }
+
+        for (int k = 1; k < 100; k += 2)
+        {
+            uint256 const tag (Serializer::getSHA512Half (IntToVUC (k)));
+            eager.delItem (tag);
+            deferred.delItem (tag);
+        }
+
+        unexpected (deferred.getHash () != eager.getHash (), "bad deferred update");
+
+        deferred.setDeferredHashing (false);
+        deferred.delItem (Serializer::getSHA512Half (IntToVUC (0)));
+        eager.delItem (Serializer::getSHA512Half (IntToVUC (0)));
+
+        unexpected (deferred.getHash () != eager.getHash (), "bad deferred flush");
+
+        // Items added and deleted again between flushes must leave no trace
+        SHAMap eagerChurn (smtFREE);
+        SHAMap deferredChurn (smtFREE);
+        deferredChurn.setDeferredHashing (true);
+
+        for (int k = 0; k < 60; ++k)
+        {
+            SHAMapItem item (Serializer::getSHA512Half (IntToVUC (k)), IntToVUC (k));
+            eagerChurn.addItem (item, true, false);
+            deferredChurn.addItem (item, true, false);
+        }
+
+        unexpected (deferredChurn.getHash () != eagerChurn.getHash (), "bad deferred add");
+
+        for (int k = 60; k < 200; ++k)
+        {
+            SHAMapItem item (Serializer::getSHA512Half (IntToVUC (k)), IntToVUC (k));
+            eagerChurn.addItem (item, true, false);
+            deferredChurn.addItem (item, true, false);
+
+            if ((k % 3) != 0)
+            {
+                eagerChurn.delItem (item.getTag ());
+                deferredChurn.delItem (item.getTag ());
+            }
+        }
+
+        for (int k = 60; k < 200; k += 6)
+        {
+            uint256 const tag (Serializer::getSHA512Half (IntToVUC (k)));
+            eagerChurn.delItem (tag);
+            deferredChurn.delItem (tag);
+        }
+
+        unexpected (deferredChurn.getHash () != eagerChurn.getHash (), "bad deferred add and delete");
+
+
+
+        beginTestCase ("inner node branches");
+
+        SHAMapTreeNode inner (1, SHAMapNode ());
+        inner.makeInner ();
+        inner.setChildHash (12, h2);
+        inner.setChildHash (3, h1);
+        inner.setChildHash (7, h3);
+        inner.setChildHash (3, uint256 ());
+        inner.setChildHash (0, h4);
+
+        unexpected (inner.getBranchCount () != 3, "bad branch count");
+
+        unexpected (!inner.isEmptyBranch (3) || inner.getChildHash (3).isNonZero (), "bad empty branch");
+
+        unexpected ((inner.getChildHash (0) != h4) || (inner.getChildHash (7) != h3) ||
+                    (inner.getChildHash (12) != h2), "bad branch hash");
+
+        Serializer s;
+        inner.addRaw (s, snfPREFIX);
+        SHAMapTreeNode parsed (SHAMapNode (), s.peekData (), 1, snfPREFIX, uint256 (), false);
+
+        unexpected (parsed.getNodeHash () != inner.getNodeHash (), "bad inner node hash");
+
+        s.erase ();
+        inner.addRaw (s, snfWIRE);
+        SHAMapTreeNode wire (SHAMapNode (), s.peekData (), 1, snfWIRE, uint256 (), false);
+
+        unexpected (wire.getNodeHash () != inner.getNodeHash (), "bad inner node wire format");
+
+        // Two children added since the last flush, then one deleted again
+        SHAMapTreeNode dirty (1, SHAMapNode ());
+        dirty.makeInner ();
+        dirty.setChildHash (2, h1);
+        dirty.setChildDirty (5);
+        dirty.setChildDirty (9);
+
+        unexpected (!dirty.setChildHash (5, uint256 ()), "deleting a dirty branch must continue up");
+
+        unexpected (!dirty.isEmptyBranch (5) || (dirty.getBranchCount () != 2), "bad dirty branch delete");
+
+        unexpected (!dirty.isHashDirty () || !dirty.isDirtyBranch (9), "bad dirty sibling");
+
+        dirty.setDirtyChildHash (9, h2);
+        SHAMapTreeNode* dirtyNodes [1] = { &dirty };
+        SHAMapTreeNode::updateHashes (dirtyNodes, 1);
+
+        inner.setChildHash (0, uint256 ());
+        inner.setChildHash (7, uint256 ());
+        inner.setChildHash (12, uint256 ());
+        inner.setChildHash (2, h1);
+        inner.setChildHash (9, h2);
+
+        unexpected (dirty.getNodeHash () != inner.getNodeHash (), "bad dirty node hash");
+
+
+
+        beginTestCase ("snapshot sharing");
+
+        // Snapshots share the node index, each must still see its own nodes
+        SHAMap::pointer live = boost::make_shared <SHAMap> (smtFREE);
+        std::vector <SHAMap::pointer> snapshots;
+        std::vector <int> itemCounts;
+        int items = 0;
+
+        for (int k = 0; k < 40; ++k)
+        {
+            for (int j = 0; j < 10; ++j)
+            {
+                int const v = (k * 10) + j;
+                live->addItem (SHAMapItem (Serializer::getSHA512Half (IntToVUC (v)), IntToVUC (v)), true, false);
+                ++items;
+            }
+
+            if ((k % 3) == 0)
+            {
+                live->delItem (Serializer::getSHA512Half (IntToVUC (k * 5)));
+                --items;
+            }
+
+            snapshots.push_back (live->snapShot (false));
+            itemCounts.push_back (items);
+        }
+
+        // Changes to a mutable snapshot do not show through
+        SHAMap::pointer copy = live->snapShot (true);
+        copy->delItem (copy->peekFirstItem ()->getTag ());
+
+        snapshots.push_back (live);
+        itemCounts.push_back (items);
+
+        for (int i = 0; i < snapshots.size (); ++i)
+        {
+            int count = 0;
+
+            for (SHAMapItem::pointer item = snapshots[i]->peekFirstItem (); item;
+                    item = snapshots[i]->peekNextItem (item->getTag ()))
+                ++count;
+
+            unexpected (count != itemCounts[i], "bad shared snapshot");
+        }
     }
 };
 
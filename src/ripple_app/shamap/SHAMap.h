@@ -86,13 +86,20 @@ public:
     SHAMapItem getItem (uint256 const & id);
     uint256 getHash () const
     {
-        return root->getNodeHash ();
-    }
-    uint256 getHash ()
-    {
+        flushHashes ();
         return root->getNodeHash ();
     }
 
+    /** Defer rehashing of inner nodes until a hash is needed.
+
+        While deferred, a change only marks the inner nodes above it as
+        dirty. The next time the hash of the map or the contents of its
+        inner nodes are needed, every dirty node is rehashed once, children
+        before parents. When many changes are pending, the subtrees below
+        the root are rehashed in parallel on the job queue.
+    */
+    void setDeferredHashing (bool defer);
+
     // save a copy if you have a temporary anyway
     bool updateGiveItem (SHAMapItem::ref, bool isTransaction, bool hasMeta);
     bool addGiveItem (SHAMapItem::ref, bool isTransaction, bool hasMeta);
@@ -212,6 +219,23 @@ public:
 private:
     static KeyCache <uint256, UptimeTimerAdapter> fullBelowCache;
 
+    class HashWork;
+
+    enum
+    {
+        // Changes pending before rehashing uses the job queue
+        parallelHashThreshold = 256,
+
+        // Most jobs that help rehash the subtrees below the root
+        maxHashJobs = 4
+    };
+
+    void flushHashes () const;
+    void rehashDirty (SHAMapTreeNode* node) const;
+    void rehashChildren (SHAMapTreeNode* node) const;
+    static void hashJob (boost::shared_ptr <HashWork> work, Job&);
+    void setChildNode (SHAMapTreeNode::ref node, int branch, SHAMapTreeNode::ref child);
+
     void dirtyUp (std::stack<SHAMapTreeNode::pointer>& stack, uint256 const & target, uint256 prevHash);
     std::stack<SHAMapTreeNode::pointer> getStack (uint256 const & id, bool include_nonmatching_leaf);
     SHAMapTreeNode::pointer walkTo (uint256 const & id, bool modify);
@@ -233,6 +257,7 @@ private:
     SHAMapItem::pointer onlyBelow (SHAMapTreeNode*);
     void eraseChildren (SHAMapTreeNode::pointer);
     void dropBelow (SHAMapTreeNode*);
+    void prefetchChildren (SHAMapTreeNode*);
     bool hasInnerNode (const SHAMapNode & nodeID, uint256 const & hash);
     bool hasLeafNode (uint256 const & tag, uint256 const & hash);
 
@@ -240,15 +265,12 @@ private:
                      Delta & differences, int & maxCount);
 
 private:
-#if 1
-    LockType mLock;
-#else
+    // Mutable so that const readers can bring deferred hashes up to date
     mutable LockType mLock;
-#endif
 
     uint32 mSeq;
     uint32 mLedgerSeq; // sequence number of ledger this is part of
-    boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer> mTNByID;
+    SHAMapNodeMap mTNByID;
 
     boost::shared_ptr<DirtyMap> mDirtyNodes;
 
@@ -257,6 +279,11 @@ private:
     SHAMapState mState;
 
     SHAMapType mType;
+
+    // Flushing the deferred hashes does not change the contents of the
+    // map, so it is allowed from const members like getHash.
+    bool mDeferHashes;          // only mark inner nodes dirty on changes
+    mutable int mDeferredChanges;   // changes since the hashes were flushed
 };
 
 #endif
@@ -238,6 +238,7 @@ void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissi
     std::stack<SHAMapTreeNode::pointer> nodeStack;
 
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
 
     if (!root->isInner ())  // root is only node, and we have it
         return;
@@ -0,0 +1,309 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+SHAMapFlusher::SHAMapFlusher ()
+    : mPending (0)
+    , mStopped (false)
+{
+}
+
+SHAMapFlusher::~SHAMapFlusher ()
+{
+    // Writing needs the application, which is being torn down by now
+    assert (mChunks.empty () && (mPending == 0));
+}
+
+void SHAMapFlusher::flushDirty (SHAMap::DirtyMap& map, NodeObjectType type, uint32 seq)
+{
+    if (map.empty ())
+        return;
+
+    bool stopped = !getApp().running ();
+    int chunkCount = 0;
+
+    if (!stopped)
+    {
+        LockType::scoped_lock sl (mLock);
+
+        // Checked with the queue locked, so stop drains whatever gets queued
+        stopped = mStopped;
+
+        if (!stopped)
+            chunkCount = queueChunks (map, type, seq);
+    }
+
+    if (stopped)
+    {
+        // No jobs to hand the work to
+        while (SHAMap::flushDirty (map, 256, type, seq) > 0)
+            ;
+
+        return;
+    }
+
+    map.clear ();
+
+    for (int i = 0; i < chunkCount; ++i)
+        getApp().getJobQueue ().addJob (jtWRITE, "SHAMap::flush",
+            BIND_TYPE (&SHAMapFlusher::writeJob, this, P_1));
+
+    // Apply backpressure, the caller helps until the backlog is acceptable
+    while ((getPendingCount () + getApp().getNodeStore ().getWriteLoad ()) > maxPendingWrites)
+    {
+        if (!writeNextChunk ())
+            break;
+    }
+}
+
+// Splits the map into chunks and queues them, the caller holds the lock
+int SHAMapFlusher::queueChunks (SHAMap::DirtyMap& map, NodeObjectType type, uint32 seq)
+{
+    int chunkCount = 0;
+    boost::shared_ptr <Chunk> chunk;
+
+    for (SHAMap::DirtyMap::iterator it = map.begin (); it != map.end (); ++it)
+    {
+        if (!chunk)
+        {
+            chunk = boost::make_shared <Chunk> ();
+            chunk->type = type;
+            chunk->seq = seq;
+            chunk->nodes.reserve (batchSize);
+        }
+
+        chunk->nodes.push_back (it->second);
+
+        if (chunk->nodes.size () >= batchSize)
+        {
+            mChunks.push_back (chunk);
+            chunk.reset ();
+            ++chunkCount;
+        }
+    }
+
+    if (chunk)
+    {
+        mChunks.push_back (chunk);
+        ++chunkCount;
+    }
+
+    mPending += map.size ();
+
+    return chunkCount;
+}
+
+void SHAMapFlusher::waitForFlush ()
+{
+    while (writeNextChunk ())
+        ;
+
+    LockType::scoped_lock sl (mLock);
+
+    // Wait for the chunks taken by jobs
+    while (mPending != 0)
+        mCondition.wait (sl);
+}
+
+void SHAMapFlusher::stop ()
+{
+    {
+        LockType::scoped_lock sl (mLock);
+        mStopped = true;
+    }
+
+    waitForFlush ();
+}
+
+int SHAMapFlusher::getPendingCount ()
+{
+    LockType::scoped_lock sl (mLock);
+    return mPending;
+}
+
+// Takes the oldest queued chunk and writes it, returns false if none are left
+bool SHAMapFlusher::writeNextChunk ()
+{
+    boost::shared_ptr <Chunk> chunk;
+
+    {
+        LockType::scoped_lock sl (mLock);
+
+        if (mChunks.empty ())
+            return false;
+
+        chunk = mChunks.front ();
+        mChunks.pop_front ();
+    }
+
+    writeChunk (*chunk);
+
+    {
+        LockType::scoped_lock sl (mLock);
+
+        mPending -= chunk->nodes.size ();
+
+        if (mPending == 0)
+            mCondition.notify_all ();
+    }
+
+    return true;
+}
+
+void SHAMapFlusher::writeJob (Job&)
+{
+    // The chunk this job was queued for may already have been taken
+    writeNextChunk ();
+}
+
+void SHAMapFlusher::writeChunk (Chunk const& chunk)
+{
+    LoadEvent::autoptr event (getApp().getJobQueue ().getLoadEventAP (jtDISK, "SHAMap::flush"));
+
+    NodeStore::Batch batch;
+    batch.reserve (chunk.nodes.size ());
+
+    Serializer s;
+
+    BOOST_FOREACH (SHAMapTreeNode::ref node, chunk.nodes)
+    {
+        s.erase ();
+        node->addRaw (s, snfPREFIX);
+
+#ifdef BEAST_DEBUG
+
+        if (s.getSHA512Half () != node->getNodeHash ())
+        {
+            WriteLog (lsFATAL, SHAMap) << *node;
+            WriteLog (lsFATAL, SHAMap) << s.getSHA512Half () << " != " << node->getNodeHash ();
+            assert (false);
+        }
+
+#endif
+
+        batch.push_back (NodeObject::createObject (chunk.type, chunk.seq, s.modData (), node->getNodeHash ()));
+    }
+
+    getApp().getNodeStore ().storeBatch (batch);
+
+    WriteLog (lsTRACE, SHAMap) << "Flushed " << batch.size () << " dirty nodes";
+}
+
+//------------------------------------------------------------------------------
+
+class SHAMapFlusherTests : public UnitTest
+{
+public:
+    SHAMapFlusherTests () : UnitTest ("SHAMapFlusher", "ripple")
+    {
+    }
+
+    // Fills a map and returns the nodes it made dirty
+    static boost::shared_ptr <SHAMap::DirtyMap> makeDirty (int first, int count)
+    {
+        SHAMap map (smtFREE);
+        map.armDirty ();
+
+        for (int i = first; i < (first + count); ++i)
+        {
+            std::string const data (lexicalCast <std::string> (i));
+            map.addItem (SHAMapItem (Serializer::getSHA512Half (data), Blob (data.begin (), data.end ())), true, false);
+        }
+
+        return map.disarmDirty ();
+    }
+
+    static void getNodes (SHAMap::DirtyMap const& map, std::vector <SHAMapTreeNode::pointer>& nodes)
+    {
+        for (SHAMap::DirtyMap::const_iterator it = map.begin (); it != map.end (); ++it)
+            nodes.push_back (it->second);
+    }
+
+    // Returns true if every node reads back from the node store as written
+    static bool fetchAll (std::vector <SHAMapTreeNode::pointer> const& nodes)
+    {
+        Serializer s;
+
+        BOOST_FOREACH (SHAMapTreeNode::ref node, nodes)
+        {
+            NodeObject::pointer object = getApp().getNodeStore ().fetch (node->getNodeHash ());
+
+            s.erase ();
+            node->addRaw (s, snfPREFIX);
+
+            if (!object || (object->getData () != s.peekData ()))
+                return false;
+        }
+
+        return true;
+    }
+
+    void testDrainOnStop ()
+    {
+        beginTestCase ("drain on stop");
+
+        boost::shared_ptr <SHAMap::DirtyMap> dirty = makeDirty (0, 3000);
+        std::vector <SHAMapTreeNode::pointer> nodes;
+        getNodes (*dirty, nodes);
+        int const nodeCount = nodes.size ();
+
+        SHAMapFlusher flusher;
+        int chunkCount;
+
+        {
+            // Queue the chunks the way flushDirty does, without jobs to write them
+            SHAMapFlusher::LockType::scoped_lock sl (flusher.mLock);
+            chunkCount = flusher.queueChunks (*dirty, hotACCOUNT_NODE, 1);
+        }
+
+        dirty->clear ();
+
+        expect (chunkCount == ((nodeCount + SHAMapFlusher::batchSize - 1) / SHAMapFlusher::batchSize),
+            "bad chunk count");
+        expect (flusher.getPendingCount () == nodeCount, "bad pending count");
+
+        flusher.stop ();
+
+        expect (flusher.getPendingCount () == 0, "stop left nodes pending");
+        expect (fetchAll (nodes), "drained nodes not in the node store");
+    }
+
+    void testFlushDirty ()
+    {
+        beginTestCase ("flush and fetch");
+
+        boost::shared_ptr <SHAMap::DirtyMap> dirty = makeDirty (3000, 500);
+        std::vector <SHAMapTreeNode::pointer> nodes;
+        getNodes (*dirty, nodes);
+
+        SHAMapFlusher flusher;
+        flusher.flushDirty (*dirty, hotTRANSACTION_NODE, 2);
+        flusher.stop ();
+
+        expect (dirty->empty (), "flushed map not emptied");
+        expect (fetchAll (nodes), "flushed nodes not in the node store");
+    }
+
+    void runTest ()
+    {
+        testDrainOnStop ();
+        testFlushDirty ();
+    }
+};
+
+static SHAMapFlusherTests shaMapFlusherTests;
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAPFLUSHER_H
+#define RIPPLE_SHAMAPFLUSHER_H
+
+/** Writes the dirty nodes of closed ledgers to the node store.
+
+    The nodes from SHAMap::disarmDirty are split into chunks, and each chunk
+    is serialized and written with a single NodeStore::Database::storeBatch
+    call from a job. Chunks are written in parallel.
+
+    Writing is not allowed to fall arbitrarily far behind. When the nodes
+    waiting to be written plus the node store's own write load exceed a
+    limit, the thread queueing more nodes writes chunks itself until the
+    backlog is under the limit again.
+
+    Until its chunk is written a node can only be read through the ledger
+    that holds it, NodeStore::Database::fetch does not find it.
+*/
+class SHAMapFlusher
+{
+public:
+    enum
+    {
+        // Nodes serialized and stored together
+        batchSize = 1024,
+
+        // Pending writes above which callers help write
+        maxPendingWrites = 32768
+    };
+
+    SHAMapFlusher ();
+
+    /** Destroy the flusher.
+        Nothing may be pending, stop must have been called while the
+        node store was still open.
+    */
+    ~SHAMapFlusher ();
+
+    /** Queue the nodes in the map for writing.
+        The map is left empty.
+    */
+    void flushDirty (SHAMap::DirtyMap& map, NodeObjectType type, uint32 seq);
+
+    /** Write out everything that is pending. */
+    void waitForFlush ();
+
+    /** Write out everything that is pending and stop using jobs.
+        Nodes queued after this are written by the calling thread.
+    */
+    void stop ();
+
+    /** Get the number of nodes queued or being written. */
+    int getPendingCount ();
+
+private:
+    friend class SHAMapFlusherTests;
+
+    struct Chunk
+    {
+        NodeObjectType type;
+        uint32 seq;
+        std::vector <SHAMapTreeNode::pointer> nodes;
+    };
+
+    int queueChunks (SHAMap::DirtyMap& map, NodeObjectType type, uint32 seq);
+    bool writeNextChunk ();
+    void writeJob (Job&);
+    static void writeChunk (Chunk const& chunk);
+
+private:
+    typedef boost::recursive_mutex LockType;
+    typedef boost::condition_variable_any CondvarType;
+
+    LockType mLock;
+    CondvarType mCondition;
+    std::deque <boost::shared_ptr <Chunk> > mChunks;
+    int mPending;
+    bool mStopped;
+};
+
+#endif
@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+SHAMapNodeMap::SHAMapNodeMap ()
+    : mSize (0)
+    , mSuperseded (0)
+{
+}
+
+SHAMapTreeNode::pointer const* SHAMapNodeMap::find (SHAMapNode const& id) const
+{
+    Map::const_iterator it = mTop.find (id);
+
+    if (it != mTop.end ())
+        return it->second ? &it->second : nullptr;
+
+    return findFrozen (id);
+}
+
+SHAMapTreeNode::pointer const* SHAMapNodeMap::findFrozen (SHAMapNode const& id) const
+{
+    for (Layer const* layer = mFrozen.get (); layer != nullptr; layer = layer->below.get ())
+    {
+        Map::const_iterator it = layer->nodes.find (id);
+
+        if (it != layer->nodes.end ())
+            return it->second ? &it->second : nullptr;
+    }
+
+    return nullptr;
+}
+
+void SHAMapNodeMap::set (SHAMapNode const& id, SHAMapTreeNode::ref node)
+{
+    assert (node);
+
+    if (find (id) == nullptr)
+        ++mSize;
+
+    supersede (id);
+    mTop[id] = node;
+    compact ();
+}
+
+bool SHAMapNodeMap::insert (SHAMapNode const& id, SHAMapTreeNode::ref node)
+{
+    assert (node);
+
+    if (find (id) != nullptr)
+        return false;
+
+    ++mSize;
+    mTop[id] = node;
+    return true;
+}
+
+bool SHAMapNodeMap::erase (SHAMapNode const& id)
+{
+    if (find (id) == nullptr)
+        return false;
+
+    --mSize;
+
+    if (findFrozen (id) != nullptr)
+    {
+        supersede (id);
+        mTop[id].reset ();
+        compact ();
+    }
+    else
+    {
+        mTop.erase (id);
+    }
+
+    return true;
+}
+
+void SHAMapNodeMap::clear ()
+{
+    mTop.clear ();
+    mFrozen.reset ();
+    mSize = 0;
+    mSuperseded = 0;
+}
+
+void SHAMapNodeMap::shareWith (SHAMapNodeMap& other)
+{
+    freeze ();
+
+    other.mTop.clear ();
+    other.mFrozen = mFrozen;
+    other.mSize = mSize;
+    other.mSuperseded = 0;
+}
+
+void SHAMapNodeMap::getNodes (std::vector <SHAMapTreeNode::pointer>& nodes) const
+{
+    nodes.reserve (nodes.size () + mSize);
+
+    for (Map::const_iterator it = mTop.begin (); it != mTop.end (); ++it)
+    {
+        if (it->second)
+            nodes.push_back (it->second);
+    }
+
+    for (Layer const* layer = mFrozen.get (); layer != nullptr; layer = layer->below.get ())
+    {
+        for (Map::const_iterator it = layer->nodes.begin (); it != layer->nodes.end (); ++it)
+        {
+            // Skip entries hidden by a layer above
+            if (it->second && (find (it->first) == &it->second))
+                nodes.push_back (it->second);
+        }
+    }
+}
+
+// Counts a frozen entry that the top layer is about to hide
+void SHAMapNodeMap::supersede (SHAMapNode const& id)
+{
+    if ((mTop.find (id) == mTop.end ()) && (findFrozen (id) != nullptr))
+        ++mSuperseded;
+}
+
+// Flattens the index into the top layer once enough frozen entries are
+// superseded. The frozen layers are released, and with them the nodes
+// that no other map still shares. This costs a pass over the index, which
+// the superseded entries since the last pass pay for.
+void SHAMapNodeMap::compact ()
+{
+    if ((mSuperseded < minSuperseded) || ((2 * mSuperseded) < mSize))
+        return;
+
+    Map nodes;
+    nodes.rehash (mTop.bucket_count ());
+
+    // Entries already in the map are newer and win
+    for (Map::const_iterator it = mTop.begin (); it != mTop.end (); ++it)
+        nodes.insert (*it);
+
+    for (Layer const* layer = mFrozen.get (); layer != nullptr; layer = layer->below.get ())
+        nodes.insert (layer->nodes.begin (), layer->nodes.end ());
+
+    for (Map::iterator it = nodes.begin (); it != nodes.end ();)
+    {
+        if (it->second)
+            ++it;
+        else
+            it = nodes.erase (it);
+    }
+
+    assert (nodes.size () == mSize);
+
+    mTop.swap (nodes);
+    mFrozen.reset ();
+    mSuperseded = 0;
+}
+
+// Moves the top layer onto the frozen stack
+void SHAMapNodeMap::freeze ()
+{
+    mSuperseded = 0;
+
+    if (mTop.empty ())
+        return;
+
+    boost::shared_ptr <Layer> layer (boost::make_shared <Layer> ());
+    layer->nodes.swap (mTop);
+    layer->below = mFrozen;
+
+    // Merge in the layers below that are not much bigger than this one,
+    // and any that would make the stack too deep. Layers stay shared with
+    // other maps, so this copies them rather than changing them.
+    while (layer->below &&
+           ((layer->below->nodes.size () <= (2 * layer->nodes.size ())) ||
+            (layer->below->depth >= maxLayers)))
+    {
+        boost::shared_ptr <Layer const> below = layer->below;
+
+        // Entries already in this layer are newer and win
+        layer->nodes.insert (below->nodes.begin (), below->nodes.end ());
+        layer->below = below->below;
+    }
+
+    if (!layer->below)
+    {
+        // Nothing is left for null entries to hide
+        for (Map::iterator it = layer->nodes.begin (); it != layer->nodes.end ();)
+        {
+            if (it->second)
+                ++it;
+            else
+                it = layer->nodes.erase (it);
+        }
+    }
+
+    layer->depth = layer->below ? (layer->below->depth + 1) : 1;
+    mFrozen = layer;
+}
+
+//------------------------------------------------------------------------------
+
+class SHAMapNodeMapTests : public UnitTest
+{
+public:
+    SHAMapNodeMapTests () : UnitTest ("SHAMapNodeMap", "ripple")
+    {
+    }
+
+    static SHAMapNode makeID (int i)
+    {
+        return SHAMapNode (63, Serializer::getSHA512Half (lexicalCast <std::string> (i)));
+    }
+
+    static SHAMapTreeNode::pointer makeNode (int i)
+    {
+        return boost::make_shared <SHAMapTreeNode> (1, makeID (i));
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("compaction");
+
+        int const count = 200;
+
+        SHAMapNodeMap map;
+        std::vector <boost::weak_ptr <SHAMapTreeNode> > original;
+
+        for (int i = 0; i < count; ++i)
+        {
+            SHAMapTreeNode::pointer node = makeNode (i);
+            map.set (makeID (i), node);
+            original.push_back (node);
+        }
+
+        {
+            // A snapshot still sees its nodes after the map replaces them
+            SHAMapNodeMap snapshot;
+            map.shareWith (snapshot);
+
+            for (int i = 0; i < count; ++i)
+            {
+                if ((i % 4) == 0)
+                    map.erase (makeID (i));
+                else
+                    map.set (makeID (i), makeNode (i));
+            }
+
+            bool same = true;
+
+            for (int i = 0; i < count; ++i)
+            {
+                SHAMapTreeNode::pointer const* node = snapshot.find (makeID (i));
+                same = same && (node != nullptr) && (*node == original[i].lock ());
+            }
+
+            unexpected (!same, "snapshot lost its nodes");
+            unexpected (snapshot.size () != count, "bad snapshot size");
+        }
+
+        bool released = true;
+
+        for (int i = 0; i < count; ++i)
+            released = released && original[i].expired ();
+
+        unexpected (!released, "superseded nodes were kept alive");
+
+        bool present = true;
+
+        for (int i = 0; i < count; ++i)
+            present = present && ((map.find (makeID (i)) == nullptr) == ((i % 4) == 0));
+
+        unexpected (!present, "bad lookup after compaction");
+        unexpected (map.size () != (count - (count / 4)), "bad size after compaction");
+
+        std::vector <SHAMapTreeNode::pointer> nodes;
+        map.getNodes (nodes);
+        unexpected (nodes.size () != map.size (), "bad node list after compaction");
+    }
+};
+
+static SHAMapNodeMapTests shaMapNodeMapTests;
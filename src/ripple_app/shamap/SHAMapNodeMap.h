@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAPNODEMAP_H
+#define RIPPLE_SHAMAPNODEMAP_H
+
+/** The nodes of a SHAMap that are in memory, indexed by node ID.
+
+    Taking a snapshot of a map shares its index in constant time. The index
+    is a stack of layers. Changes go into the top layer, which belongs to
+    one map. The layers below it are frozen and may be shared by any number
+    of maps. A node erased while it is still in a frozen layer is hidden by
+    a null entry in the top layer.
+
+    Frozen layers are merged as they pile up, so a lookup only checks a few
+    layers and a snapshot costs, amortized, a small multiple of the changes
+    made since the one before it.
+
+    An entry in the top layer supersedes the frozen entry with the same ID,
+    which the frozen layer keeps alive. Once too many are superseded the
+    index is flattened into the top layer and lets go of its frozen layers.
+*/
+class SHAMapNodeMap
+{
+public:
+    typedef boost::unordered_map <SHAMapNode, SHAMapTreeNode::pointer> Map;
+
+    SHAMapNodeMap ();
+
+    /** Returns the node with this ID, or nullptr if there is none. */
+    SHAMapTreeNode::pointer const* find (SHAMapNode const& id) const;
+
+    /** Add a node, replacing any node with the same ID. */
+    void set (SHAMapNode const& id, SHAMapTreeNode::ref node);
+
+    /** Add a node. Returns false if there already is a node with this ID. */
+    bool insert (SHAMapNode const& id, SHAMapTreeNode::ref node);
+
+    /** Remove a node. Returns false if there was none. */
+    bool erase (SHAMapNode const& id);
+
+    void clear ();
+
+    std::size_t size () const
+    {
+        return mSize;
+    }
+
+    void rehash (std::size_t buckets)
+    {
+        mTop.rehash (buckets);
+    }
+
+    /** Make other index the same nodes as this one.
+        From then on, changes made to one are not seen by the other.
+    */
+    void shareWith (SHAMapNodeMap& other);
+
+    /** Retrieve every node. */
+    void getNodes (std::vector <SHAMapTreeNode::pointer>& nodes) const;
+
+private:
+    enum
+    {
+        // Most frozen layers a lookup has to check
+        maxLayers = 8,
+
+        // Fewest superseded frozen entries that cause a compaction
+        minSuperseded = 64
+    };
+
+    struct Layer
+    {
+        Map nodes;
+        boost::shared_ptr <Layer const> below;
+        int depth;
+    };
+
+    SHAMapTreeNode::pointer const* findFrozen (SHAMapNode const& id) const;
+    void freeze ();
+    void supersede (SHAMapNode const& id);
+    void compact ();
+
+    Map mTop;
+    boost::shared_ptr <Layer const> mFrozen;
+    std::size_t mSize;
+    std::size_t mSuperseded;    // frozen entries hidden by the top layer
+};
+
+namespace detail
+{
+
+/** Specialization for SHAMapNodeMap
+*/
+template <>
+struct Destroyer <SHAMapNodeMap>
+{
+    static void destroy (SHAMapNodeMap& v)
+    {
+        v.clear ();
+    }
+};
+
+}
+
+#endif
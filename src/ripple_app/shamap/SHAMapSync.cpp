@@ -136,6 +136,7 @@ void SHAMap::getMissingNodes (std::vector<SHAMapNode>& nodeIDs, std::vector<uint
                     else if (d->isInner () && !d->isFullBelow ())
                     {
                         have_all = false;
+                        prefetchChildren (d);
                         stack.push (d);
                     }
                 }
@@ -158,6 +159,34 @@ void SHAMap::getMissingNodes (std::vector<SHAMapNode>& nodeIDs, std::vector<uint
         clearSynching ();
 }
 
+// Ask the node store to start reading the children of an inner node
+// that we are going to visit, so they are in its cache by the time
+// getNodePointerNT asks for them.
+void SHAMap::prefetchChildren (SHAMapTreeNode* node)
+{
+    if (!getApp().running ())
+        return;
+
+    std::vector<uint256> hashes;
+    hashes.reserve (16);
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (!node->isEmptyBranch (branch))
+        {
+            uint256 const& childHash = node->getChildHash (branch);
+
+            if (!fullBelowCache.isPresent (childHash) &&
+                !checkCacheNode (node->getChildNodeID (branch)))
+            {
+                hashes.push_back (childHash);
+            }
+        }
+    }
+
+    getApp().getNodeStore ().prefetch (hashes);
+}
+
 std::vector<uint256> SHAMap::getNeededHashes (int max, SHAMapSyncFilter* filter)
 {
     std::vector<uint256> nodeHashes;
@@ -175,6 +204,7 @@ bool SHAMap::getNodeFat (const SHAMapNode& wanted, std::vector<SHAMapNode>& node
 {
     // Gets a node and some of its children
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
 
     SHAMapTreeNode* node = getNodePointer(wanted);
 
@@ -230,6 +260,7 @@ bool SHAMap::getNodeFat (const SHAMapNode& wanted, std::vector<SHAMapNode>& node
 bool SHAMap::getRootNode (Serializer& s, SHANodeFormat format)
 {
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
     root->addRaw (s, format);
     return true;
 }
@@ -258,7 +289,7 @@ SHAMapAddNode SHAMap::addRootNode (Blob const& rootNode, SHANodeFormat format,
 #endif
 
     root = node;
-    mTNByID[*root] = root;
+    mTNByID.set (*root, root);
 
     if (root->getNodeHash ().isZero ())
     {
@@ -296,7 +327,7 @@ SHAMapAddNode SHAMap::addRootNode (uint256 const& hash, Blob const& rootNode, SH
         return SHAMapAddNode::invalid ();
 
     root = node;
-    mTNByID[*root] = root;
+    mTNByID.set (*root, root);
 
     if (root->getNodeHash ().isZero ())
     {
@@ -374,7 +405,7 @@ SHAMapAddNode SHAMap::addKnownNode (const SHAMapNode& node, Blob const& rawNode,
                 filter->gotNode (false, node, iNode->getChildHash (branch), s.modData (), newNode->getType ());
             }
 
-            mTNByID[node] = newNode;
+            mTNByID.set (node, newNode);
             return SHAMapAddNode::useful ();
         }
         iNode = nextNode;
@@ -389,6 +420,8 @@ bool SHAMap::deepCompare (SHAMap& other)
     // Intended for debug/test only
     std::stack<SHAMapTreeNode::pointer> stack;
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
+    other.flushHashes ();
 
     stack.push (root);
 
@@ -458,9 +491,9 @@ bool SHAMap::deepCompare (SHAMap& other)
 
 bool SHAMap::hasInnerNode (const SHAMapNode& nodeID, uint256 const& nodeHash)
 {
-    boost::unordered_map<SHAMapNode, SHAMapTreeNode::pointer>::iterator it = mTNByID.find (nodeID);
-    if (it != mTNByID.end())
-        if (it->second->getNodeHash() == nodeHash)
+    SHAMapTreeNode::pointer const* found = mTNByID.find (nodeID);
+    if (found != nullptr)
+        if ((*found)->getNodeHash() == nodeHash)
             return true;
 
     SHAMapTreeNode* node = root.get ();
@@ -516,6 +549,7 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
                            FUNCTION_TYPE<void (const uint256&, const Blob&)> func)
 {
     ScopedLockType ul1 (mLock, __FILE__, __LINE__);
+    flushHashes ();
 
     ScopedPointer <LockType::ScopedTryLockType> ul2;
 
@@ -597,6 +631,7 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
 std::list<Blob > SHAMap::getTrustedPath (uint256 const& index)
 {
     ScopedLockType sl (mLock, __FILE__, __LINE__);
+    flushHashes ();
     std::stack<SHAMapTreeNode::pointer> stack = SHAMap::getStack (index, false);
 
     if (stack.empty () || !stack.top ()->isLeaf ())
@@ -18,28 +18,39 @@
 //==============================================================================
 
 
+uint256 const SHAMapTreeNode::zeroHash;
+
 SHAMapTreeNode::SHAMapTreeNode (uint32 seq, const SHAMapNode& nodeID)
     : SHAMapNode (nodeID)
     , mHash (uint64(0))
+    , mHashes (nullptr)
     , mSeq (seq)
     , mAccessSeq (seq)
     , mType (tnERROR)
     , mIsBranch (0)
+    , mDirtyBranches (0)
+    , mHashSlots (0)
     , mFullBelow (false)
 {
 }
 
 SHAMapTreeNode::SHAMapTreeNode (const SHAMapTreeNode& node, uint32 seq) : SHAMapNode (node),
-    mHash (node.mHash), mSeq (seq), mType (node.mType), mIsBranch (node.mIsBranch), mFullBelow (false)
+    mHash (node.mHash), mHashes (nullptr), mSeq (seq), mType (node.mType), mIsBranch (node.mIsBranch),
+    mDirtyBranches (node.mDirtyBranches), mHashSlots (0), mFullBelow (false)
 {
     if (node.mItem)
         mItem = boost::make_shared<SHAMapItem> (*node.mItem);
-    else
-        memcpy (mHashes, node.mHashes, sizeof (mHashes));
+    else if (mIsBranch != 0)
+    {
+        mHashSlots = countBranches (mIsBranch);
+        mHashes = new uint256 [mHashSlots];
+        std::copy (node.mHashes, node.mHashes + mHashSlots, mHashes);
+    }
 }
 
 SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& node, SHAMapItem::ref item, TNType type, uint32 seq) :
-    SHAMapNode (node), mItem (item), mSeq (seq), mType (type), mIsBranch (0), mFullBelow (false)
+    SHAMapNode (node), mHashes (nullptr), mItem (item), mSeq (seq), mType (type), mIsBranch (0),
+    mDirtyBranches (0), mHashSlots (0), mFullBelow (false)
 {
     assert (item->peekData ().size () >= 12);
     updateHash ();
@@ -47,7 +58,8 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& node, SHAMapItem::ref item, TN
 
 SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& id, Blob const& rawNode, uint32 seq,
                                 SHANodeFormat format, uint256 const& hash, bool hashValid) :
-    SHAMapNode (id), mSeq (seq), mType (tnERROR), mIsBranch (0), mFullBelow (false)
+    SHAMapNode (id), mHashes (nullptr), mSeq (seq), mType (tnERROR), mIsBranch (0), mDirtyBranches (0),
+    mHashSlots (0), mFullBelow (false)
 {
     if (format == snfWIRE)
     {
@@ -92,19 +104,19 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& id, Blob const& rawNode, uint3
             if (len != 512)
                 throw std::runtime_error ("invalid FI node");
 
-            for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (mHashes[i], i * 32);
+            uint256 hashes[16];
 
-                if (mHashes[i].isNonZero ())
-                    mIsBranch |= (1 << i);
-            }
+            for (int i = 0; i < 16; ++i)
+                s.get256 (hashes[i], i * 32);
 
+            setHashes (hashes);
             mType = tnINNER;
         }
         else if (type == 3)
         {
             // compressed inner
+            uint256 hashes[16];
+
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -112,12 +124,10 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& id, Blob const& rawNode, uint3
 
                 if ((pos < 0) || (pos >= 16)) throw std::runtime_error ("invalid CI node");
 
-                s.get256 (mHashes[pos], i * 33);
-
-                if (mHashes[pos].isNonZero ())
-                    mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos], i * 33);
             }
 
+            setHashes (hashes);
             mType = tnINNER;
         }
         else if (type == 4)
@@ -183,14 +193,12 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& id, Blob const& rawNode, uint3
             if (s.getLength () != 512)
                 throw std::runtime_error ("invalid PIN node");
 
-            for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (mHashes[i], i * 32);
+            uint256 hashes[16];
 
-                if (mHashes[i].isNonZero ())
-                    mIsBranch |= (1 << i);
-            }
+            for (int i = 0; i < 16; ++i)
+                s.get256 (hashes[i], i * 32);
 
+            setHashes (hashes);
             mType = tnINNER;
         }
         else if (prefix == HashPrefix::txNode)
@@ -230,6 +238,11 @@ SHAMapTreeNode::SHAMapTreeNode (const SHAMapNode& id, Blob const& rawNode, uint3
         updateHash ();
 }
 
+SHAMapTreeNode::~SHAMapTreeNode ()
+{
+    delete[] mHashes;
+}
+
 bool SHAMapTreeNode::updateHash ()
 {
     uint256 nh;
@@ -238,13 +251,16 @@ bool SHAMapTreeNode::updateHash ()
     {
         if (mIsBranch != 0)
         {
-            nh = Serializer::getPrefixHash (HashPrefix::innerNode, reinterpret_cast<unsigned char*> (mHashes), sizeof (mHashes));
+            uint256 hashes[16];
+            getHashes (hashes);
+
+            nh = Serializer::getPrefixHash (HashPrefix::innerNode, reinterpret_cast<unsigned char*> (hashes), sizeof (hashes));
 #if RIPPLE_VERIFY_NODEOBJECT_KEYS
             Serializer s;
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i]);
+                s.add256 (hashes[i]);
 
             assert (nh == s.getSHA512Half ());
 #endif
@@ -302,7 +318,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i]);
+                s.add256 (getChildHash (i));
         }
         else
         {
@@ -312,7 +328,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
                 for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i]);
+                        s.add256 (getChildHash (i));
                         s.add8 (i);
                     }
 
@@ -321,7 +337,7 @@ void SHAMapTreeNode::addRaw (Serializer& s, SHANodeFormat format)
             else
             {
                 for (int i = 0; i < 16; ++i)
-                    s.add256 (mHashes[i]);
+                    s.add256 (getChildHash (i));
 
                 s.add8 (2);
             }
@@ -378,6 +394,8 @@ bool SHAMapTreeNode::setItem (SHAMapItem::ref i, TNType type)
 {
     mType = type;
     mItem = i;
+    mDirtyBranches = 0;
+    clearHashes ();
     assert (isLeaf ());
     return updateHash ();
 }
@@ -396,20 +414,14 @@ bool SHAMapTreeNode::isEmpty () const
 int SHAMapTreeNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return countBranches (mIsBranch);
 }
 
 void SHAMapTreeNode::makeInner ()
 {
     mItem.reset ();
-    mIsBranch = 0;
-    memset (mHashes, 0, sizeof (mHashes));
+    mDirtyBranches = 0;
+    clearHashes ();
     mType = tnINNER;
     mHash.zero ();
 }
@@ -435,7 +447,7 @@ std::string SHAMapTreeNode::getString () const
                 ret += "\nb";
                 ret += lexicalCastThrow <std::string> (i);
                 ret += " = ";
-                ret += mHashes[i].GetHex ();
+                ret += getChildHash (i).GetHex ();
             }
     }
 
@@ -466,15 +478,193 @@ bool SHAMapTreeNode::setChildHash (int m, uint256 const& hash)
     assert ((m >= 0) && (m < 16));
     assert (mType == tnINNER);
 
-    if (mHashes[m] == hash)
+    bool const wasDirty = (mDirtyBranches & (1 << m)) != 0;
+    mDirtyBranches &= ~ (1 << m);
+
+    bool const changed = getChildHash (m) != hash;
+
+    // A zero hash empties the branch, even one that setChildDirty opened
+    // for a child which was deleted before its hash was ever set
+    setBranchHash (m, hash);
+
+    if (!changed && !wasDirty)
         return false;
 
-    mHashes[m] = hash;
+    // Hash once, after the last out of date branch is set
+    if (mDirtyBranches != 0)
+        return true;
+
+    // The branch to this node is still marked dirty in the parent, so the
+    // caller must go on up even if the hash comes out as it was
+    return updateHash () || wasDirty;
+}
+
+void SHAMapTreeNode::setChildDirty (int m)
+{
+    assert ((m >= 0) && (m < 16));
+    assert (mType == tnINNER);
+
+    if (isEmptyBranch (m))
+        addBranch (m);
+
+    mDirtyBranches |= (1 << m);
+}
+
+void SHAMapTreeNode::setDirtyChildHash (int m, uint256 const& hash)
+{
+    assert ((m >= 0) && (m < 16));
+    assert (mType == tnINNER);
+    assert (isDirtyBranch (m));
+
+    setBranchHash (m, hash);
+}
+
+void SHAMapTreeNode::updateHashes (SHAMapTreeNode* const* nodes, int count)
+{
+    // Inner nodes are all the same size, so several hash in each pass
+    int const chunk = 16;
+
+    for (int first = 0; first < count; first += chunk)
+    {
+        int const n = std::min (chunk, count - first);
+
+        uint256 children [chunk][16];
+        const unsigned char* data [chunk];
+        int sizes [chunk];
+        uint256 hashes [chunk];
+
+        for (int i = 0; i < n; ++i)
+        {
+            assert (nodes[first + i]->mType == tnINNER);
+            nodes[first + i]->getHashes (children[i]);
+            data[i] = reinterpret_cast<const unsigned char*> (children[i]);
+            sizes[i] = sizeof (children[i]);
+        }
+
+        Serializer::getPrefixHashBatch (HashPrefix::innerNode, data, sizes, n, hashes);
+
+        for (int i = 0; i < n; ++i)
+        {
+            SHAMapTreeNode* const node = nodes[first + i];
+
+            node->mDirtyBranches = 0;
+
+            if (node->mIsBranch != 0)
+                node->mHash = hashes[i];
+            else
+                node->mHash.zero ();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// Inner nodes only store the hashes of their non-empty branches. The slot
+// of a branch is the number of non-empty branches before it. Most inner
+// nodes have only a few branches and leaves have none, so this saves
+// most of the 512 bytes a full array of hashes would take.
+
+int SHAMapTreeNode::countBranches (int mask)
+{
+    mask = mask - ((mask >> 1) & 0x5555);
+    mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+    mask = (mask + (mask >> 4)) & 0x0f0f;
+    return (mask + (mask >> 8)) & 0x1f;
+}
+
+void SHAMapTreeNode::addBranch (int m)
+{
+    assert (isEmptyBranch (m));
 
+    int const count = countBranches (mIsBranch);
+    int const slot = getSlot (m);
+
+    if (count == mHashSlots)
+    {
+        // Grow in steps, nodes being modified tend to keep growing
+        int const slots = (count < 2) ? 2 : std::min (16, count * 2);
+        uint256* hashes = new uint256 [slots];
+        std::copy (mHashes, mHashes + count, hashes);
+        delete[] mHashes;
+        mHashes = hashes;
+        mHashSlots = slots;
+    }
+
+    for (int i = count; i > slot; --i)
+        mHashes[i] = mHashes[i - 1];
+
+    mHashes[slot].zero ();
+    mIsBranch |= (1 << m);
+}
+
+void SHAMapTreeNode::removeBranch (int m)
+{
+    assert (!isEmptyBranch (m));
+
+    int const count = countBranches (mIsBranch);
+
+    for (int i = getSlot (m) + 1; i < count; ++i)
+        mHashes[i - 1] = mHashes[i];
+
+    mIsBranch &= ~ (1 << m);
+}
+
+void SHAMapTreeNode::setBranchHash (int m, uint256 const& hash)
+{
     if (hash.isNonZero ())
-        mIsBranch |= (1 << m);
-    else
-        mIsBranch &= ~ (1 << m);
+    {
+        if (isEmptyBranch (m))
+            addBranch (m);
 
-    return updateHash ();
+        mHashes[getSlot (m)] = hash;
+    }
+    else if (!isEmptyBranch (m))
+    {
+        removeBranch (m);
+    }
+}
+
+void SHAMapTreeNode::getHashes (uint256* hashes) const
+{
+    int slot = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (isEmptyBranch (i))
+            hashes[i].zero ();
+        else
+            hashes[i] = mHashes[slot++];
+    }
+}
+
+void SHAMapTreeNode::setHashes (uint256 const* hashes)
+{
+    clearHashes ();
+
+    int mask = 0;
+
+    for (int i = 0; i < 16; ++i)
+        if (hashes[i].isNonZero ())
+            mask |= (1 << i);
+
+    if (mask == 0)
+        return;
+
+    mHashSlots = countBranches (mask);
+    mHashes = new uint256 [mHashSlots];
+    mIsBranch = mask;
+
+    int slot = 0;
+
+    for (int i = 0; i < 16; ++i)
+        if (hashes[i].isNonZero ())
+            mHashes[slot++] = hashes[i];
+}
+
+void SHAMapTreeNode::clearHashes ()
+{
+    delete[] mHashes;
+    mHashes = nullptr;
+    mHashSlots = 0;
+    mIsBranch = 0;
 }
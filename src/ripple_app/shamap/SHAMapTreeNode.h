@@ -33,6 +33,7 @@ enum SHANodeFormat
 class SHAMapTreeNode
     : public SHAMapNode
     , public CountedObject <SHAMapTreeNode>
+    , public Uncopyable
 {
 public:
     static char const* getCountedObjectName () { return "SHAMapTreeNode"; }
@@ -57,6 +58,7 @@ public:
     // raw node functions
     SHAMapTreeNode (const SHAMapNode & id, Blob const & data, uint32 seq,
                     SHANodeFormat format, uint256 const & hash, bool hashValid);
+    ~SHAMapTreeNode ();
     void addRaw (Serializer&, SHANodeFormat format);
 
     virtual bool isPopulated () const
@@ -129,7 +131,25 @@ public:
     uint256 const& getChildHash (int m) const
     {
         assert ((m >= 0) && (m < 16) && (mType == tnINNER));
-        return mHashes[m];
+        return isEmptyBranch (m) ? zeroHash : mHashes[getSlot (m)];
+    }
+
+    // deferred hashing functions
+    //
+    // A dirty branch has a child whose hash changed but was not yet copied
+    // into this node. Until every dirty branch is set with setChildHash,
+    // the hash of this node is out of date.
+    //
+    void setChildDirty (int m);
+    void setDirtyChildHash (int m, uint256 const& hash); // node stays dirty
+    static void updateHashes (SHAMapTreeNode* const* nodes, int count); // clears dirty
+    bool isHashDirty () const
+    {
+        return mDirtyBranches != 0;
+    }
+    bool isDirtyBranch (int m) const
+    {
+        return (mDirtyBranches & (1 << m)) != 0;
     }
 
     // item node function
@@ -170,22 +190,35 @@ public:
     virtual std::string getString () const;
 
 private:
-    // VFALCO TODO derive from Uncopyable
-    SHAMapTreeNode (const SHAMapTreeNode&); // no implementation
-    SHAMapTreeNode& operator= (const SHAMapTreeNode&); // no implementation
-
     // VFALCO TODO remove the use of friend
     friend class SHAMap;
 
+    static uint256 const zeroHash;
+
     uint256             mHash;
-    uint256             mHashes[16];
+    uint256*            mHashes;        // hashes of the non-empty branches, in branch order
     SHAMapItem::pointer mItem;
     uint32              mSeq, mAccessSeq;
     TNType              mType;
-    int                 mIsBranch;
+    int                 mIsBranch;      // which branches have a slot in mHashes
+    int                 mDirtyBranches;
+    int                 mHashSlots;     // allocated size of mHashes
     bool                mFullBelow;
 
     bool updateHash ();
+
+    // branch storage functions
+    static int countBranches (int mask);
+    int getSlot (int m) const
+    {
+        return countBranches (mIsBranch & ((1 << m) - 1));
+    }
+    void addBranch (int m);
+    void removeBranch (int m);
+    void setBranchHash (int m, uint256 const& hash);
+    void getHashes (uint256* hashes) const;
+    void setHashes (uint256 const* hashes);
+    void clearHashes ();
 };
 
 #endif
@@ -27,8 +27,7 @@ SETUP_LOG (TransactionEngine)
 void TransactionEngine::txnWrite ()
 {
     // Write back the account states
-    typedef std::map<uint256, LedgerEntrySetEntry>::value_type u256_LES_pair;
-    BOOST_FOREACH (u256_LES_pair & it, mNodes)
+    BOOST_FOREACH (LedgerEntrySet::value_type & it, mNodes)
     {
         SLE::ref    sleEntry    = it.second.mEntry;
 
@@ -75,8 +74,75 @@ TER TransactionEngine::applyTransaction (const SerializedTransaction& txn, Trans
         bool& didApply)
 {
     WriteLog (lsTRACE, TransactionEngine) << "applyTransaction>";
-    didApply = false;
     assert (mLedger);
+
+    Arena::Scope arena;
+
+    Serializer m;
+    TER terResult = applyToNodes (txn, params, didApply, m, mTxnSeq);
+
+    if (didApply)
+    {
+        ++mTxnSeq;
+        commitNodes (txn, params, m);
+    }
+
+    mTxnAccount.reset ();
+    mNodes.clear ();
+
+    if (!isSetBit (params, tapOPEN_LEDGER) && isTemMalformed (terResult))
+    {
+        // XXX Malformed or failed transaction in closed ledger must bow out.
+    }
+
+    return terResult;
+}
+
+TER TransactionEngine::speculateTransaction (const SerializedTransaction& txn, TransactionEngineParams params,
+        bool& didApply, LedgerEntrySet& nodes)
+{
+    assert (mLedger);
+
+    // The entries left in nodes keep the arena alive until they are committed
+    Arena::Scope arena;
+
+    // The metadata index is not known yet, commitTransaction sets it
+    Serializer m;
+    mNodes.setTrackMisses (true);
+    TER terResult = applyToNodes (txn, params, didApply, m, 0);
+
+    nodes.swapWith (mNodes);
+    mNodes.setTrackMisses (false);
+    mTxnAccount.reset ();
+    mNodes.clear ();
+
+    return terResult;
+}
+
+void TransactionEngine::commitTransaction (const SerializedTransaction& txn, TransactionEngineParams params,
+        TER terResult, LedgerEntrySet& nodes)
+{
+    assert (mLedger);
+
+    Arena::Scope arena;
+
+    Serializer m;
+    nodes.addRawMeta (m, terResult, mTxnSeq++);
+
+    mNodes.swapWith (nodes);
+    commitNodes (txn, params, m);
+
+    mTxnAccount.reset ();
+    mNodes.clear ();
+}
+
+// Applies the transaction to the entry set without touching the ledger.
+// If it applies, the metadata is built with the given transaction index.
+//
+TER TransactionEngine::applyToNodes (const SerializedTransaction& txn, TransactionEngineParams params,
+        bool& didApply, Serializer& m, uint32 index)
+{
+    didApply = false;
     mNodes.init (mLedger, txn.getTransactionID (), mLedger->getLedgerSeq (), params);
 
 #ifdef BEAST_DEBUG
@@ -102,127 +168,127 @@ TER TransactionEngine::applyTransaction (const SerializedTransaction& txn, Trans
 
     UPTR_T<Transactor> transactor = Transactor::makeTransactor (txn, params, this);
 
-    if (transactor.get () != NULL)
+    if (transactor.get () == NULL)
     {
-        uint256 txID        = txn.getTransactionID ();
+        WriteLog (lsWARNING, TransactionEngine) << "applyTransaction: Invalid transaction: unknown transaction type";
+        return temUNKNOWN;
+    }
 
-        if (!txID)
-        {
-            WriteLog (lsWARNING, TransactionEngine) << "applyTransaction: invalid transaction id";
+    uint256 txID        = txn.getTransactionID ();
 
-            return temINVALID;
-        }
+    if (!txID)
+    {
+        WriteLog (lsWARNING, TransactionEngine) << "applyTransaction: invalid transaction id";
 
-        TER terResult = transactor->apply ();
-        std::string strToken;
-        std::string strHuman;
+        return temINVALID;
+    }
 
-        transResultInfo (terResult, strToken, strHuman);
+    TER terResult = transactor->apply ();
+    std::string strToken;
+    std::string strHuman;
 
-        WriteLog (lsINFO, TransactionEngine) << "applyTransaction: terResult=" << strToken << " : " << terResult << " : " << strHuman;
+    transResultInfo (terResult, strToken, strHuman);
 
-        if (isTesSuccess (terResult))
-            didApply = true;
-        else if (isTecClaim (terResult) && !isSetBit (params, tapRETRY))
-        {
-            // only claim the transaction fee
-            WriteLog (lsDEBUG, TransactionEngine) << "Reprocessing to only claim fee";
-            mNodes.clear ();
+    WriteLog (lsINFO, TransactionEngine) << "applyTransaction: terResult=" << strToken << " : " << terResult << " : " << strHuman;
 
-            SLE::pointer txnAcct = entryCache (ltACCOUNT_ROOT, Ledger::getAccountRootIndex (txn.getSourceAccount ()));
+    if (isTesSuccess (terResult))
+        didApply = true;
+    else if (isTecClaim (terResult) && !isSetBit (params, tapRETRY))
+    {
+        // only claim the transaction fee
+        WriteLog (lsDEBUG, TransactionEngine) << "Reprocessing to only claim fee";
+
+        // This drops what was read, speculation always sets tapRETRY so it never gets here
+        assert (!mNodes.isTrackingMisses ());
+        mNodes.clear ();
+
+        SLE::pointer txnAcct = entryCache (ltACCOUNT_ROOT, Ledger::getAccountRootIndex (txn.getSourceAccount ()));
+
+        if (!txnAcct)
+            terResult = terNO_ACCOUNT;
+        else
+        {
+            uint32 t_seq = txn.getSequence ();
+            uint32 a_seq = txnAcct->getFieldU32 (sfSequence);
 
-            if (!txnAcct)
-                terResult = terNO_ACCOUNT;
+            if (a_seq < t_seq)
+                terResult = terPRE_SEQ;
+            else if (a_seq > t_seq)
+                terResult = tefPAST_SEQ;
             else
             {
-                uint32 t_seq = txn.getSequence ();
-                uint32 a_seq = txnAcct->getFieldU32 (sfSequence);
+                STAmount fee        = txn.getTransactionFee ();
+                STAmount balance    = txnAcct->getFieldAmount (sfBalance);
 
-                if (a_seq < t_seq)
-                    terResult = terPRE_SEQ;
-                else if (a_seq > t_seq)
-                    terResult = tefPAST_SEQ;
+                if (balance < fee)
+                    terResult = terINSUF_FEE_B;
                 else
                 {
-                    STAmount fee        = txn.getTransactionFee ();
-                    STAmount balance    = txnAcct->getFieldAmount (sfBalance);
-
-                    if (balance < fee)
-                        terResult = terINSUF_FEE_B;
-                    else
-                    {
-                        txnAcct->setFieldAmount (sfBalance, balance - fee);
-                        txnAcct->setFieldU32 (sfSequence, t_seq + 1);
-                        entryModify (txnAcct);
-                        didApply = true;
-                    }
+                    txnAcct->setFieldAmount (sfBalance, balance - fee);
+                    txnAcct->setFieldU32 (sfSequence, t_seq + 1);
+                    entryModify (txnAcct);
+                    didApply = true;
                 }
             }
         }
-        else
-            WriteLog (lsDEBUG, TransactionEngine) << "Not applying transaction " << txID;
+    }
+    else
+        WriteLog (lsDEBUG, TransactionEngine) << "Not applying transaction " << txID;
 
-        if (didApply)
+    if (didApply)
+    {
+        if (!checkInvariants (terResult, txn, params))
         {
-            if (!checkInvariants (terResult, txn, params))
-            {
-                WriteLog (lsFATAL, TransactionEngine) << "Transaction violates invariants";
-                WriteLog (lsFATAL, TransactionEngine) << txn.getJson (0);
-                WriteLog (lsFATAL, TransactionEngine) << transToken (terResult) << ": " << transHuman (terResult);
-                WriteLog (lsFATAL, TransactionEngine) << mNodes.getJson (0);
-                didApply = false;
-                terResult = tefINTERNAL;
-            }
-            else
-            {
-                // Transaction succeeded fully or (retries are not allowed and the transaction could claim a fee)
-                Serializer m;
-                mNodes.calcRawMeta (m, terResult, mTxnSeq++);
+            WriteLog (lsFATAL, TransactionEngine) << "Transaction violates invariants";
+            WriteLog (lsFATAL, TransactionEngine) << txn.getJson (0);
+            WriteLog (lsFATAL, TransactionEngine) << transToken (terResult) << ": " << transHuman (terResult);
+            WriteLog (lsFATAL, TransactionEngine) << mNodes.getJson (0);
+            didApply = false;
+            terResult = tefINTERNAL;
+        }
+        else
+        {
+            // Transaction succeeded fully or (retries are not allowed and the transaction could claim a fee)
+            mNodes.calcRawMeta (m, terResult, index);
+        }
+    }
 
-                txnWrite ();
+    return terResult;
+}
 
-                Serializer s;
-                txn.add (s);
+// Writes the transaction and the entries it changed to the ledger
+//
+void TransactionEngine::commitNodes (const SerializedTransaction& txn, TransactionEngineParams params,
+        Serializer const& m)
+{
+    uint256 txID        = txn.getTransactionID ();
 
-                if (isSetBit (params, tapOPEN_LEDGER))
-                {
-                    if (!mLedger->addTransaction (txID, s))
-                    {
-                        WriteLog (lsFATAL, TransactionEngine) << "Tried to add transaction to open ledger that already had it";
-                        assert (false);
-                        throw std::runtime_error ("Duplicate transaction applied");
-                    }
-                }
-                else
-                {
-                    if (!mLedger->addTransaction (txID, s, m))
-                    {
-                        WriteLog (lsFATAL, TransactionEngine) << "Tried to add transaction to ledger that already had it";
-                        assert (false);
-                        throw std::runtime_error ("Duplicate transaction applied to closed ledger");
-                    }
-
-                    // Charge whatever fee they specified.
-                    STAmount saPaid = txn.getTransactionFee ();
-                    mLedger->destroyCoins (saPaid.getNValue ());
-                }
-            }
-        }
+    txnWrite ();
 
-        mTxnAccount.reset ();
-        mNodes.clear ();
+    Serializer s;
+    txn.add (s);
 
-        if (!isSetBit (params, tapOPEN_LEDGER) && isTemMalformed (terResult))
+    if (isSetBit (params, tapOPEN_LEDGER))
+    {
+        if (!mLedger->addTransaction (txID, s))
         {
-            // XXX Malformed or failed transaction in closed ledger must bow out.
+            WriteLog (lsFATAL, TransactionEngine) << "Tried to add transaction to open ledger that already had it";
+            assert (false);
+            throw std::runtime_error ("Duplicate transaction applied");
         }
-
-        return terResult;
     }
     else
     {
-        WriteLog (lsWARNING, TransactionEngine) << "applyTransaction: Invalid transaction: unknown transaction type";
-        return temUNKNOWN;
+        if (!mLedger->addTransaction (txID, s, m))
+        {
+            WriteLog (lsFATAL, TransactionEngine) << "Tried to add transaction to ledger that already had it";
+            assert (false);
+            throw std::runtime_error ("Duplicate transaction applied to closed ledger");
+        }
+
+        // Charge whatever fee they specified.
+        STAmount saPaid = txn.getTransactionFee ();
+        mLedger->destroyCoins (saPaid.getNValue ());
     }
 }
 
@@ -57,6 +57,10 @@ protected:
 
     void                txnWrite ();
 
+    TER applyToNodes (const SerializedTransaction&, TransactionEngineParams, bool & didApply,
+                      Serializer & meta, uint32 index);
+    void commitNodes (const SerializedTransaction&, TransactionEngineParams, Serializer const & meta);
+
 public:
     typedef boost::shared_ptr<TransactionEngine> pointer;
 
@@ -101,6 +105,16 @@ public:
     }
 
     TER applyTransaction (const SerializedTransaction&, TransactionEngineParams, bool & didApply);
+
+    // Apply a transaction without changing the ledger. The entries it read
+    // or changed, with its metadata, are left in nodes for commitTransaction.
+    TER speculateTransaction (const SerializedTransaction&, TransactionEngineParams, bool & didApply,
+                              LedgerEntrySet & nodes);
+
+    // Write a speculated transaction that applied to the ledger. The ledger must
+    // still hold the entries the transaction read when it was speculated.
+    void commitTransaction (const SerializedTransaction&, TransactionEngineParams, TER result,
+                            LedgerEntrySet & nodes);
     bool checkInvariants (TER result, const SerializedTransaction & txn, TransactionEngineParams params);
 };
 
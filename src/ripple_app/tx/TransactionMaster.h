@@ -38,7 +38,7 @@ public:
     void sweep (void);
 
 private:
-    TaggedCacheType <uint256, Transaction, UptimeTimerAdapter> mCache;
+    ShardedTaggedCacheType <uint256, Transaction, UptimeTimerAdapter> mCache;
 };
 
 #endif
@@ -211,3 +211,77 @@ Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
 
     return jvResult;
 }
+
+bool WSConnection::invokeLedgerDump (Json::Value const& jvRequest, std::string& reply)
+{
+#if RIPPLE_USE_RESOURCE_MANAGER
+    if (m_usage.disconnect ())
+        return false;
+#else
+    if (getApp().getLoadManager ().shouldCutoff (m_loadSource))
+        return false;
+#endif
+
+    Config::Role const role = m_isPublic
+            ? Config::GUEST     // Don't check on the public interface.
+            : getConfig ().getAdminRole (jvRequest, m_remoteIP);
+
+    if (Config::FORBID == role)
+        return false;
+
+    RPCHandler  mRPCHandler (&this->m_netOPs, boost::dynamic_pointer_cast<InfoSub> (this->shared_from_this ()));
+    int         options = 0;
+
+    Ledger::pointer ledger = mRPCHandler.getLedgerDump (jvRequest, role, options);
+
+    if (!ledger)
+        return false;
+
+    // Websocketpp sends each message as a single frame, so the text is still
+    // collected in full, but the Json::Value tree for it is never built.
+    try
+    {
+        Json::StringSink    sink (reply);
+        Json::StreamWriter  writer (sink);
+
+        writer.startObject ();
+        writer.startObject ("result");
+        ledger->writeJson (writer, options);
+        writer.endObject ();
+
+#if RIPPLE_USE_RESOURCE_MANAGER
+        m_usage.charge (Resource::legacyFee (LT_RPCReference));
+        if (m_usage.warn ())
+        {
+            writer.write ("warning", "load");
+        }
+#else
+        if (getApp().getLoadManager ().applyLoadCharge (m_loadSource, LT_RPCReference) &&
+            getApp().getLoadManager ().shouldWarn (m_loadSource))
+        {
+            writer.write ("warning", "load");
+        }
+#endif
+
+        writer.write ("status", "success");
+
+        if (jvRequest.isMember ("id"))
+        {
+            writer.write ("id", jvRequest["id"]);
+        }
+
+        writer.write ("type", "response");
+        writer.endObject ();
+        writer.flush ();
+    }
+    catch (std::exception& e)
+    {
+        WriteLog (lsINFO, WSConnection) << "Caught throw: " << e.what ();
+
+        // Let invokeCommand report the failure
+        reply.clear ();
+        return false;
+    }
+
+    return true;
+}
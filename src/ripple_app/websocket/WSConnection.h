@@ -54,6 +54,11 @@ public:
     void returnMessage (message_ptr ptr);
     Json::Value invokeCommand (Json::Value& jvRequest);
 
+    /** Write the response to a ledger dump without building it as a Value.
+        Returns false, leaving reply empty, if invokeCommand must be used.
+    */
+    bool invokeLedgerDump (Json::Value const& jvRequest, std::string& reply);
+
 protected:
     Resource::Manager& m_resourceManager;
     Resource::Consumer m_usage;
@@ -143,6 +148,14 @@ public:
             m_serverHandler.send (ptr, sObj, broadcast);
     }
 
+    void send (Message::pointer const& message, bool broadcast)
+    {
+        connection_ptr ptr = m_connection.lock ();
+
+        if (ptr)
+            m_serverHandler.send (ptr, message, broadcast);
+    }
+
     void disconnect ()
     {
         connection_ptr ptr = m_connection.lock ();
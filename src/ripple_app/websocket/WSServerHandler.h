@@ -102,6 +102,11 @@ public:
         }
     }
 
+    static void ssendm (connection_ptr cpClient, InfoSub::Message::pointer const& message, bool broadcast)
+    {
+        ssendb (cpClient, message->getText (), broadcast);
+    }
+
     static void ssendb (connection_ptr cpClient, const std::string& strMessage, bool broadcast)
     {
         try
@@ -128,6 +133,13 @@ public:
                                           &WSServerHandler<endpoint_type>::ssendb, cpClient, strMessage, broadcast));
     }
 
+    // The message is shared, not copied, until the connection frames it
+    void send (connection_ptr cpClient, InfoSub::Message::pointer const& message, bool broadcast)
+    {
+        cpClient->get_strand ().post (BIND_TYPE (
+                                          &WSServerHandler<endpoint_type>::ssendm, cpClient, message, broadcast));
+    }
+
     void send (connection_ptr cpClient, const Json::Value& jvObj, bool broadcast)
     {
         Json::FastWriter    jfwWriter;
@@ -336,7 +348,12 @@ public:
                 job.rename (std::string ("WSClient::") + cmd);
 	    }
 
-            send (cpClient, conn->invokeCommand (jvRequest), false);
+            std::string reply;
+
+            if (conn->invokeLedgerDump (jvRequest, reply))
+                send (cpClient, reply, false);
+            else
+                send (cpClient, conn->invokeCommand (jvRequest), false);
         }
 
         return true;
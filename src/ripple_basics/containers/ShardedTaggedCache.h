@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_SHARDEDTAGGEDCACHE_H
+#define RIPPLE_SHARDEDTAGGEDCACHE_H
+
+/** A TaggedCacheType split into independently locked shards.
+
+    Each key belongs to exactly one shard, chosen from the hash of the key,
+    and every shard is a complete TaggedCacheType with its own lock. Threads
+    working on keys in different shards never contend with each other, and
+    a sweep only locks one shard at a time.
+
+    The target size and byte target are divided evenly among the shards,
+    the target age and eviction policy apply to each of them unchanged.
+
+    The interface is the same as TaggedCacheType except that there is no
+    single mutex to peek at. Callers that need to keep other state consistent
+    with the cache must use a lock of their own.
+
+    @see TaggedCacheType
+*/
+template <typename c_Key, typename c_Data, class Timer>
+class ShardedTaggedCacheType : public Uncopyable
+{
+public:
+    typedef c_Key                                   key_type;
+    typedef c_Data                                  data_type;
+    typedef boost::shared_ptr <data_type>           data_ptr;
+    typedef TaggedCacheType <c_Key, c_Data, Timer>  Shard;
+    typedef TaggedCache::EvictionPolicy             EvictionPolicy;
+
+    enum
+    {
+        defaultShardCount = 16
+    };
+
+    ShardedTaggedCacheType (const char* name, int size, int age,
+                            int shardCount = defaultShardCount)
+        : mTargetSize (size)
+        , mTargetBytes (0)
+    {
+        bassert (shardCount > 0);
+
+        mShards.reserve (shardCount);
+
+        for (int i = 0; i < shardCount; ++i)
+            mShards.push_back (new Shard (name, shardSize (size, shardCount), age));
+    }
+
+    int getShardCount () const
+    {
+        return mShards.size ();
+    }
+
+    int getTargetSize () const
+    {
+        return mTargetSize;
+    }
+
+    int getTargetAge () const
+    {
+        return mShards [0].getTargetAge ();
+    }
+
+    std::size_t getTargetBytes () const
+    {
+        return mTargetBytes;
+    }
+
+    EvictionPolicy getEvictionPolicy () const
+    {
+        return mShards [0].getEvictionPolicy ();
+    }
+
+    int getCacheSize ()
+    {
+        int size = 0;
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            size += mShards [i].getCacheSize ();
+
+        return size;
+    }
+
+    int getTrackSize ()
+    {
+        int size = 0;
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            size += mShards [i].getTrackSize ();
+
+        return size;
+    }
+
+    std::size_t getCacheBytes ()
+    {
+        std::size_t bytes = 0;
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            bytes += mShards [i].getCacheBytes ();
+
+        return bytes;
+    }
+
+    float getHitRate ()
+    {
+        uint64 hits = 0;
+        uint64 misses = 0;
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+        {
+            uint64 shardHits;
+            uint64 shardMisses;
+            mShards [i].getHitCounts (shardHits, shardMisses);
+            hits += shardHits;
+            misses += shardMisses;
+        }
+
+        return (static_cast<float> (hits) * 100) / (1.0f + hits + misses);
+    }
+
+    void clearStats ()
+    {
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].clearStats ();
+    }
+
+    void setTargetSize (int size)
+    {
+        mTargetSize = size;
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].setTargetSize (shardSize (size, mShards.size ()));
+    }
+
+    void setTargetAge (int age)
+    {
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].setTargetAge (age);
+    }
+
+    void setTargetBytes (std::size_t bytes)
+    {
+        mTargetBytes = bytes;
+
+        // Zero means no byte limit, keep it that way
+        std::size_t const perShard = (bytes == 0) ? 0 :
+            std::max <std::size_t> (1, (bytes + mShards.size () - 1) / mShards.size ());
+
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].setTargetBytes (perShard);
+    }
+
+    void setEvictionPolicy (EvictionPolicy policy)
+    {
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].setEvictionPolicy (policy);
+    }
+
+    /** Sweep every shard.
+        Only one shard is locked at any time, the others remain
+        available to other threads while the sweep is in progress.
+    */
+    void sweep ()
+    {
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].sweep ();
+    }
+
+    void clear ()
+    {
+        for (std::size_t i = 0; i < mShards.size (); ++i)
+            mShards [i].clear ();
+    }
+
+    bool refreshIfPresent (const key_type& key)
+    {
+        return getShard (key).refreshIfPresent (key);
+    }
+
+    bool del (const key_type& key, bool valid)
+    {
+        return getShard (key).del (key, valid);
+    }
+
+    bool canonicalize (const key_type& key, data_ptr& data, bool replace = false)
+    {
+        return getShard (key).canonicalize (key, data, replace);
+    }
+
+    bool store (const key_type& key, const c_Data& data)
+    {
+        return getShard (key).store (key, data);
+    }
+
+    data_ptr fetch (const key_type& key)
+    {
+        return getShard (key).fetch (key);
+    }
+
+    bool retrieve (const key_type& key, c_Data& data)
+    {
+        return getShard (key).retrieve (key, data);
+    }
+
+private:
+    static int shardSize (int size, int shardCount)
+    {
+        // Zero means no size limit, keep it that way
+        if (size <= 0)
+            return size;
+
+        return std::max (1, (size + shardCount - 1) / shardCount);
+    }
+
+    Shard& getShard (const key_type& key)
+    {
+        // Fold in the high bits, since the low bits of the
+        // hash are also used to pick a bucket inside the shard.
+        std::size_t const hash = boost::hash <key_type> () (key);
+
+        return mShards [((hash >> 16) ^ hash) % mShards.size ()];
+    }
+
+    boost::ptr_vector <Shard> mShards;
+    int mTargetSize;
+    std::size_t mTargetBytes;
+};
+
+#endif
@@ -19,3 +19,111 @@
 
 
 SETUP_LOGN (TaggedCacheLog,"TaggedCache")
+
+//------------------------------------------------------------------------------
+
+class TaggedCacheTests : public UnitTest
+{
+public:
+    TaggedCacheTests () : UnitTest ("TaggedCache", "ripple")
+    {
+    }
+
+    // Lets the test control the passage of time
+    struct ManualTimer
+    {
+        static int now;
+
+        static int getElapsedSeconds ()
+        {
+            return now;
+        }
+    };
+
+    typedef TaggedCacheType <int, Blob, ManualTimer> Cache;
+
+    static void insert (Cache& cache, int key, std::size_t size)
+    {
+        boost::shared_ptr <Blob> data (boost::make_shared <Blob> (size));
+        cache.canonicalize (key, data);
+    }
+
+    void testBytes ()
+    {
+        beginTestCase ("bytes");
+
+        ManualTimer::now = 0;
+
+        Cache cache ("test", 0, 60);
+
+        for (int i = 0; i < 4; ++i)
+            insert (cache, i, 1000);
+
+        expect (cache.getCacheBytes () >= 4 * 1000);
+
+        // Replacing an object updates its size
+        std::size_t const before = cache.getCacheBytes ();
+        boost::shared_ptr <Blob> bigger (boost::make_shared <Blob> (5000));
+        cache.canonicalize (0, bigger, true);
+
+        expect (cache.getCacheBytes () >= before + 4000);
+
+        cache.del (0, false);
+
+        expect (cache.getCacheBytes () < before);
+
+        // Everything ages out
+        ManualTimer::now += 100;
+        cache.sweep ();
+
+        expect (cache.getCacheBytes () == 0);
+        expect (cache.getCacheSize () == 0);
+    }
+
+    void testScanResistance ()
+    {
+        beginTestCase ("scan resistance");
+
+        ManualTimer::now = 0;
+
+        Cache cache ("test", 8, 60);
+        cache.setEvictionPolicy (TaggedCache::evictByClock);
+
+        // The working set is used repeatedly
+        for (int i = 0; i < 8; ++i)
+        {
+            insert (cache, i, 10);
+            cache.fetch (i);
+        }
+
+        cache.sweep ();
+
+        // A scan touches many keys once
+        for (int i = 100; i < 200; ++i)
+            insert (cache, i, 10);
+
+        for (int i = 0; i < 8; ++i)
+            cache.fetch (i);
+
+        cache.sweep ();
+
+        expect (cache.getCacheSize () <= 8);
+
+        cache.clearStats ();
+
+        for (int i = 0; i < 8; ++i)
+            expect (cache.fetch (i) != nullptr, "working set was evicted");
+
+        expect (cache.getHitRate () > 80);
+    }
+
+    void runTest ()
+    {
+        testBytes ();
+        testScanResistance ();
+    }
+};
+
+int TaggedCacheTests::ManualTimer::now = 0;
+
+static TaggedCacheTests taggedCacheTests;
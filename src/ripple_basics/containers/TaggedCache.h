@@ -40,6 +40,52 @@ class TaggedCache
 public:
     typedef RippleRecursiveMutex LockType;
     typedef LockType::ScopedLockType ScopedLockType;
+
+    /** How a sweep chooses the objects to drop from the cache. */
+    enum EvictionPolicy
+    {
+        /** Drop objects that were not used within the target age.
+
+            When the cache is over its targets the age is shortened until it
+            fits, so a burst of new objects can push out everything else.
+        */
+        evictByAge,
+
+        /** Scan resistant, in the style of CLOCK-Pro.
+
+            New objects start out cold. An object that is used again before
+            the next sweep becomes hot, and a hot object that goes a whole
+            sweep without being used becomes cold again. When the cache is
+            over its targets the cold objects are dropped first, so objects
+            that were only touched once, for example by a full ledger
+            traversal, cannot push out the working set. Objects older than
+            the target age are dropped either way.
+        */
+        evictByClock
+    };
+};
+
+/** Estimates the memory used by an object held in a TaggedCacheType.
+
+    This is used to enforce the byte target of the cache. Specialize it
+    for types that own storage of varying size.
+*/
+template <typename Data>
+struct TaggedCacheBytes
+{
+    static std::size_t get (Data const&)
+    {
+        return sizeof (Data);
+    }
+};
+
+template <>
+struct TaggedCacheBytes <Blob>
+{
+    static std::size_t get (Blob const& blob)
+    {
+        return sizeof (Blob) + blob.capacity ();
+    }
 };
 
 /** Combination cache/map container.
@@ -62,13 +108,17 @@ public:
 public:
     typedef TaggedCache::LockType LockType;
     typedef TaggedCache::ScopedLockType ScopedLockType;
+    typedef TaggedCache::EvictionPolicy EvictionPolicy;
 
     TaggedCacheType (const char* name, int size, int age)
         : mLock (static_cast <TaggedCache const*>(this), "TaggedCache", __FILE__, __LINE__)
         , mName (name)
+        , mPolicy (evictByAge)
         , mTargetSize (size)
         , mTargetAge (age)
+        , mTargetBytes (0)
         , mCacheCount (0)
+        , mCacheBytes (0)
         , mHits (0)
         , mMisses (0)
     {
@@ -76,14 +126,26 @@ public:
 
     int getTargetSize () const;
     int getTargetAge () const;
+    std::size_t getTargetBytes () const;
+    EvictionPolicy getEvictionPolicy () const;
 
     int getCacheSize ();
     int getTrackSize ();
+    std::size_t getCacheBytes ();
     float getHitRate ();
+    void getHitCounts (uint64& hits, uint64& misses);
     void clearStats ();
 
     void setTargetSize (int size);
     void setTargetAge (int age);
+
+    /** Set the approximate number of bytes the cache should hold.
+        Zero means only the target size and age are used.
+        @see TaggedCacheBytes
+    */
+    void setTargetBytes (std::size_t bytes);
+
+    void setEvictionPolicy (EvictionPolicy policy);
     void sweep ();
     void clear ();
 
@@ -108,12 +170,12 @@ public:
             if (! entry.isCached ())
             {
                 // Convert weak to strong.
-                entry.ptr = entry.lock ();
+                data_ptr const data = entry.lock ();
 
-                if (entry.isCached ())
+                if (data)
                 {
                     // We just put the object back in cache
-                    ++mCacheCount;
+                    setCached (entry, data);
                     entry.touch ();
                     found = true;
                 }
@@ -172,8 +234,15 @@ private:
         int             last_use;
         data_ptr        ptr;
         weak_data_ptr   weak_ptr;
-
-        cache_entry (int l, const data_ptr& d) : last_use (l), ptr (d), weak_ptr (d)
+        std::size_t     bytes;          // Estimated size while cached
+        bool            referenced;     // Used since the last sweep
+        bool            hot;            // Survived a sweep while in use
+
+        explicit cache_entry (int l)
+            : last_use (l)
+            , bytes (0)
+            , referenced (false)
+            , hot (false)
         {
             ;
         }
@@ -196,6 +265,7 @@ private:
         void touch ()
         {
             last_use = Timer::getElapsedSeconds ();
+            referenced = true;
         }
     };
 
@@ -203,12 +273,22 @@ private:
     typedef boost::unordered_map<key_type, cache_entry>     cache_type;
     typedef typename cache_type::iterator                   cache_iterator;
 
+    void setCached (cache_entry& entry, data_ptr const& data);
+    void setUncached (cache_entry& entry);
+    bool isOverTarget () const;
+    int getSweepTarget (int now) const;
+    void sweepPass (int target, bool useClock, std::vector <data_ptr>& stuffToSweep,
+                    int& cacheRemovals, int& mapRemovals);
+
     mutable LockType mLock;
 
     std::string mName;          // Used for logging
+    EvictionPolicy mPolicy;
     int         mTargetSize;    // Desired number of cache entries (0 = ignore)
     int         mTargetAge;     // Desired maximum cache age
+    std::size_t mTargetBytes;   // Desired size of cached items (0 = ignore)
     int         mCacheCount;    // Number of items cached
+    std::size_t mCacheBytes;    // Estimated size of cached items
 
     cache_type  mCache;         // Hold strong reference to recent objects
 
@@ -249,6 +329,36 @@ void TaggedCacheType<c_Key, c_Data, Timer>::setTargetAge (int s)
     WriteLog (lsDEBUG, TaggedCacheLog) << mName << " target age set to " << s;
 }
 
+template<typename c_Key, typename c_Data, class Timer>
+std::size_t TaggedCacheType<c_Key, c_Data, Timer>::getTargetBytes () const
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    return mTargetBytes;
+}
+
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::setTargetBytes (std::size_t bytes)
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    mTargetBytes = bytes;
+    WriteLog (lsDEBUG, TaggedCacheLog) << mName << " target bytes set to " << bytes;
+}
+
+template<typename c_Key, typename c_Data, class Timer>
+typename TaggedCacheType<c_Key, c_Data, Timer>::EvictionPolicy
+TaggedCacheType<c_Key, c_Data, Timer>::getEvictionPolicy () const
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    return mPolicy;
+}
+
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::setEvictionPolicy (EvictionPolicy policy)
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    mPolicy = policy;
+}
+
 template<typename c_Key, typename c_Data, class Timer>
 int TaggedCacheType<c_Key, c_Data, Timer>::getCacheSize ()
 {
@@ -263,6 +373,13 @@ int TaggedCacheType<c_Key, c_Data, Timer>::getTrackSize ()
     return mCache.size ();
 }
 
+template<typename c_Key, typename c_Data, class Timer>
+std::size_t TaggedCacheType<c_Key, c_Data, Timer>::getCacheBytes ()
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    return mCacheBytes;
+}
+
 template<typename c_Key, typename c_Data, class Timer>
 float TaggedCacheType<c_Key, c_Data, Timer>::getHitRate ()
 {
@@ -270,6 +387,14 @@ float TaggedCacheType<c_Key, c_Data, Timer>::getHitRate ()
     return (static_cast<float> (mHits) * 100) / (1.0f + mHits + mMisses);
 }
 
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::getHitCounts (uint64& hits, uint64& misses)
+{
+    ScopedLockType sl (mLock, __FILE__, __LINE__);
+    hits = mHits;
+    misses = mMisses;
+}
+
 template<typename c_Key, typename c_Data, class Timer>
 void TaggedCacheType<c_Key, c_Data, Timer>::clearStats ()
 {
@@ -284,6 +409,7 @@ void TaggedCacheType<c_Key, c_Data, Timer>::clear ()
     ScopedLockType sl (mLock, __FILE__, __LINE__);
     mCache.clear ();
     mCacheCount = 0;
+    mCacheBytes = 0;
 }
 
 template<typename c_Key, typename c_Data, class Timer>
@@ -291,7 +417,6 @@ void TaggedCacheType<c_Key, c_Data, Timer>::sweep ()
 {
     int cacheRemovals = 0;
     int mapRemovals = 0;
-    int cc = 0;
 
     // Keep references to all the stuff we sweep
     // so that we can destroy them outside the lock.
@@ -302,74 +427,132 @@ void TaggedCacheType<c_Key, c_Data, Timer>::sweep ()
         ScopedLockType sl (mLock, __FILE__, __LINE__);
 
         int const now = Timer::getElapsedSeconds ();
-        int target = now - mTargetAge;
 
-        if ((mTargetSize != 0) && (static_cast<int> (mCache.size ()) > mTargetSize))
-        {
-            target = now - (mTargetAge * mTargetSize / mCache.size ());
+        stuffToSweep.reserve (mCache.size ());
 
-            if (target > (now - 2))
-                target = now - 2;
+        if (mPolicy == evictByClock)
+        {
+            sweepPass (now - mTargetAge, true, stuffToSweep, cacheRemovals, mapRemovals);
 
-            WriteLog (lsINFO, TaggedCacheLog) << mName << " is growing fast " <<
-                                              mCache.size () << " of " << mTargetSize <<
-                                              " aging at " << (now - target) << " of " << mTargetAge;
+            // Everything left is in active use, fall back to aging
+            if (isOverTarget ())
+                sweepPass (getSweepTarget (now), false, stuffToSweep, cacheRemovals, mapRemovals);
         }
+        else
+        {
+            sweepPass (getSweepTarget (now), false, stuffToSweep, cacheRemovals, mapRemovals);
+        }
+    }
 
-        stuffToSweep.reserve (mCache.size ());
+    if (ShouldLog (lsTRACE, TaggedCacheLog) && (mapRemovals || cacheRemovals))
+    {
+        WriteLog (lsTRACE, TaggedCacheLog) << mName << ": cache = " << mCache.size () << "-" << cacheRemovals <<
+                                           ", map-=" << mapRemovals;
+    }
+
+    // At this point stuffToSweep will go out of scope outside the lock
+    // and decrement the reference count on each strong pointer.
+}
+
+// Returns the last use time before which cached objects are dropped,
+// shortening the target age when the cache is over its targets.
+template<typename c_Key, typename c_Data, class Timer>
+int TaggedCacheType<c_Key, c_Data, Timer>::getSweepTarget (int now) const
+{
+    int age = mTargetAge;
+
+    if ((mTargetSize != 0) && (static_cast<int> (mCache.size ()) > mTargetSize))
+        age = std::min (age, static_cast<int> (mTargetAge * mTargetSize / mCache.size ()));
 
-        cache_iterator cit = mCache.begin ();
+    if ((mTargetBytes != 0) && (mCacheBytes > mTargetBytes))
+        age = std::min (age, static_cast<int> (mTargetAge *
+            (static_cast<double> (mTargetBytes) / mCacheBytes)));
 
-        while (cit != mCache.end ())
+    if (age == mTargetAge)
+        return now - mTargetAge;
+
+    int target = now - age;
+
+    if (target > (now - 2))
+        target = now - 2;
+
+    WriteLog (lsINFO, TaggedCacheLog) << mName << " is growing fast " <<
+                                      mCache.size () << " of " << mTargetSize <<
+                                      " (" << mCacheBytes << " of " << mTargetBytes << " bytes)" <<
+                                      " aging at " << (now - target) << " of " << mTargetAge;
+
+    return target;
+}
+
+template<typename c_Key, typename c_Data, class Timer>
+bool TaggedCacheType<c_Key, c_Data, Timer>::isOverTarget () const
+{
+    return ((mTargetSize != 0) && (mCacheCount > mTargetSize)) ||
+           ((mTargetBytes != 0) && (mCacheBytes > mTargetBytes));
+}
+
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::sweepPass (int target, bool useClock,
+    std::vector <data_ptr>& stuffToSweep, int& cacheRemovals, int& mapRemovals)
+{
+    cache_iterator cit = mCache.begin ();
+
+    while (cit != mCache.end ())
+    {
+        cache_entry& entry = cit->second;
+
+        if (entry.isWeak ())
         {
-            if (cit->second.isWeak ())
+            // weak
+            if (entry.isExpired ())
             {
-                // weak
-                if (cit->second.isExpired ())
-                {
-                    ++mapRemovals;
-                    cit = mCache.erase (cit);
-                }
-                else
-                {
-                    ++cit;
-                }
+                ++mapRemovals;
+                cit = mCache.erase (cit);
             }
-            else if (cit->second.last_use < target)
+            else
             {
-                // strong, expired
-                --mCacheCount;
-                ++cacheRemovals;
-                if (cit->second.ptr.unique ())
-                {
-                    stuffToSweep.push_back (cit->second.ptr);
-                    ++mapRemovals;
-                    cit = mCache.erase (cit);
-                }
-                else
-                {
-                    // remains weakly cached
-                    cit->second.ptr.reset ();
-                    ++cit;
-                }
+                ++cit;
+            }
+        }
+        else if ((entry.last_use < target) ||
+            (useClock && !entry.hot && !entry.referenced && isOverTarget ()))
+        {
+            // strong, expired or cold while over target
+            ++cacheRemovals;
+            if (entry.ptr.unique ())
+            {
+                stuffToSweep.push_back (entry.ptr);
+                setUncached (entry);
+                ++mapRemovals;
+                cit = mCache.erase (cit);
             }
             else
             {
-                // strong, not expired
-                ++cc;
+                // remains weakly cached
+                setUncached (entry);
                 ++cit;
             }
         }
-    }
+        else
+        {
+            // strong, not expired
+            if (useClock)
+            {
+                // Give used objects another chance, age the rest
+                if (entry.referenced)
+                {
+                    entry.referenced = false;
+                    entry.hot = true;
+                }
+                else
+                {
+                    entry.hot = false;
+                }
+            }
 
-    if (ShouldLog (lsTRACE, TaggedCacheLog) && (mapRemovals || cacheRemovals))
-    {
-        WriteLog (lsTRACE, TaggedCacheLog) << mName << ": cache = " << mCache.size () << "-" << cacheRemovals <<
-                                           ", map-=" << mapRemovals;
+            ++cit;
+        }
     }
-
-    // At this point stuffToSweep will go out of scope outside the lock
-    // and decrement the reference count on each strong pointer.
 }
 
 template<typename c_Key, typename c_Data, class Timer>
@@ -389,8 +572,7 @@ bool TaggedCacheType<c_Key, c_Data, Timer>::del (const key_type& key, bool valid
 
     if (entry.isCached ())
     {
-        --mCacheCount;
-        entry.ptr.reset ();
+        setUncached (entry);
         ret = true;
     }
 
@@ -412,8 +594,8 @@ bool TaggedCacheType<c_Key, c_Data, Timer>::canonicalize (const key_type& key, b
 
     if (cit == mCache.end ())
     {
-        mCache.insert (cache_pair (key, cache_entry (Timer::getElapsedSeconds (), data)));
-        ++mCacheCount;
+        cit = mCache.insert (cache_pair (key, cache_entry (Timer::getElapsedSeconds ()))).first;
+        setCached (cit->second, data);
         return false;
     }
 
@@ -423,10 +605,7 @@ bool TaggedCacheType<c_Key, c_Data, Timer>::canonicalize (const key_type& key, b
     if (entry.isCached ())
     {
         if (replace)
-        {
-            entry.ptr = data;
-            entry.weak_ptr = data;
-        }
+            setCached (entry, data);
         else
             data = entry.ptr;
 
@@ -439,22 +618,18 @@ bool TaggedCacheType<c_Key, c_Data, Timer>::canonicalize (const key_type& key, b
     {
         if (replace)
         {
-            entry.ptr = data;
-            entry.weak_ptr = data;
+            setCached (entry, data);
         }
         else
         {
-            entry.ptr = cachedData;
+            setCached (entry, cachedData);
             data = cachedData;
         }
 
-        ++mCacheCount;
         return true;
     }
 
-    entry.ptr = data;
-    entry.weak_ptr = data;
-    ++mCacheCount;
+    setCached (entry, data);
 
     return false;
 }
@@ -482,13 +657,13 @@ boost::shared_ptr<c_Data> TaggedCacheType<c_Key, c_Data, Timer>::fetch (const ke
         return entry.ptr;
     }
 
-    entry.ptr = entry.lock ();
+    data_ptr const data = entry.lock ();
 
-    if (entry.isCached ())
+    if (data)
     {
         // independent of cache size, so not counted as a hit
-        ++mCacheCount;
-        return entry.ptr;
+        setCached (entry, data);
+        return data;
     }
 
     mCache.erase (cit);
@@ -516,4 +691,29 @@ bool TaggedCacheType<c_Key, c_Data, Timer>::retrieve (const key_type& key, c_Dat
     return true;
 }
 
+// Make the entry hold a strong reference to the data
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::setCached (cache_entry& entry, data_ptr const& data)
+{
+    if (entry.isCached ())
+        mCacheBytes -= entry.bytes;
+    else
+        ++mCacheCount;
+
+    entry.ptr = data;
+    entry.weak_ptr = data;
+    entry.bytes = data ? TaggedCacheBytes <c_Data>::get (*data) : 0;
+    mCacheBytes += entry.bytes;
+}
+
+// Drop the strong reference, leaving the entry weakly tracked
+template<typename c_Key, typename c_Data, class Timer>
+void TaggedCacheType<c_Key, c_Data, Timer>::setUncached (cache_entry& entry)
+{
+    --mCacheCount;
+    mCacheBytes -= entry.bytes;
+    entry.bytes = 0;
+    entry.ptr.reset ();
+}
+
 #endif
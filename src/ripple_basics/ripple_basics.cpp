@@ -24,6 +24,7 @@
 
 #include "beast/modules/beast_core/system/BeforeBoost.h"
 #include <boost/asio.hpp> // For StringUtilities.cpp
+#include <boost/thread/tss.hpp> // For Arena.cpp
 
 #include <fstream> // for Log files
 
@@ -56,6 +57,7 @@ namespace ripple
 #include "log/LogPartition.cpp"
 #include "log/LogSink.cpp"
 
+#include "utility/Arena.cpp"
 #include "utility/CountedObject.cpp"
 #include "utility/IniFile.cpp"
 #include "utility/StringUtilities.cpp"
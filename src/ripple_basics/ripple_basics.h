@@ -72,6 +72,7 @@ using namespace beast;
 #include "log/LogJournal.h"
 #include "log/LoggedTimings.h"
 
+#include "utility/Arena.h"
 #include "utility/CountedObject.h"
 #include "utility/IniFile.h"
 #include "utility/PlatformMacros.h"
@@ -85,6 +86,7 @@ using namespace beast;
 #include "containers/RangeSet.h"
 #include "containers/BlackList.h"
 #include "containers/TaggedCache.h"
+#include "containers/ShardedTaggedCache.h"
 
 }
 
@@ -0,0 +1,265 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+struct Arena::Block
+{
+    Block* next;
+};
+
+namespace
+{
+
+// The arena is a thread's own business, there is nothing to clean up
+void keepArena (Arena*)
+{
+}
+
+boost::thread_specific_ptr <Arena>& currentArena ()
+{
+    static boost::thread_specific_ptr <Arena> current (&keepArena);
+    return current;
+}
+
+// Rounded so that what follows stays 16 byte aligned
+std::size_t const arenaSize = (sizeof (Arena) + 15) & ~std::size_t (15);
+std::size_t const blockHeaderSize = 16;
+
+}
+
+//------------------------------------------------------------------------------
+
+Arena::Scope::Scope ()
+    : m_arena (nullptr)
+{
+    if (Arena::getCurrent () == nullptr)
+    {
+        m_arena = Arena::create ();
+        Arena::setCurrent (m_arena);
+    }
+}
+
+Arena::Scope::~Scope ()
+{
+    if (m_arena != nullptr)
+    {
+        Arena::setCurrent (nullptr);
+        m_arena->release ();
+    }
+}
+
+Arena::Suspend::Suspend ()
+    : m_previous (Arena::getCurrent ())
+{
+    if (m_previous != nullptr)
+        Arena::setCurrent (nullptr);
+}
+
+Arena::Suspend::~Suspend ()
+{
+    if (m_previous != nullptr)
+        Arena::setCurrent (m_previous);
+}
+
+//------------------------------------------------------------------------------
+
+Arena::Arena ()
+    : m_blocks (nullptr)
+    , m_next (nullptr)
+    , m_end (nullptr)
+    , m_used (0)
+    , m_refs (1)
+{
+}
+
+Arena::~Arena ()
+{
+    while (m_blocks != nullptr)
+    {
+        Block* next = m_blocks->next;
+        free (m_blocks);
+        m_blocks = next;
+    }
+}
+
+Arena* Arena::create ()
+{
+    // The first block shares the allocation of the arena itself
+    char* mem = static_cast <char*> (malloc (arenaSize + blockSize));
+
+    if (mem == nullptr)
+        throw std::bad_alloc ();
+
+    Arena* arena = new (mem) Arena;
+    arena->m_next = mem + arenaSize;
+    arena->m_end = arena->m_next + blockSize;
+    return arena;
+}
+
+Arena* Arena::getCurrent ()
+{
+    return currentArena ().get ();
+}
+
+void Arena::setCurrent (Arena* arena)
+{
+    currentArena ().reset (arena);
+}
+
+void* Arena::allocate (std::size_t bytes)
+{
+    Arena* arena = getCurrent ();
+
+    if ((arena != nullptr) && (bytes <= largeSize))
+        return arena->allocateHere ((bytes + 15) & ~std::size_t (15));
+
+    char* mem = static_cast <char*> (malloc (headerSize + bytes));
+
+    if (mem == nullptr)
+        throw std::bad_alloc ();
+
+    *reinterpret_cast <Arena**> (mem) = nullptr;
+    return mem + headerSize;
+}
+
+void Arena::deallocate (void* p)
+{
+    if (p == nullptr)
+        return;
+
+    char* mem = static_cast <char*> (p) - headerSize;
+    Arena* arena = *reinterpret_cast <Arena**> (mem);
+
+    if (arena != nullptr)
+        arena->release ();
+    else
+        free (mem);
+}
+
+void* Arena::allocateHere (std::size_t bytes)
+{
+    std::size_t const needed = headerSize + bytes;
+
+    if (static_cast <std::size_t> (m_end - m_next) < needed)
+    {
+        Block* block = static_cast <Block*> (malloc (blockHeaderSize + blockSize));
+
+        if (block == nullptr)
+            throw std::bad_alloc ();
+
+        block->next = m_blocks;
+        m_blocks = block;
+        m_next = reinterpret_cast <char*> (block) + blockHeaderSize;
+        m_end = m_next + blockSize;
+    }
+
+    char* mem = m_next;
+    m_next += needed;
+    m_used += bytes;
+    ++m_refs;
+
+    *reinterpret_cast <Arena**> (mem) = this;
+    return mem + headerSize;
+}
+
+void Arena::release ()
+{
+    if (--m_refs == 0)
+    {
+        this->~Arena ();
+        free (this);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+class ArenaTests : public UnitTest
+{
+public:
+    ArenaTests () : UnitTest ("Arena", "ripple")
+    {
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("scope");
+
+        unexpected (Arena::getCurrent () != nullptr, "arena current outside a scope");
+
+        void* escaped;
+        {
+            Arena::Scope scope;
+            Arena* arena = Arena::getCurrent ();
+
+            unexpected (arena == nullptr, "no arena inside a scope");
+
+            {
+                Arena::Scope nested;
+                unexpected (Arena::getCurrent () != arena, "nested scope did not share");
+            }
+
+            unexpected (Arena::getCurrent () != arena, "nested scope lost the arena");
+
+            std::vector <void*> blocks;
+
+            // Enough to span several blocks
+            for (int i = 0; i < 1000; ++i)
+            {
+                void* p = Arena::allocate (1 + (i % 100));
+                unexpected ((reinterpret_cast <std::size_t> (p) & 15) != 0, "misaligned");
+                memset (p, i & 0xff, 1 + (i % 100));
+                blocks.push_back (p);
+            }
+
+            unexpected (arena->getUsed () < 50000, "bytes not counted");
+
+            {
+                Arena::Suspend suspend;
+                unexpected (Arena::getCurrent () != nullptr, "suspend did not suspend");
+                Arena::deallocate (Arena::allocate (8));
+            }
+
+            unexpected (Arena::getCurrent () != arena, "suspend did not restore");
+
+            for (std::size_t i = 0; i < blocks.size (); ++i)
+                unexpected (*static_cast <unsigned char*> (blocks[i]) != (i & 0xff), "overwritten");
+
+            BOOST_FOREACH (void* p, blocks)
+            {
+                Arena::deallocate (p);
+            }
+
+            // Large requests go to the heap
+            Arena::deallocate (Arena::allocate (100000));
+
+            escaped = Arena::allocate (32);
+            memset (escaped, 0x5a, 32);
+        }
+
+        beginTestCase ("escape");
+
+        unexpected (Arena::getCurrent () != nullptr, "arena still current");
+
+        // The arena outlives its scope while the allocation is alive
+        unexpected (static_cast <unsigned char*> (escaped)[31] != 0x5a, "escaped object lost");
+        Arena::deallocate (escaped);
+    }
+};
+
+static ArenaTests arenaTests;
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_ARENA_H_INCLUDED
+#define RIPPLE_ARENA_H_INCLUDED
+
+/** Bump allocator for objects that die together.
+
+    While an Arena::Scope is alive on a thread, allocate() carves memory
+    out of large blocks owned by the scope's arena instead of calling
+    malloc, and deallocate() only drops a count. The blocks are all freed
+    at once when the scope has ended and the last object allocated from
+    them is gone, so an object that outlives its scope stays valid.
+
+    Freed memory is never reused, and a single object that escapes keeps
+    every block alive. A scope should only cover short work whose objects
+    die together, such as applying one transaction.
+
+    Objects that are about to be kept in a long lived cache should be
+    created under an Arena::Suspend, otherwise they hold the whole arena
+    in memory.
+
+    Memory from allocate() may be released from any thread.
+*/
+class Arena : public Uncopyable
+{
+public:
+    /** Makes a new arena current on this thread.
+
+        If an arena is already current, the scope shares it.
+    */
+    class Scope : public Uncopyable
+    {
+    public:
+        Scope ();
+        ~Scope ();
+
+    private:
+        Arena* m_arena;
+    };
+
+    /** Turns arena allocation off on this thread until destroyed. */
+    class Suspend : public Uncopyable
+    {
+    public:
+        Suspend ();
+        ~Suspend ();
+
+    private:
+        Arena* m_previous;
+    };
+
+    /** Allocates from the current arena, or from the heap if there is none. */
+    static void* allocate (std::size_t bytes);
+
+    /** Releases memory obtained from allocate. */
+    static void deallocate (void* p);
+
+    /** Returns the arena current on this thread, if any. */
+    static Arena* getCurrent ();
+
+    /** Returns the number of bytes handed out by this arena. */
+    std::size_t getUsed () const
+    {
+        return m_used;
+    }
+
+private:
+    enum
+    {
+        headerSize  = 16,           // Keeps the returned memory 16 byte aligned
+        blockSize   = 16384,
+        largeSize   = 2048          // Larger requests always go to the heap
+    };
+
+    struct Block;
+
+    Arena ();
+    ~Arena ();
+
+    static Arena* create ();
+    static void setCurrent (Arena* arena);
+
+    void* allocateHere (std::size_t bytes);
+    void release ();
+
+    Block* m_blocks;
+    char* m_next;
+    char* m_end;
+    std::size_t m_used;
+    Atomic <int> m_refs;
+};
+
+#endif
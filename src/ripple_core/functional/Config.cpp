@@ -106,6 +106,7 @@ Config::Config ()
     SSL_VERIFY              = true;
 
     ELB_SUPPORT             = false;
+    PARALLEL_APPLY          = false;
     RUN_STANDALONE          = false;
     START_UP                = NORMAL;
 }
@@ -342,6 +343,9 @@ void Config::load ()
             importNodeDatabase = parseKeyValueSection (
                 secConfig, ConfigSection::importNodeDatabase ());
 
+            jobQueue = parseKeyValueSection (
+                secConfig, ConfigSection::jobQueue ());
+
             if (SectionSingleB (secConfig, SECTION_PEER_PORT, strTemp))
                 peerListeningPort = lexicalCastThrow <int> (strTemp);
 
@@ -398,6 +402,9 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_ELB_SUPPORT, strTemp))
                 ELB_SUPPORT         = lexicalCastThrow <bool> (strTemp);
 
+            if (SectionSingleB (secConfig, SECTION_PARALLEL_APPLY, strTemp))
+                PARALLEL_APPLY      = lexicalCastThrow <bool> (strTemp);
+
             (void) SectionSingleB (secConfig, SECTION_WEBSOCKET_IP, WEBSOCKET_IP);
 
             if (SectionSingleB (secConfig, SECTION_WEBSOCKET_PORT, strTemp))
@@ -548,6 +555,7 @@ int Config::getSize (SizedItemName item)
 
         { siNodeCacheSize,      {   8192,   65536,  262144, 512000,     0       } },
         { siNodeCacheAge,       {   30,     60,     90,     120,        900     } },
+        { siNodeCacheMB,        {   32,     128,    512,    1024,       0       } },
 
         { siSLECacheSize,       {   4096,   8192,   16384,  65536,      0       } },
         { siSLECacheAge,        {   30,     60,     90,     120,        300     } },
@@ -556,6 +564,7 @@ int Config::getSize (SizedItemName item)
         { siLedgerAge,          {   30,     90,     180,    240,        900     } },
 
         { siHashNodeDBCache,    {   4,      12,     24,     64,         128      } },
+        { siNodeReadThreads,    {   1,      2,      4,      6,          8        } },
         { siTxnDBCache,         {   4,      12,     24,     64,         128      } },
         { siLgrDBCache,         {   4,      8,      16,     32,         128      } },
     };
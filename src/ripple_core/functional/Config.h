@@ -65,12 +65,14 @@ enum SizedItemName
     siValidationsAge,
     siNodeCacheSize,
     siNodeCacheAge,
+    siNodeCacheMB,
     siSLECacheSize,
     siSLECacheAge,
     siLedgerSize,
     siLedgerAge,
     siLedgerFetch,
     siHashNodeDBCache,
+    siNodeReadThreads,
     siTxnDBCache,
     siLgrDBCache,
 };
@@ -328,6 +330,16 @@ public:
     */
     StringPairArray importNodeDatabase;
 
+    /** Parameters for the threads that run the JobQueue.
+
+        This is 0 or more strings of the form <key>=<value>
+        Recognized keys are 'work_stealing', 'cpus' and 'pin_threads',
+        see rippled-example.cfg
+
+        @see JobQueue
+    */
+    StringPairArray jobQueue;
+
     //
     //
     //--------------------------------------------------------------------------
@@ -371,6 +383,7 @@ public:
     int                         LEDGER_PROPOSAL_DELAY_SECONDS;
     int                         LEDGER_AVALANCHE_SECONDS;
     bool                        LEDGER_CREATOR;         // Should be false unless we are starting a new ledger.
+    bool                        PARALLEL_APPLY;         // Speculatively apply consensus transactions in parallel
 
     /** Operate in stand-alone mode.
 
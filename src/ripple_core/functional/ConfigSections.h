@@ -32,6 +32,7 @@ struct ConfigSection
     static String nodeDatabase ()                 { return "node_db"; }
     static String tempNodeDatabase ()             { return "temp_db"; }
     static String importNodeDatabase ()           { return "import_db"; }
+    static String jobQueue ()                     { return "job_queue"; }
 };
 
 // VFALCO TODO Rename and replace these macros with variables.
@@ -52,6 +53,7 @@ struct ConfigSection
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
 #define SECTION_NODE_SIZE               "node_size"
+#define SECTION_PARALLEL_APPLY          "parallel_apply"
 #define SECTION_PATH_SEARCH_OLD         "path_search_old"
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
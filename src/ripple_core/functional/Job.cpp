@@ -126,6 +126,8 @@ const char* Job::toString (JobType t)
     case jtNETOP_TIMER:     return "heartbeat";
 
     case jtADMIN:           return "administration";
+    case jtSHAMAP_HASH:     return "hashSubtree";
+    case jtSPECULATE:       return "speculateTransactions";
 
     // special types not dispatched by the job pool
     case jtPEER:            return "peerCommand";
@@ -50,6 +50,8 @@ enum JobType
     jtNETOP_CLUSTER = 21,   // NetworkOPs cluster peer report
     jtNETOP_TIMER   = 22,   // NetworkOPs net timer processing
     jtADMIN         = 23,   // An administrative operation
+    jtSHAMAP_HASH   = 24,   // Rehash a SHAMap subtree for a waiting thread
+    jtSPECULATE     = 25,   // Speculatively apply transactions for a waiting thread
 
     // special types not dispatched by the job pool
     jtPEER          = 30,
@@ -25,6 +25,9 @@ class JobQueueImp
 public:
     // Statistics for each JobType
     //
+    // The counts are only changed while holding the mutex, but they are
+    // atomic so that they can be read without it.
+    //
     struct Count
     {
         Count () noexcept
@@ -35,29 +38,29 @@ public:
         {
         }
 
-        Count (JobType type_) noexcept
-            : type (type_)
-            , waiting (0)
-            , running (0)
-            , deferred (0)
-        {
-        }
-
-        JobType type;    // The type of Job these counts reflect
-        int waiting;     // The number waiting
-        int running;     // How many are running
-        int deferred;    // Number of jobs we didn't signal due to limits
+        JobType type;           // The type of Job these counts reflect
+        Atomic <int> waiting;   // The number waiting
+        Atomic <int> running;   // How many are running
+        int deferred;           // Number of jobs we didn't signal due to limits
     };
 
-    typedef std::set <Job> JobSet;
-    typedef std::map <JobType, Count> MapType;
+    // Waiting jobs of a single type, in the order they were added
+    typedef std::deque <Job> JobList;
     typedef CriticalSection::ScopedLockType ScopedLock;
 
     Journal m_journal;
     CriticalSection m_mutex;
     uint64 m_lastJob;
-    JobSet m_jobSet;
-    MapType m_jobCounts;
+    JobList m_jobs [NUM_JOB_TYPES];
+    Count m_jobCounts [NUM_JOB_TYPES];
+
+    // Bit N is set when jobs of type N are waiting and below their limit.
+    // Higher types have higher priority, so the next job to run comes from
+    // the highest set bit.
+    uint64 m_runnable;
+
+    // The total number of waiting jobs
+    int m_waitingCount;
 
     // The number of jobs running through processTask()
     int m_processCount;
@@ -72,21 +75,16 @@ public:
         : JobQueue ("JobQueue", parent)
         , m_journal (journal)
         , m_lastJob (0)
+        , m_runnable (0)
+        , m_waitingCount (0)
         , m_processCount (0)
         , m_workers (*this, "JobQueue", 0)
         , m_cancelCallback (boost::bind (&Stoppable::isStopping, this))
     {
-        {
-            ScopedLock lock (m_mutex);
+        static_bassert (NUM_JOB_TYPES <= 64);
 
-            // Initialize the job counts.
-            // The 'limit' field in particular will be set based on the limit
-            for (int i = 0; i < NUM_JOB_TYPES; ++i)
-            {
-                JobType const type (static_cast <JobType> (i));
-                m_jobCounts [type] = Count (type);
-            }
-        }
+        for (int i = 0; i < NUM_JOB_TYPES; ++i)
+            m_jobCounts [i].type = static_cast <JobType> (i);
 
         m_loads [ jtPUBOLDLEDGER  ].setTargetLatency (10000, 15000);
         m_loads [ jtVALIDATION_ut ].setTargetLatency (2000, 5000);
@@ -137,30 +135,27 @@ public:
         {
             ScopedLock lock (m_mutex);
 
-            std::pair< std::set <Job>::iterator, bool > it =
-                m_jobSet.insert (Job (
-                    type, name, ++m_lastJob, m_loads[type], jobFunc, m_cancelCallback));
+            m_jobs [type].push_back (Job (
+                type, name, ++m_lastJob, m_loads[type], jobFunc, m_cancelCallback));
 
-            queueJob (*it.first, lock);
+            queueJob (m_jobs [type].back (), lock);
         }
     }
 
     int getJobCount (JobType t)
     {
-        ScopedLock lock (m_mutex);
-
-        MapType::const_iterator c = m_jobCounts.find (t);
+        if (! isValidType (t))
+            return 0;
 
-        return (c == m_jobCounts.end ()) ? 0 : c->second.waiting;
+        return m_jobCounts [t].waiting.get ();
     }
 
     int getJobCountTotal (JobType t)
     {
-        ScopedLock lock (m_mutex);
+        if (! isValidType (t))
+            return 0;
 
-        MapType::const_iterator c = m_jobCounts.find (t);
-
-        return (c == m_jobCounts.end ()) ? 0 : (c->second.waiting + c->second.running);
+        return m_jobCounts [t].waiting.get () + m_jobCounts [t].running.get ();
     }
 
     int getJobCountGE (JobType t)
@@ -168,15 +163,8 @@ public:
         // return the number of jobs at this priority level or greater
         int ret = 0;
 
-        ScopedLock lock (m_mutex);
-
-        typedef MapType::value_type jt_int_pair;
-
-        BOOST_FOREACH (jt_int_pair const& it, m_jobCounts)
-        {
-            if (it.first >= t)
-                ret += it.second.waiting;
-        }
+        for (int i = std::max (0, static_cast <int> (t)); i < NUM_JOB_TYPES; ++i)
+            ret += m_jobCounts [i].waiting.get ();
 
         return ret;
     }
@@ -186,16 +174,14 @@ public:
         // return all jobs at all priority levels
         std::vector< std::pair<JobType, std::pair<int, int> > > ret;
 
-        ScopedLock lock (m_mutex);
-
-        ret.reserve (m_jobCounts.size ());
-
-        typedef MapType::value_type jt_int_pair;
+        ret.reserve (NUM_JOB_TYPES);
 
-        BOOST_FOREACH (const jt_int_pair & it, m_jobCounts)
+        for (int i = 0; i < NUM_JOB_TYPES; ++i)
         {
-            ret.push_back (std::make_pair (it.second.type,
-                std::make_pair (it.second.waiting, it.second.running)));
+            Count const& count (m_jobCounts [i]);
+
+            ret.push_back (std::make_pair (count.type,
+                std::make_pair (count.waiting.get (), count.running.get ())));
         }
 
         return ret;
@@ -239,6 +225,23 @@ public:
     }
 
 
+    void configure (StringPairArray const& params)
+    {
+        bool const stealing (params ["work_stealing"].getIntValue () != 0);
+        bool const pinThreads (params ["pin_threads"].getIntValue () != 0);
+        uint32 const cpuMask (parseCpuList (params ["cpus"]));
+
+        m_workers.setWorkStealing (stealing);
+        m_workers.setAffinity (cpuMask, pinThreads);
+
+        if (stealing)
+            m_journal.info << "Work stealing enabled";
+
+        if (cpuMask != 0)
+            m_journal.info << "Threads " << (pinThreads ? "pinned to" : "limited to") <<
+                " CPU mask 0x" << String::toHexString (static_cast <int> (cpuMask));
+    }
+
     LoadEvent::pointer getLoadEvent (JobType t, const std::string& name)
     {
         return boost::make_shared<LoadEvent> (boost::ref (m_loads[t]), name, true);
@@ -269,8 +272,6 @@ public:
 
         Json::Value priorities = Json::arrayValue;
 
-        ScopedLock lock (m_mutex);
-
         for (int i = 0; i < NUM_JOB_TYPES; ++i)
         {
             JobType const type (static_cast <JobType> (i));
@@ -287,18 +288,8 @@ public:
 
             m_loads [i].getCountAndLatency (count, latencyAvg, latencyPeak, isOver);
 
-            MapType::const_iterator it = m_jobCounts.find (type);
-
-            if (it == m_jobCounts.end ())
-            {
-                jobCount = 0;
-                threadCount = 0;
-            }
-            else
-            {
-                jobCount = it->second.waiting;
-                threadCount = it->second.running;
-            }
+            jobCount = m_jobCounts [i].waiting.get ();
+            threadCount = m_jobCounts [i].running.get ();
 
             if ((count != 0) || (jobCount != 0) || (latencyPeak != 0) || (threadCount != 0))
             {
@@ -336,6 +327,82 @@ public:
 private:
     //------------------------------------------------------------------------------
 
+    // Parses a list of CPU numbers and ranges such as "0-3,8,10-11"
+    // into an affinity mask. Only CPUs 0 through 31 can be represented.
+    //
+    uint32 parseCpuList (String const& list)
+    {
+        uint32 mask = 0;
+
+        StringArray tokens;
+        tokens.addTokens (list, ",", String::empty);
+        tokens.trim ();
+        tokens.removeEmptyStrings ();
+
+        for (int i = 0; i < tokens.size (); ++i)
+        {
+            String const& token (tokens [i]);
+
+            int first = token.getIntValue ();
+            int last = first;
+
+            if (token.containsChar ('-'))
+                last = token.fromFirstOccurrenceOf ("-", false, false).getIntValue ();
+
+            if (first < 0 || last > 31 || first > last)
+            {
+                m_journal.warning << "Ignoring CPU range '" << token << "'";
+                continue;
+            }
+
+            for (int cpu = first; cpu <= last; ++cpu)
+                mask |= uint32 (1) << cpu;
+        }
+
+        return mask;
+    }
+
+    static bool isValidType (JobType type)
+    {
+        return (type >= 0) && (type < NUM_JOB_TYPES);
+    }
+
+    // Returns the index of the highest set bit. The mask must not be zero.
+    //
+    static int highestBit (uint64 mask)
+    {
+        int bit = 0;
+
+        if (mask >> 32) { mask >>= 32; bit += 32; }
+        if (mask >> 16) { mask >>= 16; bit += 16; }
+        if (mask >> 8)  { mask >>= 8;  bit += 8; }
+        if (mask >> 4)  { mask >>= 4;  bit += 4; }
+        if (mask >> 2)  { mask >>= 2;  bit += 2; }
+        if (mask >> 1)  { bit += 1; }
+
+        return bit;
+    }
+
+    // Sets or clears the runnable bit for a type to reflect its
+    // waiting jobs and how many of them are already running.
+    //
+    void updateRunnable (JobType type, ScopedLock const& lock)
+    {
+        uint64 const bit (uint64 (1) << type);
+
+        if (! m_jobs [type].empty () &&
+            m_jobCounts [type].running.get () < getJobLimit (type))
+        {
+            m_runnable |= bit;
+        }
+        else
+        {
+            m_runnable &= ~bit;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
     // Signals the service stopped if the stopped condition is met.
     //
     void checkStopped (ScopedLock const& lock)
@@ -350,7 +417,7 @@ private:
         if (isStopping() &&
             areChildrenStopped() &&
             (m_processCount == 0) &&
-            m_jobSet.empty())
+            (m_waitingCount == 0))
         {
             stopped();
         }
@@ -362,7 +429,7 @@ private:
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
+    //  The Job must be the last one in the list for its type.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
@@ -376,12 +443,12 @@ private:
     {
         JobType const type (job.getType ());
 
-        bassert (type != jtINVALID);
-        bassert (m_jobSet.find (job) != m_jobSet.end ());
+        bassert (isValidType (type));
+        bassert (&m_jobs [type].back () == &job);
 
         Count& count (m_jobCounts [type]);
 
-        if (count.waiting + count.running < getJobLimit (type))
+        if (count.waiting.get () + count.running.get () < getJobLimit (type))
         {
             m_workers.addTask ();
         }
@@ -392,6 +459,9 @@ private:
             ++count.deferred;
         }
         ++count.waiting;
+        ++m_waitingCount;
+
+        updateRunnable (type, lock);
     }
 
     //------------------------------------------------------------------------------
@@ -399,15 +469,15 @@ private:
     // Returns the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  The oldest waiting Job of a type whose running count is below its limit.
+    //  The runnable bitmap has a bit set for each type with a RunnableJob.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  At least one RunnableJob exists.
     //
     // Post-conditions:
-    //  job is a valid Job object.
-    //  job is removed from mJobQueue.
+    //  job is the RunnableJob with the highest priority type.
+    //  job is removed from the list for its type.
     //  Waiting job count of it's type is decremented
     //  Running job count of it's type is incremented
     //
@@ -416,35 +486,24 @@ private:
     //
     void getNextJob (Job& job, ScopedLock const& lock)
     {
-        bassert (! m_jobSet.empty ());
+        bassert (m_runnable != 0);
 
-        JobSet::const_iterator iter;
-        for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
-        {
-            Count& count (m_jobCounts [iter->getType ()]);
-
-            bassert (count.running <= getJobLimit (count.type));
-
-            // Run this job if we're running below the limit.
-            if (count.running < getJobLimit (count.type))
-            {
-                bassert (count.waiting > 0);
-                break;
-            }
-        }
-
-        bassert (iter != m_jobSet.end ());
-
-        JobType const type = iter->getType ();
+        JobType const type (static_cast <JobType> (highestBit (m_runnable)));
+        JobList& jobs (m_jobs [type]);
         Count& count (m_jobCounts [type]);
 
-        bassert (type != jtINVALID);
+        bassert (! jobs.empty ());
+        bassert (count.waiting.get () > 0);
+        bassert (count.running.get () < getJobLimit (type));
 
-        job = *iter;
-        m_jobSet.erase (iter);
+        job = jobs.front ();
+        jobs.pop_front ();
 
         --count.waiting;
+        --m_waitingCount;
         ++count.running;
+
+        updateRunnable (type, lock);
     }
 
     //------------------------------------------------------------------------------
@@ -452,7 +511,7 @@ private:
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
+    //  Job must have been removed by getNextJob.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
@@ -466,21 +525,22 @@ private:
     {
         JobType const type = job.getType ();
 
-        bassert (m_jobSet.find (job) == m_jobSet.end ());
-        bassert (type != jtINVALID);
+        bassert (isValidType (type));
 
         Count& count (m_jobCounts [type]);
 
         // Queue a deferred task if possible
         if (count.deferred > 0)
         {
-            bassert (count.running + count.waiting >= getJobLimit (type));
+            bassert (count.running.get () + count.waiting.get () >= getJobLimit (type));
 
             --count.deferred;
             m_workers.addTask ();
         }
 
         --count.running;
+
+        updateRunnable (type, lock);
     }
 
     //------------------------------------------------------------------------------
@@ -488,7 +548,7 @@ private:
     // Runs the next appropriate waiting Job.
     //
     // Pre-conditions:
-    //  A RunnableJob must exist in the JobSet
+    //  A RunnableJob must exist
     //
     // Post-conditions:
     //  The chosen RunnableJob will have Job::doJob() called.
@@ -565,6 +625,8 @@ private:
         case jtNETOP_CLUSTER:
         case jtNETOP_TIMER:
         case jtADMIN:
+        case jtSHAMAP_HASH:
+        case jtSPECULATE:
             return true;
 
         default:
@@ -622,6 +684,8 @@ private:
         case jtPROPOSAL_t:
         case jtSWEEP:
         case jtADMIN:
+        case jtSHAMAP_HASH:
+        case jtSPECULATE:
             limit = std::numeric_limits <int>::max ();
             break;
 
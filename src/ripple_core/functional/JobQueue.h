@@ -52,6 +52,12 @@ public:
 
     virtual void setThreadCount (int c, bool const standaloneMode) = 0;
 
+    /** Apply the [job_queue] configuration.
+        This must be called before setThreadCount.
+        @see Config::jobQueue
+    */
+    virtual void configure (StringPairArray const& params) = 0;
+
     // VFALCO TODO Rename these to newLoadEventMeasurement or something similar
     //             since they create the object.
     //
@@ -31,6 +31,8 @@ namespace ripple
 #  include "impl/DecodedBlob.h"
 #  include "impl/EncodedBlob.h"
 #  include "impl/BatchWriter.h"
+#  include "impl/FetchOrder.h"
+#  include "impl/AsyncReader.h"
 # include "backend/HyperDBFactory.h"
 #include "backend/HyperDBFactory.cpp"
 # include "backend/KeyvaDBFactory.h"
@@ -46,6 +48,7 @@ namespace ripple
 # include "backend/SophiaFactory.h"
 #include "backend/SophiaFactory.cpp"
 
+#include "impl/AsyncReader.cpp"
 #include "impl/BatchWriter.cpp"
 # include "impl/Factories.h"
 # include "impl/DatabaseImp.h"
@@ -64,6 +64,42 @@ public:
     */
     virtual Status fetch (void const* key, NodeObject::Ptr* pObject) = 0;
 
+    /** Fetch a group of objects.
+
+        On return, pObjects holds one entry for each key, in the same order
+        as the keys. Objects which are not found are set to `nullptr`.
+
+        Backends which can coalesce lookups, for example by visiting the
+        keys in sorted order under a single read transaction, should
+        override this. The default implementation calls @ref fetch for
+        each key.
+
+        @note This will be called concurrently.
+
+        @param keys The keys of the objects to fetch.
+        @param pObjects [out] The fetched objects.
+
+        @return `ok` if every key was either found or not found, otherwise
+                the first error status encountered.
+    */
+    virtual Status fetchBatch (std::vector <uint256> const& keys, Batch* pObjects)
+    {
+        Status result (ok);
+
+        pObjects->clear ();
+        pObjects->resize (keys.size ());
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            Status const status = fetch (keys [i].begin (), &(*pObjects) [i]);
+
+            if (status != ok && status != notFound && result == ok)
+                result = status;
+        }
+
+        return result;
+    }
+
     /** Store a single object.
 
         Depending on the implementation this may happen immediately
@@ -99,6 +99,46 @@ public:
     */
     virtual NodeObject::pointer fetch (uint256 const& hash) = 0;
 
+    /** Fetch a group of objects.
+        Objects already in the cache are returned directly, the remaining
+        keys are looked up together using @ref Backend::fetchBatch so that
+        the backend can coalesce its reads.
+
+        On return, pObjects holds one entry for each hash, in the same
+        order. Objects which could not be retrieved are `nullptr`.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects to retrieve.
+        @param pObjects [out] The retrieved objects.
+        @return The number of objects which were retrieved.
+    */
+    virtual int fetchBatch (std::vector <uint256> const& hashes,
+                            Batch* pObjects) = 0;
+
+    /** Fetch an object without blocking.
+        If the object is already in the cache, or is known not to be in
+        the database, the callback is invoked before this returns.
+        Otherwise the read is queued to the Scheduler's read tasks and
+        the callback is invoked from one of them.
+
+        @note This can be called concurrently.
+        @param hash The key of the object to retrieve.
+        @param callback Receives the object, or nullptr if it couldn't be
+                        retrieved.
+    */
+    virtual void asyncFetch (uint256 const& hash,
+                             FetchCallback const& callback) = 0;
+
+    /** Hint that objects will be wanted soon.
+        Objects which are not already cached are read in the background
+        so that a later @ref fetch finds them in the cache. Hints may be
+        ignored when the read queue is full.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects which will be wanted.
+    */
+    virtual void prefetch (std::vector <uint256> const& hashes) = 0;
+
     /** Store the object.
 
         The caller's Blob parameter is overwritten.
@@ -116,6 +156,17 @@ public:
                         Blob& data,
                         uint256 const& hash) = 0;
 
+    /** Store a group of objects.
+
+        Objects which are not already cached are added to the cache and
+        written to the backend together using @ref Backend::storeBatch,
+        on the caller's thread.
+
+        @note This can be called concurrently.
+        @param batch The objects to store.
+    */
+    virtual void storeBatch (Batch const& batch) = 0;
+
     /** Visit every object in the database
         This is usually called during import.
 
@@ -140,6 +191,16 @@ public:
     //        TODO Document the parameter meanings.
     virtual void tune (int size, int age) = 0;
 
+    /** Set the approximate memory budget of the cache, in bytes.
+        Zero means the cache is only limited by its size and age.
+    */
+    virtual void tuneBytes (std::size_t bytes) = 0;
+
+    /** Retrieve the estimated memory used by cached objects, in bytes.
+        This is used for diagnostics.
+    */
+    virtual std::size_t getCacheBytes () = 0;
+
     // VFALCO TODO Document this.
     virtual void sweep () = 0;
 
@@ -34,6 +34,8 @@ public:
 
     void scheduleTask (Task& task);
 
+    void scheduleReadTask (Task& task);
+
     void scheduledTasksStopped ();
 };
 
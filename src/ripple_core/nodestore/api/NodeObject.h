@@ -149,4 +149,14 @@ private:
     Blob mData;
 };
 
+/** Counts the payload of a NodeObject against the byte target of a cache. */
+template <>
+struct TaggedCacheBytes <NodeObject>
+{
+    static std::size_t get (NodeObject const& object)
+    {
+        return sizeof (NodeObject) + object.getData ().capacity ();
+    }
+};
+
 #endif
@@ -28,9 +28,9 @@ namespace NodeStore
     
     For improved performance, a backend has the option of performing writes
     in batches. These writes can be scheduled using the provided scheduler
-    object.
+    object. The database also uses it to perform asynchronous reads.
 
-    @see BatchWriter
+    @see BatchWriter, AsyncReader
 */
 class Scheduler
 {
@@ -43,6 +43,14 @@ public:
         foreign thread.
     */
     virtual void scheduleTask (Task& task) = 0;
+
+    /** Schedules a task which reads from the backend.
+        Reads are kept apart from scheduled writes so that they can be
+        given their own threads, since a caller may be waiting on them
+        and a backlog of writes should not hold them up. The same
+        threading rules as for @ref scheduleTask apply.
+    */
+    virtual void scheduleReadTask (Task& task) = 0;
 };
 
 }
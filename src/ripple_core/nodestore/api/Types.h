@@ -29,7 +29,22 @@ enum
     // This is only used to pre-allocate the array for
     // batch objects and does not affect the amount written.
     //
-    batchWritePreallocationSize = 128
+    batchWritePreallocationSize = 128,
+
+    // The largest number of keys an asynchronous read
+    // task looks up in a single call to the backend.
+    //
+    batchReadSize = 64,
+
+    // The most asynchronous read tasks that may be
+    // scheduled at once for a single database.
+    //
+    asyncReadTaskLimit = 8,
+
+    // Prefetch hints are dropped once this many
+    // asynchronous reads are already waiting.
+    //
+    prefetchQueueLimit = 8192
 };
 
 /** Return codes from Backend operations. */
@@ -44,6 +59,11 @@ enum Status
 /** A batch of NodeObjects to write at once. */
 typedef std::vector <NodeObject::Ptr> Batch;
 
+/** Called with the result of an asynchronous fetch.
+    The object is `nullptr` if it could not be retrieved.
+*/
+typedef FUNCTION_TYPE <void (NodeObject::Ptr const&)> FetchCallback;
+
 /** A list of key/value parameter pairs passed to the backend. */
 typedef StringPairArray Parameters;
 
@@ -90,51 +90,90 @@ public:
 
     Status fetch (void const* key, NodeObject::Ptr* pObject)
     {
-        pObject->reset ();
+        hyperleveldb::ReadOptions const options;
 
-        Status status (ok);
+        // These are reused std::string objects,
+        // required for leveldb's funky interface.
+        //
+        StringPool::ScopedItem item (m_stringPool);
 
-        hyperleveldb::ReadOptions const options;
-        hyperleveldb::Slice const slice (static_cast <char const*> (key), m_keyBytes);
+        return fetchWith (options, key, item.getObject (), pObject);
+    }
+
+    Status fetchBatch (std::vector <uint256> const& keys, Batch* pObjects)
+    {
+        pObjects->clear ();
+        pObjects->resize (keys.size ());
+
+        Status result (ok);
+
+        // Read every key from the same snapshot, in ascending order, so
+        // that neighbouring keys come out of blocks already in the cache.
+        //
+        hyperleveldb::ReadOptions options;
+        options.snapshot = m_db->GetSnapshot ();
 
         {
-            // These are reused std::string objects,
-            // required for leveldb's funky interface.
-            //
             StringPool::ScopedItem item (m_stringPool);
-            std::string& string = item.getObject ();
 
-            hyperleveldb::Status getStatus = m_db->Get (options, slice, &string);
+            FetchOrder const order (keys);
 
-            if (getStatus.ok ())
+            for (std::size_t n = 0; n < order.size (); ++n)
             {
-                DecodedBlob decoded (key, string.data (), string.size ());
+                Status const status = fetchWith (options, order.key (n).begin (),
+                    item.getObject (), &(*pObjects) [order [n]]);
 
-                if (decoded.wasOk ())
-                {
-                    *pObject = decoded.createObject ();
-                }
-                else
-                {
-                    // Decoding failed, probably corrupted!
-                    //
-                    status = dataCorrupt;
-                }
+                if (status != ok && status != notFound && result == ok)
+                    result = status;
+            }
+        }
+
+        m_db->ReleaseSnapshot (options.snapshot);
+
+        return result;
+    }
+
+    Status fetchWith (hyperleveldb::ReadOptions const& options,
+                      void const* key,
+                      std::string& string,
+                      NodeObject::Ptr* pObject)
+    {
+        pObject->reset ();
+
+        Status status (ok);
+
+        hyperleveldb::Slice const slice (static_cast <char const*> (key), m_keyBytes);
+
+        hyperleveldb::Status getStatus = m_db->Get (options, slice, &string);
+
+        if (getStatus.ok ())
+        {
+            DecodedBlob decoded (key, string.data (), string.size ());
+
+            if (decoded.wasOk ())
+            {
+                *pObject = decoded.createObject ();
             }
             else
             {
-                if (getStatus.IsCorruption ())
-                {
-                    status = dataCorrupt;
-                }
-                else if (getStatus.IsNotFound ())
-                {
-                    status = notFound;
-                }
-                else
-                {
-                    status = unknown;
-                }
+                // Decoding failed, probably corrupted!
+                //
+                status = dataCorrupt;
+            }
+        }
+        else
+        {
+            if (getStatus.IsCorruption ())
+            {
+                status = dataCorrupt;
+            }
+            else if (getStatus.IsNotFound ())
+            {
+                status = notFound;
+            }
+            else
+            {
+                status = unknown;
             }
         }
 
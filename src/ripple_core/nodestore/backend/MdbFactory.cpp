@@ -127,39 +127,91 @@ public:
 
         if (error == 0)
         {
-            MDB_val dbkey;
-            MDB_val data;
+            status = fetchWith (txn, key, pObject);
 
-            dbkey.mv_size = m_keyBytes;
-            dbkey.mv_data = mdb_cast (key);
+            mdb_txn_abort (txn);
+        }
+        else
+        {
+            status = unknown;
+
+            WriteLog (lsWARNING, NodeObject) << "MDB txn failed, code=" << error;
+        }
 
-            error = mdb_get (txn, m_dbi, &dbkey, &data);
+        return status;
+    }
 
-            if (error == 0)
+    Status fetchBatch (std::vector <uint256> const& keys, Batch* pObjects)
+    {
+        pObjects->clear ();
+        pObjects->resize (keys.size ());
+
+        Status result (ok);
+
+        MDB_txn* txn = nullptr;
+
+        int error = 0;
+
+        // One read transaction covers the whole batch, and walking the
+        // keys in ascending order keeps the B-tree pages we touch warm.
+        //
+        error = mdb_txn_begin (m_env, NULL, MDB_RDONLY, &txn);
+
+        if (error == 0)
+        {
+            FetchOrder const order (keys);
+
+            for (std::size_t n = 0; n < order.size (); ++n)
             {
-                DecodedBlob decoded (key, data.mv_data, data.mv_size);
+                Status const status = fetchWith (txn, order.key (n).begin (),
+                    &(*pObjects) [order [n]]);
 
-                if (decoded.wasOk ())
-                {
-                    *pObject = decoded.createObject ();
-                }
-                else
-                {
-                    status = dataCorrupt;
-                }
+                if (status != ok && status != notFound && result == ok)
+                    result = status;
             }
-            else if (error == MDB_NOTFOUND)
+
+            mdb_txn_abort (txn);
+        }
+        else
+        {
+            result = unknown;
+
+            WriteLog (lsWARNING, NodeObject) << "MDB txn failed, code=" << error;
+        }
+
+        return result;
+    }
+
+    Status fetchWith (MDB_txn* txn, void const* key, NodeObject::Ptr* pObject)
+    {
+        pObject->reset ();
+
+        Status status (ok);
+
+        MDB_val dbkey;
+        MDB_val data;
+
+        dbkey.mv_size = m_keyBytes;
+        dbkey.mv_data = mdb_cast (key);
+
+        int const error = mdb_get (txn, m_dbi, &dbkey, &data);
+
+        if (error == 0)
+        {
+            DecodedBlob decoded (key, data.mv_data, data.mv_size);
+
+            if (decoded.wasOk ())
             {
-                status = notFound;
+                *pObject = decoded.createObject ();
             }
             else
             {
-                status = unknown;
-
-                WriteLog (lsWARNING, NodeObject) << "MDB txn failed, code=" << error;
+                status = dataCorrupt;
             }
-
-            mdb_txn_abort (txn);
+        }
+        else if (error == MDB_NOTFOUND)
+        {
+            status = notFound;
         }
         else
         {
@@ -63,6 +63,24 @@ public:
         return ok;
     }
 
+    Status fetchBatch (std::vector <uint256> const& keys, Batch* pObjects)
+    {
+        pObjects->clear ();
+        pObjects->reserve (keys.size ());
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            Map::iterator iter = m_map.find (keys [i]);
+
+            if (iter != m_map.end ())
+                pObjects->push_back (iter->second);
+            else
+                pObjects->push_back (NodeObject::Ptr ());
+        }
+
+        return ok;
+    }
+
     void store (NodeObject::ref object)
     {
         Map::iterator iter = m_map.find (object->getHash ());
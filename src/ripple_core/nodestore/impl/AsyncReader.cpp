@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+namespace NodeStore
+{
+
+AsyncReader::AsyncReader (Database& database, Scheduler& scheduler)
+    : m_database (database)
+    , m_scheduler (scheduler)
+    , m_activeTasks (0)
+{
+}
+
+AsyncReader::~AsyncReader ()
+{
+    waitForReading ();
+}
+
+void AsyncReader::fetch (uint256 const& hash, FetchCallback const& callback)
+{
+    LockType::scoped_lock sl (m_mutex);
+
+    m_pending.push_back (Request (hash, callback));
+
+    scheduleIfNeeded (sl);
+}
+
+void AsyncReader::prefetch (std::vector <uint256> const& hashes)
+{
+    if (hashes.empty ())
+        return;
+
+    LockType::scoped_lock sl (m_mutex);
+
+    if (m_pending.size () >= prefetchQueueLimit)
+        return;
+
+    for (std::size_t i = 0; i < hashes.size (); ++i)
+        m_pending.push_back (Request (hashes [i], FetchCallback ()));
+
+    scheduleIfNeeded (sl);
+}
+
+int AsyncReader::getReadLoad ()
+{
+    LockType::scoped_lock sl (m_mutex);
+
+    return static_cast <int> (m_pending.size ());
+}
+
+void AsyncReader::scheduleIfNeeded (LockType::scoped_lock& lock)
+{
+    // Schedule one task for each full batch of
+    // waiting reads, up to the limit.
+    //
+    for (;;)
+    {
+        int const wanted = std::min (static_cast <int> (asyncReadTaskLimit),
+            static_cast <int> ((m_pending.size () + batchReadSize - 1) / batchReadSize));
+
+        if (m_activeTasks >= wanted)
+            break;
+
+        ++m_activeTasks;
+
+        // The scheduler might run the task synchronously.
+        //
+        lock.unlock ();
+        m_scheduler.scheduleReadTask (*this);
+        lock.lock ();
+    }
+}
+
+void AsyncReader::performScheduledTask ()
+{
+    std::vector <uint256> hashes;
+    std::vector <FetchCallback> callbacks;
+    Batch objects;
+
+    hashes.reserve (batchReadSize);
+    callbacks.reserve (batchReadSize);
+
+    for (;;)
+    {
+        hashes.clear ();
+        callbacks.clear ();
+
+        {
+            LockType::scoped_lock sl (m_mutex);
+
+            if (m_pending.empty ())
+            {
+                --m_activeTasks;
+                m_condition.notify_all ();
+
+                return;
+            }
+
+            while (! m_pending.empty () && hashes.size () < batchReadSize)
+            {
+                hashes.push_back (m_pending.front ().hash);
+                callbacks.push_back (m_pending.front ().callback);
+                m_pending.pop_front ();
+            }
+        }
+
+        m_database.fetchBatch (hashes, &objects);
+
+        for (std::size_t i = 0; i < callbacks.size (); ++i)
+        {
+            if (callbacks [i])
+                callbacks [i] (objects [i]);
+        }
+    }
+}
+
+void AsyncReader::waitForReading ()
+{
+    LockType::scoped_lock sl (m_mutex);
+
+    while (m_activeTasks > 0)
+        m_condition.wait (sl);
+}
+
+}
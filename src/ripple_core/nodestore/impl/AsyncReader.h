@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_NODESTORE_ASYNCREADER_H_INCLUDED
+#define RIPPLE_NODESTORE_ASYNCREADER_H_INCLUDED
+
+namespace NodeStore
+{
+
+/** Asynchronous read assist logic.
+
+    Requested keys are queued and looked up in batches by read tasks
+    scheduled with the Scheduler, so the caller's thread never blocks on
+    the backend. At most @ref asyncReadTaskLimit tasks are scheduled at
+    once, each one drains the queue until it is empty.
+
+    @see Scheduler, Database::asyncFetch, Database::prefetch
+*/
+class AsyncReader : private Task
+{
+public:
+    /** Create an asynchronous reader.
+        The objects are retrieved using Database::fetchBatch, so that
+        they end up in the database's cache.
+    */
+    AsyncReader (Database& database, Scheduler& scheduler);
+
+    /** Destroy the asynchronous reader.
+
+        Pending reads are completed and their callbacks invoked
+        before this returns.
+    */
+    ~AsyncReader ();
+
+    /** Queue a read whose result is passed to the callback.
+        The callback is invoked on a scheduler thread.
+    */
+    void fetch (uint256 const& hash, FetchCallback const& callback);
+
+    /** Queue reads whose results are only wanted in the cache.
+        If too many reads are already waiting the hint is dropped.
+    */
+    void prefetch (std::vector <uint256> const& hashes);
+
+    /** Get the number of reads that have not been started yet. */
+    int getReadLoad ();
+
+private:
+    struct Request
+    {
+        Request ()
+        {
+        }
+
+        Request (uint256 const& hash_, FetchCallback const& callback_)
+            : hash (hash_)
+            , callback (callback_)
+        {
+        }
+
+        uint256 hash;
+        FetchCallback callback;     // empty for a prefetch
+    };
+
+    typedef boost::recursive_mutex LockType;
+    typedef boost::condition_variable_any CondvarType;
+
+    void performScheduledTask ();
+    void scheduleIfNeeded (LockType::scoped_lock& lock);
+    void waitForReading ();
+
+private:
+    Database& m_database;
+    Scheduler& m_scheduler;
+    LockType m_mutex;
+    CondvarType m_condition;
+    std::deque <Request> m_pending;
+    int m_activeTasks;
+};
+
+}
+
+#endif
@@ -36,7 +36,10 @@ public:
             ? createBackend (fastBackendParameters, scheduler) : nullptr)
         , m_cache ("NodeStore", 16384, 300)
         , m_negativeCache ("NoteStoreNegativeCache", 0, 120)
+        , m_reader (*this, scheduler)
     {
+        // Keep full ledger traversals from flushing the working set
+        m_cache.setEvictionPolicy (TaggedCache::evictByClock);
     }
 
     ~DatabaseImp ()
@@ -165,6 +168,155 @@ public:
 
     //------------------------------------------------------------------------------
 
+    int fetchBatch (std::vector <uint256> const& hashes, Batch* pObjects)
+    {
+        pObjects->clear ();
+        pObjects->resize (hashes.size ());
+
+        // Positions in hashes of the objects we still need to find.
+        //
+        std::vector <std::size_t> missing;
+        missing.reserve (hashes.size ());
+
+        int found = 0;
+
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            NodeObject::Ptr obj = m_cache.fetch (hashes [i]);
+
+            if (obj != nullptr)
+            {
+                (*pObjects) [i] = obj;
+                ++found;
+            }
+            else if (! m_negativeCache.isPresent (hashes [i]))
+            {
+                missing.push_back (i);
+            }
+        }
+
+        // Check the fast backend database if we have one
+        //
+        if (! missing.empty () && m_fastBackend != nullptr)
+            found += fetchBatchInternal (m_fastBackend, hashes, missing, pObjects, false);
+
+        // Whatever remains has to come from the main database.
+        //
+        if (! missing.empty ())
+        {
+            found += fetchBatchInternal (m_backend, hashes, missing, pObjects,
+                m_fastBackend != nullptr);
+
+            // Remember the objects that are not in the main database so
+            // we can skip the lookup for the same objects again later.
+            //
+            for (std::size_t i = 0; i < missing.size (); ++i)
+                m_negativeCache.add (hashes [missing [i]]);
+        }
+
+        return found;
+    }
+
+    void asyncFetch (uint256 const& hash, FetchCallback const& callback)
+    {
+        NodeObject::Ptr obj = m_cache.fetch (hash);
+
+        if (obj != nullptr || m_negativeCache.isPresent (hash))
+        {
+            callback (obj);
+        }
+        else
+        {
+            m_reader.fetch (hash, callback);
+        }
+    }
+
+    void prefetch (std::vector <uint256> const& hashes)
+    {
+        std::vector <uint256> wanted;
+        wanted.reserve (hashes.size ());
+
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            if (! m_cache.refreshIfPresent (hashes [i]) &&
+                ! m_negativeCache.isPresent (hashes [i]))
+            {
+                wanted.push_back (hashes [i]);
+            }
+        }
+
+        m_reader.prefetch (wanted);
+    }
+
+    /** Look up the missing objects in one backend call.
+        Found objects are canonicalized, placed into pObjects and removed
+        from missing. If copyToFastBackend is set, objects that were found
+        are also stored in the fast backend.
+        @return The number of objects found.
+    */
+    int fetchBatchInternal (Backend* backend,
+                            std::vector <uint256> const& hashes,
+                            std::vector <std::size_t>& missing,
+                            Batch* pObjects,
+                            bool copyToFastBackend)
+    {
+        std::vector <uint256> keys;
+        keys.reserve (missing.size ());
+
+        for (std::size_t i = 0; i < missing.size (); ++i)
+            keys.push_back (hashes [missing [i]]);
+
+        Batch results;
+
+        Status const status = backend->fetchBatch (keys, &results);
+
+        switch (status)
+        {
+        case ok:
+        case notFound:
+            break;
+
+        case dataCorrupt:
+            // VFALCO TODO Deal with encountering corrupt data!
+            //
+            WriteLog (lsFATAL, NodeObject) << "Corrupt NodeObject in batch fetch";
+            break;
+
+        default:
+            WriteLog (lsWARNING, NodeObject) << "Unknown status=" << status;
+            break;
+        }
+
+        int found = 0;
+        std::size_t stillMissing = 0;
+
+        for (std::size_t i = 0; i < missing.size (); ++i)
+        {
+            NodeObject::Ptr obj (results [i]);
+
+            if (obj != nullptr)
+            {
+                m_cache.canonicalize (keys [i], obj);
+
+                if (copyToFastBackend)
+                    m_fastBackend->store (obj);
+
+                (*pObjects) [missing [i]] = obj;
+                ++found;
+            }
+            else
+            {
+                missing [stillMissing++] = missing [i];
+            }
+        }
+
+        missing.resize (stillMissing);
+
+        return found;
+    }
+
+    //------------------------------------------------------------------------------
+
     void store (NodeObjectType type,
                 uint32 index,
                 Blob& data,
@@ -197,6 +349,35 @@ public:
         }
     }
 
+    void storeBatch (Batch const& batch)
+    {
+        Batch toWrite;
+        toWrite.reserve (batch.size ());
+
+        BOOST_FOREACH (NodeObject::Ptr const& object, batch)
+        {
+            uint256 const& hash = object->getHash ();
+
+            if (! m_cache.refreshIfPresent (hash))
+            {
+                NodeObject::Ptr cached (object);
+
+                if (!m_cache.canonicalize (hash, cached))
+                    toWrite.push_back (cached);
+
+                m_negativeCache.del (hash);
+            }
+        }
+
+        if (! toWrite.empty ())
+        {
+            m_backend->storeBatch (toWrite);
+
+            if (m_fastBackend)
+                m_fastBackend->storeBatch (toWrite);
+        }
+    }
+
     //------------------------------------------------------------------------------
 
     float getCacheHitRate ()
@@ -210,6 +391,16 @@ public:
         m_cache.setTargetAge (age);
     }
 
+    void tuneBytes (std::size_t bytes)
+    {
+        m_cache.setTargetBytes (bytes);
+    }
+
+    std::size_t getCacheBytes ()
+    {
+        return m_cache.getCacheBytes ();
+    }
+
     void sweep ()
     {
         m_cache.sweep ();
@@ -316,8 +507,12 @@ private:
     ScopedPointer <Backend> m_fastBackend;
 
     // VFALCO NOTE What are these things for? We need comments.
-    TaggedCacheType <uint256, NodeObject, UptimeTimerAdapter> m_cache;
+    ShardedTaggedCacheType <uint256, NodeObject, UptimeTimerAdapter> m_cache;
     KeyCache <uint256, UptimeTimerAdapter> m_negativeCache;
+
+    // Performs asyncFetch and prefetch. This is declared last so that
+    // pending reads finish before anything they use is destroyed.
+    AsyncReader m_reader;
 };
 
 //------------------------------------------------------------------------------
@@ -35,6 +35,12 @@ void DummyScheduler::scheduleTask (Task& task)
     task.performScheduledTask();
 }
 
+void DummyScheduler::scheduleReadTask (Task& task)
+{
+    // Invoke the task synchronously.
+    task.performScheduledTask();
+}
+
 void DummyScheduler::scheduledTasksStopped ()
 {
 }
@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_NODESTORE_FETCHORDER_H_INCLUDED
+#define RIPPLE_NODESTORE_FETCHORDER_H_INCLUDED
+
+namespace NodeStore
+{
+
+/** Determines the order in which a batch of keys is looked up.
+
+    Backends which store their keys sorted can read neighbouring keys
+    much more cheaply if the lookups are made in ascending key order,
+    since the pages or blocks they need are usually already loaded.
+    This produces the positions of the keys in that order, so that the
+    results can still be placed where the caller expects them.
+*/
+class FetchOrder
+{
+public:
+    explicit FetchOrder (std::vector <uint256> const& keys)
+        : m_keys (keys)
+    {
+        m_order.reserve (keys.size ());
+
+        for (std::size_t i = 0; i < keys.size (); ++i)
+            m_order.push_back (i);
+
+        std::sort (m_order.begin (), m_order.end (), KeyLess (keys));
+    }
+
+    /** Returns the number of keys. */
+    std::size_t size () const
+    {
+        return m_order.size ();
+    }
+
+    /** Returns the position in the original list of the n-th smallest key. */
+    std::size_t operator[] (std::size_t n) const
+    {
+        return m_order [n];
+    }
+
+    /** Returns the n-th smallest key. */
+    uint256 const& key (std::size_t n) const
+    {
+        return m_keys [m_order [n]];
+    }
+
+private:
+    struct KeyLess
+    {
+        explicit KeyLess (std::vector <uint256> const& keys)
+            : m_keys (keys)
+        {
+        }
+
+        bool operator() (std::size_t lhs, std::size_t rhs) const
+        {
+            return m_keys [lhs] < m_keys [rhs];
+        }
+
+        std::vector <uint256> const& m_keys;
+    };
+
+    std::vector <uint256> const& m_keys;
+    std::vector <std::size_t> m_order;
+};
+
+}
+
+#endif
@@ -62,6 +62,29 @@ public:
                 fetchCopyOfBatch (*backend, &copy, batch);
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
+
+            {
+                // Read it back in with a batch fetch
+                Batch copy;
+                fetchBatchCopyOfBatch (*backend, &copy, batch);
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
+
+            {
+                // Batch fetch keys which are not in the backend
+                Batch missing;
+                createPredictableBatch (missing, numObjectsToTest, 10, seedValue);
+
+                Batch copy;
+                fetchBatchCopyOfBatch (*backend, &copy, missing);
+
+                bool allNull = true;
+                for (int i = 0; i < copy.size (); ++i)
+                    if (copy [i] != nullptr)
+                        allNull = false;
+
+                expect (allNull, "Should not be found");
+            }
         }
 
         {
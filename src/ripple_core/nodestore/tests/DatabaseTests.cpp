@@ -139,6 +139,13 @@ public:
                 fetchCopyOfBatch (*db, &copy, batch);
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
+
+            {
+                // Read it back in with a batch fetch
+                Batch copy;
+                fetchBatchCopyOfBatch (*db, &copy, batch);
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
         }
 
         if (testPersistence)
@@ -157,6 +164,20 @@ public:
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
 
+            {
+                // Re-open the database without the ephemeral DB
+                ScopedPointer <Database> db (Database::New ("test", scheduler, nodeParams));
+
+                // Read it back in with a batch fetch
+                Batch copy;
+                fetchBatchCopyOfBatch (*db, &copy, batch);
+
+                // Canonicalize the source and destination batches
+                std::sort (batch.begin (), batch.end (), NodeObject::LessThan ());
+                std::sort (copy.begin (), copy.end (), NodeObject::LessThan ());
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
+
             if (useEphemeralDatabase)
             {
                 // Verify the ephemeral db
@@ -177,6 +198,113 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void testStoreBatch (String type, int64 const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        beginTestCase (String ("storeBatch '") + type + "'");
+
+        File const node_db (File::createTempFile ("node_db"));
+        StringPairArray nodeParams;
+        nodeParams.set ("type", type);
+        nodeParams.set ("path", node_db.getFullPathName ());
+
+        Batch batch;
+        createPredictableBatch (batch, 0, numObjectsToTest, seedValue);
+
+        {
+            ScopedPointer <Database> db (Database::New ("test", scheduler, nodeParams));
+
+            // Store half, then all of it, so some objects are already cached
+            Batch half (batch.begin (), batch.begin () + batch.size () / 2);
+            db->storeBatch (half);
+            db->storeBatch (batch);
+
+            Batch copy;
+            fetchCopyOfBatch (*db, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+        }
+
+        {
+            // Re-open the db so nothing is cached
+            ScopedPointer <Database> db (Database::New ("test", scheduler, nodeParams));
+
+            Batch copy;
+            fetchBatchCopyOfBatch (*db, &copy, batch);
+
+            std::sort (batch.begin (), batch.end (), NodeObject::LessThan ());
+            std::sort (copy.begin (), copy.end (), NodeObject::LessThan ());
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    // Collects the results of asynchronous fetches
+    struct FetchResults
+    {
+        FetchResults ()
+            : missing (0)
+        {
+        }
+
+        void add (NodeObject::Ptr const& object)
+        {
+            if (object != nullptr)
+                batch.push_back (object);
+            else
+                ++missing;
+        }
+
+        Batch batch;
+        int missing;
+    };
+
+    void testAsyncFetch (String type, int64 const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        beginTestCase (String ("asyncFetch and prefetch '") + type + "'");
+
+        File const node_db (File::createTempFile ("node_db"));
+        StringPairArray nodeParams;
+        nodeParams.set ("type", type);
+        nodeParams.set ("path", node_db.getFullPathName ());
+
+        Batch batch;
+        createPredictableBatch (batch, 0, numObjectsToTest, seedValue);
+
+        // Write to the db
+        {
+            ScopedPointer <Database> db (Database::New ("test", scheduler, nodeParams));
+            storeBatch (*db, batch);
+        }
+
+        // Re-open the db so nothing is cached
+        ScopedPointer <Database> db (Database::New ("test", scheduler, nodeParams));
+
+        std::vector <uint256> hashes;
+        for (int i = 0; i < batch.size (); ++i)
+            hashes.push_back (batch [i]->getHash ());
+
+        db->prefetch (hashes);
+
+        FetchResults results;
+        for (int i = 0; i < hashes.size (); ++i)
+            db->asyncFetch (hashes [i], BIND_TYPE (&FetchResults::add, &results, P_1));
+
+        // Fetch some objects that were never stored
+        Batch missing;
+        createPredictableBatch (missing, numObjectsToTest, 10, seedValue);
+        for (int i = 0; i < missing.size (); ++i)
+            db->asyncFetch (missing [i]->getHash (), BIND_TYPE (&FetchResults::add, &results, P_1));
+
+        expect (results.missing == missing.size (), "Should not be found");
+        expect (areBatchesEqual (batch, results.batch), "Should be equal");
+    }
+
+    //--------------------------------------------------------------------------
+
     void runBackendTests (bool useEphemeralDatabase, int64 const seedValue)
     {
         testNodeStore ("leveldb", useEphemeralDatabase, true, seedValue);
@@ -234,6 +362,10 @@ public:
         runBackendTests (true, seedValue);
 
         runImportTests (seedValue);
+
+        testAsyncFetch ("leveldb", seedValue);
+
+        testStoreBatch ("leveldb", seedValue);
     }
 };
 
@@ -149,6 +149,22 @@ public:
         }
     }
 
+    // Get a copy of a batch in a backend using a single batch fetch
+    void fetchBatchCopyOfBatch (Backend& backend, Batch* pCopy, Batch const& batch)
+    {
+        std::vector <uint256> keys;
+        keys.reserve (batch.size ());
+
+        for (int i = 0; i < batch.size (); ++i)
+            keys.push_back (batch [i]->getHash ());
+
+        Status const status = backend.fetchBatch (keys, pCopy);
+
+        expect (status == ok, "Should be ok");
+
+        expect (pCopy->size () == batch.size (), "Should be the same size");
+    }
+
     // Store all objects in a batch
     static void storeBatch (Database& db, Batch const& batch)
     {
@@ -182,6 +198,31 @@ public:
         }
     }
 
+    // Fetch all the hashes in one batch with a single batch fetch,
+    // keeping only the objects which were found.
+    static void fetchBatchCopyOfBatch (Database& db,
+                                       Batch* pCopy,
+                                       Batch const& batch)
+    {
+        std::vector <uint256> hashes;
+        hashes.reserve (batch.size ());
+
+        for (int i = 0; i < batch.size (); ++i)
+            hashes.push_back (batch [i]->getHash ());
+
+        Batch results;
+        db.fetchBatch (hashes, &results);
+
+        pCopy->clear ();
+        pCopy->reserve (results.size ());
+
+        for (int i = 0; i < results.size (); ++i)
+        {
+            if (results [i] != nullptr)
+                pCopy->push_back (results [i]);
+        }
+    }
+
     TestBase (String name, UnitTest::When when = UnitTest::runNormal)
         : UnitTest (name, "ripple", when)
     {
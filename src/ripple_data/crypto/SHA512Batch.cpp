@@ -0,0 +1,324 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+// A message being hashed in one lane
+struct SHA512Batch::Lane
+{
+    int index;                      // message number, or -1 if idle
+    unsigned char prefix [4];
+    int prefixSize;
+    unsigned char const* data;
+    int size;
+    int block;                      // next block to compress
+    int blocks;                     // total blocks, including padding
+};
+
+void SHA512Batch::getHalf (uint32 prefix, bool usePrefix,
+                           unsigned char const* const* data, int const* sizes,
+                           int count, uint256* results)
+{
+    if ((count > 1) && isAccelerated ())
+        getHalfLanes (prefix, usePrefix, data, sizes, count, results);
+    else
+        getHalfSerial (prefix, usePrefix, data, sizes, count, results);
+}
+
+void SHA512Batch::getHalfSerial (uint32 prefix, bool usePrefix,
+                                 unsigned char const* const* data, int const* sizes,
+                                 int count, uint256* results)
+{
+    unsigned char be_prefix[4];
+    be_prefix[0] = static_cast<unsigned char> (prefix >> 24);
+    be_prefix[1] = static_cast<unsigned char> ((prefix >> 16) & 0xff);
+    be_prefix[2] = static_cast<unsigned char> ((prefix >> 8) & 0xff);
+    be_prefix[3] = static_cast<unsigned char> (prefix & 0xff);
+
+    for (int i = 0; i < count; ++i)
+    {
+        uint256 j[2];
+        SHA512_CTX ctx;
+        SHA512_Init (&ctx);
+
+        if (usePrefix)
+            SHA512_Update (&ctx, &be_prefix[0], 4);
+
+        SHA512_Update (&ctx, data[i], sizes[i]);
+        SHA512_Final (reinterpret_cast<unsigned char*> (&j[0]), &ctx);
+        results[i] = j[0];
+    }
+}
+
+// Returns the next 128 byte block of the padded message: prefix, data,
+// a one bit, zeros, and the length in bits in the last 16 bytes. Blocks
+// that lie entirely within the data are used in place, the others are
+// built in the scratch buffer.
+unsigned char const* SHA512Batch::getBlock (unsigned char* block, Lane const& lane)
+{
+    int const offset = lane.block * 128;
+    int const total = lane.prefixSize + lane.size;
+
+    if ((offset >= lane.prefixSize) && ((offset + 128) <= total))
+        return lane.data + offset - lane.prefixSize;
+
+    memset (block, 0, 128);
+
+    for (int p = offset; (p < lane.prefixSize) && (p < offset + 128); ++p)
+        block[p - offset] = lane.prefix[p];
+
+    int const begin = std::max (offset, lane.prefixSize);
+    int const end = std::min (total, offset + 128);
+
+    if (end > begin)
+        memcpy (block + begin - offset, lane.data + begin - lane.prefixSize, end - begin);
+
+    if ((total >= offset) && (total < offset + 128))
+        block[total - offset] = 0x80;
+
+    if (lane.block == (lane.blocks - 1))
+    {
+        uint64 const bits = static_cast<uint64> (total) * 8;
+
+        for (int i = 0; i < 8; ++i)
+            block[127 - i] = static_cast<unsigned char> (bits >> (8 * i));
+    }
+
+    return block;
+}
+
+//------------------------------------------------------------------------------
+
+#if RIPPLE_SHA512BATCH_AVX2
+
+static uint64 const sha512K [80] =
+{
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static uint64 const sha512H0 [8] =
+{
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+#define RIPPLE_SHA512_ROTR(x, n) \
+    _mm256_or_si256 (_mm256_srli_epi64 ((x), (n)), _mm256_slli_epi64 ((x), 64 - (n)))
+
+static inline long long sha512LoadBE (unsigned char const* p)
+{
+    uint64 v;
+    memcpy (&v, p, sizeof (v));
+    return static_cast<long long> (__builtin_bswap64 (v));
+}
+
+// Compresses one block into each of four states. state[w][lane] holds
+// word w of the state for that lane.
+__attribute__ ((target ("avx2")))
+static void sha512Compress4 (uint64 state [8][4], unsigned char const* const blocks [4])
+{
+    __m256i w [80];
+
+    for (int t = 0; t < 16; ++t)
+    {
+        w[t] = _mm256_set_epi64x (
+            sha512LoadBE (blocks[3] + 8 * t), sha512LoadBE (blocks[2] + 8 * t),
+            sha512LoadBE (blocks[1] + 8 * t), sha512LoadBE (blocks[0] + 8 * t));
+    }
+
+    for (int t = 16; t < 80; ++t)
+    {
+        __m256i const w15 = w[t - 15];
+        __m256i const w2 = w[t - 2];
+
+        __m256i const s0 = _mm256_xor_si256 (_mm256_xor_si256 (
+            RIPPLE_SHA512_ROTR (w15, 1), RIPPLE_SHA512_ROTR (w15, 8)), _mm256_srli_epi64 (w15, 7));
+        __m256i const s1 = _mm256_xor_si256 (_mm256_xor_si256 (
+            RIPPLE_SHA512_ROTR (w2, 19), RIPPLE_SHA512_ROTR (w2, 61)), _mm256_srli_epi64 (w2, 6));
+
+        w[t] = _mm256_add_epi64 (_mm256_add_epi64 (w[t - 16], s0),
+                                 _mm256_add_epi64 (w[t - 7], s1));
+    }
+
+    __m256i h [8];
+
+    for (int i = 0; i < 8; ++i)
+        h[i] = _mm256_loadu_si256 (reinterpret_cast<__m256i const*> (state[i]));
+
+    __m256i a = h[0], b = h[1], c = h[2], d = h[3];
+    __m256i e = h[4], f = h[5], g = h[6], hh = h[7];
+
+    for (int t = 0; t < 80; ++t)
+    {
+        __m256i const S1 = _mm256_xor_si256 (_mm256_xor_si256 (
+            RIPPLE_SHA512_ROTR (e, 14), RIPPLE_SHA512_ROTR (e, 18)), RIPPLE_SHA512_ROTR (e, 41));
+        __m256i const ch = _mm256_xor_si256 (_mm256_and_si256 (e, f), _mm256_andnot_si256 (e, g));
+        __m256i const t1 = _mm256_add_epi64 (
+            _mm256_add_epi64 (_mm256_add_epi64 (hh, S1), _mm256_add_epi64 (ch, w[t])),
+            _mm256_set1_epi64x (static_cast<long long> (sha512K[t])));
+
+        __m256i const S0 = _mm256_xor_si256 (_mm256_xor_si256 (
+            RIPPLE_SHA512_ROTR (a, 28), RIPPLE_SHA512_ROTR (a, 34)), RIPPLE_SHA512_ROTR (a, 39));
+        __m256i const maj = _mm256_xor_si256 (_mm256_and_si256 (a, _mm256_xor_si256 (b, c)),
+                                              _mm256_and_si256 (b, c));
+        __m256i const t2 = _mm256_add_epi64 (S0, maj);
+
+        hh = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi64 (d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi64 (t1, t2);
+    }
+
+    h[0] = _mm256_add_epi64 (h[0], a);
+    h[1] = _mm256_add_epi64 (h[1], b);
+    h[2] = _mm256_add_epi64 (h[2], c);
+    h[3] = _mm256_add_epi64 (h[3], d);
+    h[4] = _mm256_add_epi64 (h[4], e);
+    h[5] = _mm256_add_epi64 (h[5], f);
+    h[6] = _mm256_add_epi64 (h[6], g);
+    h[7] = _mm256_add_epi64 (h[7], hh);
+
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (state[i]), h[i]);
+}
+
+#undef RIPPLE_SHA512_ROTR
+
+bool SHA512Batch::isAccelerated ()
+{
+    static bool const avx2 = __builtin_cpu_supports ("avx2");
+    return avx2;
+}
+
+void SHA512Batch::getHalfLanes (uint32 prefix, bool usePrefix,
+                                unsigned char const* const* data, int const* sizes,
+                                int count, uint256* results)
+{
+    int const lanes = 4;
+
+    Lane lane [lanes];
+    uint64 state [8][lanes];
+    unsigned char scratch [lanes][128];
+    unsigned char const* blocks [lanes];
+
+    int next = 0;
+    int active = 0;
+
+    for (int l = 0; l < lanes; ++l)
+    {
+        lane[l].index = -1;
+        lane[l].prefixSize = usePrefix ? 4 : 0;
+        lane[l].prefix[0] = static_cast<unsigned char> (prefix >> 24);
+        lane[l].prefix[1] = static_cast<unsigned char> ((prefix >> 16) & 0xff);
+        lane[l].prefix[2] = static_cast<unsigned char> ((prefix >> 8) & 0xff);
+        lane[l].prefix[3] = static_cast<unsigned char> (prefix & 0xff);
+        memset (scratch[l], 0, 128);
+        blocks[l] = scratch[l];
+
+        for (int i = 0; i < 8; ++i)
+            state[i][l] = sha512H0[i];
+    }
+
+    for (;;)
+    {
+        // Give idle lanes the next message
+        for (int l = 0; l < lanes; ++l)
+        {
+            if ((lane[l].index < 0) && (next < count))
+            {
+                lane[l].index = next;
+                lane[l].data = data[next];
+                lane[l].size = sizes[next];
+                lane[l].block = 0;
+                lane[l].blocks = (lane[l].prefixSize + lane[l].size + 16 + 1 + 127) / 128;
+                ++next;
+                ++active;
+
+                for (int i = 0; i < 8; ++i)
+                    state[i][l] = sha512H0[i];
+            }
+        }
+
+        if (active == 0)
+            break;
+
+        // Idle lanes are compressed too, their results are ignored
+        for (int l = 0; l < lanes; ++l)
+        {
+            if (lane[l].index >= 0)
+                blocks[l] = getBlock (scratch[l], lane[l]);
+        }
+
+        sha512Compress4 (state, blocks);
+
+        for (int l = 0; l < lanes; ++l)
+        {
+            if ((lane[l].index >= 0) && (++lane[l].block == lane[l].blocks))
+            {
+                unsigned char* out = results[lane[l].index].begin ();
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    for (int j = 0; j < 8; ++j)
+                        out[8 * i + j] = static_cast<unsigned char> (state[i][l] >> (56 - 8 * j));
+                }
+
+                lane[l].index = -1;
+                --active;
+            }
+        }
+    }
+}
+
+#else
+
+bool SHA512Batch::isAccelerated ()
+{
+    return false;
+}
+
+void SHA512Batch::getHalfLanes (uint32 prefix, bool usePrefix,
+                                unsigned char const* const* data, int const* sizes,
+                                int count, uint256* results)
+{
+    getHalfSerial (prefix, usePrefix, data, sizes, count, results);
+}
+
+#endif
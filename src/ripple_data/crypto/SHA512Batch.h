@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHA512BATCH_H
+#define RIPPLE_SHA512BATCH_H
+
+/** Computes the SHA512Half of several independent messages at once.
+
+    On processors with AVX2, four messages go through each pass of the
+    SHA-512 compression function, one in each 64 bit lane. A lane that
+    finishes its message picks up the next one, so messages of different
+    lengths can be mixed. Elsewhere each message is hashed on its own with
+    OpenSSL.
+
+    The results are identical to Serializer::getSHA512Half, or to
+    Serializer::getPrefixHash when a prefix is used.
+*/
+class SHA512Batch
+{
+public:
+    /** Hash count messages, placing the SHA512Half of each in results.
+
+        @param prefix    A value hashed big endian before each message.
+        @param usePrefix Whether prefix is hashed at all.
+    */
+    static void getHalf (uint32 prefix, bool usePrefix,
+                         unsigned char const* const* data, int const* sizes,
+                         int count, uint256* results);
+
+    /** Returns true if more than one message is hashed per pass. */
+    static bool isAccelerated ();
+
+private:
+    struct Lane;
+
+    static void getHalfSerial (uint32 prefix, bool usePrefix,
+                               unsigned char const* const* data, int const* sizes,
+                               int count, uint256* results);
+
+    static void getHalfLanes (uint32 prefix, bool usePrefix,
+                              unsigned char const* const* data, int const* sizes,
+                              int count, uint256* results);
+
+    static unsigned char const* getBlock (unsigned char* block, Lane const& lane);
+};
+
+#endif
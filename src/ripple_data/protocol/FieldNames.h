@@ -128,6 +128,16 @@ public:
     }
 
     std::string getName () const;
+
+    /** The name as a Json::Value member name which is never copied.
+        Values using it must not outlive the field, which is why this is
+        only for fields that have a name of their own.
+    */
+    Json::StaticString getJsonName () const
+    {
+        return Json::StaticString (fieldName.c_str ());
+    }
+
     bool hasName () const
     {
         return !fieldName.empty ();
@@ -529,7 +529,7 @@ int STAmount::compare (const STAmount& a) const
     return 0;
 }
 
-STAmount* STAmount::construct (SerializerIterator& sit, SField::ref name)
+STAmount STAmount::decode (SerializerIterator& sit, SField::ref name)
 {
     uint64 value = sit.get64 ();
 
@@ -537,11 +537,11 @@ STAmount* STAmount::construct (SerializerIterator& sit, SField::ref name)
     {
         // native
         if ((value & cPosNative) != 0)
-            return new STAmount (name, value & ~cPosNative, false); // positive
+            return STAmount (name, value & ~cPosNative, false); // positive
         else if (value == 0)
             throw std::runtime_error ("negative zero is not canonical");
 
-        return new STAmount (name, value, true); // negative
+        return STAmount (name, value, true); // negative
     }
 
     uint160 uCurrencyID = sit.get160 ();
@@ -562,13 +562,18 @@ STAmount* STAmount::construct (SerializerIterator& sit, SField::ref name)
         if ((value < cMinValue) || (value > cMaxValue) || (offset < cMinOffset) || (offset > cMaxOffset))
             throw std::runtime_error ("invalid currency value");
 
-        return new STAmount (name, uCurrencyID, uIssuerID, value, offset, isNegative);
+        return STAmount (name, uCurrencyID, uIssuerID, value, offset, isNegative);
     }
 
     if (offset != 512)
         throw std::runtime_error ("invalid currency value");
 
-    return new STAmount (name, uCurrencyID, uIssuerID);
+    return STAmount (name, uCurrencyID, uIssuerID);
+}
+
+STAmount* STAmount::construct (SerializerIterator& sit, SField::ref name)
+{
+    return new STAmount (decode (sit, name));
 }
 
 int64 STAmount::getSNValue () const
@@ -899,6 +904,101 @@ STAmount operator- (const STAmount& v1, const STAmount& v2)
         return STAmount (v1.getFName (), v1.mCurrency, v1.mIssuer, -fv, ov1, true);
 }
 
+//------------------------------------------------------------------------------
+
+// Computes floor ((a * b + addend) / divisor) using fixed width arithmetic.
+//
+// The intermediate value always fits in 128 bits. If the quotient does not
+// fit in 64 bits, all ones is returned, the same as the CBigNum code this
+// replaces produced on 64 bit platforms. None of the callers can get there,
+// since both their operands are normalized.
+//
+#if defined (__SIZEOF_INT128__)
+
+static inline uint64 mulDivU64 (uint64 a, uint64 b, uint64 addend, uint64 divisor)
+{
+    unsigned __int128 v = static_cast <unsigned __int128> (a) * b + addend;
+
+    if ((v >> 64) >= divisor)
+        return ~static_cast <uint64> (0);
+
+    return static_cast <uint64> (v / divisor);
+}
+
+#else
+
+static uint64 mulDivU64 (uint64 a, uint64 b, uint64 addend, uint64 divisor)
+{
+    uint64 const mask = 0xffffffffull;
+
+    // 64 x 64 -> 128 bit multiply, in 32 bit halves
+    uint64 const ll = (a & mask) * (b & mask);
+    uint64 const lh = (a & mask) * (b >> 32);
+    uint64 const hl = (a >> 32) * (b & mask);
+    uint64 const hh = (a >> 32) * (b >> 32);
+
+    uint64 const mid = (ll >> 32) + (lh & mask) + (hl & mask);
+
+    uint64 hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    uint64 lo = (mid << 32) | (ll & mask);
+
+    lo += addend;
+
+    if (lo < addend)
+        ++hi;
+
+    if (hi >= divisor)
+        return ~static_cast <uint64> (0);
+
+    // 128 / 64 -> 64 bit divide, two 32 bit digits at a time (Knuth D)
+    int shift = 0;
+
+    while ((divisor & (1ull << 63)) == 0)
+    {
+        divisor <<= 1;
+        ++shift;
+    }
+
+    if (shift != 0)
+    {
+        hi = (hi << shift) | (lo >> (64 - shift));
+        lo <<= shift;
+    }
+
+    uint64 const dh = divisor >> 32;
+    uint64 const dl = divisor & mask;
+
+    uint64 q1 = hi / dh;
+    uint64 r = hi - q1 * dh;
+
+    while ((q1 > mask) || (q1 * dl > ((r << 32) | (lo >> 32))))
+    {
+        --q1;
+        r += dh;
+
+        if (r > mask)
+            break;
+    }
+
+    uint64 const rem = ((hi << 32) | (lo >> 32)) - q1 * divisor;
+
+    uint64 q0 = rem / dh;
+    r = rem - q0 * dh;
+
+    while ((q0 > mask) || (q0 * dl > ((r << 32) | (lo & mask))))
+    {
+        --q0;
+        r += dh;
+
+        if (r > mask)
+            break;
+    }
+
+    return (q1 << 32) | q0;
+}
+
+#endif
+
 STAmount STAmount::divide (const STAmount& num, const STAmount& den, const uint160& uCurrencyID, const uint160& uIssuerID)
 {
     if (den.isZero ())
@@ -926,19 +1026,10 @@ STAmount STAmount::divide (const STAmount& num, const STAmount& den, const uint1
         }
 
     // Compute (numerator * 10^17) / denominator
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, numVal) != 1) ||
-            (BN_mul_word64 (&v, tenTo17) != 1) ||
-            (BN_div_word64 (&v, denVal) == ((uint64) - 1)))
-    {
-        throw std::runtime_error ("internal bn error");
-    }
-
     // 10^16 <= quotient <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
+    uint64 const v = mulDivU64 (numVal, tenTo17, 0, denVal);
 
-    return STAmount (uCurrencyID, uIssuerID, v.getuint64 () + 5,
+    return STAmount (uCurrencyID, uIssuerID, v + 5,
                      numOffset - denOffset - 17, num.mIsNegative != den.mIsNegative);
 }
 
@@ -983,20 +1074,10 @@ STAmount STAmount::multiply (const STAmount& v1, const STAmount& v2, const uint1
     }
 
     // Compute (numerator * denominator) / 10^14 with rounding
-    // 10^16 <= result <= 10^18
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, value1) != 1) ||
-            (BN_mul_word64 (&v, value2) != 1) ||
-            (BN_div_word64 (&v, tenTo14) == ((uint64) - 1)))
-    {
-        throw std::runtime_error ("internal bn error");
-    }
-
     // 10^16 <= product <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
+    uint64 const v = mulDivU64 (value1, value2, 0, tenTo14);
 
-    return STAmount (uCurrencyID, uIssuerID, v.getuint64 () + 7, offset1 + offset2 + 14,
+    return STAmount (uCurrencyID, uIssuerID, v + 7, offset1 + offset2 + 14,
                      v1.mIsNegative != v2.mIsNegative);
 }
 
@@ -1215,9 +1296,7 @@ STAmount STAmount::getPay (const STAmount& offerOut, const STAmount& offerIn, co
 
 STAmount STAmount::deserialize (SerializerIterator& it)
 {
-    UPTR_T<STAmount> s (dynamic_cast<STAmount*> (construct (it, sfGeneric)));
-    STAmount ret (*s);
-    return ret;
+    return decode (it, sfGeneric);
 }
 
 std::string STAmount::getFullText () const
@@ -1921,15 +2000,192 @@ public:
 
     //--------------------------------------------------------------------------
 
+    // The arbitrary precision computation that mulDivU64 replaced
+    static uint64 bigMulDiv (uint64 a, uint64 b, uint64 addend, uint64 divisor)
+    {
+        CBigNum v;
+
+        if ((BN_add_word64 (&v, a) != 1) ||
+                (BN_mul_word64 (&v, b) != 1) ||
+                (BN_add_word64 (&v, addend) != 1) ||
+                (BN_div_word64 (&v, divisor) == ((uint64) - 1)))
+        {
+            throw std::runtime_error ("internal bn error");
+        }
+
+        return v.getuint64 ();
+    }
+
+    static uint64 randomValue (Random& r, uint64 low, uint64 high)
+    {
+        return low + (static_cast <uint64> (r.nextInt64 ()) % (high - low + 1));
+    }
+
+    void testMulDiv ()
+    {
+        beginTestCase ("fixed width arithmetic");
+
+        Random r (1234);
+        int failures = 0;
+
+        for (int i = 0; i < 100000; ++i)
+        {
+            uint64 a, b, addend, divisor;
+
+            if ((i % 2) == 0)
+            {
+                // divide and divRound
+                a = randomValue (r, STAmount::cMinValue, 10 * STAmount::cMaxValue);
+                b = tenTo17;
+                divisor = randomValue (r, STAmount::cMinValue, 10 * STAmount::cMaxValue);
+                addend = r.nextBool () ? (divisor - 1) : 0;
+            }
+            else
+            {
+                // multiply and mulRound
+                a = randomValue (r, STAmount::cMinValue, 10 * STAmount::cMaxValue);
+                b = randomValue (r, STAmount::cMinValue, 10 * STAmount::cMaxValue);
+                divisor = tenTo14;
+                addend = r.nextBool () ? tenTo14m1 : 0;
+            }
+
+            if (mulDivU64 (a, b, addend, divisor) != bigMulDiv (a, b, addend, divisor))
+                ++failures;
+        }
+
+        // Operands near the limits of 64 bits
+        for (int i = 0; i < 100000; ++i)
+        {
+            uint64 const a = static_cast <uint64> (r.nextInt64 ()) >> r.nextInt (64);
+            uint64 const b = static_cast <uint64> (r.nextInt64 ()) >> r.nextInt (64);
+            uint64 const addend = static_cast <uint64> (r.nextInt64 ()) >> r.nextInt (64);
+            uint64 const divisor = (static_cast <uint64> (r.nextInt64 ()) >> r.nextInt (64)) | 1;
+
+            CBigNum v (a);
+            v *= CBigNum (b);
+            v += CBigNum (addend);
+            v /= CBigNum (divisor);
+
+            // An oversized quotient saturates
+            uint64 const expected = (BN_num_bits (&v) > 64)
+                ? ~static_cast <uint64> (0) : v.getuint64 ();
+
+            if (mulDivU64 (a, b, addend, divisor) != expected)
+                ++failures;
+        }
+
+        expect (failures == 0, "mulDivU64 differs from CBigNum");
+    }
+
+    //--------------------------------------------------------------------------
+
     void runTest ()
     {
         testSetValue ();
         testNativeCurrency ();
         testCustomCurrency ();
         testArithmetic ();
+        testMulDiv ();
         testUnderflow ();
         testRounding ();
     }
 };
 
 static STAmountTests stAmountTests;
+
+//------------------------------------------------------------------------------
+
+class STAmountTimingTests : public UnitTest
+{
+public:
+    enum
+    {
+        numberOfOperations = 1000000
+    };
+
+    STAmountTimingTests () : UnitTest ("STAmountTiming", "ripple", runManual)
+    {
+    }
+
+    static STAmount randomAmount (Random& r)
+    {
+        uint64 const value = STAmount::cMinValue +
+            static_cast <uint64> (r.nextInt64 ()) % (STAmount::cMaxValue - STAmount::cMinValue);
+
+        return STAmount (CURRENCY_ONE, ACCOUNT_ONE, value, r.nextInt (20) - 10, r.nextBool ());
+    }
+
+    void logElapsed (char const* name, int64 const startTime)
+    {
+        double const elapsed = Time::highResolutionTicksToSeconds (
+            Time::getHighResolutionTicks () - startTime);
+
+        String s;
+        s << "  " << name << ": " << String (elapsed * 1e9 / numberOfOperations, 1)
+          << " ns per operation";
+        logMessage (s);
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("multiply and divide");
+
+        Random r (1234);
+        std::vector <STAmount> amounts;
+        amounts.reserve (numberOfOperations + 1);
+
+        for (int i = 0; i <= numberOfOperations; ++i)
+            amounts.push_back (randomAmount (r));
+
+        // Keep the results live so the loops are not optimized away
+        uint64 check = 0;
+        int64 startTime;
+
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += STAmount::multiply (amounts[i], amounts[i + 1], CURRENCY_ONE, ACCOUNT_ONE).getMantissa ();
+
+        logElapsed ("multiply", startTime);
+
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += STAmount::divide (amounts[i], amounts[i + 1], CURRENCY_ONE, ACCOUNT_ONE).getMantissa ();
+
+        logElapsed ("divide", startTime);
+
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += STAmount::mulRound (amounts[i], amounts[i + 1], CURRENCY_ONE, ACCOUNT_ONE, (i & 1) != 0).getMantissa ();
+
+        logElapsed ("mulRound", startTime);
+
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += STAmount::divRound (amounts[i], amounts[i + 1], CURRENCY_ONE, ACCOUNT_ONE, (i & 1) != 0).getMantissa ();
+
+        logElapsed ("divRound", startTime);
+
+        // The CBigNum computation the above used to perform
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += STAmountTests::bigMulDiv (amounts[i].getMantissa (), amounts[i + 1].getMantissa (), 0, tenTo14);
+
+        logElapsed ("CBigNum muldiv", startTime);
+
+        startTime = Time::getHighResolutionTicks ();
+
+        for (int i = 0; i < numberOfOperations; ++i)
+            check += mulDivU64 (amounts[i].getMantissa (), amounts[i + 1].getMantissa (), 0, tenTo14);
+
+        logElapsed ("fixed width muldiv", startTime);
+
+        expect (check != 0);
+    }
+};
+
+static STAmountTimingTests stAmountTimingTests;
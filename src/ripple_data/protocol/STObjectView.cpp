@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+STObjectView::STObjectView (Serializer const& data)
+    : mData (data)
+    , mParsed (false)
+    , mCount (0)
+{
+}
+
+int STObjectView::getCount () const
+{
+    parse ();
+
+    return mCount;
+}
+
+void STObjectView::addField (int code, int offset, int length) const
+{
+    Field const field = { code, offset, length };
+
+    if (mCount < inlineFields)
+        mFields [mCount] = field;
+    else
+        mMore.push_back (field);
+
+    ++mCount;
+}
+
+void STObjectView::parse () const
+{
+    if (mParsed)
+        return;
+
+    // Reference is not const only to keep out temporaries
+    SerializerIterator sit (const_cast <Serializer&> (mData));
+
+    while (!sit.empty ())
+    {
+        int type;
+        int index;
+        sit.getFieldID (type, index);
+
+        if ((type == STI_OBJECT) && (index == 1))
+            break;
+
+        int const code = FIELD_CODE (type, index);
+        int offset = sit.getPos ();
+        int length;
+
+        switch (type)
+        {
+        case STI_UINT8:     length = 1;             break;
+        case STI_UINT16:    length = 2;             break;
+        case STI_UINT32:    length = 4;             break;
+        case STI_UINT64:    length = 8;             break;
+        case STI_HASH128:   length = 128 / 8;       break;
+        case STI_HASH160:   length = 160 / 8;       break;
+        case STI_HASH256:   length = 256 / 8;       break;
+
+        case STI_AMOUNT:
+            // Only native amounts fit in one 64 bit word
+            length = ((mData.peekData ().at (offset) & 0x80) != 0) ? (64 + 160 + 160) / 8 : 64 / 8;
+            break;
+
+        case STI_VL:
+        case STI_ACCOUNT:
+        case STI_VECTOR256:
+            {
+                if (!mData.getVLLength (length, offset))
+                    throw std::runtime_error ("invalid length");
+
+                offset += Serializer::decodeLengthLength (mData.peekData ().at (offset));
+            }
+            break;
+
+        default:
+            {
+                // Objects, arrays and path sets are only delimited by
+                // their contents, so the way past them is to parse them
+                SField::ref fn = SField::getField (type, index);
+
+                if (fn.isInvalid ())
+                    throw std::runtime_error ("Unknown field");
+
+                STObject::makeDeserializedObject (fn.fieldType, fn, sit, 1);
+                length = sit.getPos () - offset;
+            }
+            break;
+        }
+
+        if ((length < 0) || (length > (mData.getLength () - offset)))
+            throw std::runtime_error ("field overruns object");
+
+        addField (code, offset, length);
+        sit.setPos (offset + length);
+    }
+
+    mParsed = true;
+}
+
+STObjectView::Field const* STObjectView::findField (SField::ref field, SerializedTypeID type) const
+{
+    if (field.fieldType != type)
+        throw std::runtime_error ("Wrong field type");
+
+    parse ();
+
+    for (int i = 0; i < mCount; ++i)
+    {
+        Field const& f = (i < inlineFields) ? mFields [i] : mMore [i - inlineFields];
+
+        if (f.code == field.fieldCode)
+            return &f;
+    }
+
+    return nullptr;
+}
+
+bool STObjectView::isFieldPresent (SField::ref field) const
+{
+    return findField (field, field.fieldType) != nullptr;
+}
+
+unsigned char STObjectView::getFieldU8 (SField::ref field) const
+{
+    unsigned char value = 0;
+    Field const* f = findField (field, STI_UINT8);
+
+    if (f != nullptr)
+        mData.get8 (value, f->offset);
+
+    return value;
+}
+
+uint16 STObjectView::getFieldU16 (SField::ref field) const
+{
+    uint16 value = 0;
+    Field const* f = findField (field, STI_UINT16);
+
+    if (f != nullptr)
+        mData.get16 (value, f->offset);
+
+    return value;
+}
+
+uint32 STObjectView::getFieldU32 (SField::ref field) const
+{
+    uint32 value = 0;
+    Field const* f = findField (field, STI_UINT32);
+
+    if (f != nullptr)
+        mData.get32 (value, f->offset);
+
+    return value;
+}
+
+uint64 STObjectView::getFieldU64 (SField::ref field) const
+{
+    uint64 value = 0;
+    Field const* f = findField (field, STI_UINT64);
+
+    if (f != nullptr)
+        mData.get64 (value, f->offset);
+
+    return value;
+}
+
+uint128 STObjectView::getFieldH128 (SField::ref field) const
+{
+    uint128 value;
+    Field const* f = findField (field, STI_HASH128);
+
+    if (f != nullptr)
+        mData.get128 (value, f->offset);
+
+    return value;
+}
+
+uint160 STObjectView::getFieldH160 (SField::ref field) const
+{
+    uint160 value;
+    Field const* f = findField (field, STI_HASH160);
+
+    if (f != nullptr)
+        mData.get160 (value, f->offset);
+
+    return value;
+}
+
+uint256 STObjectView::getFieldH256 (SField::ref field) const
+{
+    uint256 value;
+    Field const* f = findField (field, STI_HASH256);
+
+    if (f != nullptr)
+        mData.get256 (value, f->offset);
+
+    return value;
+}
+
+uint160 STObjectView::getFieldAccount160 (SField::ref field) const
+{
+    uint160 value;
+    Field const* f = findField (field, STI_ACCOUNT);
+
+    // Like STAccount, an account of any other length has no value
+    if ((f != nullptr) && (f->length == (160 / 8)))
+        mData.get160 (value, f->offset);
+
+    return value;
+}
+
+RippleAddress STObjectView::getFieldAccount (SField::ref field) const
+{
+    RippleAddress a;
+    Field const* f = findField (field, STI_ACCOUNT);
+
+    if ((f != nullptr) && (f->length == (160 / 8)))
+    {
+        uint160 value;
+        mData.get160 (value, f->offset);
+        a.setAccountID (value);
+    }
+
+    return a;
+}
+
+Blob STObjectView::getFieldVL (SField::ref field) const
+{
+    Field const* f = findField (field, STI_VL);
+
+    if (f == nullptr)
+        return Blob ();
+
+    return mData.getRaw (f->offset, f->length);
+}
+
+STAmount STObjectView::getFieldAmount (SField::ref field) const
+{
+    Field const* f = findField (field, STI_AMOUNT);
+
+    if (f == nullptr)
+        return STAmount ();
+
+    SerializerIterator sit (const_cast <Serializer&> (mData));
+    sit.setPos (f->offset);
+
+    STAmount amount (STAmount::deserialize (sit));
+    amount.setFName (field);
+    return amount;
+}
+
+UPTR_T<STObject> STObjectView::getObject (SField::ref name) const
+{
+    SerializerIterator sit (const_cast <Serializer&> (mData));
+
+    UPTR_T<STObject> object (new STObject (name));
+    object->set (sit);
+    return object;
+}
+
+//------------------------------------------------------------------------------
+
+class STObjectViewTests : public UnitTest
+{
+public:
+    STObjectViewTests () : UnitTest ("STObjectView", "ripple")
+    {
+    }
+
+    void runTest ()
+    {
+        beginTestCase ("fields");
+
+        uint160 const currency (1);
+        uint160 const issuer (2);
+
+        STObject object (sfLedgerEntry);
+        object.setFieldU16 (sfLedgerEntryType, 0x72);
+        object.setFieldU32 (sfFlags, 0x20000);
+        object.setFieldU64 (sfIndexNext, 9);
+        object.setFieldH256 (sfPreviousTxnID, uint256 (4));
+        object.setFieldAccount (sfAccount, issuer);
+        object.setFieldVL (sfDomain, Blob (300, 7));
+        object.setFieldAmount (sfBalance, STAmount (sfBalance, currency, issuer, 1234, -2));
+        object.setFieldAmount (sfTakerPays, STAmount (sfTakerPays, uint64 (5000)));
+
+        STArray memos (sfTemplate);
+        memos.push_back (STObject (sfModifiedNode));
+        memos.back ().setFieldU32 (sfSequence, 3);
+        object.giveObject (memos.clone ());
+
+        object.setFieldU32 (sfSequence, 77);
+
+        Serializer s;
+        object.add (s);
+        STObjectView view (s);
+
+        unexpected (view.getCount () != object.getCount (), "bad field count");
+        unexpected (view.getFieldU16 (sfLedgerEntryType) != 0x72, "bad U16");
+        unexpected (view.getFlags () != 0x20000, "bad flags");
+        unexpected (view.getFieldU64 (sfIndexNext) != 9, "bad U64");
+        unexpected (view.getFieldH256 (sfPreviousTxnID) != uint256 (4), "bad H256");
+        unexpected (view.getFieldAccount160 (sfAccount) != issuer, "bad account");
+        unexpected (view.getFieldVL (sfDomain) != Blob (300, 7), "bad VL");
+        unexpected (view.getFieldAmount (sfBalance) != object.getFieldAmount (sfBalance), "bad amount");
+        unexpected (view.getFieldAmount (sfTakerPays) != object.getFieldAmount (sfTakerPays), "bad native amount");
+        unexpected (view.getFieldU32 (sfSequence) != 77, "bad field after array");
+
+        unexpected (view.isFieldPresent (sfOwnerCount) || (view.getFieldU32 (sfOwnerCount) != 0),
+                    "bad absent field");
+
+        UPTR_T<STObject> copy (view.getObject (sfLedgerEntry));
+        unexpected (copy->getSerializer () != s, "bad conversion");
+    }
+};
+
+static STObjectViewTests stObjectViewTests;
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_STOBJECTVIEW_H
+#define RIPPLE_STOBJECTVIEW_H
+
+/** A read-only view of a serialized object.
+
+    The fields are located in the serialized bytes the first time one is
+    asked for, and each value is read straight from the bytes when it is
+    requested. Nothing is allocated to read a scalar field, so reading a
+    few fields of a ledger entry costs far less than building an STObject.
+
+    Absent fields read as default values, as optional fields of an
+    STObject do. Malformed data throws, as deserializing it would.
+
+    The view does not own the bytes, the Serializer must outlive it. A
+    view is not safe to share between threads until a field has been read,
+    since the first read records where the fields are.
+*/
+class STObjectView
+{
+public:
+    explicit STObjectView (Serializer const& data);
+
+    int getCount () const;
+    bool isFieldPresent (SField::ref field) const;
+
+    unsigned char getFieldU8 (SField::ref field) const;
+    uint16 getFieldU16 (SField::ref field) const;
+    uint32 getFieldU32 (SField::ref field) const;
+    uint64 getFieldU64 (SField::ref field) const;
+    uint128 getFieldH128 (SField::ref field) const;
+    uint160 getFieldH160 (SField::ref field) const;
+    uint256 getFieldH256 (SField::ref field) const;
+    RippleAddress getFieldAccount (SField::ref field) const;
+    uint160 getFieldAccount160 (SField::ref field) const;
+    Blob getFieldVL (SField::ref field) const;
+    STAmount getFieldAmount (SField::ref field) const;
+
+    uint32 getFlags () const
+    {
+        return getFieldU32 (sfFlags);
+    }
+
+    /** Deserialize the whole object, for when it has to be changed. */
+    UPTR_T<STObject> getObject (SField::ref name) const;
+
+private:
+    struct Field
+    {
+        int code;       // (type<<16)|index, as SField::fieldCode
+        int offset;     // First byte of the value, after any length
+        int length;     // Bytes in the value
+    };
+
+    enum
+    {
+        // Fields recorded without allocating, enough for any ledger entry
+        inlineFields = 24
+    };
+
+    void parse () const;
+    void addField (int code, int offset, int length) const;
+    Field const* findField (SField::ref field, SerializedTypeID type) const;
+
+    Serializer const& mData;
+
+    mutable bool mParsed;
+    mutable int mCount;
+    mutable Field mFields [inlineFields];
+    mutable std::vector <Field> mMore;
+};
+
+#endif
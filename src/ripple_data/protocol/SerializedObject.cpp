@@ -137,6 +137,8 @@ UPTR_T<SerializedType> STObject::makeDeserializedObject (SerializedTypeID id, SF
 void STObject::set (const SOTemplate& type)
 {
     mData.clear ();
+    mData.reserve (type.peek ().size ());
+    mIndex.clear ();
     mType = &type;
 
     BOOST_FOREACH (const SOElement * elem, type.peek ())
@@ -202,6 +204,7 @@ bool STObject::setType (const SOTemplate& type)
     }
 
     mData.swap (newData);
+    mIndex.clear ();
     return valid;
 }
 
@@ -262,6 +265,7 @@ bool STObject::set (SerializerIterator& sit, int depth)
     // Empty the destination buffer
     //
     mData.clear ();
+    mIndex.clear ();
 
     // Consume data in the pipe until we run out or reach the end
     //
@@ -446,15 +450,45 @@ int STObject::getFieldIndex (SField::ref field) const
     if (mType != NULL)
         return mType->getIndex (field);
 
-    int i = 0;
-    BOOST_FOREACH (const SerializedType & elem, mData)
+    // Positions are never negative, so this finds the first field with the code
+    FieldIndex::const_iterator it = std::lower_bound (mIndex.begin (), mIndex.end (),
+                                    std::make_pair (field.fieldCode, -1));
+
+    if ((it == mIndex.end ()) || (it->first != field.fieldCode))
+        return -1;
+
+    return it->second;
+}
+
+int STObject::indexField (int index)
+{
+    if (mType == NULL)
+    {
+        std::pair <int, int> const entry (mData[index].getFName ().fieldCode, index);
+
+        // Fields are usually added in canonical order
+        if (mIndex.empty () || (mIndex.back () < entry))
+            mIndex.push_back (entry);
+        else
+            mIndex.insert (std::lower_bound (mIndex.begin (), mIndex.end (), entry), entry);
+    }
+
+    return index;
+}
+
+void STObject::rebuildIndex ()
+{
+    mIndex.clear ();
+
+    if (mType == NULL)
     {
-        if (elem.getFName () == field)
-            return i;
+        mIndex.reserve (mData.size ());
+
+        for (int i = 0; i < static_cast <int> (mData.size ()); ++i)
+            mIndex.push_back (std::make_pair (mData[i].getFName ().fieldCode, i));
 
-        ++i;
+        std::sort (mIndex.begin (), mIndex.end ());
     }
-    return -1;
 }
 
 const SerializedType& STObject::peekAtField (SField::ref field) const
@@ -622,6 +656,7 @@ bool STObject::delField (SField::ref field)
 void STObject::delField (int index)
 {
     mData.erase (mData.begin () + index);
+    rebuildIndex ();
 }
 
 std::string STObject::getFieldString (SField::ref field) const
@@ -1057,10 +1092,13 @@ Json::Value STObject::getJson (int options) const
     {
         if (it.getSType () != STI_NOTPRESENT)
         {
+            // Swap the member in rather than copying its whole subtree
+            Json::Value member (it.getJson (options));
+
             if (!it.getFName ().hasName ())
-                ret[lexicalCast <std::string> (index)] = it.getJson (options);
+                ret[lexicalCast <std::string> (index)].swap (member);
             else
-                ret[it.getName ()] = it.getJson (options);
+                ret[it.getFName ().getJsonName ()].swap (member);
         }
     }
     return ret;
@@ -1164,14 +1202,14 @@ Json::Value STArray::getJson (int p) const
     {
         if (object.getSType () != STI_NOTPRESENT)
         {
-            Json::Value inner = Json::objectValue;
+            Json::Value& inner = v.append (Json::objectValue);
+            Json::Value member (object.getJson (p));
 
             if (!object.getFName ().hasName ())
-                inner[lexicalCast <std::string> (index)] = object.getJson (p);
+                inner[lexicalCast <std::string> (index)].swap (member);
             else
-                inner[object.getName ()] = object.getJson (p);
+                inner[object.getFName ().getJsonName ()].swap (member);
 
-            v.append (inner);
             index++;
         }
     }
@@ -1594,6 +1632,7 @@ public:
         SField sfTestH256 (STI_HASH256, 255, "TestH256");
         SField sfTestU32 (STI_UINT32, 255, "TestU32");
         SField sfTestObject (STI_OBJECT, 255, "TestObject");
+        SField sfTestArray (STI_ARRAY, 255, "TestArray");
 
         SOTemplate elements;
         elements.push_back (SOElement (sfFlags, SOE_REQUIRED));
@@ -1662,6 +1701,50 @@ public:
 
             unexpected (object3.getFieldVL (sfTestVL) != j, "STObject error");
         }
+
+        beginTestCase ("free object lookup");
+
+        STObject free (sfTestObject);
+
+        // Out of canonical order, so the index has to insert
+        free.setFieldU32 (sfTestU32, 7);
+        free.setFieldH256 (sfTestH256, uint256 (3));
+        free.setFieldU32 (sfFlags, 5);
+
+        unexpected (!free.isFree () || (free.getCount () != 3), "free object error 1");
+        unexpected ((free.getFieldU32 (sfTestU32) != 7) || (free.getFieldU32 (sfFlags) != 5) ||
+                    (free.getFieldH256 (sfTestH256) != uint256 (3)), "free object error 2");
+        unexpected (free.isFieldPresent (sfTestVL), "free object error 3");
+
+        unexpected (!free.delField (sfTestH256), "free object error 4");
+        unexpected (free.isFieldPresent (sfTestH256) || (free.getFieldU32 (sfTestU32) != 7) ||
+                    (free.getFieldU32 (sfFlags) != 5), "free object error 5");
+
+        Serializer s;
+        free.add (s);
+        SerializerIterator it (s);
+        UPTR_T<SerializedType> parsed (STObject::deserialize (it, sfTestObject));
+        STObject const& object4 = static_cast <STObject const&> (*parsed);
+
+        unexpected ((object4.getFieldU32 (sfTestU32) != 7) || (object4.getFieldU32 (sfFlags) != 5) ||
+                    object4.isFieldPresent (sfTestH256), "free object error 6");
+
+        beginTestCase ("json");
+
+        STArray entries (sfTestArray);
+        entries.push_back (free);
+        entries.push_back (free);
+
+        Json::Value json (entries.getJson (0));
+
+        // Member names refer to the fields, and must survive a copy
+        Json::Value const copied (json);
+
+        unexpected (!copied.isArray () || (copied.size () != 2), "json error 1");
+        unexpected (!copied[1u].isMember ("TestObject") ||
+                    (copied[1u]["TestObject"]["TestU32"].asUInt () != 7) ||
+                    (copied[1u]["TestObject"]["Flags"].asUInt () != 5), "json error 2");
+        unexpected (copied != json, "json error 3");
     }
 };
 
@@ -38,12 +38,14 @@ public:
         ;
     }
 
-    STObject (const SOTemplate & type, SField::ref name) : SerializedType (name)
+    STObject (const SOTemplate & type, SField::ref name) : SerializedType (name), mType (NULL)
     {
         set (type);
     }
 
-    STObject (const SOTemplate & type, SerializerIterator & sit, SField::ref name) : SerializedType (name)
+    // The template is set first so that no field index is built
+    STObject (const SOTemplate & type, SerializerIterator & sit, SField::ref name)
+        : SerializedType (name), mType (&type)
     {
         set (sit);
         setType (type);
@@ -107,26 +109,22 @@ public:
     int addObject (const SerializedType & t)
     {
         mData.push_back (t.clone ().release ());
-        return mData.size () - 1;
+        return indexField (mData.size () - 1);
     }
     int giveObject (UPTR_T<SerializedType> t)
     {
         mData.push_back (t.release ());
-        return mData.size () - 1;
+        return indexField (mData.size () - 1);
     }
     int giveObject (SerializedType * t)
     {
         mData.push_back (t);
-        return mData.size () - 1;
+        return indexField (mData.size () - 1);
     }
     const boost::ptr_vector<SerializedType>& peekData () const
     {
         return mData;
     }
-    boost::ptr_vector<SerializedType>& peekData ()
-    {
-        return mData;
-    }
     SerializedType& front ()
     {
         return mData.front ();
@@ -314,11 +312,20 @@ private:
     STObject (SField::ref name, boost::ptr_vector<SerializedType>& data) : SerializedType (name), mType (NULL)
     {
         mData.swap (data);
+        rebuildIndex ();
     }
 
+    int indexField (int index);
+    void rebuildIndex ();
+
 private:
+    // Field code and position of each field of a free object, sorted.
+    // Objects with a template use the template's index instead.
+    typedef std::vector <std::pair <int, int> > FieldIndex;
+
     boost::ptr_vector<SerializedType>   mData;
     const SOTemplate*                   mType;
+    FieldIndex                          mIndex;
 };
 
 //------------------------------------------------------------------------------
@@ -501,7 +501,7 @@ Json::Value STPath::getJson (int) const
 
     BOOST_FOREACH (std::vector<STPathElement>::const_iterator::value_type it, mPath)
     {
-        Json::Value elem (Json::objectValue);
+        Json::Value& elem   = ret.append (Json::objectValue);
         int         iType   = it.getNodeType ();
 
         elem["type"]        = iType;
@@ -515,8 +515,6 @@ Json::Value STPath::getJson (int) const
 
         if (iType & STPathElement::typeIssuer)
             elem["issuer"]      = RippleAddress::createHumanAccountID (it.getIssuerID ());
-
-        ret.append (elem);
     }
 
     return ret;
@@ -527,7 +525,10 @@ Json::Value STPathSet::getJson (int options) const
     Json::Value ret (Json::arrayValue);
 
     BOOST_FOREACH (std::vector<STPath>::const_iterator::value_type it, value)
-    ret.append (it.getJson (options));
+    {
+        Json::Value path (it.getJson (options));
+        ret.append (Json::nullValue).swap (path);
+    }
 
     return ret;
 }
@@ -84,6 +84,18 @@ public:
 
     virtual ~SerializedType () { }
 
+    // Fields are created and destroyed in great numbers while transactions
+    // are applied and paths are found, so they come from the current Arena.
+    static void* operator new (std::size_t bytes)
+    {
+        return Arena::allocate (bytes);
+    }
+
+    static void operator delete (void* p)
+    {
+        Arena::deallocate (p);
+    }
+
     static UPTR_T<SerializedType> deserialize (SField::ref name)
     {
         return UPTR_T<SerializedType> (new SerializedType (name));
@@ -764,6 +776,7 @@ private:
     {
         return new STAmount (*this);
     }
+    static STAmount decode (SerializerIterator&, SField::ref name);
     static STAmount* construct (SerializerIterator&, SField::ref name);
 
     STAmount (SField::ref name, const uint160& cur, const uint160& iss, uint64 val, int off, bool isNat, bool isNeg)
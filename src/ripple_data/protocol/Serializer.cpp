@@ -381,6 +381,18 @@ uint256 Serializer::getPrefixHash (uint32 prefix, const unsigned char* data, int
     return j[0];
 }
 
+void Serializer::getSHA512HalfBatch (const unsigned char* const* data, const int* sizes, int count,
+                                     uint256* results)
+{
+    SHA512Batch::getHalf (0, false, data, sizes, count, results);
+}
+
+void Serializer::getPrefixHashBatch (uint32 prefix, const unsigned char* const* data, const int* sizes,
+                                     int count, uint256* results)
+{
+    SHA512Batch::getHalf (prefix, true, data, sizes, count, results);
+}
+
 bool Serializer::checkSignature (int pubkeyOffset, int signatureOffset) const
 {
     Blob pubkey, signature;
@@ -741,6 +753,49 @@ public:
         s2.addRaw (s1.peekData ());
 
         expect (s1.getPrefixHash (0x12345600) == s2.getSHA512Half ());
+
+        beginTestCase ("batch hash");
+
+        // Mixed lengths cover every padding case and lanes that finish
+        // their messages at different times
+        std::vector <Blob> buffers;
+        std::vector <const unsigned char*> data;
+        std::vector <int> sizes;
+
+        for (int size = 0; size < 300; ++size)
+        {
+            Blob buffer (size);
+
+            for (int i = 0; i < size; ++i)
+                buffer[i] = static_cast <unsigned char> (size + i);
+
+            buffers.push_back (buffer);
+        }
+
+        for (int i = 0; i < buffers.size (); ++i)
+        {
+            data.push_back (buffers[i].empty () ? NULL : &buffers[i].front ());
+            sizes.push_back (buffers[i].size ());
+        }
+
+        std::vector <uint256> results (buffers.size ());
+        Serializer::getSHA512HalfBatch (&data.front (), &sizes.front (), data.size (), &results.front ());
+
+        bool good = true;
+
+        for (int i = 0; i < buffers.size (); ++i)
+            good = good && (results[i] == Serializer::getSHA512Half (data[i], sizes[i]));
+
+        expect (good, "bad batch hash");
+
+        Serializer::getPrefixHashBatch (0x12345600, &data.front (), &sizes.front (), data.size (), &results.front ());
+
+        good = true;
+
+        for (int i = 0; i < buffers.size (); ++i)
+            good = good && (results[i] == Serializer::getPrefixHash (0x12345600, data[i], sizes[i]));
+
+        expect (good, "bad batch prefix hash");
     }
 };
 
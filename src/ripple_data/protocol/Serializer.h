@@ -118,6 +118,14 @@ public:
         return getPrefixHash (prefix, reinterpret_cast<const unsigned char*> (strData.data ()), strData.size ());
     }
 
+    // batch hash functions
+    // These hash count independent buffers, several at a time when possible.
+    // results[i] is the same as getSHA512Half or getPrefixHash of buffer i.
+    static void getSHA512HalfBatch (const unsigned char* const* data, const int* sizes, int count,
+                                    uint256* results);
+    static void getPrefixHashBatch (uint32 prefix, const unsigned char* const* data, const int* sizes,
+                                    int count, uint256* results);
+
     // totality functions
     Blob const& peekData () const
     {
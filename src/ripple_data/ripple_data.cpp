@@ -46,6 +46,20 @@
 
 #include "../ripple/sslutil/ripple_sslutil.h"
 
+// The multi-buffer SHA-512 in SHA512Batch.cpp uses AVX2 when the
+// processor has it, selected at run time.
+#ifndef RIPPLE_SHA512BATCH_AVX2
+# if BEAST_INTEL && BEAST_GCC && (BEAST_CLANG || (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define RIPPLE_SHA512BATCH_AVX2 1
+# else
+#  define RIPPLE_SHA512BATCH_AVX2 0
+# endif
+#endif
+
+#if RIPPLE_SHA512BATCH_AVX2
+#include <immintrin.h>
+#endif
+
 // VFALCO TODO fix these warnings!
 #if BEAST_MSVC
 #pragma warning (push)
@@ -61,12 +75,14 @@ namespace ripple
 
 #include "crypto/CKey.h" // needs RippleAddress VFALCO TODO remove this dependency cycle
 #include "crypto/RFC1751.h"
+#include "crypto/SHA512Batch.h"
 
 #include "crypto/CKey.cpp"
 #include "crypto/CKeyDeterministic.cpp"
 #include "crypto/CKeyECIES.cpp"
 #include "crypto/Base58Data.cpp"
 #include "crypto/RFC1751.cpp"
+#include "crypto/SHA512Batch.cpp"
 
 #include "protocol/BuildInfo.cpp"
 #include "protocol/FieldNames.cpp"
@@ -76,6 +92,7 @@ namespace ripple
 #include "protocol/Serializer.cpp"
 #include "protocol/SerializedObjectTemplate.cpp"
 #include "protocol/SerializedObject.cpp"
+#include "protocol/STObjectView.cpp"
 #include "protocol/TER.cpp"
 #include "protocol/TxFormats.cpp"
 
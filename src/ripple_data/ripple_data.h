@@ -46,6 +46,7 @@ namespace ripple {
  #include "protocol/LedgerFormats.h" // needs SOTemplate from SerializedObjectTemplate
  #include "protocol/TxFormats.h"
 #include "protocol/SerializedObject.h"
+#include "protocol/STObjectView.h"
 #include "protocol/TxFlags.h"
 
 #include "utility/UptimeTimerAdapter.h"
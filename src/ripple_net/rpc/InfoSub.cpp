@@ -38,6 +38,15 @@ InfoSub::Source::Source (char const* name, Stoppable& parent)
 
 //------------------------------------------------------------------------------
 
+InfoSub::Message::Message (Json::Value json)
+{
+    mJson.swap (json);
+    Json::FastWriter w;
+    mText = w.write (mJson);
+}
+
+//------------------------------------------------------------------------------
+
 InfoSub::InfoSub (Source& source)
     : mLock (this, "InfoSub", __FILE__, __LINE__)
     , m_source (source)
@@ -61,6 +70,11 @@ void InfoSub::send (const Json::Value& jvObj, const std::string& sObj, bool broa
     send (jvObj, broadcast);
 }
 
+void InfoSub::send (Message::pointer const& message, bool broadcast)
+{
+    send (message->getJson (), message->getText (), broadcast);
+}
+
 uint64 InfoSub::getSeq ()
 {
     return mSeq;
@@ -95,6 +95,37 @@ public:
         virtual pointer addRpcSub (const std::string& strUrl, ref rspEntry) = 0;
     };
 
+public:
+    /** A published event.
+
+        The event is serialized once when the message is made. The same
+        message is then handed to every subscriber of the event.
+    */
+    class Message
+    {
+    public:
+        typedef boost::shared_ptr <Message const> pointer;
+
+        /** Take over the event.
+            Pass a temporary or MOVE_P the value to avoid copying it.
+        */
+        explicit Message (Json::Value json);
+
+        Json::Value const& getJson () const
+        {
+            return mJson;
+        }
+
+        std::string const& getText () const
+        {
+            return mText;
+        }
+
+    private:
+        Json::Value mJson;
+        std::string mText;
+    };
+
 public:
     explicit InfoSub (Source& source);
 
@@ -105,6 +136,9 @@ public:
     // VFALCO NOTE Why is this virtual?
     virtual void send (const Json::Value & jvObj, const std::string & sObj, bool broadcast);
 
+    /** Send a published event. The default sends its JSON and text. */
+    virtual void send (Message::pointer const& message, bool broadcast);
+
     uint64 getSeq ();
 
     void onSendEmpty ();
@@ -142,6 +142,28 @@ std::string HTTPReply (int nStatus, const std::string& strMsg)
                strMsg.c_str ());
 }
 
+std::string HTTPStreamHeader ()
+{
+    WriteLog (lsTRACE, RPCLog) << "HTTP Reply 200 streamed";
+
+    std::string access;
+
+    if (getConfig ().RPC_ALLOW_REMOTE) access = "Access-Control-Allow-Origin: *\r\n";
+    else access = "";
+
+    return strprintf (
+               "HTTP/1.1 200 OK\r\n"
+               "Date: %s\r\n"
+               "Connection: close\r\n"
+               "%s"
+               "Content-Type: application/json; charset=UTF-8\r\n"
+               "Server: " SYSTEM_NAME "-json-rpc/%s\r\n"
+               "\r\n",
+               rfc1123Time ().c_str (),
+               access.c_str (),
+               BuildInfo::getFullVersionString ());
+}
+
 int ReadHTTPStatus (std::basic_istream<char>& stream)
 {
     std::string str;
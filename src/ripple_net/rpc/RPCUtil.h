@@ -37,6 +37,10 @@ extern std::string createHTTPPost (const std::string& strHost, const std::string
 
 extern std::string HTTPReply (int nStatus, const std::string& strMsg);
 
+// The header for a 200 reply whose JSON body follows in pieces. There is no
+// Content-Length, the end of the body is marked by closing the connection.
+extern std::string HTTPStreamHeader ();
+
 // VFALCO TODO Create a HTTPHeaders class with a nice interface instead of the std::map
 //
 extern bool HTTPAuthorized (std::map <std::string, std::string> const& mapHeaders);